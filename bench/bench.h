@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Minimal micro-benchmark harness for the packet primitives.
+ *
+ * Each case receives an iteration count and runs its hot loop that many times;
+ * the runner calibrates the count until one batch takes long enough to be
+ * measured reliably and reports ns/op, ops/s and heap allocations/op
+ * (bench_main replaces the global operator new to count them). `--json`
+ * prints one JSON object per case for tracking results across releases.
+ */
+namespace bench {
+
+using Body = std::function<void(std::uint64_t iterations)>;
+
+struct Case {
+    std::string name;
+    Body body;
+    std::size_t bytesPerOp = 0;  // When set, throughput is reported too
+};
+
+/** @brief All registered cases, in registration order. */
+std::vector<Case>& registry();
+
+/**
+ * @brief Static registration helper: `static bench::Register r("arp/x", fn);`
+ */
+struct Register {
+    Register(const char* name, Body body) { registry().push_back({name, std::move(body), 0}); }
+    Register(const char* name, std::size_t bytesPerOp, Body body)
+    {
+        registry().push_back({name, std::move(body), bytesPerOp});
+    }
+};
+
+/** @brief Prevent the compiler from discarding a computed value. */
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/** @brief Compiler barrier: forces pending stores to be treated as observable. */
+inline void clobberMemory()
+{
+    asm volatile("" : : : "memory");
+}
+
+}  // namespace bench
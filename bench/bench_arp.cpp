@@ -0,0 +1,119 @@
+#include "bench.h"
+#include "bench_frames.h"
+
+#include "arp.h"
+#include "ethernet.h"
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using namespace bench::frames;
+
+/**
+ * @brief Previous RX path: parse copy -> makeArpReply -> serialize.
+ */
+void replyLegacy(std::uint64_t iterations)
+{
+    const auto wire = arpRequestFrame();
+    std::vector<std::uint8_t> rxBuffer(2048);
+    std::string msg;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        std::memcpy(rxBuffer.data(), wire.data(), wire.size());
+        auto frame = parseEthernetII(rxBuffer.data(), wire.size());
+        auto reply = makeArpReply(*frame, kMyMac, kMyIp, msg);
+        auto bytes = serializeEthernetII(*reply);
+        bench::doNotOptimize(bytes.data());
+    }
+}
+
+/**
+ * @brief Fast path: validate and rewrite in the RX buffer.
+ */
+void replyInPlace(std::uint64_t iterations)
+{
+    const auto wire = arpRequestFrame();
+    std::vector<std::uint8_t> rxBuffer(2048);
+    ArpInfo request{};
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        std::memcpy(rxBuffer.data(), wire.data(), wire.size());
+        const std::size_t len = arpReplyInPlace(rxBuffer.data(), wire.size(), rxBuffer.size(),
+                                                kMyMac, kMyIp, request);
+        bench::doNotOptimize(len);
+        bench::clobberMemory();
+    }
+}
+
+void parseArp(std::uint64_t iterations)
+{
+    const auto wire = arpRequestFrame();
+    const auto frame = parseEthernetII(wire.data(), wire.size());
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto info = parseArpFrame(*frame);
+        bench::doNotOptimize(info);
+    }
+}
+
+void makeReply(std::uint64_t iterations)
+{
+    const auto wire = arpRequestFrame();
+    const auto frame = parseEthernetII(wire.data(), wire.size());
+    std::string msg;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto reply = makeArpReply(*frame, kMyMac, kMyIp, msg);
+        bench::doNotOptimize(reply);
+    }
+}
+
+void makeRequest(std::uint64_t iterations)
+{
+    std::string msg;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto request = makeArpRequest(kMyMac, kMyIp, kPeerIp, msg);
+        bench::doNotOptimize(request);
+    }
+}
+
+/**
+ * @brief Redraw of the ARP panel with @p entries hosts (1 in 8 still pending).
+ */
+void formatTable(std::uint64_t iterations, std::size_t entries)
+{
+    const auto now = std::chrono::steady_clock::now();
+    std::unordered_map<std::uint32_t, ArpEntry> table;
+    for (std::size_t i = 0; i < entries; ++i)
+    {
+        ArpEntry entry;
+        entry.mac = kPeerMac;
+        entry.mac[4] = static_cast<std::uint8_t>(i >> 8);
+        entry.mac[5] = static_cast<std::uint8_t>(i);
+        entry.expiresAt = now + std::chrono::seconds(60 + i % 240);
+        entry.resolved = (i % 8) != 0;
+        table[0x0A000000u + static_cast<std::uint32_t>(i)] = entry;
+    }
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto lines = formatArpTable(table, now);
+        bench::doNotOptimize(lines.data());
+    }
+}
+
+bench::Register regLegacy("arp/reply_legacy", replyLegacy);
+bench::Register regInPlace("arp/reply_in_place", replyInPlace);
+bench::Register regParse("arp/parse_arp_frame", parseArp);
+bench::Register regMakeReply("arp/make_arp_reply", makeReply);
+bench::Register regMakeRequest("arp/make_arp_request", makeRequest);
+bench::Register regFormat16("arp/format_table_16", [](std::uint64_t n) { formatTable(n, 16); });
+bench::Register regFormat256("arp/format_table_256", [](std::uint64_t n) { formatTable(n, 256); });
+bench::Register regFormat4k("arp/format_table_4096", [](std::uint64_t n) { formatTable(n, 4096); });
+
+}  // namespace
@@ -0,0 +1,105 @@
+#include "bench.h"
+#include "bench_frames.h"
+
+#include "bpf_filter.h"
+#include "ipv4.h"
+#include "udp.h"
+
+#include <arpa/inet.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using namespace bench::frames;
+
+const char* const kExpression = "not ip6 and not udp port 5353";
+
+/**
+ * @brief mDNS query to ff02::fb (the IPv6 multicast chatter the filter is meant to drop).
+ */
+std::vector<std::uint8_t> makeMdns6()
+{
+    std::vector<std::uint8_t> frame(EthernetII::HeaderSize + 40 + 8 + 32, 0);
+    const MacAddress group{0x33, 0x33, 0x00, 0x00, 0x00, 0xfb};
+    writeEthernetHeader(frame.data(), group, kPeerMac, EtherType::IPv6);
+    std::uint8_t* ip = frame.data() + EthernetII::HeaderSize;
+    ip[0] = 0x60;
+    ip[5] = 40;
+    ip[6] = IpProto::UDP;
+    ip[7] = 255;
+    ip[8] = 0xfe;
+    ip[9] = 0x80;
+    ip[23] = 0x02;
+    ip[24] = 0xff;
+    ip[25] = 0x02;
+    ip[39] = 0xfb;
+    UdpHeader h{htons(5353), htons(5353), htons(40), 0};
+    std::memcpy(ip + 40, &h, sizeof(h));
+    return frame;
+}
+
+/**
+ * @brief Check the compiled program against the expected verdicts once; abort on mismatch.
+ */
+const std::vector<std::vector<std::uint8_t>>& frames(const BpfProgram& program)
+{
+    static const std::vector<std::vector<std::uint8_t>> mix = [&] {
+        std::vector<std::vector<std::uint8_t>> out{udpFrame(40000, 53, 32), makeMdns6(), udpFrame(40000, 5353, 32),
+                                                  udpFrame(40000, 80, 32)};
+        const bool expected[] = {true, false, false, true};
+        for (std::size_t i = 0; i < out.size(); ++i)
+        {
+            if ((runBpfFilter(program.code, out[i].data(), out[i].size()) != 0) != expected[i])
+            {
+                std::fprintf(stderr, "bpf: wrong verdict for frame %zu of '%s'\n", i, kExpression);
+                std::abort();
+            }
+        }
+        return out;
+    }();
+    return mix;
+}
+
+const BpfProgram& program()
+{
+    static const BpfProgram compiled = [] {
+        std::string error;
+        auto p = compileBpfFilter(kExpression, error);
+        if (!p)
+        {
+            std::fprintf(stderr, "bpf: %s\n", error.c_str());
+            std::abort();
+        }
+        return *p;
+    }();
+    return compiled;
+}
+
+bench::Register regCompile("bpf/compile_not_ip6_not_mdns", [](std::uint64_t n) {
+    std::string error;
+    std::size_t total = 0;
+    for (std::uint64_t i = 0; i < n; ++i)
+    {
+        auto p = compileBpfFilter(kExpression, error);
+        total += p->code.size();
+    }
+    bench::doNotOptimize(total);
+});
+
+// Cost of the userspace fallback per frame (the kernel runs the same program before the copy).
+bench::Register regRun("bpf/run_userspace_mixed_frames", [](std::uint64_t n) {
+    const BpfProgram& p = program();
+    const auto& mix = frames(p);
+    std::uint32_t accepted = 0;
+    for (std::uint64_t i = 0; i < n; ++i)
+    {
+        const auto& frame = mix[i & 3];
+        accepted += runBpfFilter(p.code, frame.data(), frame.size()) != 0;
+    }
+    bench::doNotOptimize(accepted);
+});
+
+}  // namespace
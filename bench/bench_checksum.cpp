@@ -0,0 +1,209 @@
+#include "bench.h"
+
+#include "checksum.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief RFC 1071 as written: 16-bit big-endian words, carries folded at the end.
+ * Returns the checksum in host order.
+ */
+std::uint16_t referenceChecksum(const std::uint8_t* data, std::size_t size, std::uint32_t seed = 0)
+{
+    std::uint64_t sum = seed;
+    for (std::size_t i = 0; i + 1 < size; i += 2) sum += (static_cast<std::uint32_t>(data[i]) << 8) | data[i + 1];
+    if (size & 1) sum += static_cast<std::uint32_t>(data[size - 1]) << 8;
+    while (sum >> 16) sum = (sum & 0xFFFF) + (sum >> 16);
+    return static_cast<std::uint16_t>(~sum & 0xFFFF);
+}
+
+/** @brief Memory-order checksum to host order (what referenceChecksum returns). */
+std::uint16_t toHost(std::uint16_t wire)
+{
+    std::uint8_t b[2];
+    std::memcpy(b, &wire, 2);
+    return static_cast<std::uint16_t>((b[0] << 8) | b[1]);
+}
+
+std::vector<std::uint8_t> randomBytes(std::size_t size, std::uint64_t seed)
+{
+    std::vector<std::uint8_t> out(size);
+    std::uint64_t x = seed;
+    for (auto& b : out)
+    {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        b = static_cast<std::uint8_t>(x >> 24);
+    }
+    return out;
+}
+
+[[noreturn]] void mismatch(const char* what, ChecksumKernel kernel, std::size_t size, std::size_t offset)
+{
+    std::fprintf(stderr, "checksum mismatch: %s kernel=%s size=%zu offset=%zu\n", what,
+                 checksumKernelName(kernel), size, offset);
+    std::abort();
+}
+
+/**
+ * @brief Cross-check every supported kernel against the reference before any
+ * timing: all sizes up to 1 KiB at every alignment, all-0xFF buffers (worst
+ * case for carries), large sizes, chunked sums and the incremental helpers.
+ * Aborts on the first mismatch.
+ */
+void verifyAgainstReference()
+{
+    static bool done = false;
+    if (done) return;
+    done = true;
+
+    const auto random = randomBytes(65536 + 64, 0x9E3779B97F4A7C15ull);
+    const std::vector<std::uint8_t> ones(65536 + 64, 0xFF);
+    const ChecksumKernel kernels[] = {ChecksumKernel::Scalar, ChecksumKernel::Sse2, ChecksumKernel::Avx2};
+    std::size_t cases = 0;
+
+    for (ChecksumKernel kernel : kernels)
+    {
+        if (!checksumKernelSupported(kernel)) continue;
+        for (const auto* buffer : {&random, &ones})
+        {
+            auto check = [&](std::size_t size, std::size_t offset) {
+                const std::uint8_t* p = buffer->data() + offset;
+                const std::uint16_t got = toHost(checksumFinish(checksumAccumulateWith(kernel, p, size)));
+                if (got != referenceChecksum(p, size)) mismatch("buffer", kernel, size, offset);
+                ++cases;
+            };
+            for (std::size_t size = 0; size <= 1024; ++size)
+            {
+                for (std::size_t offset = 0; offset < 8; ++offset) check(size, offset);
+            }
+            for (std::size_t size : {1500u, 1501u, 4096u, 9000u, 9001u, 65535u, 65536u}) check(size, 3);
+        }
+
+        // Even-sized chunks chained through the running sum, then an odd tail.
+        std::uint32_t sum = 0;
+        std::size_t pos = 0;
+        for (std::size_t chunk : {2u, 64u, 130u, 4000u, 77u})
+        {
+            sum = checksumAccumulateWith(kernel, random.data() + pos, chunk, sum);
+            pos += chunk;
+        }
+        if (toHost(checksumFinish(sum)) != referenceChecksum(random.data(), pos)) mismatch("chunked", kernel, pos, 0);
+    }
+
+    // Incremental updates against a recompute after the change.
+    std::vector<std::uint8_t> packet = randomBytes(1480, 42);
+    for (std::size_t i = 0; i < 2000; ++i)
+    {
+        const std::uint16_t before = internetChecksum(packet.data(), packet.size());
+        const std::size_t at = (i * 38) % (packet.size() - 16) & ~std::size_t{1};
+        const auto replacement = randomBytes(16, i + 1);
+        std::uint8_t old[16];
+        std::memcpy(old, packet.data() + at, 16);
+
+        std::uint16_t expected;
+        std::uint16_t updated;
+        if (i % 3 == 0)
+        {
+            std::uint16_t o, n;
+            std::memcpy(&o, old, 2);
+            std::memcpy(&n, replacement.data(), 2);
+            updated = checksumUpdate16(before, o, n);
+            std::memcpy(packet.data() + at, replacement.data(), 2);
+        }
+        else if (i % 3 == 1)
+        {
+            std::uint32_t o, n;
+            std::memcpy(&o, old, 4);
+            std::memcpy(&n, replacement.data(), 4);
+            updated = checksumUpdate32(before, o, n);
+            std::memcpy(packet.data() + at, replacement.data(), 4);
+        }
+        else
+        {
+            updated = checksumUpdate(before, old, replacement.data(), 16);
+            std::memcpy(packet.data() + at, replacement.data(), 16);
+        }
+        expected = internetChecksum(packet.data(), packet.size());
+        // 0x0000 and 0xFFFF are the same value in one's complement.
+        if (updated != expected && !(static_cast<std::uint16_t>(updated + expected) == 0xFFFF && (updated == 0 || expected == 0)))
+        {
+            mismatch("incremental", checksumKernel(), 16, at);
+        }
+        ++cases;
+    }
+
+    std::fprintf(stderr, "checksum: %zu cases match the RFC 1071 reference (active kernel: %s)\n", cases,
+                 checksumKernelName(checksumKernel()));
+}
+
+void runKernel(std::uint64_t iterations, ChecksumKernel kernel, std::size_t size)
+{
+    verifyAgainstReference();
+    if (!checksumKernelSupported(kernel)) kernel = ChecksumKernel::Scalar;
+    const auto data = randomBytes(size, size);
+    std::uint32_t acc = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        bench::clobberMemory();
+        acc += checksumAccumulateWith(kernel, data.data(), size);
+    }
+    bench::doNotOptimize(acc);
+}
+
+/**
+ * @brief Through the public entry point (threshold + dispatched kernel), as the stack calls it.
+ */
+void runDispatched(std::uint64_t iterations, std::size_t size)
+{
+    verifyAgainstReference();
+    const auto data = randomBytes(size, size);
+    std::uint32_t acc = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        bench::clobberMemory();
+        acc += internetChecksum(data.data(), size);
+    }
+    bench::doNotOptimize(acc);
+}
+
+void runPseudoIpv6(std::uint64_t iterations)
+{
+    const auto addresses = randomBytes(32, 7);
+    std::uint32_t acc = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        bench::clobberMemory();
+        acc += checksumPseudoIpv6(addresses.data(), addresses.data() + 16, 58, static_cast<std::uint32_t>(i));
+    }
+    bench::doNotOptimize(acc);
+}
+
+#define CHECKSUM_SIZE_CASES(size)                                                                            \
+    bench::Register regScalar##size("checksum/scalar_" #size, size,                                          \
+                                    [](std::uint64_t n) { runKernel(n, ChecksumKernel::Scalar, size); });    \
+    bench::Register regSse2##size("checksum/sse2_" #size, size,                                              \
+                                  [](std::uint64_t n) { runKernel(n, ChecksumKernel::Sse2, size); });        \
+    bench::Register regAvx2##size("checksum/avx2_" #size, size,                                              \
+                                  [](std::uint64_t n) { runKernel(n, ChecksumKernel::Avx2, size); });        \
+    bench::Register regDispatch##size("checksum/dispatch_" #size, size,                                      \
+                                      [](std::uint64_t n) { runDispatched(n, size); });
+
+CHECKSUM_SIZE_CASES(20)
+CHECKSUM_SIZE_CASES(64)
+CHECKSUM_SIZE_CASES(256)
+CHECKSUM_SIZE_CASES(1500)
+CHECKSUM_SIZE_CASES(9000)
+CHECKSUM_SIZE_CASES(65536)
+
+#undef CHECKSUM_SIZE_CASES
+
+bench::Register regPseudo6("checksum/pseudo_header_ipv6", runPseudoIpv6);
+
+}  // namespace
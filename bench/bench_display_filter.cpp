@@ -0,0 +1,129 @@
+#include "bench.h"
+#include "bench_frames.h"
+
+#include "display_filter.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace bench::frames;
+
+/**
+ * @brief Descriptors of a typical mix: bulk TCP, a SYN, DNS, ARP.
+ */
+const std::vector<FrameDescriptor>& descriptors()
+{
+    static const std::vector<FrameDescriptor> all = [] {
+        std::vector<std::vector<std::uint8_t>> frames;
+        frames.push_back(tcpFrame(80, 40000, TcpFlag::ACK, 1000, 0, 1400));
+        frames.push_back(tcpFrame(40001, 80, TcpFlag::SYN));
+        frames.push_back(udpFrame(53000, 53, 40));
+        frames.push_back(tcpFrame(40000, 80, TcpFlag::PSH | TcpFlag::ACK, 1000, 0, 200));
+        frames.push_back(arpRequestFrame());
+        std::vector<FrameDescriptor> out(frames.size());
+        for (std::size_t i = 0; i < frames.size(); ++i) dissectFrame(frames[i].data(), frames[i].size(), out[i]);
+        // Pad to 8 entries so the loop can mask the index.
+        while (out.size() < 8) out.push_back(out[out.size() % frames.size()]);
+        return out;
+    }();
+    return all;
+}
+
+const DisplayFilter& filter(const char* expression)
+{
+    static std::vector<std::pair<const char*, DisplayFilter>> cache;
+    for (const auto& entry : cache)
+    {
+        if (entry.first == expression) return entry.second;
+    }
+    std::string error;
+    auto compiled = compileDisplayFilter(expression, error);
+    if (!compiled)
+    {
+        std::fprintf(stderr, "display filter '%s': %s\n", expression, error.c_str());
+        std::abort();
+    }
+    // Both evaluators must agree before anything is timed.
+    for (const auto& frame : descriptors())
+    {
+        if (compiled->matches(frame) != compiled->reference(frame))
+        {
+            std::fprintf(stderr, "display filter '%s': bytecode and reference disagree\n", expression);
+            std::abort();
+        }
+    }
+    cache.emplace_back(expression, std::move(*compiled));
+    return cache.back().second;
+}
+
+void runFilter(std::uint64_t iterations, const char* expression, bool bytecode)
+{
+    const DisplayFilter& f = filter(expression);
+    const auto& frames = descriptors();
+    std::uint64_t hits = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        const FrameDescriptor& frame = frames[i & 7];
+        hits += bytecode ? f.matches(frame) : f.reference(frame);
+    }
+    bench::doNotOptimize(hits);
+}
+
+const char* const kArp = "arp.opcode==1 && eth.src==02:00:00:00:00:02";
+const char* const kLength = "ip.len>1000";
+const char* const kPorts = "udp.port == 53 || tcp.flags.syn == 1 || (ip.addr == 10.0.0.0/8 && !tcp)";
+
+bench::Register regArpVm("dfilter/arp_opcode_and_mac_bytecode", [](std::uint64_t n) { runFilter(n, kArp, true); });
+bench::Register regArpRef("dfilter/arp_opcode_and_mac_naive", [](std::uint64_t n) { runFilter(n, kArp, false); });
+bench::Register regLenVm("dfilter/ip_len_bytecode", [](std::uint64_t n) { runFilter(n, kLength, true); });
+bench::Register regLenRef("dfilter/ip_len_naive", [](std::uint64_t n) { runFilter(n, kLength, false); });
+bench::Register regPortsVm("dfilter/ports_flags_prefix_bytecode", [](std::uint64_t n) { runFilter(n, kPorts, true); });
+bench::Register regPortsRef("dfilter/ports_flags_prefix_naive", [](std::uint64_t n) { runFilter(n, kPorts, false); });
+bench::Register regCompile("dfilter/compile_ports_flags_prefix", [](std::uint64_t n) {
+    std::string error;
+    std::size_t total = 0;
+    for (std::uint64_t i = 0; i < n; ++i) total += compileDisplayFilter(kPorts, error)->instructionCount();
+    bench::doNotOptimize(total);
+});
+
+/**
+ * @brief Filters nested past kDisplayFilterMaxDepth, as typed into the TUI;
+ * each must be rejected (not crash the parser). Aborts otherwise.
+ */
+const std::vector<std::string>& tooDeep()
+{
+    static const std::vector<std::string> all = [] {
+        std::vector<std::string> out;
+        out.push_back(std::string(100000, '(') + "tcp" + std::string(100000, ')'));
+        out.push_back(std::string(100000, '!') + "tcp");
+        std::string chain = "tcp";
+        for (int i = 0; i < 1000; ++i) chain += " || udp";
+        out.push_back(chain);
+        for (const auto& expression : out)
+        {
+            std::string error;
+            if (compileDisplayFilter(expression, error) || error != "expresión demasiado anidada")
+            {
+                std::fprintf(stderr, "display filter: %zu-byte nested expression not rejected (%s)\n",
+                             expression.size(), error.c_str());
+                std::abort();
+            }
+        }
+        return out;
+    }();
+    return all;
+}
+
+bench::Register regTooDeep("dfilter/reject_too_deep", [](std::uint64_t n) {
+    const auto& expressions = tooDeep();
+    std::string error;
+    std::size_t rejected = 0;
+    for (std::uint64_t i = 0; i < n; ++i) rejected += !compileDisplayFilter(expressions[i % expressions.size()], error);
+    bench::doNotOptimize(rejected);
+});
+
+}  // namespace
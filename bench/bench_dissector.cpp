@@ -0,0 +1,99 @@
+#include "bench.h"
+#include "bench_frames.h"
+
+#include "arp.h"
+#include "dissector.h"
+#include "ipv6.h"
+#include "tcp.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+using namespace bench::frames;
+
+/**
+ * @brief Insert VLAN tags (outer first) after the MACs of an untagged frame.
+ */
+std::vector<std::uint8_t> tagged(std::vector<std::uint8_t> frame, const std::vector<std::uint16_t>& tpids)
+{
+    std::vector<std::uint8_t> tags;
+    for (std::size_t i = 0; i < tpids.size(); ++i)
+    {
+        const std::uint16_t vid = static_cast<std::uint16_t>(100 + i);
+        tags.insert(tags.end(), {static_cast<std::uint8_t>(tpids[i] >> 8), static_cast<std::uint8_t>(tpids[i]),
+                                 static_cast<std::uint8_t>(vid >> 8), static_cast<std::uint8_t>(vid)});
+    }
+    frame.insert(frame.begin() + 12, tags.begin(), tags.end());
+    return frame;
+}
+
+template <typename Chain>
+void runChain(std::uint64_t iterations, const std::vector<std::uint8_t>& frame)
+{
+    FrameDescriptor info;
+    std::uint64_t acc = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        bench::clobberMemory();
+        dissectWith<Chain>(frame.data(), frame.size(), info);
+        acc += info.payloadOffset;
+    }
+    bench::doNotOptimize(acc);
+}
+
+/**
+ * @brief Realistic mix: every op decodes the next frame of the set.
+ */
+void runMixed(std::uint64_t iterations)
+{
+    const std::vector<std::vector<std::uint8_t>> frames = {
+        tcpFrame(40000, 80, TcpFlag::SYN), udpFrame(5353, 9, 64),
+        tagged(udpFrame(5353, 9, 64), {EtherTypeVlan::Dot1AD, EtherTypeVlan::Dot1Q}),
+        neighborSolicitationFrame(ipv6LinkLocal(kMyMac)), arpRequestFrame()};
+    FrameDescriptor info;
+    std::uint64_t acc = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        const auto& frame = frames[i % frames.size()];
+        dissectFrame(frame.data(), frame.size(), info);
+        acc += info.payloadOffset;
+    }
+    bench::doNotOptimize(acc);
+}
+
+/**
+ * @brief What the RX path did before: copy the frame into an EthernetFrame and re-check the EtherType.
+ */
+void runLegacyCopy(std::uint64_t iterations, const std::vector<std::uint8_t>& frame)
+{
+    std::uint64_t acc = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto parsed = parseEthernetII(frame.data(), frame.size());
+        auto arp = parseArpFrame(*parsed);
+        acc += parsed->payload.size() + (arp ? arp->opcode : 0);
+    }
+    bench::doNotOptimize(acc);
+}
+
+const auto kTcp = tcpFrame(40000, 80, TcpFlag::SYN);
+const auto kQinq = tagged(udpFrame(5353, 9, 64), {EtherTypeVlan::Dot1AD, EtherTypeVlan::Dot1Q});
+const auto kNs = neighborSolicitationFrame(ipv6LinkLocal(kMyMac));
+const auto kArp = arpRequestFrame();
+
+bench::Register regLink("dissect/chain_link_only_tcp", [](std::uint64_t n) {
+    runChain<LayerChain<LinkStage>>(n, kTcp);
+});
+bench::Register regNet("dissect/chain_link_network_tcp", [](std::uint64_t n) {
+    runChain<LayerChain<LinkStage, NetworkStage>>(n, kTcp);
+});
+bench::Register regTcp("dissect/full_ipv4_tcp", [](std::uint64_t n) { runChain<FullDissector>(n, kTcp); });
+bench::Register regQinq("dissect/full_qinq_udp", [](std::uint64_t n) { runChain<FullDissector>(n, kQinq); });
+bench::Register regNs("dissect/full_ipv6_icmpv6", [](std::uint64_t n) { runChain<FullDissector>(n, kNs); });
+bench::Register regArp("dissect/full_arp", [](std::uint64_t n) { runChain<FullDissector>(n, kArp); });
+bench::Register regMixed("dissect/full_mixed_5", runMixed);
+bench::Register regLegacy("dissect/legacy_copy_parse_arp", [](std::uint64_t n) { runLegacyCopy(n, kArp); });
+
+}  // namespace
@@ -0,0 +1,418 @@
+#include "bench.h"
+
+#include "ethernet.h"
+#include "hex_codec.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const MacAddress kDst{0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+const MacAddress kSrc{0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+
+/**
+ * @brief Ethernet II frame of @p size bytes on the wire with a patterned payload.
+ */
+EthernetFrame makeFrame(std::size_t size)
+{
+    EthernetFrame frame;
+    frame.dst = kDst;
+    frame.src = kSrc;
+    frame.etherType = EtherType::IPv4;
+    frame.payload.resize(size - EthernetII::HeaderSize);
+    for (std::size_t i = 0; i < frame.payload.size(); ++i) frame.payload[i] = static_cast<std::uint8_t>(i * 7 + 3);
+    return frame;
+}
+
+/**
+ * @brief custom_packet.hex as the editor leaves it: comment header, 16 bytes per line.
+ */
+std::string makeHexFile(std::size_t size)
+{
+    const std::vector<std::uint8_t> bytes = serializeEthernetII(makeFrame(size));
+    std::string text = "# Frame de prueba\n// dst src type payload\n";
+    static const char* digits = "0123456789abcdef";
+    for (std::size_t i = 0; i < bytes.size(); ++i)
+    {
+        text += digits[bytes[i] >> 4];
+        text += digits[bytes[i] & 0x0F];
+        text += (i % 16 == 15 || i + 1 == bytes.size()) ? '\n' : ' ';
+    }
+    return text;
+}
+
+// ---------------------------------------------------------------------------
+// Stream-based versions replaced by hex_codec (kept for comparison)
+// ---------------------------------------------------------------------------
+
+std::string legacyMacToString(const MacAddress& mac)
+{
+    std::ostringstream oss;
+    oss << std::hex << std::setfill('0');
+    for (std::size_t i = 0; i < mac.size(); i++)
+    {
+        if (i) oss << ':';
+        oss << std::setw(2) << static_cast<int>(mac[i]);
+    }
+    return oss.str();
+}
+
+bool legacyIsHexDigit(char c)
+{
+    return std::isxdigit(static_cast<unsigned char>(c)) != 0;
+}
+
+std::optional<MacAddress> legacyParseMac(std::string_view text)
+{
+    std::string s(text);
+    s.erase(std::remove_if(s.begin(), s.end(), [](unsigned char ch) { return std::isspace(ch) != 0; }), s.end());
+    MacAddress mac{};
+    if (s.size() == 17)
+    {
+        int outIndex = 0;
+        for (std::size_t i = 0; i < s.size();)
+        {
+            if (outIndex >= 6 || i + 1 >= s.size()) return std::nullopt;
+            if (!legacyIsHexDigit(s[i]) || !legacyIsHexDigit(s[i + 1])) return std::nullopt;
+            unsigned int byte = 0;
+            std::stringstream ss;
+            ss << std::hex << s.substr(i, 2);
+            ss >> byte;
+            mac[outIndex++] = static_cast<std::uint8_t>(byte & 0xFFu);
+            i += 2;
+            if (i < s.size())
+            {
+                if (s[i] != ':') return std::nullopt;
+                i++;
+            }
+        }
+        return mac;
+    }
+    if (s.size() == 12)
+    {
+        for (int outIndex = 0; outIndex < 6; outIndex++)
+        {
+            if (!legacyIsHexDigit(s[outIndex * 2]) || !legacyIsHexDigit(s[outIndex * 2 + 1])) return std::nullopt;
+            unsigned int byte = 0;
+            std::stringstream ss;
+            ss << std::hex << s.substr(outIndex * 2, 2);
+            ss >> byte;
+            mac[outIndex] = static_cast<std::uint8_t>(byte & 0xFFu);
+        }
+        return mac;
+    }
+    return std::nullopt;
+}
+
+std::string legacyToHex(const std::uint8_t* data, std::size_t size, std::size_t maxBytes)
+{
+    if (!data || size == 0) return {};
+    const std::size_t n = std::min(size, maxBytes);
+    std::ostringstream oss;
+    oss << std::hex << std::setfill('0');
+    for (std::size_t i = 0; i < n; i++)
+    {
+        if (i) oss << ' ';
+        oss << std::setw(2) << static_cast<int>(data[i]);
+    }
+    if (n < size) oss << " ... (" << (size - n) << " more bytes)";
+    return oss.str();
+}
+
+std::string legacyStripComments(const std::string& line)
+{
+    std::size_t cut = std::string::npos;
+    const auto hash = line.find('#');
+    if (hash != std::string::npos) cut = std::min(cut, hash);
+    const auto slashslash = line.find("//");
+    if (slashslash != std::string::npos) cut = std::min(cut, slashslash);
+    if (cut == std::string::npos) return line;
+    return line.substr(0, cut);
+}
+
+std::optional<std::vector<std::uint8_t>> legacyParseHexBytesFile(const std::string& fileContent)
+{
+    std::vector<std::uint8_t> bytes;
+    std::istringstream in(fileContent);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        line = legacyStripComments(line);
+        std::istringstream iss(line);
+        std::string tok;
+        while (iss >> tok)
+        {
+            if (tok.rfind("0x", 0) == 0 || tok.rfind("0X", 0) == 0) tok = tok.substr(2);
+            if (tok.empty()) continue;
+            while (!tok.empty() && !legacyIsHexDigit(tok.back())) tok.pop_back();
+            while (!tok.empty() && !legacyIsHexDigit(tok.front())) tok.erase(tok.begin());
+            if (tok.empty()) continue;
+            if (tok.size() % 2 != 0) return std::nullopt;
+            for (std::size_t i = 0; i < tok.size(); i += 2)
+            {
+                if (!legacyIsHexDigit(tok[i]) || !legacyIsHexDigit(tok[i + 1])) return std::nullopt;
+                unsigned int v = 0;
+                std::stringstream ss;
+                ss << std::hex << tok.substr(i, 2);
+                ss >> v;
+                bytes.push_back(static_cast<std::uint8_t>(v & 0xFFu));
+            }
+        }
+    }
+    if (bytes.empty()) return std::nullopt;
+    return bytes;
+}
+
+/**
+ * @brief Cross-check the codec kernels and the migrated helpers against the
+ * stream-based versions before any timing: every size up to 300 at several
+ * alignments, both separators, invalid digits at every position, and a set
+ * of MAC strings and hex files. Aborts on the first mismatch.
+ */
+void verifyHexCodec()
+{
+    std::vector<std::uint8_t> data(340);
+    std::uint32_t x = 12345;
+    for (auto& b : data) b = static_cast<std::uint8_t>((x = x * 1103515245u + 12345u) >> 16);
+    const HexKernel kernels[] = {HexKernel::Scalar, HexKernel::Ssse3, HexKernel::Avx2};
+    std::vector<char> text(1100);
+    std::vector<std::uint8_t> decoded(340);
+
+    for (HexKernel kernel : kernels)
+    {
+        if (!hexKernelSupported(kernel)) continue;
+        for (std::size_t offset = 0; offset < 4; ++offset)
+        {
+            for (std::size_t size = 0; size <= 300; ++size)
+            {
+                const std::uint8_t* in = data.data() + offset;
+                const std::string expected = legacyToHex(in, size, size);
+                char* end = hexEncodeWith(kernel, in, size, text.data(), ' ');
+                if (std::string(text.data(), end) != expected)
+                {
+                    std::fprintf(stderr, "hex encode mismatch: kernel=%s size=%zu\n", hexKernelName(kernel), size);
+                    std::abort();
+                }
+                end = hexEncodeWith(kernel, in, size, text.data());
+                if (static_cast<std::size_t>(end - text.data()) != size * 2 ||
+                    !hexDecodeWith(kernel, text.data(), size, decoded.data()) ||
+                    !std::equal(in, in + size, decoded.begin()))
+                {
+                    std::fprintf(stderr, "hex round trip mismatch: kernel=%s size=%zu\n", hexKernelName(kernel), size);
+                    std::abort();
+                }
+                for (std::size_t bad = 0; bad < size * 2; bad += 7)
+                {
+                    const char saved = text[bad];
+                    text[bad] = "g/:@G`\xff "[bad % 8];
+                    if (hexDecodeWith(kernel, text.data(), size, decoded.data()))
+                    {
+                        std::fprintf(stderr, "hex decode accepted bad digit: kernel=%s size=%zu\n",
+                                     hexKernelName(kernel), size);
+                        std::abort();
+                    }
+                    text[bad] = saved;
+                }
+            }
+        }
+    }
+
+    const char* macs[] = {"02:00:5e:10:00:fb", "02005E1000FB", " 02:00:5e:10:00:fb ", "02:00:5e:10:00:f",
+                          "02-00-5e-10-00-fb", "0200:5e10:00fb", "02:00:5e:10:00:fg", "", "02 00 5e 10 00 fb"};
+    for (const char* mac : macs)
+    {
+        if (parseMac(mac) != legacyParseMac(mac) ||
+            (parseMac(mac) && macToString(*parseMac(mac)) != legacyMacToString(*parseMac(mac))))
+        {
+            std::fprintf(stderr, "parseMac mismatch: \"%s\"\n", mac);
+            std::abort();
+        }
+    }
+
+    const char* files[] = {"ff ff ff ff ff ff 02 00 00 00 00 01 88 b5 00 01 02\n",
+                           "# cabecera\n0xff, 0x02 // fin\r\naabbcc\tdd\n",
+                           "aabbc\n", "zz\n", "(aa) [bb];\n//\n#\n", "", "a\n", "0x\n0X12\n", "aa#bb\ncc/dd\n"};
+    for (const char* file : files)
+    {
+        if (parseHexBytesFile(file) != legacyParseHexBytesFile(file))
+        {
+            std::fprintf(stderr, "parseHexBytesFile mismatch: \"%s\"\n", file);
+            std::abort();
+        }
+    }
+}
+
+void runParse(std::uint64_t iterations, std::size_t size)
+{
+    const std::vector<std::uint8_t> wire = serializeEthernetII(makeFrame(size));
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto frame = parseEthernetII(wire.data(), wire.size());
+        bench::doNotOptimize(frame);
+    }
+}
+
+void runSerialize(std::uint64_t iterations, std::size_t size)
+{
+    const EthernetFrame frame = makeFrame(size);
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto bytes = serializeEthernetII(frame);
+        bench::doNotOptimize(bytes.data());
+    }
+}
+
+// The TX/RX panels render up to 256 bytes (toHex's default cap).
+void runToHex(std::uint64_t iterations, std::size_t size)
+{
+    const std::vector<std::uint8_t> wire = serializeEthernetII(makeFrame(size));
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto text = toHex(wire.data(), wire.size(), wire.size());
+        bench::doNotOptimize(text.data());
+    }
+}
+
+void runParseHexFile(std::uint64_t iterations, std::size_t size)
+{
+    const std::string text = makeHexFile(size);
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto bytes = parseHexBytesFile(text);
+        bench::doNotOptimize(bytes);
+    }
+}
+
+void runToHexLegacy(std::uint64_t iterations, std::size_t size)
+{
+    const std::vector<std::uint8_t> wire = serializeEthernetII(makeFrame(size));
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto text = legacyToHex(wire.data(), wire.size(), wire.size());
+        bench::doNotOptimize(text.data());
+    }
+}
+
+void runParseHexFileLegacy(std::uint64_t iterations, std::size_t size)
+{
+    const std::string text = makeHexFile(size);
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto bytes = legacyParseHexBytesFile(text);
+        bench::doNotOptimize(bytes);
+    }
+}
+
+// Raw codec into a reused buffer: what the helpers cost minus their std::string.
+void runEncode(std::uint64_t iterations, HexKernel kernel, std::size_t size, char separator)
+{
+    static bool verified = (verifyHexCodec(), true);
+    bench::doNotOptimize(verified);
+    const std::vector<std::uint8_t> wire = serializeEthernetII(makeFrame(size));
+    std::vector<char> text(hexEncodedSize(size, separator));
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        char* end = hexEncodeWith(kernel, wire.data(), wire.size(), text.data(), separator);
+        bench::doNotOptimize(end);
+        bench::clobberMemory();
+    }
+}
+
+void runDecode(std::uint64_t iterations, HexKernel kernel, std::size_t size)
+{
+    const std::vector<std::uint8_t> wire = serializeEthernetII(makeFrame(size));
+    std::vector<char> text(size * 2);
+    hexEncode(wire.data(), wire.size(), text.data());
+    std::vector<std::uint8_t> bytes(size);
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        const bool ok = hexDecodeWith(kernel, text.data(), size, bytes.data());
+        bench::doNotOptimize(ok);
+        bench::clobberMemory();
+    }
+}
+
+#define ETHERNET_SIZE_CASES(size)                                                                            \
+    bench::Register regParse##size("ethernet/parse_" #size, size, [](std::uint64_t n) { runParse(n, size); }); \
+    bench::Register regSerialize##size("ethernet/serialize_" #size, size,                                    \
+                                       [](std::uint64_t n) { runSerialize(n, size); });                      \
+    bench::Register regToHex##size("ethernet/to_hex_" #size, size, [](std::uint64_t n) { runToHex(n, size); }); \
+    bench::Register regHexFile##size("ethernet/parse_hex_file_" #size, size,                                 \
+                                     [](std::uint64_t n) { runParseHexFile(n, size); });                     \
+    bench::Register regToHexLegacy##size("ethernet/to_hex_" #size "_legacy", size,                           \
+                                         [](std::uint64_t n) { runToHexLegacy(n, size); });                  \
+    bench::Register regHexFileLegacy##size("ethernet/parse_hex_file_" #size "_legacy", size,                 \
+                                           [](std::uint64_t n) { runParseHexFileLegacy(n, size); });         \
+    bench::Register regEncScalar##size("hex/encode_spaced_scalar_" #size, size,                              \
+                                       [](std::uint64_t n) { runEncode(n, HexKernel::Scalar, size, ' '); }); \
+    bench::Register regEncSsse3##size("hex/encode_spaced_ssse3_" #size, size,                                \
+                                      [](std::uint64_t n) { runEncode(n, HexKernel::Ssse3, size, ' '); });   \
+    bench::Register regEncPlainScalar##size("hex/encode_scalar_" #size, size,                                \
+                                            [](std::uint64_t n) { runEncode(n, HexKernel::Scalar, size, 0); }); \
+    bench::Register regEncPlainAvx2##size("hex/encode_avx2_" #size, size,                                    \
+                                          [](std::uint64_t n) { runEncode(n, HexKernel::Avx2, size, 0); });  \
+    bench::Register regDecScalar##size("hex/decode_scalar_" #size, size,                                     \
+                                       [](std::uint64_t n) { runDecode(n, HexKernel::Scalar, size); });      \
+    bench::Register regDecSsse3##size("hex/decode_ssse3_" #size, size,                                       \
+                                      [](std::uint64_t n) { runDecode(n, HexKernel::Ssse3, size); });        \
+    bench::Register regDecAvx2##size("hex/decode_avx2_" #size, size,                                         \
+                                     [](std::uint64_t n) { runDecode(n, HexKernel::Avx2, size); });
+
+ETHERNET_SIZE_CASES(60)
+ETHERNET_SIZE_CASES(590)
+ETHERNET_SIZE_CASES(1514)
+
+#undef ETHERNET_SIZE_CASES
+
+bench::Register regMacToString("ethernet/mac_to_string", [](std::uint64_t n) {
+    MacAddress mac = kSrc;
+    for (std::uint64_t i = 0; i < n; ++i)
+    {
+        mac[5] = static_cast<std::uint8_t>(i);
+        auto text = macToString(mac);
+        bench::doNotOptimize(text.data());
+    }
+});
+
+bench::Register regMacToStringLegacy("ethernet/mac_to_string_legacy", [](std::uint64_t n) {
+    MacAddress mac = kSrc;
+    for (std::uint64_t i = 0; i < n; ++i)
+    {
+        mac[5] = static_cast<std::uint8_t>(i);
+        auto text = legacyMacToString(mac);
+        bench::doNotOptimize(text.data());
+    }
+});
+
+bench::Register regParseMacColons("ethernet/parse_mac_colons", [](std::uint64_t n) {
+    for (std::uint64_t i = 0; i < n; ++i)
+    {
+        auto mac = parseMac("02:00:5e:10:00:fb");
+        bench::doNotOptimize(mac);
+    }
+});
+
+bench::Register regParseMacPlain("ethernet/parse_mac_plain", [](std::uint64_t n) {
+    for (std::uint64_t i = 0; i < n; ++i)
+    {
+        auto mac = parseMac("02005e1000fb");
+        bench::doNotOptimize(mac);
+    }
+});
+
+bench::Register regParseMacLegacy("ethernet/parse_mac_colons_legacy", [](std::uint64_t n) {
+    for (std::uint64_t i = 0; i < n; ++i)
+    {
+        auto mac = legacyParseMac("02:00:5e:10:00:fb");
+        bench::doNotOptimize(mac);
+    }
+});
+
+}  // namespace
@@ -0,0 +1,67 @@
+#include "bench.h"
+#include "bench_frames.h"
+
+#include "dissector.h"
+#include "event_log.h"
+#include "log_ring.h"
+#include "tcp.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace bench::frames;
+
+FrameDescriptor tcpSynDescriptor()
+{
+    const auto frame = tcpFrame(40000, 80, TcpFlag::SYN);
+    FrameDescriptor info;
+    dissectFrame(frame.data(), frame.size(), info);
+    return info;
+}
+
+// What the RX path pays per logged frame now: one fixed-size record into the ring.
+void runRecord(std::uint64_t iterations)
+{
+    const FrameDescriptor info = tcpSynDescriptor();
+    LogRing log;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        log.pushEvent(makeRxEvent(info, static_cast<std::int64_t>(i)));
+    }
+    bench::doNotOptimize(log.size());
+}
+
+// Before: the line was formatted and stored for every frame, shown or not.
+void runRecordLegacy(std::uint64_t iterations)
+{
+    const FrameDescriptor info = tcpSynDescriptor();
+    LogRing log;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        log.push("[RX] " + describeFrame(info));
+    }
+    bench::doNotOptimize(log.size());
+}
+
+// Formatting moved to the redraw: one window of event rows, formatted once and then cached.
+void runVisibleRows(std::uint64_t iterations)
+{
+    const FrameDescriptor info = tcpSynDescriptor();
+    LogRing log;
+    for (int i = 0; i < 4096; ++i) log.pushEvent(makeRxEvent(info, i));
+    std::vector<LogRow> rows;
+    const std::uint64_t total = log.totalRows(100);
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        log.rows(100, total - 20, 20, rows);
+        bench::doNotOptimize(rows.data());
+    }
+}
+
+}  // namespace
+
+bench::Register regEventRecord("event_log/record_rx", [](std::uint64_t n) { runRecord(n); });
+bench::Register regEventRecordLegacy("event_log/record_rx_legacy", [](std::uint64_t n) { runRecordLegacy(n); });
+bench::Register regEventRows("event_log/visible_rows_20", [](std::uint64_t n) { runVisibleRows(n); });
@@ -0,0 +1,146 @@
+#include "bench.h"
+
+#include "flow_table.h"
+#include "ipv4.h"
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Distinct TCP 5-tuples: random-looking client address and port towards a few servers.
+ */
+std::vector<FlowKey> makeKeys(std::size_t count, std::uint64_t seed)
+{
+    std::vector<FlowKey> keys(count);
+    std::uint64_t x = seed;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        FlowKey& key = keys[i];
+        std::memset(&key, 0, sizeof(key));
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        const std::uint32_t client = static_cast<std::uint32_t>(i);  // Unique per key
+        std::memcpy(key.src, &client, 4);
+        key.dst[0] = 192;
+        key.dst[1] = 168;
+        key.dst[2] = 100;
+        key.dst[3] = static_cast<std::uint8_t>(x);
+        key.srcPort = static_cast<std::uint16_t>(x >> 16);
+        key.dstPort = 443;
+        key.proto = IpProto::TCP;
+        key.family = FlowFamily::Ipv4;
+    }
+    return keys;
+}
+
+/**
+ * @brief Visit order with no locality: a multiplicative permutation of the indices.
+ */
+std::vector<FlowKey> shuffled(const std::vector<FlowKey>& keys)
+{
+    std::vector<FlowKey> out(keys.size());
+    const std::size_t n = keys.size();
+    for (std::size_t i = 0; i < n; ++i) out[i] = keys[(i * 2654435761u) % n];
+    return out;
+}
+
+struct Populated {
+    std::unique_ptr<FlowTable> table;
+    std::vector<FlowKey> order;
+};
+
+/**
+ * @brief Table with @p flows live entries (built once per size and reused across batches).
+ */
+Populated& populated(std::size_t flows)
+{
+    static std::size_t builtFor = 0;
+    static Populated state;
+    if (builtFor != flows)
+    {
+        FlowConfig config;
+        config.memoryBytes = flows * sizeof(FlowEntry) * 2;  // 50% load after population
+        state.table = std::make_unique<FlowTable>(config);
+        const auto keys = makeKeys(flows, 0x9E3779B97F4A7C15ull);
+        const auto now = FlowTable::Clock::now();
+        for (const auto& key : keys) state.table->update(key, 64, now);
+        state.order = shuffled(keys);
+        builtFor = flows;
+    }
+    return state;
+}
+
+void runUpdate(std::uint64_t iterations, std::size_t flows)
+{
+    Populated& state = populated(flows);
+    const auto now = FlowTable::Clock::now();
+    const std::size_t n = state.order.size();
+    std::size_t i = 0;
+    for (std::uint64_t it = 0; it < iterations; ++it)
+    {
+        state.table->update(state.order[i], 1500, now);
+        if (++i == n) i = 0;
+    }
+    bench::doNotOptimize(state.table->stats().updates);
+}
+
+void runUpdateBatch(std::uint64_t iterations, std::size_t flows)
+{
+    static constexpr std::size_t kBatch = 64;  // What the RX loop drains per wakeup
+    Populated& state = populated(flows);
+    const auto now = FlowTable::Clock::now();
+    const std::vector<std::uint32_t> bytes(kBatch, 1500);
+    const std::size_t n = state.order.size() / kBatch * kBatch;
+    std::size_t i = 0;
+    for (std::uint64_t done = 0; done < iterations; done += kBatch)
+    {
+        const std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(kBatch, iterations - done));
+        state.table->updateBatch(state.order.data() + i, bytes.data(), count, now);
+        i += kBatch;
+        if (i >= n) i = 0;
+    }
+    bench::doNotOptimize(state.table->stats().updates);
+}
+
+/**
+ * @brief Every frame a new flow into a full table: insert + bounded eviction.
+ */
+void runChurn(std::uint64_t iterations)
+{
+    FlowConfig config;
+    config.memoryBytes = 4u << 20;
+    FlowTable table(config);
+    const auto keys = makeKeys(1u << 20, 0xD1B54A32D192ED03ull);
+    auto now = FlowTable::Clock::now();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        table.update(keys[i & (keys.size() - 1)], 64, now);
+        if ((i & 1023) == 0) now += std::chrono::milliseconds(1);
+    }
+    bench::doNotOptimize(table.stats().evicted);
+}
+
+/**
+ * @brief Cost of one aging step (FlowConfig::sweepSlots slots) over a 1M-flow table with nothing to expire.
+ */
+void runExpireSweep(std::uint64_t iterations)
+{
+    Populated& state = populated(1u << 20);
+    const auto now = FlowTable::Clock::now();
+    std::size_t removed = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i) removed += state.table->expire(now);
+    bench::doNotOptimize(removed);
+}
+
+bench::Register regUpdate4k("flow/update_hit_4k", [](std::uint64_t n) { runUpdate(n, 1u << 12); });
+bench::Register regUpdate1m("flow/update_hit_1m", [](std::uint64_t n) { runUpdate(n, 1u << 20); });
+bench::Register regBatch1m("flow/update_batch64_hit_1m", [](std::uint64_t n) { runUpdateBatch(n, 1u << 20); });
+bench::Register regChurn("flow/update_new_full_table_evict", runChurn);
+bench::Register regSweep("flow/expire_sweep_4096_slots_1m", runExpireSweep);
+
+}  // namespace
@@ -0,0 +1,53 @@
+#include "bench.h"
+
+#include "ethernet.h"
+#include "frame_history.h"
+
+#include <deque>
+#include <vector>
+
+namespace {
+
+std::vector<std::uint8_t> sampleFrame(std::size_t size)
+{
+    std::vector<std::uint8_t> frame(size);
+    for (std::size_t i = 0; i < size; ++i) frame[i] = static_cast<std::uint8_t>(i * 7);
+    frame[12] = 0x08;
+    frame[13] = 0x00;
+    return frame;
+}
+
+// Steady state: the history is full, every push evicts (by count or by bytes).
+void runPush(std::uint64_t iterations, std::size_t frameSize)
+{
+    const auto frame = sampleFrame(frameSize);
+    FrameHistory history(4096, 8u << 20);
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        history.push((i & 1) ? FrameDirection::Tx : FrameDirection::Rx, frame.data(), frame.size(),
+                     static_cast<std::int64_t>(i));
+    }
+    bench::doNotOptimize(history.size());
+}
+
+// Keeping the same frames as parsed EthernetFrame copies: one allocation per frame, one free per eviction.
+void runPushLegacy(std::uint64_t iterations, std::size_t frameSize)
+{
+    const auto frame = sampleFrame(frameSize);
+    std::deque<EthernetFrame> history;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto parsed = parseEthernetII(frame.data(), frame.size());
+        if (parsed) history.push_back(std::move(*parsed));
+        if (history.size() > 4096) history.pop_front();
+    }
+    bench::doNotOptimize(history.size());
+}
+
+}  // namespace
+
+bench::Register regHistoryPush64("frame_history/push_64", [](std::uint64_t n) { runPush(n, 64); });
+bench::Register regHistoryPush1514("frame_history/push_1514", [](std::uint64_t n) { runPush(n, 1514); });
+bench::Register regHistoryPush64Legacy("frame_history/push_64_legacy", [](std::uint64_t n) { runPushLegacy(n, 64); });
+bench::Register regHistoryPush1514Legacy("frame_history/push_1514_legacy",
+                                         [](std::uint64_t n) { runPushLegacy(n, 1514); });
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "arp.h"
+#include "checksum.h"
+#include "ethernet.h"
+#include "icmp.h"
+#include "ipv4.h"
+#include "ipv6.h"
+#include "ndp.h"
+#include "tcp.h"
+#include "udp.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Addresses and wire frames shared by the benchmarks.
+ *
+ * Two hosts on the TAP link: the tool (kMyMac / kMyIp) and the host kernel
+ * on the other end (kPeerMac / kPeerIp). Unless stated otherwise, frames go
+ * from the peer to us, carry valid checksums and are as tap.read() returns
+ * them (no minimum-size padding). Bench files pull them in with
+ * `using namespace bench::frames;`.
+ */
+namespace bench::frames {
+
+inline const MacAddress kMyMac{0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+inline const MacAddress kPeerMac{0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+inline const Ipv4Address kMyIp{192, 168, 100, 50};
+inline const Ipv4Address kPeerIp{192, 168, 100, 1};
+
+inline const Ipv4Route kPeerToUs{kPeerMac, kMyMac, kPeerIp, kMyIp};
+inline const Ipv4Route kUsToPeer{kMyMac, kPeerMac, kMyIp, kPeerIp};
+
+/**
+ * @brief Ethernet + IPv4 headers from @p src to kMyIp, followed by @p l4Size zero bytes.
+ */
+inline std::vector<std::uint8_t> ipv4Frame(std::uint8_t protocol, std::size_t l4Size, const Ipv4Address& src = kPeerIp,
+                                           std::uint16_t flagsFragment = 0)
+{
+    std::vector<std::uint8_t> frame(kIpv4PayloadOffset + l4Size);
+    writeEthernetHeader(frame.data(), kMyMac, kPeerMac, EtherType::IPv4);
+    writeIpv4Header(frame.data() + EthernetII::HeaderSize, src, kMyIp, protocol,
+                    static_cast<std::uint16_t>(kIpv4HeaderSize + l4Size), 1, flagsFragment, 64);
+    return frame;
+}
+
+/**
+ * @brief Fill in the UDP/TCP checksum (at @p checksumAt in the L4 header) of an ipv4Frame().
+ */
+inline void setL4Checksum(std::vector<std::uint8_t>& frame, std::size_t checksumAt)
+{
+    const std::uint8_t* ip = frame.data() + EthernetII::HeaderSize;
+    std::uint8_t* l4 = frame.data() + kIpv4PayloadOffset;
+    const std::size_t l4Size = frame.size() - kIpv4PayloadOffset;
+    const std::uint8_t protocol = ip[offsetof(Ipv4Header, protocol)];
+    const std::uint32_t pseudo = checksumPseudoIpv4(ip + offsetof(Ipv4Header, src), ip + offsetof(Ipv4Header, dst),
+                                                    protocol, static_cast<std::uint16_t>(l4Size));
+    std::uint16_t checksum = checksumFinish(checksumAccumulate(l4, l4Size, pseudo));
+    if (checksum == 0 && protocol == IpProto::UDP) checksum = 0xFFFF;  // 0 means "no checksum" in UDP
+    std::memcpy(l4 + checksumAt, &checksum, sizeof(checksum));
+}
+
+/**
+ * @brief UDP datagram with @p dataSize bytes of data.
+ */
+inline std::vector<std::uint8_t> udpFrame(std::uint16_t srcPort, std::uint16_t dstPort, std::size_t dataSize,
+                                          const Ipv4Address& src = kPeerIp)
+{
+    const std::size_t l4Size = sizeof(UdpHeader) + dataSize;
+    auto frame = ipv4Frame(IpProto::UDP, l4Size, src);
+    std::uint8_t* l4 = frame.data() + kIpv4PayloadOffset;
+    const UdpHeader h{htons(srcPort), htons(dstPort), htons(static_cast<std::uint16_t>(l4Size)), 0};
+    std::memcpy(l4, &h, sizeof(h));
+    std::memset(l4 + sizeof(h), 0x42, dataSize);
+    setL4Checksum(frame, offsetof(UdpHeader, checksum));
+    return frame;
+}
+
+/**
+ * @brief TCP segment (no options) with @p dataSize bytes of data, DF set as Linux sends it.
+ */
+inline std::vector<std::uint8_t> tcpFrame(std::uint16_t srcPort, std::uint16_t dstPort, std::uint8_t flags,
+                                          std::uint32_t seq = 1000, std::uint32_t ack = 0, std::size_t dataSize = 0)
+{
+    const std::size_t l4Size = sizeof(TcpHeader) + dataSize;
+    auto frame = ipv4Frame(IpProto::TCP, l4Size, kPeerIp, kIpv4FlagDontFragment);
+    std::uint8_t* l4 = frame.data() + kIpv4PayloadOffset;
+    const TcpHeader h{htons(srcPort), htons(dstPort), htonl(seq), htonl(ack), static_cast<std::uint8_t>(5 << 4),
+                      flags, htons(65535), 0, 0};
+    std::memcpy(l4, &h, sizeof(h));
+    std::memset(l4 + sizeof(h), 0x42, dataSize);
+    setL4Checksum(frame, offsetof(TcpHeader, checksum));
+    return frame;
+}
+
+/**
+ * @brief Echo request as sent by `ping -f -s <dataSize>`.
+ */
+inline std::vector<std::uint8_t> echoRequestFrame(std::size_t dataSize)
+{
+    const std::size_t icmpSize = sizeof(IcmpEchoHeader) + dataSize;
+    auto frame = ipv4Frame(IpProto::ICMP, icmpSize, kPeerIp, kIpv4FlagDontFragment);
+    std::uint8_t* icmp = frame.data() + kIpv4PayloadOffset;
+    const IcmpEchoHeader header{IcmpType::EchoRequest, 0, 0, htons(0x1234), htons(1)};
+    std::memcpy(icmp, &header, sizeof(header));
+    for (std::size_t i = 0; i < dataSize; ++i) icmp[sizeof(header) + i] = static_cast<std::uint8_t>(i);
+    const std::uint16_t sum = internetChecksum(icmp, icmpSize);
+    std::memcpy(icmp + offsetof(IcmpEchoHeader, checksum), &sum, sizeof(sum));
+    return frame;
+}
+
+/**
+ * @brief who-has kMyIp tell kPeerIp (42 bytes).
+ */
+inline std::vector<std::uint8_t> arpRequestFrame()
+{
+    std::string msg;
+    auto request = makeArpRequest(kPeerMac, kPeerIp, kMyIp, msg);
+    auto bytes = serializeEthernetII(*request);
+    bytes.resize(EthernetII::HeaderSize + sizeof(ArpHeader) + 2 * (6 + 4));
+    return bytes;
+}
+
+/**
+ * @brief Neighbor Solicitation for @p target from the peer's link-local
+ * address, with its source link-layer option.
+ */
+inline std::vector<std::uint8_t> neighborSolicitationFrame(const Ipv6Address& target)
+{
+    const Ipv6Address src = ipv6LinkLocal(kPeerMac);
+    const Ipv6Address dst = ipv6SolicitedNode(target);
+    std::vector<std::uint8_t> frame(kIpv6PayloadOffset + kNdpMessageSize);
+    writeEthernetHeader(frame.data(), ipv6MulticastMac(dst), kPeerMac, EtherType::IPv6);
+    writeIpv6Header(frame.data() + EthernetII::HeaderSize, src, dst, IpProto::ICMPv6, kNdpMessageSize, 255);
+
+    std::uint8_t* l4 = frame.data() + kIpv6PayloadOffset;
+    NdpNeighborMessage message{};
+    message.type = Icmpv6Type::NeighborSolicitation;
+    std::copy(target.begin(), target.end(), message.target);
+    std::memcpy(l4, &message, sizeof(message));
+    l4[sizeof(message)] = NdpOption::SourceLinkAddress;
+    l4[sizeof(message) + 1] = 1;
+    std::memcpy(l4 + sizeof(message) + 2, kPeerMac.data(), 6);
+    const std::uint32_t sum = checksumPseudoIpv6(src.data(), dst.data(), IpProto::ICMPv6, kNdpMessageSize);
+    const std::uint16_t checksum = checksumFinish(checksumAccumulate(l4, kNdpMessageSize, sum));
+    std::memcpy(l4 + offsetof(NdpNeighborMessage, checksum), &checksum, sizeof(checksum));
+    return frame;
+}
+
+}  // namespace bench::frames
@@ -0,0 +1,94 @@
+#include "bench.h"
+
+#include "hex_view.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int kBytesPerRow = 16;
+constexpr int kVisibleRows = 40;
+
+std::vector<std::uint8_t> jumboFrame()
+{
+    std::vector<std::uint8_t> frame(HexView::kMaxBytes);
+    for (std::size_t i = 0; i < frame.size(); ++i) frame[i] = static_cast<std::uint8_t>(i * 31);
+    return frame;
+}
+
+// New frame in the panel: copy + per-byte styles; no row is formatted yet.
+void runSetFrame(std::uint64_t iterations)
+{
+    const auto frame = jumboFrame();
+    HexView view;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        view.setFrame(frame.data(), frame.size() - (i & 1), nullptr);
+        bench::doNotOptimize(view.rowCount());
+    }
+}
+
+// One redraw of the visible rows, scrolled somewhere into a 64 KB frame (rows cached after the first pass).
+void runVisibleRows(std::uint64_t iterations)
+{
+    const auto frame = jumboFrame();
+    HexView view;
+    view.setFrame(frame.data(), frame.size(), nullptr);
+    view.setGeometry(kBytesPerRow, kVisibleRows);
+    view.scrollTo(2000);
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        for (std::size_t r = view.topRow(); r < view.topRow() + kVisibleRows; ++r)
+        {
+            bench::doNotOptimize(view.row(r).text.data());
+        }
+    }
+}
+
+// Search for a pattern near the end of a 64 KB frame, wrapping from the previous match.
+void runFind(std::uint64_t iterations)
+{
+    auto frame = jumboFrame();
+    const std::vector<std::uint8_t> needle = {0xde, 0xad, 0xbe, 0xef};
+    std::copy(needle.begin(), needle.end(), frame.end() - 100);
+    HexView view;
+    view.setFrame(frame.data(), frame.size(), nullptr);
+    view.setGeometry(kBytesPerRow, kVisibleRows);
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        bench::doNotOptimize(view.find(needle));
+    }
+}
+
+// Before: every redraw printed each visible byte with its own "%02X" format.
+void runVisibleRowsLegacy(std::uint64_t iterations)
+{
+    const auto frame = jumboFrame();
+    std::string line;
+    char cell[8];
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        for (int r = 0; r < kVisibleRows; ++r)
+        {
+            const std::size_t start = static_cast<std::size_t>(r * kBytesPerRow);
+            line.clear();
+            std::snprintf(cell, sizeof(cell), "%04zX", start);
+            line += cell;
+            for (int j = 0; j < kBytesPerRow; ++j)
+            {
+                std::snprintf(cell, sizeof(cell), " %02X", frame[start + static_cast<std::size_t>(j)]);
+                line += cell;
+            }
+            bench::doNotOptimize(line.data());
+        }
+    }
+}
+
+}  // namespace
+
+bench::Register regHexViewSetFrame("hex_view/set_frame_64k", [](std::uint64_t n) { runSetFrame(n); });
+bench::Register regHexViewRows("hex_view/visible_rows_40", [](std::uint64_t n) { runVisibleRows(n); });
+bench::Register regHexViewFind("hex_view/find_64k", [](std::uint64_t n) { runFind(n); });
+bench::Register regHexViewRowsLegacy("hex_view/visible_rows_40_legacy", [](std::uint64_t n) { runVisibleRowsLegacy(n); });
@@ -0,0 +1,103 @@
+#include "bench.h"
+#include "bench_frames.h"
+
+#include "checksum.h"
+#include "icmp.h"
+#include "ipv4.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using namespace bench::frames;
+
+/**
+ * @brief Full RX -> IPv4 -> ICMP -> TX path; every op is one reply handed to the sender.
+ */
+void runEcho(std::uint64_t iterations, std::size_t dataSize, bool verify)
+{
+    const auto request = echoRequestFrame(dataSize);
+    Ipv4Layer ipv4;
+    ipv4.addLocalAddress(kMyIp);
+    std::uint64_t txBytes = 0;
+    ipv4.setSender([&](const std::uint8_t*, std::size_t n) {
+        txBytes += n;
+        return static_cast<int>(n);
+    });
+    IcmpEchoResponder responder(ipv4);
+    responder.setVerifyChecksum(verify);
+
+    std::vector<std::uint8_t> rx(2048);
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        std::memcpy(rx.data(), request.data(), request.size());
+        ipv4.input(rx.data(), request.size(), rx.size(), std::chrono::steady_clock::now());
+    }
+    bench::doNotOptimize(txBytes);
+}
+
+/**
+ * @brief The responder's in-place rewrite alone: type byte and TTL, both
+ * checksums updated with RFC 1624 from the two changed words.
+ */
+void runIncremental(std::uint64_t iterations, std::size_t dataSize)
+{
+    const auto request = echoRequestFrame(dataSize);
+    std::vector<std::uint8_t> rx(2048);
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        std::memcpy(rx.data(), request.data(), request.size());
+        std::uint8_t* ip = rx.data() + EthernetII::HeaderSize;
+        std::uint8_t* icmp = rx.data() + kIpv4PayloadOffset;
+        std::uint16_t oldWord, newWord, sum;
+        std::memcpy(&oldWord, icmp, 2);
+        icmp[0] = IcmpType::EchoReply;
+        std::memcpy(&newWord, icmp, 2);
+        std::memcpy(&sum, icmp + offsetof(IcmpEchoHeader, checksum), 2);
+        sum = checksumUpdate16(sum, oldWord, newWord);
+        std::memcpy(icmp + offsetof(IcmpEchoHeader, checksum), &sum, 2);
+        std::memcpy(&oldWord, ip + offsetof(Ipv4Header, ttl), 2);
+        ip[offsetof(Ipv4Header, ttl)] = 64;
+        std::memcpy(&newWord, ip + offsetof(Ipv4Header, ttl), 2);
+        std::memcpy(&sum, ip + offsetof(Ipv4Header, checksum), 2);
+        sum = checksumUpdate16(sum, oldWord, newWord);
+        std::memcpy(ip + offsetof(Ipv4Header, checksum), &sum, 2);
+        bench::clobberMemory();
+    }
+}
+
+/**
+ * @brief Reference: same rewrite but both checksums recomputed from scratch.
+ */
+void runRecompute(std::uint64_t iterations, std::size_t dataSize)
+{
+    const auto request = echoRequestFrame(dataSize);
+    std::vector<std::uint8_t> rx(2048);
+    const std::size_t icmpSize = request.size() - kIpv4PayloadOffset;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        std::memcpy(rx.data(), request.data(), request.size());
+        std::uint8_t* ip = rx.data() + EthernetII::HeaderSize;
+        std::uint8_t* icmp = rx.data() + kIpv4PayloadOffset;
+        icmp[0] = IcmpType::EchoReply;
+        std::memset(icmp + offsetof(IcmpEchoHeader, checksum), 0, 2);
+        const std::uint16_t icmpSum = internetChecksum(icmp, icmpSize);
+        std::memcpy(icmp + offsetof(IcmpEchoHeader, checksum), &icmpSum, 2);
+        ip[offsetof(Ipv4Header, ttl)] = 64;
+        std::memset(ip + offsetof(Ipv4Header, checksum), 0, 2);
+        const std::uint16_t ipSum = internetChecksum(ip, kIpv4HeaderSize);
+        std::memcpy(ip + offsetof(Ipv4Header, checksum), &ipSum, 2);
+        bench::clobberMemory();
+    }
+}
+
+bench::Register regPing("icmp/ping_flood_56", 98, [](std::uint64_t n) { runEcho(n, 56, true); });
+bench::Register regPingNoVerify("icmp/ping_flood_56_noverify", 98, [](std::uint64_t n) { runEcho(n, 56, false); });
+bench::Register regPingLarge("icmp/ping_flood_1472", 1514, [](std::uint64_t n) { runEcho(n, 1472, true); });
+bench::Register regRewriteIncr("icmp/rewrite_incremental_1472", 1514, [](std::uint64_t n) { runIncremental(n, 1472); });
+bench::Register regRewriteFull("icmp/rewrite_recompute_1472", 1514, [](std::uint64_t n) { runRecompute(n, 1472); });
+
+}  // namespace
@@ -0,0 +1,77 @@
+#include "bench.h"
+#include "bench_frames.h"
+
+#include "checksum.h"
+#include "ipv4.h"
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using namespace bench::frames;
+
+/**
+ * @brief Frames (one or several fragments) of a UDP-protocol datagram, as the
+ * peer would put them on the wire.
+ */
+std::vector<std::vector<std::uint8_t>> makeWireFrames(std::size_t payloadSize)
+{
+    std::vector<std::vector<std::uint8_t>> frames;
+    Ipv4Layer peer;
+    peer.setSender([&](const std::uint8_t* f, std::size_t n) {
+        frames.emplace_back(f, f + n);
+        return static_cast<int>(n);
+    });
+    std::vector<std::uint8_t> buffer(kIpv4PayloadOffset + payloadSize + EthernetII::MinFrameSize, 0x5A);
+    peer.output(buffer.data(), payloadSize, buffer.size(), kPeerToUs, IpProto::UDP);
+    return frames;
+}
+
+/**
+ * @brief Feed pre-built frames into a layer; each op is one whole datagram.
+ */
+void runInput(std::uint64_t iterations, std::size_t payloadSize)
+{
+    const auto wire = makeWireFrames(payloadSize);
+    Ipv4Layer layer;
+    layer.addLocalAddress(kMyIp);
+    std::uint64_t delivered = 0;
+    layer.setHandler(IpProto::UDP, [&](Ipv4Packet& p) { delivered += p.payloadSize; });
+
+    std::vector<std::uint8_t> rx(2048);
+    const auto now = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        for (const auto& f : wire)
+        {
+            std::memcpy(rx.data(), f.data(), f.size());
+            layer.input(rx.data(), f.size(), rx.size(), now);
+        }
+    }
+    bench::doNotOptimize(delivered);
+}
+
+bench::Register regUnfrag("ipv4/input_unfragmented_1472", 1472,
+                          [](std::uint64_t n) { runInput(n, 1472); });
+bench::Register regSmall("ipv4/input_unfragmented_64", 64,
+                         [](std::uint64_t n) { runInput(n, 64); });
+bench::Register regFrag8k("ipv4/input_fragmented_8k", 8192,
+                          [](std::uint64_t n) { runInput(n, 8192); });
+bench::Register regFrag64k("ipv4/input_fragmented_64k", 65000,
+                           [](std::uint64_t n) { runInput(n, 65000); });
+
+bench::Register regChecksum("ipv4/header_checksum_20", 20, [](std::uint64_t n) {
+    std::uint8_t header[20];
+    writeIpv4Header(header, kPeerIp, kMyIp, IpProto::UDP, 84, 1, 0, 64);
+    std::uint32_t acc = 0;
+    for (std::uint64_t i = 0; i < n; ++i)
+    {
+        bench::clobberMemory();
+        acc += internetChecksum(header, sizeof(header));
+    }
+    bench::doNotOptimize(acc);
+});
+
+}  // namespace
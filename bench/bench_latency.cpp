@@ -0,0 +1,49 @@
+#include "bench.h"
+
+#include "latency_histogram.h"
+
+#include <chrono>
+
+namespace {
+
+bench::Register regTsc("latency/clock_now", [](std::uint64_t n) {
+    std::uint64_t acc = 0;
+    for (std::uint64_t i = 0; i < n; ++i) acc += LatencyClock::now();
+    bench::doNotOptimize(acc);
+});
+
+// The vDSO clock the TSC read replaces.
+bench::Register regSteady("latency/steady_clock_now", [](std::uint64_t n) {
+    std::int64_t acc = 0;
+    for (std::uint64_t i = 0; i < n; ++i) acc += std::chrono::steady_clock::now().time_since_epoch().count();
+    bench::doNotOptimize(acc);
+});
+
+bench::Register regRecord("latency/record", [](std::uint64_t n) {
+    static LatencyHistogram histogram;
+    for (std::uint64_t i = 0; i < n; ++i) histogram.record(200 + (i & 1023) * 37);
+    bench::doNotOptimize(histogram);
+});
+
+// What one instrumented stage adds: a timestamp plus recording against the previous one.
+bench::Register regStage("latency/stage_timestamp_and_record", [](std::uint64_t n) {
+    static PipelineLatency pipeline;
+    std::uint64_t previous = LatencyClock::now();
+    for (std::uint64_t i = 0; i < n; ++i)
+    {
+        const std::uint64_t now = LatencyClock::now();
+        pipeline.record(PipelineStage::Handle, previous, now);
+        previous = now;
+    }
+    bench::doNotOptimize(previous);
+});
+
+bench::Register regSnapshot("latency/snapshot_and_p999", [](std::uint64_t n) {
+    static LatencyHistogram histogram;
+    histogram.record(1000);
+    std::uint64_t acc = 0;
+    for (std::uint64_t i = 0; i < n; ++i) acc += histogram.snapshot().percentile(0.999);
+    bench::doNotOptimize(acc);
+});
+
+}  // namespace
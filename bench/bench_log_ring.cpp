@@ -0,0 +1,196 @@
+#include "bench.h"
+
+#include "log_ring.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int kWidth = 100;  // Log window of a 104-column terminal
+constexpr std::size_t kVisibleRows = 20;
+
+/**
+ * @brief Typical log lines, a few long enough to wrap.
+ */
+const std::vector<std::string>& sampleLines()
+{
+    static const std::vector<std::string> lines = {
+        "[RX] ARP who-has 192.168.100.50 tell 192.168.100.1 (60B)",
+        "[TX] ARP reply 192.168.100.50 is-at 02:00:00:00:00:01 -> TX OK (42 bytes)",
+        "[RX] IPv4 192.168.100.1 -> 192.168.100.50 TCP 51234 -> 80 [SYN] seq=1234567 win=64240 (74B)",
+        "[INFO] [MAC] Filtro en el kernel: 1 unicast, 2 grupos + broadcast; el resto se descarta antes de "
+        "llegar a la cola del TAP",
+        "[WARN] [BPF] Trama descartada por el filtro activo (udp and port 5353)",
+        "Linea sin etiqueta",
+    };
+    return lines;
+}
+
+/**
+ * @brief Ring filled with @p lines lines, spilling to the temp directory if it cannot hold them in RAM.
+ */
+void fillRing(LogRing& ring, std::size_t lines)
+{
+    std::string error;
+    if (!ring.enableSpill(lines, std::filesystem::temp_directory_path(), error))
+    {
+        std::fprintf(stderr, "log_ring: %s\n", error.c_str());
+        std::abort();
+    }
+    const auto& sample = sampleLines();
+    ring.totalRows(kWidth);
+    for (std::size_t i = 0; i < lines; ++i) ring.push(sample[i % sample.size()]);
+}
+
+// Filling a million lines takes longer than the measured loops; do it once.
+LogRing& spilledRing()
+{
+    static LogRing ring;
+    static bool filled = (fillRing(ring, 1000000), true);
+    bench::doNotOptimize(filled);
+    return ring;
+}
+
+// Steady state: every push evicts the oldest line (to the spill file or away).
+void runPush(std::uint64_t iterations, bool spill)
+{
+    LogRing small;
+    if (!spill) fillRing(small, 4096);
+    LogRing& ring = spill ? spilledRing() : small;
+    const auto& sample = sampleLines();
+    for (std::uint64_t i = 0; i < iterations; ++i) ring.push(sample[i % sample.size()]);
+    bench::doNotOptimize(ring.size());
+}
+
+// One redraw: visible rows only, at the bottom or scrolled deep into the spill file.
+void runVisibleRows(std::uint64_t iterations, bool deep)
+{
+    LogRing& ring = spilledRing();
+    std::vector<LogRow> rows;
+    const std::uint64_t total = ring.totalRows(kWidth);
+    const std::uint64_t first = deep ? total / 3 : total - kVisibleRows;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        ring.rows(kWidth, first - (i & 7), kVisibleRows, rows);
+        bench::doNotOptimize(rows.data());
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Vector log re-wrapped on every redraw (replaced by LogRing)
+// ---------------------------------------------------------------------------
+
+struct LegacyWrappedLine {
+    std::string text;
+    int colorPair = 0;
+    bool isArp = false;
+};
+
+std::vector<std::string> legacyWrapText(const std::string& text, int width)
+{
+    std::vector<std::string> lines;
+    if (width <= 0) return lines;
+    std::size_t pos = 0;
+    while (pos < text.size())
+    {
+        while (pos < text.size() && text[pos] == ' ') ++pos;
+        if (pos >= text.size()) break;
+        std::size_t lineStart = pos;
+        std::size_t lineEnd = pos;
+        std::size_t lastSpace = std::string::npos;
+        int remaining = width;
+        while (lineEnd < text.size() && remaining > 0)
+        {
+            if (text[lineEnd] == ' ') lastSpace = lineEnd;
+            ++lineEnd;
+            --remaining;
+        }
+        if (lineEnd >= text.size())
+        {
+            lines.push_back(text.substr(lineStart));
+            break;
+        }
+        if (lastSpace != std::string::npos && lastSpace > lineStart)
+        {
+            lines.push_back(text.substr(lineStart, lastSpace - lineStart));
+            pos = lastSpace + 1;
+        }
+        else
+        {
+            lines.push_back(text.substr(lineStart, width));
+            pos = lineStart + width;
+        }
+    }
+    return lines;
+}
+
+std::vector<LegacyWrappedLine> legacyBuildWrappedLog(const std::vector<std::string>& log, int maxWidth)
+{
+    std::vector<LegacyWrappedLine> out;
+    for (const auto& line : log)
+    {
+        const bool isArp = line.find("ARP") != std::string::npos;
+        std::string tag;
+        int tagColor = 0;
+        if (line.rfind("[RX]", 0) == 0) { tag = "[RX]"; tagColor = 1; }
+        else if (line.rfind("[TX]", 0) == 0) { tag = "[TX]"; tagColor = 2; }
+        else if (line.rfind("[INFO]", 0) == 0) { tag = "[INFO]"; tagColor = 3; }
+        else if (line.rfind("[WARN]", 0) == 0) { tag = "[WARN]"; tagColor = 4; }
+        int colorPair = (tagColor > 0) ? tagColor : 5;
+        std::string body = line;
+        std::string prefix;
+        if (!tag.empty())
+        {
+            body = line.substr(tag.size());
+            if (!body.empty() && body[0] == ' ') body.erase(0, 1);
+            prefix = tag + " ";
+        }
+        const int prefixLen = static_cast<int>(prefix.size());
+        auto wrapped = legacyWrapText(body, std::max(0, maxWidth - prefixLen));
+        if (wrapped.empty()) wrapped.push_back(" ");
+        for (std::size_t i = 0; i < wrapped.size(); ++i)
+        {
+            std::string lineText = prefix.empty() ? wrapped[i]
+                                   : (i == 0 ? prefix + wrapped[i] : std::string(prefixLen, ' ') + wrapped[i]);
+            out.push_back({lineText, colorPair, isArp});
+        }
+    }
+    return out;
+}
+
+void runPushLegacy(std::uint64_t iterations)
+{
+    std::vector<std::string> log;
+    const auto& sample = sampleLines();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        log.push_back(sample[i % sample.size()]);
+        if (log.size() > 200) log.erase(log.begin(), log.begin() + (log.size() - 200));
+    }
+    bench::doNotOptimize(log.data());
+}
+
+void runVisibleRowsLegacy(std::uint64_t iterations)
+{
+    std::vector<std::string> log;
+    const auto& sample = sampleLines();
+    for (std::size_t i = 0; i < 200; ++i) log.push_back(sample[i % sample.size()]);
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto wrapped = legacyBuildWrappedLog(log, kWidth);
+        bench::doNotOptimize(wrapped.data());
+    }
+}
+
+}  // namespace
+
+bench::Register regLogPush("log_ring/push", [](std::uint64_t n) { runPush(n, false); });
+bench::Register regLogPushSpill("log_ring/push_spill", [](std::uint64_t n) { runPush(n, true); });
+bench::Register regLogRowsBottom("log_ring/visible_rows_bottom", [](std::uint64_t n) { runVisibleRows(n, false); });
+bench::Register regLogRowsDeep("log_ring/visible_rows_deep", [](std::uint64_t n) { runVisibleRows(n, true); });
+bench::Register regLogPushLegacy("log_ring/push_200_legacy", [](std::uint64_t n) { runPushLegacy(n); });
+bench::Register regLogRowsLegacy("log_ring/visible_rows_200_legacy", [](std::uint64_t n) { runVisibleRowsLegacy(n); });
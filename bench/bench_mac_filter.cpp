@@ -0,0 +1,87 @@
+#include "bench.h"
+#include "bench_frames.h"
+
+#include "ipv6.h"
+#include "mac_filter.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+using namespace bench::frames;
+
+/**
+ * @brief Filter as the TUI sets it up: our MAC, broadcast, all-nodes, our
+ * solicited-node group and mDNS.
+ */
+MacFilter& filter()
+{
+    static MacFilter f = [] {
+        MacFilter m;
+        m.addUnicast(kMyMac);
+        m.join(ipv6MulticastMac(kIpv6AllNodes));
+        m.join(ipv6MulticastMac(ipv6SolicitedNode(ipv6LinkLocal(kMyMac))));
+        m.join(MacAddress{0x33, 0x33, 0x00, 0x00, 0x00, 0xfb});
+        m.join(MacAddress{0x01, 0x00, 0x5e, 0x00, 0x00, 0xfb});
+        return m;
+    }();
+    return f;
+}
+
+/**
+ * @brief Destinations seen on a busy link: ours, broadcast, joined and foreign groups, other hosts.
+ */
+const std::vector<std::vector<std::uint8_t>>& frames()
+{
+    static const std::vector<std::vector<std::uint8_t>> mix = [] {
+        const MacAddress destinations[8] = {
+            kMyMac,
+            {0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+            {0x33, 0x33, 0x00, 0x00, 0x00, 0x01},
+            {0x33, 0x33, 0x00, 0x00, 0x00, 0x16},  // MLDv2 reports
+            {0x33, 0x33, 0x00, 0x00, 0x00, 0xfb},
+            {0x01, 0x00, 0x5e, 0x7f, 0xff, 0xfa},  // SSDP
+            {0x02, 0x00, 0x00, 0x00, 0x00, 0x02},
+            kMyMac,
+        };
+        const bool expected[8] = {true, true, true, false, true, false, false, true};
+        std::vector<std::vector<std::uint8_t>> out;
+        for (int i = 0; i < 8; ++i)
+        {
+            std::vector<std::uint8_t> frame(64, 0);
+            writeEthernetHeader(frame.data(), destinations[i], MacAddress{0x02, 0, 0, 0, 0, 0x09}, EtherType::IPv6);
+            if (filter().accepts(frame.data()) != expected[i])
+            {
+                std::fprintf(stderr, "macfilter: wrong verdict for destination %d\n", i);
+                std::abort();
+            }
+            out.push_back(std::move(frame));
+        }
+        return out;
+    }();
+    return mix;
+}
+
+bench::Register regAccept("macfilter/accept_mixed_destinations", [](std::uint64_t n) {
+    MacFilter& f = filter();
+    const auto& mix = frames();
+    std::uint32_t accepted = 0;
+    for (std::uint64_t i = 0; i < n; ++i)
+    {
+        const auto& frame = mix[i & 7];
+        accepted += f.accept(frame.data(), frame.size());
+    }
+    bench::doNotOptimize(accepted);
+});
+
+// What the kernel computes per multicast frame to test its 64-bit hash mask.
+bench::Register regBucket("macfilter/kernel_hash_bucket", [](std::uint64_t n) {
+    const auto& mix = frames();
+    unsigned total = 0;
+    for (std::uint64_t i = 0; i < n; ++i) total += MacFilter::hashBucket(mix[i & 7].data());
+    bench::doNotOptimize(total);
+});
+
+}  // namespace
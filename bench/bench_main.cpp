@@ -0,0 +1,190 @@
+#include "bench.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace bench {
+
+std::vector<Case>& registry()
+{
+    static std::vector<Case> cases;
+    return cases;
+}
+
+}  // namespace bench
+
+// ---------------------------------------------------------------------------
+// Allocation counting
+// ---------------------------------------------------------------------------
+
+// Every heap allocation in the process goes through these replacements (the
+// array and nothrow forms forward to them), so a batch's allocs/op is the
+// counter delta over the iteration count.
+static std::atomic<std::uint64_t> allocationCount{0};
+static std::atomic<std::uint64_t> allocationBytes{0};
+
+static void* countedAlloc(std::size_t size, std::size_t alignment)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    void* p = nullptr;
+    if (alignment <= alignof(std::max_align_t)) p = std::malloc(size);
+    else if (posix_memalign(&p, alignment, size) != 0) p = nullptr;
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size)
+{
+    return countedAlloc(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return countedAlloc(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+// ---------------------------------------------------------------------------
+// Runner
+// ---------------------------------------------------------------------------
+
+struct Result {
+    std::uint64_t iterations = 0;
+    double nsPerOp = 0.0;
+    double allocsPerOp = 0.0;
+    double allocBytesPerOp = 0.0;
+};
+
+/**
+ * @brief Run one case with a calibrated iteration count.
+ *
+ * Doubles the batch size until a batch lasts at least `minBatch`, then reports
+ * the last batch.
+ */
+static Result runCase(const bench::Case& c)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto minBatch = std::chrono::milliseconds(200);
+
+    // Untimed zero-iteration call: lets a case build large fixtures (tables,
+    // frame sets) outside the calibrated batches.
+    c.body(0);
+
+    Result r;
+    std::uint64_t iterations = 1;
+    for (;;)
+    {
+        const std::uint64_t allocsBefore = allocationCount.load(std::memory_order_relaxed);
+        const std::uint64_t bytesBefore = allocationBytes.load(std::memory_order_relaxed);
+        const auto start = Clock::now();
+        c.body(iterations);
+        const std::chrono::nanoseconds elapsed = Clock::now() - start;
+        const double n = static_cast<double>(iterations);
+        r.iterations = iterations;
+        r.nsPerOp = static_cast<double>(elapsed.count()) / n;
+        r.allocsPerOp = static_cast<double>(allocationCount.load(std::memory_order_relaxed) - allocsBefore) / n;
+        r.allocBytesPerOp = static_cast<double>(allocationBytes.load(std::memory_order_relaxed) - bytesBefore) / n;
+        if (elapsed >= minBatch || iterations >= (1ull << 40)) break;
+        iterations *= 2;
+    }
+    return r;
+}
+
+static void printText(std::FILE* out, const bench::Case& c, const Result& r)
+{
+    const double opsPerSec = (r.nsPerOp > 0.0) ? 1e9 / r.nsPerOp : 0.0;
+    std::fprintf(out, "%-40s %12llu iters %12.2f ns/op %14.0f ops/s %8.2f allocs/op",
+                 c.name.c_str(), static_cast<unsigned long long>(r.iterations), r.nsPerOp, opsPerSec, r.allocsPerOp);
+    if (c.bytesPerOp > 0)
+    {
+        const double bytesPerSec = opsPerSec * static_cast<double>(c.bytesPerOp);
+        std::fprintf(out, " %9.2f Gbit/s %8.2f GB/s", bytesPerSec * 8.0 / 1e9, bytesPerSec / 1e9);
+    }
+    std::fprintf(out, "\n");
+}
+
+/**
+ * @brief One JSON object per line; the keys are stable across releases
+ * (new keys may be appended, existing ones keep their meaning and unit).
+ */
+static void printJson(std::FILE* out, const bench::Case& c, const Result& r)
+{
+    std::fprintf(out,
+                 "{\"name\":\"%s\",\"iterations\":%llu,\"ns_per_op\":%.3f,\"allocs_per_op\":%.3f,"
+                 "\"alloc_bytes_per_op\":%.1f,\"bytes_per_op\":%zu}\n",
+                 c.name.c_str(), static_cast<unsigned long long>(r.iterations), r.nsPerOp, r.allocsPerOp,
+                 r.allocBytesPerOp, c.bytesPerOp);
+}
+
+/**
+ * @brief Benchmark entry point.
+ *
+ * Usage: netGuiBench [--json] [--output FILE] [filter...]
+ * Runs the cases whose name contains any filter (all without filters).
+ * --json switches to JSON Lines; --output writes the results to FILE.
+ */
+int main(int argc, char** argv)
+{
+    bool json = false;
+    const char* outputPath = nullptr;
+    std::vector<const char*> filters;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--json") == 0) json = true;
+        else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) outputPath = argv[++i];
+        else filters.push_back(argv[i]);
+    }
+
+    std::FILE* out = stdout;
+    if (outputPath)
+    {
+        out = std::fopen(outputPath, "w");
+        if (!out)
+        {
+            std::perror(outputPath);
+            return 1;
+        }
+    }
+
+    for (const auto& c : bench::registry())
+    {
+        bool selected = filters.empty();
+        for (const char* f : filters)
+        {
+            selected = selected || std::strstr(c.name.c_str(), f) != nullptr;
+        }
+        if (!selected) continue;
+        const Result r = runCase(c);
+        if (json) printJson(out, c, r);
+        else printText(out, c, r);
+        std::fflush(out);
+        if (out != stdout) std::fprintf(stderr, "%s\n", c.name.c_str());
+    }
+    if (out != stdout) std::fclose(out);
+    return 0;
+}
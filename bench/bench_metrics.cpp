@@ -0,0 +1,35 @@
+#include "bench.h"
+
+#include "metrics.h"
+
+namespace {
+
+// Cost on the packet path: one relaxed load and store.
+bench::Register regCounter("metrics/counter_add", [](std::uint64_t n) {
+    static MetricsRegistry registry;
+    static MetricCounter& frames = registry.counter("bench_frames_total", "frames");
+    for (std::uint64_t i = 0; i < n; ++i) frames.add();
+    bench::doNotOptimize(frames);
+});
+
+// One scrape of roughly what the TUI exports (counters plus five histograms), on the server thread.
+bench::Register regRender("metrics/render", [](std::uint64_t n) {
+    static MetricsRegistry registry;
+    static PipelineLatency pipeline;
+    static bool ready = [] {
+        for (int i = 0; i < 12; ++i) registry.counter("bench_counter_total", "counter", "id=\"" + std::to_string(i) + "\"");
+        for (std::size_t i = 0; i < kPipelineStages; ++i)
+        {
+            const auto stage = static_cast<PipelineStage>(i);
+            pipeline[stage].record(1000 + i);
+            registry.histogram("bench_latency_seconds", "latency", pipeline[stage], "stage=\"" + std::to_string(i) + "\"");
+        }
+        return true;
+    }();
+    std::size_t bytes = 0;
+    for (std::uint64_t i = 0; i < n; ++i) bytes += registry.render().size();
+    bench::doNotOptimize(bytes);
+    bench::doNotOptimize(ready);
+});
+
+}  // namespace
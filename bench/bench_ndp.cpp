@@ -0,0 +1,101 @@
+#include "bench.h"
+#include "bench_frames.h"
+
+#include "ipv6.h"
+#include "ndp.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using namespace bench::frames;
+
+/**
+ * @brief Neighbors as a busy /64 would have them: same prefix, random-looking interface IDs.
+ */
+std::vector<Ipv6Address> makeNeighbors(std::size_t count, std::uint64_t seed)
+{
+    std::vector<Ipv6Address> out(count);
+    std::uint64_t x = seed;
+    for (auto& ip : out)
+    {
+        ip = Ipv6Address{0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0x01};
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        std::memcpy(ip.data() + 8, &x, 8);
+    }
+    return out;
+}
+
+void runLookup(std::uint64_t iterations, std::size_t entries, bool hit)
+{
+    NeighborCache cache(entries);
+    const auto now = std::chrono::steady_clock::now();
+    const auto present = makeNeighbors(entries, 0x9E3779B97F4A7C15ull);
+    for (const auto& ip : present) cache.insert(ip, now);
+    const auto queries = hit ? present : makeNeighbors(entries, 0xD1B54A32D192ED03ull);
+
+    std::size_t found = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        found += cache.find(queries[(i * 7919) & (entries - 1)]) != nullptr;
+    }
+    bench::doNotOptimize(found);
+}
+
+/**
+ * @brief RX -> IPv6 -> NDP -> NA written in place -> TX, including the cache update.
+ */
+void runSolicitation(std::uint64_t iterations)
+{
+    Ipv6Layer ipv6;
+    ipv6.setLinkAddress(kMyMac);
+    ipv6.addLocalAddress(ipv6LinkLocal(kMyMac));
+    std::uint64_t txBytes = 0;
+    ipv6.setSender([&](const std::uint8_t*, std::size_t n) {
+        txBytes += n;
+        return static_cast<int>(n);
+    });
+    Ndp ndp(ipv6);
+
+    const auto request = neighborSolicitationFrame(ipv6LinkLocal(kMyMac));
+    std::vector<std::uint8_t> rx(2048);
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        std::memcpy(rx.data(), request.data(), request.size());
+        ipv6.input(rx.data(), request.size(), rx.size(), std::chrono::steady_clock::now());
+    }
+    bench::doNotOptimize(txBytes);
+}
+
+/**
+ * @brief mDNS to 33:33:00:00:00:fb: dropped by the link-layer group filter.
+ */
+void runFiltered(std::uint64_t iterations)
+{
+    Ipv6Layer ipv6;
+    ipv6.setLinkAddress(kMyMac);
+    ipv6.addLocalAddress(ipv6LinkLocal(kMyMac));
+    const Ipv6Address mdns{0xff, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xfb};
+    std::vector<std::uint8_t> frame(kIpv6PayloadOffset + 64);
+    writeEthernetHeader(frame.data(), ipv6MulticastMac(mdns), kPeerMac, EtherType::IPv6);
+    writeIpv6Header(frame.data() + EthernetII::HeaderSize, ipv6LinkLocal(kPeerMac), mdns, IpProto::UDP, 64, 255);
+
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        ipv6.input(frame.data(), frame.size(), frame.size(), std::chrono::steady_clock::time_point{});
+    }
+    bench::doNotOptimize(ipv6.stats().rxLinkFiltered);
+}
+
+bench::Register regHit("ndp/cache_lookup_hit_1024", [](std::uint64_t n) { runLookup(n, 1024, true); });
+bench::Register regMiss("ndp/cache_lookup_miss_1024", [](std::uint64_t n) { runLookup(n, 1024, false); });
+bench::Register regHitLarge("ndp/cache_lookup_hit_65536", [](std::uint64_t n) { runLookup(n, 65536, true); });
+bench::Register regNs("ndp/ns_to_na_in_place", runSolicitation);
+bench::Register regFilter("ndp/mdns_link_filtered", runFiltered);
+
+}  // namespace
@@ -0,0 +1,126 @@
+#include "bench.h"
+
+#include "ethernet.h"
+#include "netgui_actions.h"
+#include "packet_library.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Library source with @p frames named frames of 60..1514 bytes, in a temp directory.
+ */
+std::filesystem::path writeLibrarySource(std::size_t frames)
+{
+    const std::filesystem::path path =
+        std::filesystem::temp_directory_path() / ("netgui_bench_" + std::to_string(frames) + ".hexlib");
+    std::ofstream out(path, std::ios::trunc);
+    static const char* digits = "0123456789abcdef";
+    for (std::size_t f = 0; f < frames; ++f)
+    {
+        const std::size_t size = 60 + (f * 97) % (1514 - 60);
+        out << "--- trama " << f << "\n";
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            const auto b = static_cast<std::uint8_t>(i * 7 + f);
+            out << digits[b >> 4] << digits[b & 0x0F] << ((i % 16 == 15 || i + 1 == size) ? '\n' : ' ');
+        }
+    }
+    return path;
+}
+
+/**
+ * @brief Opened library over writeLibrarySource(@p frames); aborts if it does not load.
+ */
+void openLibrary(PacketLibrary& library, std::size_t frames)
+{
+    std::string error;
+    if (!library.open(writeLibrarySource(frames), error) || library.size() != frames)
+    {
+        std::fprintf(stderr, "packet_library: %s\n", error.c_str());
+        std::abort();
+    }
+}
+
+// Writing and compiling thousands of frames takes longer than the measured
+// loop, so each size is opened once and shared by the calibration runs.
+const PacketLibrary& sharedLibrary(std::size_t frames)
+{
+    static PacketLibrary small;
+    static PacketLibrary large;
+    PacketLibrary& library = frames <= 16 ? small : large;
+    if (!library.isOpen()) openLibrary(library, frames);
+    return library;
+}
+
+// Select frame N and touch its bytes: what [l] costs before the write().
+void runFrame(std::uint64_t iterations, std::size_t frames)
+{
+    const PacketLibrary& library = sharedLibrary(frames);
+    std::size_t index = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        const PacketView view = library.frame(index);
+        bench::doNotOptimize(view.data[0] + view.data[view.size - 1]);
+        index = (index + 613) % frames;  // Jump around instead of walking the file
+    }
+}
+
+void runRefreshUnchanged(std::uint64_t iterations)
+{
+    PacketLibrary library;
+    openLibrary(library, 256);
+    std::string error;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        const bool ok = library.refresh(error);
+        bench::doNotOptimize(ok);
+    }
+}
+
+void runCompile(std::uint64_t iterations, std::size_t frames)
+{
+    const std::filesystem::path source = writeLibrarySource(frames);
+    const std::filesystem::path output = PacketLibrary::compiledPathFor(source);
+    std::string error;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        const long count = PacketLibrary::compile(source, output, error);
+        bench::doNotOptimize(count);
+    }
+}
+
+// The custom_packet.hex path: read and parse the text on every send.
+void runLoadCustomPacket(std::uint64_t iterations, std::size_t size)
+{
+    const std::filesystem::path path =
+        std::filesystem::temp_directory_path() / ("netgui_bench_custom_" + std::to_string(size) + ".hex");
+    {
+        std::vector<std::uint8_t> bytes(size);
+        for (std::size_t i = 0; i < size; ++i) bytes[i] = static_cast<std::uint8_t>(i * 7);
+        std::ofstream out(path, std::ios::trunc);
+        out << toHex(bytes.data(), bytes.size(), bytes.size()) << "\n";
+    }
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        auto bytes = loadCustomPacket(path);
+        bench::doNotOptimize(bytes);
+    }
+}
+
+}  // namespace
+
+bench::Register regLibFrame16("packet_library/frame_16", [](std::uint64_t n) { runFrame(n, 16); });
+bench::Register regLibFrame4096("packet_library/frame_4096", [](std::uint64_t n) { runFrame(n, 4096); });
+bench::Register regLibRefresh("packet_library/refresh_unchanged", [](std::uint64_t n) { runRefreshUnchanged(n); });
+bench::Register regLibCompile256("packet_library/compile_256", [](std::uint64_t n) { runCompile(n, 256); });
+bench::Register regLibLoadCustom60("packet_library/load_custom_packet_60_legacy",
+                                   [](std::uint64_t n) { runLoadCustomPacket(n, 60); });
+bench::Register regLibLoadCustom1514("packet_library/load_custom_packet_1514_legacy",
+                                     [](std::uint64_t n) { runLoadCustomPacket(n, 1514); });
@@ -0,0 +1,115 @@
+#include "bench.h"
+#include "bench_frames.h"
+
+#include "checksum.h"
+#include "dissector.h"
+#include "ipv4.h"
+#include "rss.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace bench::frames;
+
+struct FrameSet {
+    std::vector<std::vector<std::uint8_t>> frames;
+    std::vector<FrameDescriptor> info;
+};
+
+/**
+ * @brief 1024 UDP flows (distinct source address/port), 64-byte payloads, dissected once.
+ */
+const FrameSet& frameSet()
+{
+    static FrameSet set = [] {
+        FrameSet s;
+        const std::size_t flows = 1024;
+        for (std::size_t i = 0; i < flows; ++i)
+        {
+            const Ipv4Address src{10, 0, static_cast<std::uint8_t>(i >> 8), static_cast<std::uint8_t>(i)};
+            auto frame = udpFrame(static_cast<std::uint16_t>(20000 + i), 9, 64, src);
+            FrameDescriptor info;
+            dissectFrame(frame.data(), frame.size(), info);
+            s.frames.push_back(std::move(frame));
+            s.info.push_back(info);
+        }
+        return s;
+    }();
+    return set;
+}
+
+void runHash(std::uint64_t iterations, bool lut, bool ipv6)
+{
+    static const ToeplitzHash hasher(kRssMicrosoftKey);
+    std::uint8_t input[kRssMaxInputSize];
+    for (std::size_t i = 0; i < sizeof(input); ++i) input[i] = static_cast<std::uint8_t>(i * 37 + 11);
+    const std::size_t size = ipv6 ? 36 : 12;
+    std::uint32_t acc = 0;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        input[0] = static_cast<std::uint8_t>(i);
+        bench::clobberMemory();
+        acc += lut ? hasher.hash(input, size) : ToeplitzHash::reference(kRssMicrosoftKey, input, size);
+    }
+    bench::doNotOptimize(acc);
+}
+
+/**
+ * @brief Producer dispatches frames of 1024 flows; each worker checksums the
+ * frame (stand-in for per-packet work) and bumps a private counter. A full
+ * queue back-pressures the producer, so the rate is what the workers sustain.
+ * Aggregate pps = ops/s.
+ */
+void runDispatch(std::uint64_t iterations, std::size_t workerCount)
+{
+    if (iterations == 0) return;
+    const FrameSet& set = frameSet();
+
+    struct alignas(64) PerWorker {
+        std::uint64_t frames = 0;
+        std::uint32_t sum = 0;
+    };
+    std::vector<PerWorker> perWorker(workerCount);
+
+    RssConfig config;
+    config.workers = workerCount;
+    config.queueDepth = 1024;
+    RssDispatcher rss(config, [&](std::size_t worker, const RssItem& item) {
+        perWorker[worker].sum += checksumAccumulate(item.data, item.size);
+        ++perWorker[worker].frames;
+    });
+    rss.start();
+    const std::size_t n = set.frames.size();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        const std::size_t f = static_cast<std::size_t>(i % n);
+        while (!rss.dispatch(set.info[f], set.frames[f].data())) std::this_thread::yield();
+        if ((i & 0xFFFF) == 0xFFFF) rss.rebalance();
+    }
+    rss.waitIdle();
+    rss.stop();
+
+    std::uint64_t total = 0;
+    for (const auto& w : perWorker) total += w.frames + w.sum;
+    bench::doNotOptimize(total);
+}
+
+bench::Register regLut4("rss/toeplitz_ipv4_tcp_lut", [](std::uint64_t n) { runHash(n, true, false); });
+bench::Register regBit4("rss/toeplitz_ipv4_tcp_bitwise", [](std::uint64_t n) { runHash(n, false, false); });
+bench::Register regLut6("rss/toeplitz_ipv6_tcp_lut", [](std::uint64_t n) { runHash(n, true, true); });
+bench::Register regHashFrame("rss/hash_frame_ipv4_udp", [](std::uint64_t n) {
+    const FrameSet& set = frameSet();
+    const ToeplitzHash hasher;
+    std::uint32_t acc = 0;
+    for (std::uint64_t i = 0; i < n; ++i) acc += hasher.hashFrame(set.info[i & 1023]);
+    bench::doNotOptimize(acc);
+});
+bench::Register regW1("rss/dispatch_pps_1_worker", [](std::uint64_t n) { runDispatch(n, 1); });
+bench::Register regW2("rss/dispatch_pps_2_workers", [](std::uint64_t n) { runDispatch(n, 2); });
+bench::Register regW4("rss/dispatch_pps_4_workers", [](std::uint64_t n) { runDispatch(n, 4); });
+bench::Register regW8("rss/dispatch_pps_8_workers", [](std::uint64_t n) { runDispatch(n, 8); });
+
+}  // namespace
@@ -0,0 +1,263 @@
+#include "bench.h"
+#include "bench_frames.h"
+
+#include "ipv4.h"
+#include "packet_buffer.h"
+#include "tcp.h"
+#include "timer_wheel.h"
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+
+using namespace bench::frames;
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief One side of a back-to-back link: its own IPv4/TCP stack, buffer pool
+ * and timer wheel. Frames sent by the peer are copied into this host's pool
+ * (as tap.read() would) and queued until pump() feeds them to the stack.
+ */
+struct Host {
+    Ipv4Layer ipv4;
+    PacketPool pool{4096};
+    TimerWheel timers;
+    TcpLayer tcp;
+    std::vector<PacketBuffer*> inbox;
+    std::size_t inboxHead = 0;
+
+    Host(const MacAddress& mac, const Ipv4Address& ip) : tcp(ipv4, pool, timers)
+    {
+        ipv4.addLocalAddress(ip);
+        ipv4.setLinkAddress(mac);
+        inbox.reserve(4096);
+    }
+
+    void deliver(const std::uint8_t* frame, std::size_t size)
+    {
+        PacketBuffer* buffer = pool.acquire();
+        if (!buffer) return;
+        buffer->reset(0);
+        std::memcpy(buffer->append(size), frame, size);
+        inbox.push_back(buffer);
+    }
+
+    bool receiveOne(Clock::time_point now)
+    {
+        if (inboxHead == inbox.size())
+        {
+            inbox.clear();
+            inboxHead = 0;
+            return false;
+        }
+        PacketBuffer* buffer = inbox[inboxHead++];
+        ipv4.input(*buffer, now);
+        pool.release(buffer);
+        return true;
+    }
+};
+
+// Host a is the peer, host b is us.
+struct Link {
+    std::unique_ptr<Host> a = std::make_unique<Host>(kPeerMac, kPeerIp);
+    std::unique_ptr<Host> b = std::make_unique<Host>(kMyMac, kMyIp);
+
+    Link()
+    {
+        a->ipv4.setSender([this](const std::uint8_t* f, std::size_t n) {
+            b->deliver(f, n);
+            return static_cast<int>(n);
+        });
+        b->ipv4.setSender([this](const std::uint8_t* f, std::size_t n) {
+            a->deliver(f, n);
+            return static_cast<int>(n);
+        });
+        a->ipv4.setNeighborResolver([](const Ipv4Address&) { return std::optional<MacAddress>(kMyMac); });
+        b->ipv4.setNeighborResolver([](const Ipv4Address&) { return std::optional<MacAddress>(kPeerMac); });
+    }
+
+    void pump()
+    {
+        const auto now = Clock::now();
+        bool any = true;
+        while (any)
+        {
+            any = a->receiveOne(now);
+            any = b->receiveOne(now) || any;
+        }
+        a->timers.advance(now);
+        b->timers.advance(now);
+    }
+};
+
+/**
+ * @brief Bulk transfer into the discard service (like `nc ip 9 < file`):
+ * segmentation, checksums, ACK clocking and the RX hand-off on both sides.
+ */
+void runBulk(std::uint64_t iterations, std::size_t writeSize)
+{
+    Link link;
+    link.b->tcp.enableServices();
+    TcpConnection* c = link.a->tcp.connect(kMyIp, TcpPort::Discard, TcpCallbacks{});
+    link.pump();
+
+    std::vector<std::uint8_t> block(writeSize, 0x5a);
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        std::size_t offset = 0;
+        while (offset < block.size())
+        {
+            offset += c->send(block.data() + offset, block.size() - offset);
+            link.pump();
+        }
+    }
+    bench::doNotOptimize(link.b->tcp.stats().rxBytes);
+}
+
+/**
+ * @brief Pure ACKs spread over many established connections: 4-tuple lookup
+ * plus ACK processing, no payload.
+ */
+void runLookup(std::uint64_t iterations)
+{
+    constexpr std::size_t kConnections = 1024;
+    TcpConfig config;
+    config.maxConnections = kConnections;
+    config.sendBuffer = 4096;
+
+    Ipv4Layer ipv4;
+    PacketPool pool(64);
+    TimerWheel timers;
+    TcpLayer tcp(ipv4, pool, timers, config);
+    ipv4.addLocalAddress(kMyIp);
+    ipv4.setLinkAddress(kMyMac);
+    std::vector<std::uint8_t> lastFrame;
+    ipv4.setSender([&](const std::uint8_t* f, std::size_t n) {
+        lastFrame.assign(f, f + n);
+        return static_cast<int>(n);
+    });
+    tcp.listen(TcpPort::Discard, TcpCallbacks{});
+
+    // Hand-made handshakes from distinct source ports; keep the final ACK of each.
+    std::vector<std::vector<std::uint8_t>> acks;
+    for (std::size_t i = 0; i < kConnections; ++i)
+    {
+        const std::uint16_t port = static_cast<std::uint16_t>(20000 + i * 13);
+        auto segment = [&](std::uint32_t seq, std::uint32_t ack, std::uint8_t flags) {
+            return tcpFrame(port, TcpPort::Discard, flags, seq, ack);
+        };
+        auto syn = segment(1000, 0, TcpFlag::SYN);
+        ipv4.input(syn.data(), syn.size(), syn.size(), Clock::now());
+        TcpHeader reply;
+        std::memcpy(&reply, lastFrame.data() + kIpv4PayloadOffset, sizeof(reply));
+        auto ack = segment(1001, ntohl(reply.seq) + 1, TcpFlag::ACK);
+        ipv4.input(ack.data(), ack.size(), ack.size(), Clock::now());
+        acks.push_back(std::move(ack));
+    }
+
+    std::vector<std::uint8_t> rx(2048);
+    const auto now = Clock::now();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        const auto& f = acks[(i * 7) % kConnections];
+        std::memcpy(rx.data(), f.data(), f.size());
+        ipv4.input(rx.data(), f.size(), rx.size(), now);
+    }
+    bench::doNotOptimize(tcp.stats().rxSegments);
+}
+
+/**
+ * @brief Several lossy bulk transfers at once, each missing its first segment
+ * and holding the rest out of order, against the pool size the TUI uses. The
+ * timed part is the duplicate ACK for another out-of-order copy; it aborts if
+ * any ACK found the pool empty.
+ */
+void runLossyHolds(std::uint64_t iterations)
+{
+    constexpr std::size_t kConnections = 8;
+    constexpr std::uint32_t kSegments = 170;  // ~248 KiB of held data per connection
+    constexpr std::uint32_t kMss = 1460;
+
+    Ipv4Layer ipv4;
+    PacketPool pool(1024);
+    TimerWheel timers;
+    TcpLayer tcp(ipv4, pool, timers);
+    ipv4.addLocalAddress(kMyIp);
+    ipv4.setLinkAddress(kMyMac);
+    std::vector<std::uint8_t> lastFrame;
+    std::uint64_t sent = 0;
+    ipv4.setSender([&](const std::uint8_t* f, std::size_t n) {
+        lastFrame.assign(f, f + n);
+        ++sent;
+        return static_cast<int>(n);
+    });
+    tcp.listen(TcpPort::Discard, TcpCallbacks{});
+
+    auto input = [&](const std::vector<std::uint8_t>& frame) {
+        PacketBuffer* buffer = pool.acquire();
+        if (!buffer) return;
+        buffer->reset(0);
+        std::memcpy(buffer->append(frame.size()), frame.data(), frame.size());
+        ipv4.input(*buffer, Clock::now());
+        pool.release(buffer);
+    };
+
+    std::vector<std::vector<std::uint8_t>> duplicates;
+    for (std::size_t i = 0; i < kConnections; ++i)
+    {
+        const std::uint16_t port = static_cast<std::uint16_t>(30000 + i);
+        input(tcpFrame(port, TcpPort::Discard, TcpFlag::SYN, 1000, 0));
+        TcpHeader reply;
+        std::memcpy(&reply, lastFrame.data() + kIpv4PayloadOffset, sizeof(reply));
+        const std::uint32_t ack = ntohl(reply.seq) + 1;
+        input(tcpFrame(port, TcpPort::Discard, TcpFlag::ACK, 1001, ack));
+        // Segment 0 is lost; 1..kSegments arrive and are held.
+        for (std::uint32_t k = 1; k <= kSegments; ++k)
+        {
+            input(tcpFrame(port, TcpPort::Discard, TcpFlag::ACK, 1001 + k * kMss, ack, kMss));
+        }
+        duplicates.push_back(tcpFrame(port, TcpPort::Discard, TcpFlag::ACK, 1001 + kMss, ack, kMss));
+    }
+
+    const std::uint64_t before = sent;
+    for (std::uint64_t i = 0; i < iterations; ++i) input(duplicates[i % kConnections]);
+    if (tcp.stats().txNoBuffer != 0 || sent - before != iterations)
+    {
+        std::fprintf(stderr, "tcp: %llu ACKs without a buffer (%zu held, %zu free)\n",
+                     static_cast<unsigned long long>(tcp.stats().txNoBuffer), tcp.heldBuffers(), pool.available());
+        std::abort();
+    }
+    bench::doNotOptimize(tcp.stats().rxOutOfOrder);
+}
+
+/**
+ * @brief Schedule + cancel on a wheel already holding many timers (RTO re-arm on every ACK).
+ */
+void runTimerRearm(std::uint64_t iterations)
+{
+    TimerWheel wheel;
+    std::vector<TimerId> ids;
+    for (int i = 0; i < 4096; ++i) ids.push_back(wheel.schedule(std::chrono::milliseconds(200 + i), [] {}));
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        TimerId& id = ids[i & 4095];
+        wheel.cancel(id);
+        id = wheel.schedule(std::chrono::milliseconds(200), [] {});
+    }
+    bench::doNotOptimize(wheel.active());
+}
+
+bench::Register regBulk("tcp/bulk_discard_64k", 64 * 1024, [](std::uint64_t n) { runBulk(n, 64 * 1024); });
+bench::Register regLookup("tcp/ack_1024_connections", runLookup);
+bench::Register regLossy("tcp/dup_ack_8_lossy_connections", runLossyHolds);
+bench::Register regTimer("tcp/timer_rearm", runTimerRearm);
+
+}  // namespace
@@ -0,0 +1,59 @@
+#include "bench.h"
+#include "bench_frames.h"
+
+#include "ipv4.h"
+#include "traffic_stats.h"
+
+#include <random>
+#include <vector>
+
+namespace {
+
+using namespace bench::frames;
+
+/**
+ * @brief 4096 dissected frames from @p tail hosts, a quarter of them from 8
+ * hot ones. A long tail keeps the Space-Saving summaries evicting (the
+ * expensive case); a short one is a typical TAP.
+ */
+std::vector<FrameDescriptor> makeDescriptors(std::uint32_t tail)
+{
+    std::mt19937 rng(11);
+    std::vector<FrameDescriptor> out(4096);
+    for (FrameDescriptor& d : out)
+    {
+        const std::uint32_t host = (rng() % 4 == 0) ? rng() % 8 : rng() % tail;
+        const MacAddress src{0x02, 0x00, static_cast<std::uint8_t>(host >> 16), static_cast<std::uint8_t>(host >> 8),
+                             static_cast<std::uint8_t>(host), 0x01};
+        auto frame = ipv4Frame((host & 1) ? IpProto::UDP : IpProto::TCP, 20,
+                               Ipv4Address{10, static_cast<std::uint8_t>(host >> 16),
+                                           static_cast<std::uint8_t>(host >> 8), static_cast<std::uint8_t>(host)});
+        writeEthernetHeader(frame.data(), kMyMac, src, EtherType::IPv4);
+        dissectFrame(frame.data(), frame.size(), d);
+    }
+    return out;
+}
+
+void runAdd(std::uint64_t iterations, const std::vector<FrameDescriptor>& frames)
+{
+    static TrafficStats stats;
+    stats.clear();
+    const auto now = TrafficStats::Clock::now();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        stats.add(frames[i & 4095], TrafficDirection::Rx, now);
+    }
+    bench::doNotOptimize(stats.total(TrafficDirection::Rx).frames);
+}
+
+bench::Register regFew("stats/add_16_hosts", [](std::uint64_t n) {
+    static const auto frames = makeDescriptors(16);
+    runAdd(n, frames);
+});
+
+bench::Register regTail("stats/add_100k_host_tail", [](std::uint64_t n) {
+    static const auto frames = makeDescriptors(100000);
+    runAdd(n, frames);
+});
+
+}  // namespace
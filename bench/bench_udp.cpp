@@ -0,0 +1,94 @@
+#include "bench.h"
+#include "bench_frames.h"
+
+#include "checksum.h"
+#include "ipv4.h"
+#include "packet_buffer.h"
+#include "udp.h"
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using namespace bench::frames;
+
+struct Endpoint {
+    Ipv4Layer ipv4;
+    PacketPool pool{64};
+    UdpLayer udp{ipv4, pool};
+    std::uint64_t txBytes = 0;
+
+    Endpoint()
+    {
+        ipv4.addLocalAddress(kMyIp);
+        ipv4.setLinkAddress(kMyMac);
+        ipv4.setSender([this](const std::uint8_t*, std::size_t n) {
+            txBytes += n;
+            return static_cast<int>(n);
+        });
+        udp.enableServices();
+    }
+};
+
+void runReceive(std::uint64_t iterations, std::size_t size, std::uint16_t port)
+{
+    const auto wire = udpFrame(5001, port, size);
+    Endpoint ep;
+    std::vector<std::uint8_t> rx(2048);
+    const auto now = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        std::memcpy(rx.data(), wire.data(), wire.size());
+        ep.ipv4.input(rx.data(), wire.size(), rx.size(), now);
+    }
+    bench::doNotOptimize(ep.txBytes);
+}
+
+/**
+ * @brief Demux across many bound ports (hash table, not a linear scan).
+ */
+void runDemux(std::uint64_t iterations)
+{
+    constexpr std::uint16_t kPorts = 256;
+    std::vector<std::vector<std::uint8_t>> wire;
+    for (std::uint16_t p = 0; p < kPorts; ++p) wire.push_back(udpFrame(5001, static_cast<std::uint16_t>(10000 + p * 7), 32));
+
+    Endpoint ep;
+    std::uint64_t hits = 0;
+    for (std::uint16_t p = 0; p < kPorts; ++p)
+    {
+        ep.udp.bind(static_cast<std::uint16_t>(10000 + p * 7), [&](const UdpDatagram& d) { hits += d.size; });
+    }
+    std::vector<std::uint8_t> rx(2048);
+    const auto now = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        const auto& f = wire[i % kPorts];
+        std::memcpy(rx.data(), f.data(), f.size());
+        ep.ipv4.input(rx.data(), f.size(), rx.size(), now);
+    }
+    bench::doNotOptimize(hits);
+}
+
+void runSend(std::uint64_t iterations, std::size_t size)
+{
+    Endpoint ep;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        PacketBuffer* out = ep.udp.allocate();
+        std::memset(out->append(size), 0x62, size);
+        ep.udp.sendTo(out, 9, kUsToPeer, 5001);
+    }
+    bench::doNotOptimize(ep.txBytes);
+}
+
+bench::Register regDiscard("udp/rx_discard_1472", 1472, [](std::uint64_t n) { runReceive(n, 1472, 9); });
+bench::Register regDiscardSmall("udp/rx_discard_64", 64, [](std::uint64_t n) { runReceive(n, 64, 9); });
+bench::Register regEcho("udp/echo_1472", 1472, [](std::uint64_t n) { runReceive(n, 1472, 7); });
+bench::Register regChargen("udp/chargen_512", 512, [](std::uint64_t n) { runReceive(n, 1, 19); });
+bench::Register regDemux("udp/demux_256_ports", runDemux);
+bench::Register regSend("udp/sendto_1472", 1472, [](std::uint64_t n) { runSend(n, 1472); });
+
+}  // namespace
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 #include <array>
 #include <optional>
@@ -35,6 +36,7 @@ struct ArpEntry {
     MacAddress mac{};
     std::chrono::steady_clock::time_point expiresAt{};
     bool resolved = false;
+    std::chrono::steady_clock::time_point requestedAt{};  // Request pendiente (latencia de resolución)
 };
 
 // Extrae campos ARP útiles para tabla (request/reply). Retorna nullopt si no aplica.
@@ -52,6 +54,22 @@ std::optional<EthernetFrame> makeArpReply(const EthernetFrame& frame,
                                           const Ipv4Address& myIp,
                                           std::string& outMsg);
 
+// Fast path sin asignaciones: si el frame crudo (tal como llega de tap.read) es un
+// ARP Request para myIp enviado a broadcast o a myMac, lo reescribe en el mismo
+// buffer como ARP Reply (intercambia MACs/IPs, opcode=2, rellena nuestra MAC) y lo
+// deja listo para tap.write. Copia los campos del request en `request` para la
+// tabla ARP/UI. `capacity` es el tamaño total del buffer (para el padding a 60 bytes).
+// `l3Offset` es donde empieza el ARP (FrameDescriptor::l3Offset): tras tags
+// 802.1Q/802.1ad el reply conserva los tags tal cual.
+// Retorna la longitud del reply, o 0 si no aplica (buffer sin modificar).
+std::size_t arpReplyInPlace(std::uint8_t* frame,
+                            std::size_t size,
+                            std::size_t capacity,
+                            const MacAddress& myMac,
+                            const Ipv4Address& myIp,
+                            ArpInfo& request,
+                            std::size_t l3Offset = EthernetII::HeaderSize);
+
 // Construye un ARP Request (who-has) para el target IP.
 // Retorna nullopt si no se puede construir.
 std::optional<EthernetFrame> makeArpRequest(const MacAddress& myMac,
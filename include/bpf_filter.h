@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <linux/filter.h>
+
+/**
+ * @brief Value returned by an accepting program (bytes of the frame to keep).
+ */
+static constexpr std::uint32_t kBpfAcceptAll = 0x40000;
+
+/**
+ * @brief Classic BPF program ready for TUNATTACHFILTER, plus the text it came from.
+ */
+struct BpfProgram {
+    std::string expression;
+    std::vector<sock_filter> code;
+};
+
+/**
+ * @brief Compile a tcpdump-like expression into classic BPF over Ethernet frames.
+ *
+ * Primitives:
+ * - `ip`, `ip6`, `arp`, `vlan`, `tcp`, `udp`, `icmp`, `icmp6`
+ * - `ether src|dst|host MAC`, `ether proto N|ip|ip6|arp`, `[ether] broadcast|multicast`
+ * - `[src|dst] host A.B.C.D|IPv6`, `[src|dst] net A.B.C.D/len`
+ * - `[tcp|udp] [src|dst] port N` (IPv4 first fragments only; IPv6 without extension headers)
+ * - `ip proto N`, `ip6 proto N`, `less N`, `greater N`
+ *
+ * Operators: `not`/`!`, `and`/`&&`, `or`/`||`, parentheses. As in tcpdump,
+ * `and` and `or` have the same precedence and group left to right.
+ * An empty expression accepts everything.
+ *
+ * @return nullopt with @p error set if the expression is invalid.
+ */
+std::optional<BpfProgram> compileBpfFilter(std::string_view expression, std::string& error);
+
+/**
+ * @brief Run @p code over @p frame like the kernel does.
+ * @return Bytes to keep; 0 means the frame is dropped.
+ *
+ * Used when the kernel filter cannot be attached, and to check programs.
+ */
+std::uint32_t runBpfFilter(const std::vector<sock_filter>& code, const std::uint8_t* frame, std::size_t size);
+
+/**
+ * @brief One line per instruction, in the `tcpdump -d` notation.
+ */
+std::vector<std::string> disassembleBpf(const std::vector<sock_filter>& code);
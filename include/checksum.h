@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Internet checksum (RFC 1071) helpers shared by IPv4/ICMP/UDP/TCP.
+ *
+ * Words are summed in memory order, so a finished checksum can be stored into
+ * a header field with memcpy and no byte swapping (RFC 1071 section 2(B)).
+ */
+
+/**
+ * @brief Implementations of the summing loop; the best one the CPU supports
+ * is picked at first use.
+ */
+enum class ChecksumKernel : std::uint8_t {
+    Scalar,  // Portable, 64-bit accumulator
+    Sse2,
+    Avx2
+};
+
+/**
+ * @brief Buffers shorter than this always take the scalar loop (no indirect call).
+ */
+static constexpr std::size_t kChecksumSimdThreshold = 128;
+
+/**
+ * @brief Add the one's-complement sum of a buffer to a running sum.
+ *
+ * The result is folded to 16 bits, so it can be fed back as @p sum for the next
+ * chunk. Every chunk except the last must have an even size.
+ */
+std::uint32_t checksumAccumulate(const void* data, std::size_t size, std::uint32_t sum = 0);
+
+/**
+ * @brief checksumAccumulate forcing a kernel (falls back to scalar if unsupported).
+ */
+std::uint32_t checksumAccumulateWith(ChecksumKernel kernel, const void* data, std::size_t size,
+                                     std::uint32_t sum = 0);
+
+bool checksumKernelSupported(ChecksumKernel kernel);
+
+/** @brief Kernel used by checksumAccumulate. */
+ChecksumKernel checksumKernel();
+
+/**
+ * @brief Override the detected kernel (benchmarks, A/B checks).
+ *
+ * Not synchronised: call before other threads start checksumming.
+ * @return false if the CPU does not support @p kernel.
+ */
+bool setChecksumKernel(ChecksumKernel kernel);
+
+const char* checksumKernelName(ChecksumKernel kernel);
+
+/**
+ * @brief Fold a running sum to 16 bits and complement it.
+ * @return Value to store in the checksum field (memory order).
+ */
+std::uint16_t checksumFinish(std::uint32_t sum);
+
+/**
+ * @brief Checksum of a single buffer.
+ *
+ * Over a header that already carries its checksum, a valid header yields 0.
+ */
+inline std::uint16_t internetChecksum(const void* data, std::size_t size)
+{
+    return checksumFinish(checksumAccumulate(data, size));
+}
+
+/**
+ * @brief Incrementally update a checksum after one 16-bit word changed.
+ *
+ * RFC 1624 eqn. 3: HC' = ~(~HC + ~m + m'). All three values are in the same
+ * (memory) order as the header field, so no byte swapping is needed.
+ */
+inline std::uint16_t checksumUpdate16(std::uint16_t checksum, std::uint16_t oldWord, std::uint16_t newWord)
+{
+    std::uint32_t sum = static_cast<std::uint16_t>(~checksum);
+    sum += static_cast<std::uint16_t>(~oldWord);
+    sum += newWord;
+    sum = (sum & 0xFFFFu) + (sum >> 16);
+    sum = (sum & 0xFFFFu) + (sum >> 16);
+    return static_cast<std::uint16_t>(~sum & 0xFFFFu);
+}
+
+/**
+ * @brief Incrementally update a checksum after a 32-bit field changed (an IPv4
+ * address, a TCP sequence number), both values in memory order.
+ */
+inline std::uint16_t checksumUpdate32(std::uint16_t checksum, std::uint32_t oldValue, std::uint32_t newValue)
+{
+    checksum = checksumUpdate16(checksum, static_cast<std::uint16_t>(oldValue), static_cast<std::uint16_t>(newValue));
+    return checksumUpdate16(checksum, static_cast<std::uint16_t>(oldValue >> 16),
+                            static_cast<std::uint16_t>(newValue >> 16));
+}
+
+/**
+ * @brief Incrementally update a checksum after @p size bytes (even, at an even
+ * offset) changed from @p oldData to @p newData, e.g. an IPv6 address rewrite.
+ */
+std::uint16_t checksumUpdate(std::uint16_t checksum, const void* oldData, const void* newData, std::size_t size);
+
+/**
+ * @brief Sum of the IPv4 pseudo-header used by UDP/TCP checksums (RFC 768/793).
+ * @param src,dst 4-byte addresses in wire order.
+ * @param length  L4 length (header + data), host order.
+ */
+std::uint32_t checksumPseudoIpv4(const std::uint8_t* src, const std::uint8_t* dst,
+                                 std::uint8_t protocol, std::uint16_t length);
+
+/**
+ * @brief Sum of the IPv6 pseudo-header used by ICMPv6/UDP/TCP checksums (RFC 8200 8.1).
+ * @param src,dst 16-byte addresses in wire order.
+ * @param length  Upper-layer length, host order.
+ */
+std::uint32_t checksumPseudoIpv6(const std::uint8_t* src, const std::uint8_t* dst,
+                                 std::uint8_t nextHeader, std::uint32_t length);
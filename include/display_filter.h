@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "dissector.h"
+
+/**
+ * @brief One display-filter instruction: 8 bytes, registers addressed by index.
+ *
+ * Field loads read the FrameDescriptor at a fixed offset, comparisons take an
+ * immediate, and/or/not combine registers; the program is straight-line
+ * (no jumps), so every frame runs the same short sequence.
+ */
+struct DisplayFilterInsn {
+    std::uint8_t op;
+    std::uint8_t dst;
+    std::uint8_t a;
+    std::uint8_t b;
+    std::uint32_t arg;  // Immediate, descriptor offset, layer mask or pool offset (by op)
+};
+
+class DisplayFilter;
+
+/**
+ * @brief Compile a Wireshark-style display filter over dissected frames.
+ *
+ * Fields: frame.len, eth.src/dst/addr/type, vlan.id, arp.opcode,
+ * arp.src.hw_mac, arp.dst.hw_mac, arp.src.proto_ipv4, arp.dst.proto_ipv4,
+ * ip.src/dst/addr/proto/ttl/len, ipv6.src/dst/addr/nxt/hlim,
+ * tcp.srcport/dstport/port/flags/seq/ack/window_size/len,
+ * tcp.flags.fin/syn/rst/push/ack/urg, udp.srcport/dstport/port/len,
+ * icmp.type/code, icmpv6.type/code (tcp.len/udp.len count payload bytes,
+ * ip.len is the IPv4 total length); protocol names (eth, vlan, arp, ip,
+ * ipv6, icmp, icmpv6, udp, tcp) test presence.
+ *
+ * Comparisons: `==`, `!=`, `<`, `<=`, `>`, `>=` (or eq/ne/lt/le/gt/ge) and
+ * `field & mask` (bits set). Values are numbers (decimal or 0x), MACs and
+ * IPv4/IPv6 addresses with an optional /prefix. A `*.addr`/`*.port` field
+ * matches if either side does; `a != b` is `!(a == b)`. A bare field name
+ * tests that its layer is present. Logic: `!`/not, `&&`/and, `||`/or,
+ * parentheses (not > and > or). The parse tree may be at most
+ * kDisplayFilterMaxDepth levels deep.
+ *
+ * @return nullopt with @p error set if the expression is invalid.
+ */
+std::optional<DisplayFilter> compileDisplayFilter(std::string_view expression, std::string& error);
+
+/** @brief Deepest parse tree (nesting of !, parentheses and chained operators) a filter may have. */
+static constexpr int kDisplayFilterMaxDepth = 256;
+
+/**
+ * @brief Compiled display filter (see compileDisplayFilter()).
+ */
+class DisplayFilter {
+public:
+    /** @brief Run the bytecode. An empty filter matches everything. */
+    bool matches(const FrameDescriptor& frame) const;
+
+    /**
+     * @brief Same verdict by walking the parse tree and looking fields up by
+     * name: the straightforward interpreter, kept for checks and benchmarks.
+     */
+    bool reference(const FrameDescriptor& frame) const;
+
+    const std::string& expression() const { return text; }
+    bool empty() const { return code.empty(); }
+    std::size_t instructionCount() const { return code.size(); }
+    std::vector<std::string> disassemble() const;
+
+    struct Node {
+        enum Kind : std::uint8_t { Compare, Present, And, Or, Not };
+        Kind kind = Compare;
+        int left = -1;
+        int right = -1;
+        std::string field;
+        std::uint8_t op = 0;                // Comparison (DisplayFilterInsn op code)
+        std::uint32_t value = 0;            // Scalar operand
+        std::vector<std::uint8_t> bytes;    // Address operand
+        std::vector<std::uint8_t> mask;     // Prefix mask for bytes
+    };
+
+private:
+    friend std::optional<DisplayFilter> compileDisplayFilter(std::string_view expression, std::string& error);
+
+    bool evaluate(int node, const FrameDescriptor& frame) const;
+
+    std::string text;
+    std::vector<DisplayFilterInsn> code;
+    std::vector<std::uint8_t> pool;  // Address constants followed by their masks
+    std::vector<Node> tree;
+    int root = -1;
+    std::uint8_t registers = 0;
+};
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "ethernet.h"
+
+/**
+ * @brief Protocol layers recognised by the dissector.
+ */
+enum class Layer : std::uint8_t {
+    Ethernet,
+    Vlan,    // 802.1Q or 802.1ad (QinQ outer) tag
+    Arp,
+    Ipv4,
+    Ipv6,
+    Icmp,
+    Icmpv6,
+    Udp,
+    Tcp
+};
+
+const char* layerName(Layer layer);
+
+/**
+ * @brief Extra 802.1Q/802.1ad EtherTypes seen by the dissector.
+ */
+namespace EtherTypeVlan {
+static constexpr std::uint16_t Dot1Q = 0x8100;
+static constexpr std::uint16_t Dot1AD = 0x88A8;  // QinQ service tag
+}  // namespace EtherTypeVlan
+
+/**
+ * @brief Conditions noted while decoding (bit set in FrameDescriptor::flags).
+ */
+namespace DissectFlag {
+static constexpr std::uint8_t Truncated = 0x01;  // A header or declared length ran past the buffer
+static constexpr std::uint8_t Malformed = 0x02;  // Impossible header field (bad IHL, data offset...)
+static constexpr std::uint8_t Fragment = 0x04;   // IPv4/IPv6 fragment: L4 only decoded for the first one
+}  // namespace DissectFlag
+
+/**
+ * @brief Where one layer's header sits in the frame.
+ */
+struct FrameLayer {
+    std::uint16_t offset;  // From the start of the Ethernet header
+    std::uint16_t length;  // Header length (not including what it carries)
+    Layer id;
+};
+
+/**
+ * @brief Flat result of one dissection pass (plain data, fixed size, no heap).
+ *
+ * Offsets are from the first byte of the Ethernet header; 0 means "absent"
+ * for l3Offset/l4Offset. Multi-byte values are host order, addresses are
+ * wire order. For IPv4 only the first 4 bytes of srcIp/dstIp are used; for
+ * ARP they hold the sender/target protocol addresses.
+ */
+struct FrameDescriptor {
+    static constexpr std::size_t kMaxLayers = 6;  // Ethernet, two tags, L3, L4 (+1 spare)
+
+    std::uint16_t frameSize;
+    std::uint16_t etherType;       // Innermost, after any VLAN tags
+    std::uint16_t l3Offset;
+    std::uint16_t l4Offset;
+    std::uint16_t payloadOffset;   // First byte after the deepest decoded header
+    std::uint16_t payloadSize;     // Up to the end of the L3 datagram (link padding excluded)
+    std::uint16_t vlan[2];         // VID of each tag, outer first
+    std::uint8_t vlanCount;
+    std::uint8_t layerCount;
+    std::uint8_t flags;
+    std::uint8_t ipVersion;        // 4, 6 or 0
+    std::uint8_t ipProto;          // IPv4 protocol / IPv6 upper-layer header (after extensions)
+    std::uint8_t ttl;              // TTL / hop limit
+    std::uint16_t fragment;        // IPv4 flags + offset field
+    std::uint8_t dstMac[6];
+    std::uint8_t srcMac[6];
+    std::uint8_t srcIp[16];
+    std::uint8_t dstIp[16];
+    std::uint16_t arpOpcode;
+    std::uint8_t arpSenderMac[6];
+    std::uint8_t arpTargetMac[6];
+    std::uint16_t srcPort;
+    std::uint16_t dstPort;
+    std::uint8_t icmpType;
+    std::uint8_t icmpCode;
+    std::uint8_t tcpFlags;
+    std::uint16_t tcpWindow;
+    std::uint32_t tcpSeq;
+    std::uint32_t tcpAck;
+    FrameLayer layers[kMaxLayers];
+
+    const FrameLayer* find(Layer id) const
+    {
+        for (std::size_t i = 0; i < layerCount; ++i)
+        {
+            if (layers[i].id == id) return &layers[i];
+        }
+        return nullptr;
+    }
+    bool has(Layer id) const { return find(id) != nullptr; }
+    /** @brief Deepest decoded layer (Ethernet if nothing else). */
+    Layer top() const { return layerCount ? layers[layerCount - 1].id : Layer::Ethernet; }
+};
+
+static_assert(std::is_trivially_copyable<FrameDescriptor>::value && std::is_standard_layout<FrameDescriptor>::value,
+              "FrameDescriptor must stay plain data");
+
+/**
+ * @brief Read position shared by the stages of one pass.
+ *
+ * @c bias is added to every recorded offset; it lets a decode that starts
+ * past the Ethernet header (dissectEthernetFrame) report frame offsets.
+ */
+struct DissectCursor {
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+    std::size_t offset = 0;
+    std::size_t bias = 0;
+    std::size_t end = 0;          // End of the current datagram (trims link padding)
+    std::uint16_t next = 0;       // Selector for the next stage: EtherType, then IP protocol
+    std::uint8_t layerCount = 0;  // Kept here, not read back from the descriptor, while decoding
+};
+
+/**
+ * @brief Ethernet II header plus up to two VLAN tags; selects on the innermost EtherType.
+ */
+struct LinkStage {
+    static bool run(DissectCursor& cursor, FrameDescriptor& out);
+};
+
+/**
+ * @brief ARP, IPv4 or IPv6 (walking IPv6 extension headers); selects on the IP protocol.
+ */
+struct NetworkStage {
+    static bool run(DissectCursor& cursor, FrameDescriptor& out);
+};
+
+/**
+ * @brief ICMP, ICMPv6, UDP or TCP.
+ */
+struct TransportStage {
+    static bool run(DissectCursor& cursor, FrameDescriptor& out);
+};
+
+/**
+ * @brief Compile-time chain of stages: each runs while the previous one
+ * succeeded (fold over &&), so the whole walk is one inlined pass with no
+ * per-layer dispatch tables.
+ */
+template <typename... Stages>
+struct LayerChain {
+    static void run(DissectCursor& cursor, FrameDescriptor& out)
+    {
+        (void)(Stages::run(cursor, out) && ...);
+        out.layerCount = cursor.layerCount;
+    }
+};
+
+using FullDissector = LayerChain<LinkStage, NetworkStage, TransportStage>;
+
+/**
+ * @brief Run @p Chain over a raw frame. @return true if the Ethernet header was decoded.
+ */
+template <typename Chain>
+bool dissectWith(const std::uint8_t* data, std::size_t size, FrameDescriptor& out)
+{
+    std::memset(&out, 0, sizeof(out));  // Inlined vector stores; `out = {}` becomes rep stos
+    if (!data || size > 0xFFFF) return false;
+    out.frameSize = static_cast<std::uint16_t>(size);
+    DissectCursor cursor;
+    cursor.data = data;
+    cursor.size = size;
+    cursor.end = size;
+    Chain::run(cursor, out);
+    return out.layerCount > 0;
+}
+
+/**
+ * @brief Full decode (Ethernet -> VLAN -> ARP/IPv4/IPv6 -> ICMP/UDP/TCP) of a raw frame.
+ *
+ * Does not validate checksums or allocate; the protocol layers still do their
+ * own validation before acting on a frame.
+ */
+bool dissectFrame(const std::uint8_t* data, std::size_t size, FrameDescriptor& out);
+
+/**
+ * @brief Full decode of an already split EthernetFrame (no re-serialization).
+ */
+bool dissectEthernetFrame(const EthernetFrame& frame, FrameDescriptor& out);
+
+/**
+ * @brief Protocol stack label for panels ("IPv4/TCP", "802.1Q/IPv6/ICMPv6", "ARP", "0x88B5").
+ */
+std::string frameProtocolLabel(const FrameDescriptor& frame);
+
+/**
+ * @brief One-line summary for the log: MACs, addresses, ports, flags and sizes.
+ */
+std::string describeFrame(const FrameDescriptor& frame);
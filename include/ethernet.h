@@ -31,6 +31,14 @@ static constexpr std::uint16_t IPv6 = 0x86DD;
 static constexpr std::uint16_t Demo = 0x88B5;
 }  // namespace EtherType
 
+/**
+ * @brief Fixed Ethernet II sizes (TAP frames carry no FCS).
+ */
+namespace EthernetII {
+static constexpr std::size_t HeaderSize = 14;
+static constexpr std::size_t MinFrameSize = 60;
+}  // namespace EthernetII
+
 /**
  * @brief Ethernet II frame (without FCS).
  *
@@ -63,6 +71,13 @@ std::optional<MacAddress> parseMac(std::string_view text);
  */
 std::vector<std::uint8_t> serializeEthernetII(const EthernetFrame& frame);
 
+/**
+ * @brief Write a 14-byte Ethernet II header at @p out (no allocation).
+ *
+ * Used by the in-place TX paths that build frames directly in a buffer.
+ */
+void writeEthernetHeader(std::uint8_t* out, const MacAddress& dst, const MacAddress& src, std::uint16_t etherType);
+
 /**
  * @brief Parse an Ethernet II frame from raw bytes.
  * @return Parsed frame if the buffer is large enough.
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "dissector.h"
+#include "ethernet.h"
+#include "ipv4.h"
+#include "log_ring.h"
+
+/**
+ * @brief What an EventRecord describes.
+ */
+enum class EventKind : std::uint8_t {
+    RxFrame,       // Dissected frame (descriptor fields below)
+    RxRaw,         // Frame that did not decode; value = bytes read
+    ArpRequest,    // srcIp asks for dstIp
+    ArpReply,      // srcIp is at arpSenderMac
+    ArpFastReply   // We answered srcIp's request in place: dstIp is at arpSenderMac; value = txWrite() result
+};
+
+/**
+ * @brief Fixed-size, plain-data log event recorded on the RX path.
+ *
+ * Holds the fields describeFrame() prints, copied out of the FrameDescriptor,
+ * so recording one is a few stores with no allocation. The text is built by
+ * formatEvent() only when the log row is drawn (or the log exported).
+ */
+struct EventRecord {
+    std::int64_t timestampNs;  // steady_clock
+    std::int32_t value;
+    EventKind kind;
+    std::uint8_t layerCount;
+    std::uint8_t flags;        // DissectFlag
+    std::uint8_t ipVersion;
+    Layer layers[FrameDescriptor::kMaxLayers];
+    std::uint8_t vlanCount;
+    std::uint8_t ipProto;
+    std::uint8_t tcpFlags;
+    std::uint8_t icmpType;
+    std::uint8_t icmpCode;
+    std::uint16_t etherType;
+    std::uint16_t payloadSize;
+    std::uint16_t srcPort;
+    std::uint16_t dstPort;
+    std::uint16_t arpOpcode;
+    std::uint16_t vlan[2];
+    std::uint8_t srcMac[6];
+    std::uint8_t dstMac[6];
+    std::uint8_t arpSenderMac[6];
+    std::uint8_t srcIp[16];
+    std::uint8_t dstIp[16];
+};
+
+static_assert(std::is_trivially_copyable<EventRecord>::value && sizeof(EventRecord) == 96,
+              "EventRecord must stay a fixed-size plain record");
+
+/** @brief Event for a dissected frame. */
+EventRecord makeRxEvent(const FrameDescriptor& frame, std::int64_t timestampNs);
+
+/** @brief Event for a frame that did not decode as Ethernet. */
+EventRecord makeRxRawEvent(std::size_t size, std::int64_t timestampNs);
+
+/**
+ * @brief ARP event. @p sender / @p target are the protocol addresses of the
+ * packet, @p mac the hardware address announced (replies).
+ */
+EventRecord makeArpEvent(EventKind kind, const Ipv4Address& sender, const Ipv4Address& target,
+                         const MacAddress& mac, std::int64_t timestampNs, int sent = 0);
+
+/** @brief Log tag the event is shown with. */
+LogTag eventTag(const EventRecord& event);
+
+/** @brief True for events about ARP (marked in the log gutter). */
+bool eventIsArp(const EventRecord& event);
+
+/**
+ * @brief Log text of @p event without its tag, replacing @p out.
+ */
+void formatEvent(const EventRecord& event, std::string& out);
+
+/**
+ * @brief Header summary of an ARP event ("REQ who-has a tell b", "REP a is-at m").
+ */
+std::string eventArpSummary(const EventRecord& event);
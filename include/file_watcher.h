@@ -0,0 +1,48 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+/**
+ * @brief Tells when a file has been saved, using inotify on its directory.
+ *
+ * The directory is watched rather than the file so that saves which replace
+ * it (write a temporary file, then rename over the original, as vim and most
+ * "atomic save" editors do) are seen as well as in-place rewrites. Only
+ * completed writes (IN_CLOSE_WRITE) and renames onto the name (IN_MOVED_TO)
+ * count, so a half-written file is never reported.
+ *
+ * Non-blocking: fd() can be added to a poll() set, changed() never waits.
+ * Linux only.
+ */
+class FileWatcher {
+public:
+    FileWatcher() = default;
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    /**
+     * @brief Start watching @p file (it does not need to exist yet, its directory does).
+     * @return false with @p error set; the previous watch, if any, is dropped either way.
+     */
+    bool watch(const std::filesystem::path& file, std::string& error);
+
+    bool active() const { return inotifyFd >= 0; }
+
+    /** @brief inotify descriptor (readable when events are pending), -1 if not watching. */
+    int fd() const { return inotifyFd; }
+
+    /**
+     * @brief Drain pending events.
+     * @return true if the file was written or replaced since the last call.
+     */
+    bool changed();
+
+private:
+    void close();
+
+    int inotifyFd = -1;
+    std::string fileName;
+};
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "dissector.h"
+
+/**
+ * @brief Address family of a flow key (FlowKey::family); 0 marks an empty slot.
+ */
+namespace FlowFamily {
+static constexpr std::uint8_t Link = 1;  // Non-IP: MAC pair + EtherType
+static constexpr std::uint8_t Ipv4 = 4;
+static constexpr std::uint8_t Ipv6 = 6;
+}  // namespace FlowFamily
+
+/**
+ * @brief Unidirectional flow identity (as NetFlow/IPFIX: each direction is its own flow).
+ *
+ * IP: addresses (IPv4 in the first 4 bytes), ports, protocol. ICMP/ICMPv6 put
+ * type << 8 | code in dstPort. Non-IP: MACs in src/dst, EtherType in dstPort.
+ * Unused bytes are zero so keys compare and hash as five 64-bit words.
+ */
+struct FlowKey {
+    std::uint8_t src[16];
+    std::uint8_t dst[16];
+    std::uint16_t srcPort;
+    std::uint16_t dstPort;
+    std::uint8_t proto;
+    std::uint8_t family;
+    std::uint16_t tag;  // Hash bits, filled in by the table; 0 in lookups from makeFlowKey
+};
+
+static_assert(sizeof(FlowKey) == 40, "FlowKey is hashed as five 64-bit words");
+
+/**
+ * @brief Flow key of a dissected frame (zeroed key with family 0 if nothing to key on).
+ */
+FlowKey makeFlowKey(const FrameDescriptor& frame);
+
+/**
+ * @brief One tracked flow: exactly one cache line, so an update touches one line.
+ *
+ * Timestamps are milliseconds since the table's epoch (wraps after ~49 days;
+ * ages are computed with unsigned differences, so only idle spans that long
+ * would be misread).
+ */
+struct alignas(64) FlowEntry {
+    FlowKey key;
+    std::uint64_t packets;
+    std::uint64_t bytes;
+    std::uint32_t firstSeenMs;
+    std::uint32_t lastSeenMs;
+};
+
+static_assert(sizeof(FlowEntry) == 64, "FlowEntry must stay one cache line");
+
+struct FlowConfig {
+    std::size_t memoryBytes = 16u << 20;                // Slot array size (rounded down to a power of two)
+    std::chrono::milliseconds idleTimeout{30000};        // Flows idle this long are aged out
+    std::size_t sweepSlots = 4096;                      // Slots examined per expire() call
+};
+
+struct FlowStats {
+    std::uint64_t updates = 0;
+    std::uint64_t created = 0;
+    std::uint64_t expired = 0;
+    std::uint64_t evicted = 0;   // Pushed out to make room when the table was full
+    std::uint64_t ignored = 0;   // Frames with nothing to key on
+};
+
+/**
+ * @brief Fixed-memory flow table: open addressing with linear probing over
+ * 64-byte entries, at most 3/4 full.
+ *
+ * All memory is allocated up front from FlowConfig::memoryBytes. When the
+ * table is full a new flow evicts the least recently seen entry near its
+ * home slot, so an update never scans the table. Aging is an incremental
+ * sweep (expire) so a large table never stalls the RX loop.
+ */
+class FlowTable {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FlowTable(const FlowConfig& config = FlowConfig{});
+
+    /**
+     * @brief Count one frame of @p bytes for @p key, creating the flow if needed.
+     * @return The flow, or nullptr if @p key is empty (family 0).
+     */
+    FlowEntry* update(const FlowKey& key, std::uint32_t bytes, Clock::time_point now);
+
+    /** @brief update(makeFlowKey(frame), frame.frameSize, now). */
+    FlowEntry* update(const FrameDescriptor& frame, Clock::time_point now);
+
+    /**
+     * @brief Update a batch of flows: hashes and prefetches every home slot
+     * first, then updates, so the cache misses of a large table overlap.
+     */
+    void updateBatch(const FlowKey* keys, const std::uint32_t* bytes, std::size_t total, Clock::time_point now);
+
+    const FlowEntry* find(const FlowKey& key) const;
+
+    /**
+     * @brief Age out flows idle for longer than the configured timeout,
+     * examining at most FlowConfig::sweepSlots slots from where the last call stopped.
+     * @return Flows removed.
+     */
+    std::size_t expire(Clock::time_point now);
+
+    void clear();
+
+    /**
+     * @brief Up to @p count flows with the most bytes, largest first.
+     */
+    std::vector<FlowEntry> topFlows(std::size_t count) const;
+
+    /** @brief Milliseconds since the table's epoch, as stored in entries. */
+    std::uint32_t toMs(Clock::time_point now) const;
+
+    std::size_t size() const { return count; }
+    std::size_t maxFlows() const { return limit; }
+    std::size_t slotCount() const { return slots.size(); }
+    std::size_t memoryBytes() const { return slots.size() * sizeof(FlowEntry); }
+    const FlowConfig& config() const { return cfg; }
+    const FlowStats& stats() const { return counters; }
+
+    FlowTable(const FlowTable&) = delete;
+    FlowTable& operator=(const FlowTable&) = delete;
+
+private:
+    /**
+     * @brief Zero-filled slot memory from mmap, backed by huge pages where the
+     * kernel allows: random updates over a large table otherwise pay a TLB
+     * miss (page walk) on top of the cache miss.
+     */
+    class SlotArray {
+    public:
+        explicit SlotArray(std::size_t count);
+        ~SlotArray();
+        SlotArray(const SlotArray&) = delete;
+        SlotArray& operator=(const SlotArray&) = delete;
+
+        std::size_t size() const { return count; }
+        FlowEntry& operator[](std::size_t i) { return base[i]; }
+        const FlowEntry& operator[](std::size_t i) const { return base[i]; }
+        FlowEntry* begin() { return base; }
+        FlowEntry* end() { return base + count; }
+        const FlowEntry* begin() const { return base; }
+        const FlowEntry* end() const { return base + count; }
+
+    private:
+        FlowEntry* base = nullptr;
+        std::size_t count = 0;
+    };
+
+    /**
+     * @brief A key as the five words stored in a slot (tag merged in) plus its home slot.
+     */
+    struct Probe {
+        std::uint64_t words[5];
+        std::size_t home;
+    };
+
+    static std::size_t slotsFor(std::size_t memoryBytes);
+    static std::uint64_t hashOf(const std::uint64_t* words);
+    Probe probeFor(const FlowKey& key) const;
+    std::size_t slotOf(const Probe& probe) const;  // slots.size() if absent
+    FlowEntry* insertAt(const Probe& probe, std::uint32_t nowMs);
+    FlowEntry* updateProbe(const Probe& probe, std::uint32_t bytes, std::uint32_t nowMs);
+    void eraseSlot(std::size_t slot);
+    void evictNear(std::size_t home, std::uint32_t nowMs);
+
+    FlowConfig cfg;
+    SlotArray slots;
+    std::size_t mask = 0;
+    std::size_t limit = 0;
+    std::size_t count = 0;
+    std::size_t sweepCursor = 0;
+    Clock::time_point epoch;
+    FlowStats counters;
+};
+
+/**
+ * @brief "Top flujos" lines for the TUI: protocol, endpoints, packets, bytes, age and idle time.
+ */
+std::vector<std::string> formatTopFlows(const FlowTable& table, std::size_t count, FlowTable::Clock::time_point now);
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Direction a frame in FrameHistory travelled through the TAP.
+ */
+enum class FrameDirection : std::uint8_t { Rx, Tx };
+
+/**
+ * @brief One frame of the history, pointing into the arena.
+ *
+ * data stays valid until the frame is evicted (the next push() may do it).
+ */
+struct HistoryFrame {
+    std::uint64_t seq = 0;
+    std::int64_t timestampNs = 0;  // steady_clock
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+    FrameDirection direction = FrameDirection::Rx;
+};
+
+/**
+ * @brief Last frames seen on the TAP, in both directions, bounded by count
+ * and by bytes.
+ *
+ * Frames are copied back to back into one preallocated arena used as a ring
+ * (a frame that does not fit before the end of the arena starts again at its
+ * beginning) and indexed by a fixed ring of entries, so push() never
+ * allocates: it evicts the oldest frames until the new one has room.
+ *
+ * Frames are addressed by sequence number (push order), which stays stable
+ * while older frames are evicted. Single-threaded (the UI loop).
+ */
+class FrameHistory {
+public:
+    /** @p maxFrames entries (at least 1) in an arena of @p maxBytes (at least one maximum frame). */
+    FrameHistory(std::size_t maxFrames, std::size_t maxBytes);
+
+    /**
+     * @brief Copy a frame into the history.
+     * @return false (frame not kept) if it is empty or larger than the arena.
+     */
+    bool push(FrameDirection direction, const std::uint8_t* data, std::size_t length, std::int64_t timestampNs);
+
+    /** @brief Frames currently kept. */
+    std::size_t size() const { return static_cast<std::size_t>(nextSeq - oldestSeq); }
+    bool empty() const { return nextSeq == oldestSeq; }
+
+    /** @brief Sequence numbers kept: [firstSeq(), endSeq()). */
+    std::uint64_t firstSeq() const { return oldestSeq; }
+    std::uint64_t endSeq() const { return nextSeq; }
+
+    std::size_t maxFrames() const { return entries.size(); }
+    std::size_t maxBytes() const { return arena.size(); }
+
+    /** @brief Bytes of the arena held by kept frames (without the unused tails). */
+    std::size_t bytesUsed() const { return bytesKept; }
+
+    /** @brief Frame @p seq; false if it was evicted or not pushed yet. */
+    bool get(std::uint64_t seq, HistoryFrame& out) const;
+
+    void clear();
+
+private:
+    struct Entry {
+        std::uint64_t position;  // Logical arena offset (physical = position % arena size)
+        std::int64_t timestampNs;
+        std::uint32_t size;
+        FrameDirection direction;
+    };
+
+    void evictOldest();
+
+    std::vector<std::uint8_t> arena;
+    std::vector<Entry> entries;  // slot = seq % maxFrames
+    std::uint64_t oldestSeq = 0;
+    std::uint64_t nextSeq = 0;
+    std::uint64_t writePosition = 0;  // Logical offset of the next frame
+    std::size_t bytesKept = 0;
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Table-driven hex encoding/decoding into caller-provided buffers.
+ *
+ * Nothing here allocates: callers size the output with hexEncodedSize() (or
+ * half the digit count when decoding) and keep the buffer across calls.
+ * Short inputs use 256-entry lookup tables; long ones go through an SSSE3 or
+ * AVX2 kernel picked at first use, in the same way as checksum.h.
+ */
+
+/**
+ * @brief Implementations of the bulk loops.
+ */
+enum class HexKernel : std::uint8_t {
+    Scalar,  // Lookup tables, one byte per step
+    Ssse3,   // pshufb nibble lookup, 16 bytes per step
+    Avx2     // 32 bytes per step (separated encoding stays on SSSE3)
+};
+
+/**
+ * @brief Inputs shorter than this (bytes to encode, pairs to decode) stay on the tables.
+ */
+static constexpr std::size_t kHexSimdThreshold = 32;
+
+/**
+ * @brief Value of every character as a hex digit, 0xFF if it is not one.
+ */
+extern const std::array<std::uint8_t, 256> kHexDigitValue;
+
+/** @brief Value of @p c as a hex digit (0-15), or -1. */
+inline int hexDigitValue(char c)
+{
+    const std::uint8_t v = kHexDigitValue[static_cast<unsigned char>(c)];
+    return v == 0xFF ? -1 : v;
+}
+
+inline bool isHexDigitChar(char c)
+{
+    return kHexDigitValue[static_cast<unsigned char>(c)] != 0xFF;
+}
+
+/**
+ * @brief Characters hexEncode() writes for @p size bytes: 2 per byte, plus
+ * one separator between bytes when @p separator is not '\0'.
+ */
+inline std::size_t hexEncodedSize(std::size_t size, char separator = '\0')
+{
+    if (size == 0) return 0;
+    return separator ? size * 3 - 1 : size * 2;
+}
+
+/**
+ * @brief Write @p size bytes as lowercase hex at @p out, optionally with
+ * @p separator between bytes ("aa bb cc", "aa:bb:cc"). No terminator.
+ * @return One past the last character written.
+ */
+char* hexEncode(const std::uint8_t* data, std::size_t size, char* out, char separator = '\0');
+
+/**
+ * @brief Decode @p pairs digit pairs (2 * @p pairs characters, no
+ * separators, either case) into @p out.
+ * @return false at the first non-hex character; @p out is then partially written.
+ */
+bool hexDecode(const char* text, std::size_t pairs, std::uint8_t* out);
+
+/**
+ * @brief hexEncode/hexDecode forcing a kernel (falls back to scalar if unsupported).
+ */
+char* hexEncodeWith(HexKernel kernel, const std::uint8_t* data, std::size_t size, char* out, char separator = '\0');
+bool hexDecodeWith(HexKernel kernel, const char* text, std::size_t pairs, std::uint8_t* out);
+
+bool hexKernelSupported(HexKernel kernel);
+
+/** @brief Kernel used by hexEncode/hexDecode. */
+HexKernel hexKernel();
+
+/**
+ * @brief Override the detected kernel (benchmarks, A/B checks).
+ *
+ * Not synchronised: call before other threads start encoding.
+ * @return false if the CPU does not support @p kernel.
+ */
+bool setHexKernel(HexKernel kernel);
+
+const char* hexKernelName(HexKernel kernel);
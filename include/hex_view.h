@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "dissector.h"
+
+/**
+ * @brief How a run of bytes in a HexView row is highlighted.
+ */
+enum class HexStyle : std::uint8_t {
+    Plain,      // Not covered by the dissection (link padding, undecoded tail)
+    Link,       // Ethernet header
+    Tag,        // VLAN tags
+    Network,    // ARP, IPv4, IPv6 headers
+    Transport,  // ICMP, ICMPv6, UDP, TCP headers
+    Payload,    // Data carried by the deepest decoded header
+    Match       // Current search match
+};
+
+/**
+ * @brief Run of equally styled columns in HexRow::text.
+ */
+struct HexSegment {
+    std::uint16_t column;
+    std::uint16_t length;
+    HexStyle style;
+};
+
+/**
+ * @brief One formatted row: "OOOO HH HH ...  ascii", plus the styled runs of
+ * its hex and ASCII columns (Plain columns have no segment).
+ */
+struct HexRow {
+    std::string text;
+    std::vector<HexSegment> segments;
+};
+
+/**
+ * @brief Scrollable hex/ASCII view of one frame of up to kMaxBytes.
+ *
+ * Rows are formatted only when asked for (the visible ones) and kept until
+ * the frame, the row width or the search match changes, so scrolling back
+ * and redrawing cost no formatting. Bytes are styled by the header that
+ * covers them in the frame's dissection.
+ *
+ * The view copies the frame; the caller's buffer can go away after setFrame().
+ */
+class HexView {
+public:
+    static constexpr std::size_t kMaxBytes = 65536;
+
+    /**
+     * @brief Show @p size bytes of @p data (at most kMaxBytes), highlighting
+     * the layers of @p dissection (nullptr: no highlighting). Scrolls to the
+     * top and drops the search match.
+     */
+    void setFrame(const std::uint8_t* data, std::size_t size, const FrameDescriptor* dissection);
+
+    /** @brief Row width and rows on screen; keeps the first visible byte on screen. */
+    void setGeometry(int bytesPerRow, int visibleRows);
+
+    std::size_t size() const { return bytes.size(); }
+    bool truncated() const { return frameSize > bytes.size(); }
+    /** @brief Size of the frame given to setFrame() (larger than size() if truncated). */
+    std::size_t originalSize() const { return frameSize; }
+
+    int bytesPerRow() const { return rowBytes; }
+    int visibleRows() const { return screenRows; }
+    std::size_t rowCount() const;
+    std::size_t topRow() const { return top; }
+
+    /** @brief Column of the ASCII part in every row. */
+    int asciiColumn() const { return 5 + rowBytes * 3 + 1; }
+
+    /** @brief Scroll so that @p row is the first one shown (clamped). */
+    void scrollTo(std::size_t row);
+    void scrollBy(long rows);
+
+    /** @brief Scroll so that byte @p offset is on screen; false if it is past the end. */
+    bool jumpTo(std::size_t offset);
+
+    /**
+     * @brief Select the next occurrence of @p needle after the current match
+     * (from the start if none, wrapping around) and scroll to it.
+     * @return false if it does not occur (the previous match is dropped).
+     */
+    bool find(const std::vector<std::uint8_t>& needle);
+
+    bool hasMatch() const { return matchLength > 0; }
+    std::size_t matchOffset() const { return matchStart; }
+
+    /** @brief Row @p index (< rowCount()), formatted on first use. */
+    const HexRow& row(std::size_t index);
+
+    /**
+     * @brief Search bytes for a query: "de ad be ef" / "dead:beef" (hex
+     * digits, even count) or text; text in double quotes is always text.
+     */
+    static std::vector<std::uint8_t> parseQuery(std::string_view query);
+
+private:
+    void formatRow(std::size_t index, HexRow& out) const;
+    void dropRows(std::size_t fromByte, std::size_t length);
+    std::size_t maxTop() const;
+
+    std::vector<std::uint8_t> bytes;
+    std::vector<HexStyle> styles;  // Per byte, from the dissection
+    std::vector<HexRow> rows;      // Cache; empty text = not formatted yet
+    std::size_t frameSize = 0;
+    int rowBytes = 16;
+    int screenRows = 1;
+    std::size_t top = 0;
+    std::size_t matchStart = 0;
+    std::size_t matchLength = 0;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+#include "ipv4.h"
+#include "rate_counter.h"
+
+/**
+ * @brief ICMPv4 types handled by the responder.
+ */
+namespace IcmpType {
+static constexpr std::uint8_t EchoReply = 0;
+static constexpr std::uint8_t EchoRequest = 8;
+}  // namespace IcmpType
+
+#pragma pack(push, 1)
+struct IcmpEchoHeader {
+    std::uint8_t type;
+    std::uint8_t code;
+    std::uint16_t checksum;
+    std::uint16_t identifier;
+    std::uint16_t sequence;
+};
+#pragma pack(pop)
+
+struct IcmpStats {
+    std::uint64_t rxMessages = 0;
+    std::uint64_t echoRequests = 0;
+    std::uint64_t echoReplies = 0;   // Replies written to the TAP
+    std::uint64_t checksumErrors = 0;
+    std::uint64_t malformed = 0;
+    std::uint64_t ignored = 0;       // Other types, broadcast echo
+    std::uint64_t txErrors = 0;
+};
+
+/**
+ * @brief ICMP echo responder on the IPv4 receive path.
+ *
+ * The request is turned into the reply inside the received buffer: MACs and
+ * IPs are swapped (which leaves the IP checksum unchanged), TTL is reset and
+ * the type changes 8 -> 0, with both checksums patched incrementally
+ * (RFC 1624) instead of recomputed, and the frame goes straight back out
+ * through Ipv4Layer::send(). Reassembled requests are re-fragmented on the
+ * way out via Ipv4Layer::output().
+ *
+ * Registers itself as the ICMP handler of @p ipv4, so it must outlive it (and
+ * is neither copyable nor movable).
+ */
+class IcmpEchoResponder {
+public:
+    explicit IcmpEchoResponder(Ipv4Layer& ipv4);
+    IcmpEchoResponder(const IcmpEchoResponder&) = delete;
+    IcmpEchoResponder& operator=(const IcmpEchoResponder&) = delete;
+
+    /** @brief Verify the request checksum before answering (default on). */
+    void setVerifyChecksum(bool enabled) { verifyChecksum = enabled; }
+
+    void handle(Ipv4Packet& packet);
+
+    const IcmpStats& stats() const { return counters; }
+
+    /** @brief Replies sent during the last complete second. */
+    std::uint64_t repliesPerSecond(RateCounter::Clock::time_point now) { return replyRate.perSecond(now); }
+    /** @brief Requests received during the last complete second. */
+    std::uint64_t requestsPerSecond(RateCounter::Clock::time_point now) { return requestRate.perSecond(now); }
+
+private:
+    Ipv4Layer& ipv4;
+    IcmpStats counters;
+    RateCounter replyRate;
+    RateCounter requestRate;
+    bool verifyChecksum = true;
+};
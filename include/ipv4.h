@@ -0,0 +1,320 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "arp.h"
+#include "ethernet.h"
+#include "packet_buffer.h"
+
+/**
+ * @brief IP protocol numbers used by the stack.
+ */
+namespace IpProto {
+static constexpr std::uint8_t ICMP = 1;
+static constexpr std::uint8_t TCP = 6;
+static constexpr std::uint8_t UDP = 17;
+static constexpr std::uint8_t ICMPv6 = 58;
+}  // namespace IpProto
+
+#pragma pack(push, 1)
+/**
+ * @brief IPv4 header without options (RFC 791). Multi-byte fields are big-endian.
+ */
+struct Ipv4Header {
+    std::uint8_t versionIhl;      // version (4) << 4 | header length in 32-bit words
+    std::uint8_t tos;
+    std::uint16_t totalLength;    // header + payload
+    std::uint16_t identification;
+    std::uint16_t flagsFragment;  // flags (3 bits) | fragment offset in 8-byte units
+    std::uint8_t ttl;
+    std::uint8_t protocol;
+    std::uint16_t checksum;
+    std::uint8_t src[4];
+    std::uint8_t dst[4];
+};
+#pragma pack(pop)
+
+static constexpr std::size_t kIpv4HeaderSize = sizeof(Ipv4Header);
+/** @brief Offset of the L4 payload in a frame built for Ipv4Layer::output(). */
+static constexpr std::size_t kIpv4PayloadOffset = EthernetII::HeaderSize + kIpv4HeaderSize;
+static constexpr std::size_t kIpv4MaxDatagram = 65535;
+static constexpr std::uint16_t kIpv4FlagMoreFragments = 0x2000;
+static constexpr std::uint16_t kIpv4FlagDontFragment = 0x4000;
+static constexpr std::uint16_t kIpv4OffsetMask = 0x1FFF;
+
+/**
+ * @brief Validated view of an IPv4 datagram inside a writable frame buffer.
+ *
+ * Nothing is copied: handlers read (and may rewrite, for in-place replies) the
+ * bytes behind @c frame. For reassembled datagrams @c frame points into the
+ * reassembly memory and is only valid during the handler call.
+ */
+struct Ipv4Packet {
+    std::uint8_t* frame = nullptr;  // Start of the Ethernet header
+    std::size_t frameSize = 0;      // Ethernet header + IP total length (link padding trimmed)
+    std::size_t capacity = 0;       // Writable bytes starting at frame
+    std::size_t l3Offset = EthernetII::HeaderSize;
+    std::size_t headerSize = 0;     // IHL * 4
+    std::size_t payloadSize = 0;    // Total length - header
+    Ipv4Address src{};
+    Ipv4Address dst{};
+    std::uint8_t protocol = 0;
+    std::uint8_t ttl = 0;
+    std::uint16_t identification = 0;
+    std::uint16_t flagsFragment = 0;  // Host order
+    bool reassembled = false;
+    std::chrono::steady_clock::time_point rxTime{};  // Set by Ipv4Layer::input
+    PacketBuffer* buffer = nullptr;  // Pooled RX buffer holding frame (handlers may retain it), or nullptr
+
+    std::uint8_t* header() const { return frame + l3Offset; }
+    std::uint8_t* payload() const { return frame + l3Offset + headerSize; }
+    bool isFragment() const { return (flagsFragment & (kIpv4FlagMoreFragments | kIpv4OffsetMask)) != 0; }
+    std::size_t fragmentOffset() const { return static_cast<std::size_t>(flagsFragment & kIpv4OffsetMask) * 8; }
+};
+
+/**
+ * @brief Result of IPv4 header validation.
+ */
+enum class Ipv4Status {
+    Ok,
+    TooShort,         // Buffer smaller than a minimal header
+    BadVersion,       // Version != 4
+    BadHeaderLength,  // IHL < 5 or header beyond the buffer
+    BadTotalLength,   // Total length < header or beyond the buffer
+    BadChecksum,
+    BadAddress,       // Multicast/broadcast source
+    BadFragment       // Fragment extends past 65535 bytes
+};
+
+/**
+ * @brief Validate an IPv4 header located at `frame + l3Offset`.
+ *
+ * Fills @p out with a view of the datagram on success. The checksum check for
+ * the common 20-byte header is specialised (five 32-bit loads).
+ */
+Ipv4Status parseIpv4(std::uint8_t* frame, std::size_t size, std::size_t capacity,
+                     std::size_t l3Offset, Ipv4Packet& out);
+
+/**
+ * @brief Write a 20-byte IPv4 header (no options) with its checksum at @p out.
+ */
+void writeIpv4Header(std::uint8_t* out,
+                     const Ipv4Address& src,
+                     const Ipv4Address& dst,
+                     std::uint8_t protocol,
+                     std::uint16_t totalLength,
+                     std::uint16_t identification,
+                     std::uint16_t flagsFragment,
+                     std::uint8_t ttl);
+
+/**
+ * @brief Dotted-decimal text ("a.b.c.d") for logs and UI.
+ */
+std::string ipv4ToString(const Ipv4Address& ip);
+
+/**
+ * @brief Limits for fragment reassembly.
+ *
+ * All reassembly memory is allocated once from @c memoryBudget: each slot
+ * holds one datagram of up to 64 KB plus its block bitmap, so the number of
+ * datagrams in flight is budget / slot size (at least one).
+ */
+struct Ipv4ReassemblyConfig {
+    std::size_t memoryBudget = 2u * 1024u * 1024u;
+    std::size_t maxFragmentsPerDatagram = 64;
+    std::size_t maxDatagramsPerSource = 4;  // Flood protection: one source can't take every slot
+    std::chrono::milliseconds timeout{30000};
+};
+
+struct Ipv4ReassemblyStats {
+    std::uint64_t fragments = 0;
+    std::uint64_t reassembled = 0;
+    std::uint64_t timeouts = 0;
+    std::uint64_t evicted = 0;           // Oldest datagram dropped to make room
+    std::uint64_t overlaps = 0;          // Overlapping/duplicate fragments (datagram dropped)
+    std::uint64_t malformed = 0;         // Bad sizes/offsets (datagram dropped)
+    std::uint64_t tooManyFragments = 0;
+    std::uint64_t sourceLimited = 0;     // Rejected by maxDatagramsPerSource
+};
+
+/**
+ * @brief Fragment reassembly with a fixed memory budget (RFC 791 / RFC 815).
+ *
+ * Received 8-byte blocks are tracked in a bitmap per datagram; any overlap
+ * drops the whole datagram (RFC 5722 behaviour, avoids overlap attacks). Each
+ * datagram has a hard deadline from its first fragment that is never
+ * extended, so a slow trickle of fragments can't pin a slot.
+ */
+class Ipv4Reassembler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit Ipv4Reassembler(const Ipv4ReassemblyConfig& config = {});
+
+    /**
+     * @brief Add one fragment.
+     * @return The complete datagram (Ethernet + rebuilt 20-byte header +
+     *         payload) once every fragment is in. Call release() after use.
+     */
+    std::optional<Ipv4Packet> add(const Ipv4Packet& fragment, Clock::time_point now);
+
+    /** @brief Free the slot of a datagram returned by add(). */
+    void release(const Ipv4Packet& datagram);
+
+    /** @brief Drop datagrams past their deadline. @return Number dropped. */
+    std::size_t expire(Clock::time_point now);
+
+    std::size_t slotCount() const { return slots.size(); }
+    std::size_t inFlight() const;
+    const Ipv4ReassemblyStats& stats() const { return counters; }
+
+private:
+    struct Slot {
+        bool inUse = false;
+        bool complete = false;
+        Ipv4Address src{};
+        Ipv4Address dst{};
+        std::uint16_t identification = 0;
+        std::uint8_t protocol = 0;
+        Clock::time_point created{};
+        Clock::time_point deadline{};
+        std::size_t received = 0;   // Payload bytes stored
+        std::size_t totalSize = 0;  // Known once the last fragment arrives
+        std::size_t highest = 0;    // Highest payload end seen
+        std::size_t fragments = 0;
+        std::array<std::uint64_t, (kIpv4MaxDatagram / 8 + 64) / 64> blocks{};
+    };
+
+    Slot* findOrCreate(const Ipv4Packet& fragment, Clock::time_point now);
+    void drop(Slot& slot);
+    std::uint8_t* slotData(std::size_t index) { return arena.data() + index * slotStride; }
+
+    Ipv4ReassemblyConfig config;
+    Ipv4ReassemblyStats counters;
+    std::size_t slotStride = 0;
+    std::vector<std::uint8_t> arena;
+    std::vector<Slot> slots;
+};
+
+/** @brief Handler for one IP protocol; may rewrite the packet in place. */
+using Ipv4Handler = std::function<void(Ipv4Packet& packet)>;
+
+/** @brief Sink for finished frames (normally TapDevice::write). */
+using FrameSender = std::function<int(const std::uint8_t* frame, std::size_t size)>;
+
+/** @brief Next-hop MAC lookup (normally the ARP table); nullopt if unresolved. */
+using NeighborResolver = std::function<std::optional<MacAddress>(const Ipv4Address& ip)>;
+
+struct Ipv4Stats {
+    std::uint64_t rxPackets = 0;
+    std::uint64_t rxBytes = 0;
+    std::uint64_t rxDelivered = 0;
+    std::uint64_t rxHeaderErrors = 0;
+    std::uint64_t rxChecksumErrors = 0;
+    std::uint64_t rxNotLocal = 0;
+    std::uint64_t rxNoProtocol = 0;
+    std::uint64_t txPackets = 0;
+    std::uint64_t txFragments = 0;
+    std::uint64_t txErrors = 0;
+    std::uint64_t txNoRoute = 0;  // Destination MAC not resolved
+};
+
+/**
+ * @brief Where an outgoing datagram goes (link and network addresses).
+ */
+struct Ipv4Route {
+    MacAddress srcMac{};
+    MacAddress dstMac{};
+    Ipv4Address src{};
+    Ipv4Address dst{};
+};
+
+/**
+ * @brief IPv4 input/output: validation, local demultiplexing, reassembly and
+ * (fragmenting) transmission.
+ */
+class Ipv4Layer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit Ipv4Layer(const Ipv4ReassemblyConfig& reassembly = {});
+
+    void addLocalAddress(const Ipv4Address& ip);
+    bool isLocal(const Ipv4Address& ip) const;
+    const std::vector<Ipv4Address>& localAddresses() const { return locals; }
+
+    void setHandler(std::uint8_t protocol, Ipv4Handler handler);
+    void setSender(FrameSender sender) { sendFrame = std::move(sender); }
+    void setNeighborResolver(NeighborResolver resolver) { resolveNeighbor = std::move(resolver); }
+    void setLinkAddress(const MacAddress& mac) { linkAddress = mac; }
+    const MacAddress& link() const { return linkAddress; }
+    void setMtu(std::size_t value) { mtu = value; }
+
+    /**
+     * @brief Process one received frame whose L3 header starts at @p l3Offset.
+     * @return true if the datagram was delivered to (or queued for) a handler.
+     */
+    bool input(std::uint8_t* frame, std::size_t size, std::size_t capacity,
+               Clock::time_point now, std::size_t l3Offset = EthernetII::HeaderSize);
+
+    /**
+     * @brief input() for a frame in a pooled buffer (data() is the Ethernet
+     * header). Handlers see it in Ipv4Packet::buffer and may keep a reference
+     * (e.g. TCP out-of-order queues) instead of copying the payload.
+     */
+    bool input(PacketBuffer& buffer, Clock::time_point now, std::size_t l3Offset = EthernetII::HeaderSize);
+
+    /**
+     * @brief Prepend Ethernet + IPv4 headers and transmit.
+     *
+     * The payload must already sit at `frame + kIpv4PayloadOffset`; the bytes
+     * in front of it are overwritten. Datagrams larger than the MTU are sent
+     * as fragments. @return Bytes handed to the sender, or -1 on error.
+     */
+    int output(std::uint8_t* frame, std::size_t payloadSize, std::size_t capacity,
+               const Ipv4Route& route, std::uint8_t protocol, std::uint8_t ttl = 64);
+
+    /**
+     * @brief Same as output() for a pooled buffer whose data() is the L4
+     * segment: the Ethernet and IPv4 headers are prepended in its headroom.
+     */
+    int output(PacketBuffer& packet, const Ipv4Route& route, std::uint8_t protocol, std::uint8_t ttl = 64);
+
+    /**
+     * @brief Route to @p dst from our first local address, resolving the
+     * next-hop MAC through the neighbor resolver. nullopt if unresolved.
+     */
+    std::optional<Ipv4Route> route(const Ipv4Address& dst);
+
+    /** @brief Transmit a finished frame (used by in-place responders). */
+    int send(const std::uint8_t* frame, std::size_t size);
+
+    /** @brief Age out incomplete datagrams. @return Number dropped. */
+    std::size_t expire(Clock::time_point now) { return reassembler.expire(now); }
+
+    const Ipv4Stats& stats() const { return counters; }
+    const Ipv4Reassembler& reassembly() const { return reassembler; }
+
+private:
+    bool deliver(Ipv4Packet& packet);
+    bool receive(std::uint8_t* frame, std::size_t size, std::size_t capacity,
+                 Clock::time_point now, std::size_t l3Offset, PacketBuffer* buffer);
+
+    std::vector<Ipv4Address> locals;
+    std::array<Ipv4Handler, 256> handlers{};
+    FrameSender sendFrame;
+    NeighborResolver resolveNeighbor;
+    MacAddress linkAddress{};
+    Ipv4Reassembler reassembler;
+    Ipv4Stats counters;
+    std::size_t mtu = 1500;
+    std::uint16_t nextId = 1;
+    std::vector<std::uint8_t> fragmentScratch;
+};
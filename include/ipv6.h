@@ -0,0 +1,213 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "ethernet.h"
+#include "ipv4.h"
+#include "packet_buffer.h"
+
+/**
+ * @brief 16-byte IPv6 address in wire order.
+ */
+using Ipv6Address = std::array<std::uint8_t, 16>;
+
+#pragma pack(push, 1)
+/**
+ * @brief Fixed IPv6 header (RFC 8200). Multi-byte fields are big-endian.
+ */
+struct Ipv6Header {
+    std::uint32_t versionClassFlow;  // version (6) << 28 | traffic class << 20 | flow label
+    std::uint16_t payloadLength;     // Bytes after this header
+    std::uint8_t nextHeader;
+    std::uint8_t hopLimit;
+    std::uint8_t src[16];
+    std::uint8_t dst[16];
+};
+#pragma pack(pop)
+
+static constexpr std::size_t kIpv6HeaderSize = sizeof(Ipv6Header);
+/** @brief Offset of the upper-layer payload in an untagged frame. */
+static constexpr std::size_t kIpv6PayloadOffset = EthernetII::HeaderSize + kIpv6HeaderSize;
+
+/**
+ * @brief Validated view of an IPv6 packet inside a writable frame buffer.
+ *
+ * Same contract as Ipv4Packet: handlers read (and may rewrite in place) the
+ * bytes behind @c frame. Extension headers are not walked; @c nextHeader is
+ * the value from the fixed header.
+ */
+struct Ipv6Packet {
+    std::uint8_t* frame = nullptr;  // Start of the Ethernet header
+    std::size_t frameSize = 0;      // Ethernet header + 40 + payload length (link padding trimmed)
+    std::size_t capacity = 0;       // Writable bytes starting at frame
+    std::size_t l3Offset = EthernetII::HeaderSize;
+    std::size_t payloadSize = 0;
+    Ipv6Address src{};
+    Ipv6Address dst{};
+    std::uint8_t nextHeader = 0;
+    std::uint8_t hopLimit = 0;
+    std::chrono::steady_clock::time_point rxTime{};  // Set by Ipv6Layer::input
+    PacketBuffer* buffer = nullptr;  // Pooled RX buffer holding frame, or nullptr
+
+    std::uint8_t* header() const { return frame + l3Offset; }
+    std::uint8_t* payload() const { return frame + l3Offset + kIpv6HeaderSize; }
+};
+
+/**
+ * @brief Result of IPv6 header validation.
+ */
+enum class Ipv6Status {
+    Ok,
+    TooShort,          // Buffer smaller than the fixed header
+    BadVersion,        // Version != 6
+    BadPayloadLength,  // Payload beyond the buffer
+    BadAddress         // Multicast source
+};
+
+/**
+ * @brief Validate an IPv6 header located at `frame + l3Offset`.
+ */
+Ipv6Status parseIpv6(std::uint8_t* frame, std::size_t size, std::size_t capacity,
+                     std::size_t l3Offset, Ipv6Packet& out);
+
+/**
+ * @brief Write a 40-byte IPv6 header (traffic class and flow label 0) at @p out.
+ */
+void writeIpv6Header(std::uint8_t* out,
+                     const Ipv6Address& src,
+                     const Ipv6Address& dst,
+                     std::uint8_t nextHeader,
+                     std::uint16_t payloadLength,
+                     std::uint8_t hopLimit);
+
+/**
+ * @brief RFC 5952 text ("fe80::1", "ff02::1:ff00:1") for logs and UI.
+ */
+std::string ipv6ToString(const Ipv6Address& ip);
+
+inline bool ipv6IsMulticast(const Ipv6Address& ip) { return ip[0] == 0xff; }
+
+inline bool ipv6IsUnspecified(const Ipv6Address& ip)
+{
+    for (std::uint8_t b : ip)
+    {
+        if (b != 0) return false;
+    }
+    return true;
+}
+
+/** @brief ff02::1, joined by every node. */
+static constexpr Ipv6Address kIpv6AllNodes{0xff, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01};
+
+/**
+ * @brief Solicited-node group of @p ip (ff02::1:ffXX:XXXX, RFC 4291 2.7.1).
+ */
+Ipv6Address ipv6SolicitedNode(const Ipv6Address& ip);
+
+/**
+ * @brief Link-layer group of a multicast address: 33:33 + its low 32 bits (RFC 2464 7).
+ */
+MacAddress ipv6MulticastMac(const Ipv6Address& group);
+
+/**
+ * @brief fe80::/64 address with the modified EUI-64 interface ID of @p mac (RFC 4291 App. A).
+ */
+Ipv6Address ipv6LinkLocal(const MacAddress& mac);
+
+/** @brief Handler for one next-header value; may rewrite the packet in place. */
+using Ipv6Handler = std::function<void(Ipv6Packet& packet)>;
+
+/** @brief Told when a group gets its first reference (@p joined) or loses its last one. */
+using Ipv6GroupListener = std::function<void(const Ipv6Address& group, bool joined)>;
+
+struct Ipv6Stats {
+    std::uint64_t rxPackets = 0;
+    std::uint64_t rxBytes = 0;
+    std::uint64_t rxDelivered = 0;
+    std::uint64_t rxHeaderErrors = 0;
+    std::uint64_t rxLinkFiltered = 0;   // Destination MAC is not ours nor a joined group
+    std::uint64_t rxNotLocal = 0;       // Destination address is not ours nor a joined group
+    std::uint64_t rxNoNextHeader = 0;
+    std::uint64_t txPackets = 0;
+    std::uint64_t txErrors = 0;
+};
+
+/**
+ * @brief IPv6 input path: validation, multicast filtering and next-header demux.
+ *
+ * Multicast acceptance follows what a NIC plus the kernel do: a frame sent to
+ * 33:33:xx:xx:xx:xx is only looked at when its low 32 bits match a joined
+ * group, and the destination address must then be one of the joined groups.
+ * Each local address joins its solicited-node group (reference counted, two
+ * addresses can share one) and ff02::1 is always joined, so unrelated
+ * multicast such as mDNS (ff02::fb) is dropped before any handler runs.
+ */
+class Ipv6Layer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    Ipv6Layer();
+
+    /** @brief Add a unicast address and join its solicited-node group. */
+    void addLocalAddress(const Ipv6Address& ip);
+    bool isLocal(const Ipv6Address& ip) const;
+    const std::vector<Ipv6Address>& localAddresses() const { return locals; }
+
+    /** @brief Join/leave a multicast group (reference counted). */
+    void joinGroup(const Ipv6Address& group);
+    void leaveGroup(const Ipv6Address& group);
+    bool isMember(const Ipv6Address& group) const;
+
+    /**
+     * @brief Follow membership changes (e.g. to program a link-layer filter).
+     * Groups joined so far are replayed as joins.
+     */
+    void setGroupListener(Ipv6GroupListener listener);
+
+    /** @brief Link-layer filter: our MAC or the 33:33 MAC of a joined group (broadcast is not IPv6). */
+    bool acceptsLinkDestination(const std::uint8_t* mac) const;
+
+    void setHandler(std::uint8_t nextHeader, Ipv6Handler handler);
+    void setSender(FrameSender sender) { sendFrame = std::move(sender); }
+    void setLinkAddress(const MacAddress& mac) { linkAddress = mac; }
+    const MacAddress& link() const { return linkAddress; }
+
+    /**
+     * @brief Process one received frame whose L3 header starts at @p l3Offset.
+     * @return true if the packet was delivered to a handler.
+     */
+    bool input(std::uint8_t* frame, std::size_t size, std::size_t capacity,
+               Clock::time_point now, std::size_t l3Offset = EthernetII::HeaderSize);
+
+    /** @brief input() for a frame in a pooled buffer (exposed as Ipv6Packet::buffer). */
+    bool input(PacketBuffer& buffer, Clock::time_point now, std::size_t l3Offset = EthernetII::HeaderSize);
+
+    /** @brief Transmit a finished frame (used by in-place responders). */
+    int send(const std::uint8_t* frame, std::size_t size);
+
+    const Ipv6Stats& stats() const { return counters; }
+
+private:
+    struct Group {
+        Ipv6Address address{};
+        std::uint32_t low32 = 0;  // Last 4 bytes, compared against the MAC
+        std::uint32_t refs = 0;
+    };
+
+    bool receive(std::uint8_t* frame, std::size_t size, std::size_t capacity,
+                 Clock::time_point now, std::size_t l3Offset, PacketBuffer* buffer);
+
+    std::vector<Ipv6Address> locals;
+    std::vector<Group> groups;  // A handful of entries: a linear scan beats hashing
+    std::array<Ipv6Handler, 256> handlers{};
+    FrameSender sendFrame;
+    Ipv6GroupListener groupListener;
+    MacAddress linkAddress{};
+    Ipv6Stats counters;
+};
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define NETGUI_LATENCY_TSC 1
+#endif
+
+/**
+ * @brief Timestamp source for per-frame instrumentation.
+ *
+ * now() is the TSC where there is one (a few cycles, no syscall; the kernel
+ * only uses it as clocksource when it is invariant) and the vDSO monotonic
+ * clock elsewhere. Ticks become nanoseconds through a 32.32 fixed-point
+ * factor calibrated against steady_clock on first use.
+ */
+struct LatencyClock {
+    static std::uint64_t now()
+    {
+#if NETGUI_LATENCY_TSC
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    /** @brief Ticks between two now() readings in nanoseconds (0 if @p end precedes @p start). */
+    static std::uint64_t nanoseconds(std::uint64_t start, std::uint64_t end);
+};
+
+/**
+ * @brief Merged view of a LatencyHistogram (see LatencyHistogram::snapshot()).
+ */
+struct LatencySnapshot {
+    std::vector<std::uint64_t> buckets;
+    std::uint64_t count = 0;
+    std::uint64_t sum = 0;  // Nanoseconds
+    std::uint64_t max = 0;
+
+    /**
+     * @brief Value at quantile @p q (0..1): the upper bound of the bucket
+     * holding it, capped at max. 0 if empty.
+     */
+    std::uint64_t percentile(double q) const;
+
+    /** @brief Samples recorded at or below @p ns (bucket resolution). */
+    std::uint64_t countAtOrBelow(std::uint64_t ns) const;
+};
+
+/**
+ * @brief HDR-style log-linear latency histogram in nanoseconds.
+ *
+ * Values below 2 * SubBuckets are counted exactly; above, each power of two
+ * is split into SubBuckets linear buckets, so any recorded value is known to
+ * within 1/SubBuckets (about 3%) up to 2^MaxExponent ns (~18 min, larger
+ * values land in the top bucket).
+ *
+ * Each recording thread gets its own shard, allocated on its first record();
+ * a shard has a single writer, so counting is a relaxed load and store (no
+ * locked instruction) and snapshot() merges all shards from any thread.
+ * Past MaxThreads threads, shards are shared and concurrent increments can
+ * be lost (never torn).
+ */
+class LatencyHistogram {
+public:
+    static constexpr unsigned SubBucketBits = 5;
+    static constexpr std::size_t SubBuckets = std::size_t{1} << SubBucketBits;
+    static constexpr unsigned MaxExponent = 40;
+    static constexpr std::size_t BucketCount = (MaxExponent - SubBucketBits + 1) * SubBuckets;
+    static constexpr std::size_t MaxThreads = 16;
+
+    LatencyHistogram() = default;
+    ~LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(std::uint64_t ns);
+
+    /** @brief record() of the time between two LatencyClock::now() readings. */
+    void recordTicks(std::uint64_t start, std::uint64_t end) { record(LatencyClock::nanoseconds(start, end)); }
+
+    LatencySnapshot snapshot() const;
+
+    static std::size_t bucketIndex(std::uint64_t ns);
+    /** @brief Largest value that falls in bucket @p index. */
+    static std::uint64_t bucketUpperBound(std::size_t index);
+
+private:
+    struct Shard {
+        std::array<std::atomic<std::uint64_t>, BucketCount> counts{};
+        std::atomic<std::uint64_t> sum{0};
+        std::atomic<std::uint64_t> max{0};
+    };
+
+    Shard& shard();
+
+    std::array<std::atomic<Shard*>, MaxThreads> shards{};
+};
+
+/**
+ * @brief Timed stages of one frame: tap.read -> dissect -> handler -> tap.write.
+ */
+enum class PipelineStage : std::uint8_t {
+    Dissect,  // tap.read returned -> descriptor filled
+    Handle,   // Descriptor filled -> protocol handlers and UI bookkeeping done
+    Write,    // tap.write call
+    RxToTx    // tap.read returned -> reply written (frames answered while being handled)
+};
+
+static constexpr std::size_t kPipelineStages = 4;
+
+const char* pipelineStageName(PipelineStage stage);
+
+/**
+ * @brief One histogram per PipelineStage.
+ */
+class PipelineLatency {
+public:
+    LatencyHistogram& operator[](PipelineStage stage) { return stages[static_cast<std::size_t>(stage)]; }
+    const LatencyHistogram& operator[](PipelineStage stage) const { return stages[static_cast<std::size_t>(stage)]; }
+
+    void record(PipelineStage stage, std::uint64_t startTicks, std::uint64_t endTicks)
+    {
+        (*this)[stage].recordTicks(startTicks, endTicks);
+    }
+
+private:
+    std::array<LatencyHistogram, kPipelineStages> stages;
+};
+
+/**
+ * @brief One line per stage: samples, p50, p99, p99.9 and max.
+ */
+std::vector<std::string> formatPipelineLatency(const PipelineLatency& latency);
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Tag at the start of a log line ("[RX] ..."), stored apart from the
+ * body so the view can colour it and indent continuation rows.
+ */
+enum class LogTag : std::uint8_t { None, Rx, Tx, Info, Warn };
+
+struct EventRecord;  // event_log.h
+
+/** @brief "[RX]", "[TX]", "[INFO]", "[WARN]", or "" for None. */
+const char* logTagText(LogTag tag);
+
+/**
+ * @brief One screen row of a wrapped log line.
+ */
+struct LogRow {
+    std::string_view text;  // Slice of the body, valid until the next push() or rows()
+    LogTag tag = LogTag::None;
+    bool firstRow = false;  // Row that starts with the tag; the rest are indented by its width
+    bool isArp = false;     // Line mentions ARP (marked in the gutter)
+};
+
+/**
+ * @brief Fixed-capacity log for the TUI, wrapped to the window width.
+ *
+ * The newest lines live in a RAM ring together with their wrapped layout,
+ * computed when the line is pushed and redone only when the width changes.
+ * With enableSpill(), lines leaving the RAM ring are appended to a
+ * memory-mapped file (fixed-size index + text ring) instead of being dropped,
+ * so up to capacity() lines stay reachable by scrolling while the kernel is
+ * free to write the cold pages back to disk.
+ *
+ * Lines can also be EventRecords (pushEvent()): they are stored as the
+ * fixed-size record, take exactly one row (no wrapping, the view clips them)
+ * and are only turned into text by rows() when they are on screen.
+ *
+ * Each line records how many rows precede it, so rows() finds the first
+ * visible line with a binary search however far back the view is scrolled,
+ * and only the visible lines are touched.
+ *
+ * Single-threaded (the UI loop).
+ */
+class LogRing {
+public:
+    explicit LogRing(std::size_t memoryLines = 4096);
+    ~LogRing();
+
+    LogRing(const LogRing&) = delete;
+    LogRing& operator=(const LogRing&) = delete;
+
+    /**
+     * @brief Keep up to @p capacity lines in total, those that do not fit in
+     * RAM in an unlinked temporary file under @p directory. Lines already
+     * spilled by a previous call are dropped.
+     * @return false with @p error set (the log keeps working in RAM only).
+     */
+    bool enableSpill(std::size_t capacity, const std::filesystem::path& directory, std::string& error);
+
+    /** @brief Append a line; the oldest one is spilled or dropped when full. */
+    void push(std::string_view line);
+
+    /** @brief Append an event, formatted lazily; a copy of the record and no text. */
+    void pushEvent(const EventRecord& event);
+
+    /** @brief Lines that can still be scrolled to. */
+    std::size_t size() const { return static_cast<std::size_t>(nextSeq - firstSeq); }
+    std::size_t capacity() const { return memoryCapacity + spillSlots; }
+    bool spilling() const { return spillBase != nullptr; }
+
+    /** @brief Lines pushed so far: changes whenever the log does (redraw check). */
+    std::uint64_t pushed() const { return nextSeq; }
+
+    /** @brief Rows of the whole log wrapped to @p width (re-wraps it if the width changed). */
+    std::uint64_t totalRows(int width);
+
+    /**
+     * @brief Rows [@p first, @p first + @p count) of the log wrapped to
+     * @p width, oldest first, into @p out (cleared first).
+     */
+    void rows(int width, std::uint64_t first, std::size_t count, std::vector<LogRow>& out);
+
+private:
+    struct Span {
+        std::uint32_t offset;
+        std::uint32_t length;
+    };
+
+    struct Line {
+        std::string body;
+        std::vector<Span> spans;  // Layout at layoutWidth (empty body: no spans, one row)
+        std::uint64_t rowsBefore = 0;
+        LogTag tag = LogTag::None;
+        bool isArp = false;
+        bool isEvent = false;  // Record in events[slot], body unused
+    };
+
+    struct SpillEntry;
+
+    void relayout(int width);
+    void wrapLine(std::string_view body, LogTag tag, std::vector<Span>& out) const;
+    Line& claimSlot();
+    void spill(std::uint64_t seq, const Line& line, const EventRecord& event);
+    void unmapSpill();
+
+    bool inMemory(std::uint64_t seq) const { return nextSeq - seq <= memoryCount; }
+    std::uint64_t rowsBefore(std::uint64_t seq) const;
+    std::string_view spilledBody(std::uint64_t seq) const;
+
+    std::vector<Line> lines;  // RAM ring, slot = seq % memoryCapacity
+    std::vector<EventRecord> events;  // Same slots, for event lines
+    std::size_t memoryCapacity;
+    std::size_t memoryCount = 0;
+    std::uint64_t firstSeq = 0;  // Oldest reachable line
+    std::uint64_t nextSeq = 0;
+    std::uint64_t rowsEnd = 0;   // rowsBefore() of the next line
+    int layoutWidth = -1;        // Width the stored layout was computed for
+
+    // Spill file: spillSlots index entries, then spillBytes of text written
+    // as a ring at increasing logical positions.
+    std::uint8_t* spillBase = nullptr;
+    std::size_t spillMapped = 0;
+    std::size_t spillSlots = 0;
+    std::uint64_t spillBytes = 0;
+    std::uint64_t spillWritePos = 0;
+
+    std::vector<Span> scratch;  // Layout of spilled lines being read
+    // Text of event lines already drawn, slot = seq % size (at least one
+    // window): a line stays formatted while it is on screen.
+    struct FormattedEvent {
+        std::uint64_t seq = ~std::uint64_t{0};
+        std::string text;
+    };
+    std::vector<FormattedEvent> formatted;
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ethernet.h"
+
+struct MacFilterStats {
+    std::uint64_t accepted = 0;
+    std::uint64_t rejectedRunt = 0;       // Shorter than an Ethernet header
+    std::uint64_t rejectedUnicast = 0;    // Unicast not in the exact list
+    std::uint64_t rejectedBroadcast = 0;  // Broadcast while it is not accepted
+    std::uint64_t rejectedHash = 0;       // Multicast whose hash bit is clear (the kernel drops these too)
+    std::uint64_t rejectedGroup = 0;      // Hash hit but not a joined group (leaks past the kernel filter)
+};
+
+/**
+ * @brief Destination-MAC acceptance filter: exact unicast addresses,
+ * broadcast and a set of multicast groups.
+ *
+ * Mirrors the TAP driver's TX filter (TUNSETTXFILTER) so the same rules can
+ * run in the kernel and on the fast path: the kernel compares the first
+ * KernelExactSlots addresses exactly and hashes the remaining multicast ones
+ * into a 64-bit mask (CRC-32 of the address, top 6 bits), which lets some
+ * foreign groups through. Here multicast first tests the same mask, then an
+ * exact open-addressing set, so the userspace verdict is always exact and
+ * the counters show what each stage threw away.
+ *
+ * Groups are reference counted (two IPv6 addresses can share a
+ * solicited-node group). Every change bumps generation() so the owner knows
+ * when to reprogram the kernel from kernelAddresses().
+ */
+class MacFilter {
+public:
+    static constexpr std::size_t KernelExactSlots = 8;  // FLT_EXACT_COUNT in drivers/net/tun.c
+
+    MacFilter();
+
+    /** @brief Accept frames sent to @p mac (unicast only). @return false if it is multicast. */
+    bool addUnicast(const MacAddress& mac);
+    void removeUnicast(const MacAddress& mac);
+
+    /** @brief Join/leave a multicast group (reference counted). @return false if @p group is not multicast. */
+    bool join(const MacAddress& group);
+    void leave(const MacAddress& group);
+    bool isMember(const MacAddress& group) const;
+
+    void setAcceptBroadcast(bool accept);
+    bool acceptsBroadcast() const { return broadcast; }
+
+    /** @brief Accept every multicast frame (TUN_FLT_ALLMULTI). */
+    void setAllMulticast(bool accept);
+    bool allMulticast() const { return allMulti; }
+
+    /** @brief Verdict for one destination address, without counting. */
+    bool accepts(const std::uint8_t* mac) const;
+
+    /** @brief Fast-path check of a received frame; updates stats(). */
+    bool accept(const std::uint8_t* frame, std::size_t size);
+
+    /**
+     * @brief Address list for TUNSETTXFILTER: unicast first (the kernel stops at
+     * the first unicast past the exact slots), then broadcast, then groups.
+     * Empty if there are more unicast addresses than exact slots, in which case
+     * the kernel cannot hold the filter.
+     */
+    std::vector<MacAddress> kernelAddresses() const;
+
+    /** @brief Kernel hash bucket (0..63) of an address: ether_crc(6, mac) >> 26. */
+    static unsigned hashBucket(const std::uint8_t* mac);
+
+    /** @brief 64-bit hash mask over broadcast and the joined groups. */
+    std::uint64_t hashMask() const { return mask; }
+
+    std::size_t unicastCount() const { return unicast.size(); }
+    std::size_t groupCount() const { return groups.size(); }
+    std::uint64_t generation() const { return version; }
+
+    const MacFilterStats& stats() const { return counters; }
+    void resetStats() { counters = MacFilterStats{}; }
+
+private:
+    struct Group {
+        std::uint64_t key = 0;
+        std::uint32_t refs = 0;
+    };
+
+    void rebuild();
+    bool inGroupSet(std::uint64_t key) const;
+
+    std::vector<std::uint64_t> unicast;  // A handful of entries: compared linearly
+    std::vector<Group> groups;
+    std::vector<std::uint64_t> table;    // Open addressing over group keys, 0 = empty, power-of-two size
+    std::uint64_t mask = 0;
+    unsigned shift = 0;
+    bool broadcast = true;
+    bool allMulti = false;
+    std::uint64_t version = 0;
+    MacFilterStats counters;
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "latency_histogram.h"
+
+/**
+ * @brief Monotonic counter with a single writer (the packet thread): add()
+ * is a relaxed load and store, readable from any thread without locking.
+ * Give each writing thread its own counter (e.g. a label per worker).
+ */
+class MetricCounter {
+public:
+    void add(std::uint64_t n = 1) { value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+    std::uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::uint64_t> value{0};
+};
+
+/**
+ * @brief Point-in-time value, set by its owner and read by the exporter.
+ */
+class MetricGauge {
+public:
+    void set(double v) { value.store(v, std::memory_order_relaxed); }
+    double get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value{0.0};
+};
+
+enum class MetricType : std::uint8_t { Counter, Gauge, Histogram };
+
+/**
+ * @brief Named metrics rendered in the Prometheus text format (0.0.4).
+ *
+ * Metrics are registered up front (before a MetricsServer starts reading);
+ * after that the registry is only read, and every value is an atomic, a
+ * LatencyHistogram snapshot or a callback that must itself be thread-safe,
+ * so scrapes never block the packet path. Series with the same name form
+ * one family; @p labels is the inside of the braces, e.g. `direction="rx"`.
+ */
+class MetricsRegistry {
+public:
+    MetricCounter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+    MetricGauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    /** @brief Export @p histogram (nanoseconds) in seconds with the buckets in kMetricLatencyBuckets. */
+    void histogram(const std::string& name, const std::string& help, const LatencyHistogram& histogram,
+                   const std::string& labels = "");
+
+    /** @brief Counter or gauge computed on the exporting thread at each scrape. */
+    void callback(const std::string& name, const std::string& help, MetricType type, std::function<double()> read,
+                  const std::string& labels = "");
+
+    std::string render() const;
+
+private:
+    struct Metric {
+        std::string name;
+        std::string help;
+        std::string labels;
+        MetricType type = MetricType::Counter;
+        MetricCounter counter;
+        MetricGauge gauge;
+        const LatencyHistogram* histogram = nullptr;
+        std::function<double()> read;
+    };
+
+    Metric& add(const std::string& name, const std::string& help, const std::string& labels, MetricType type);
+
+    std::vector<std::unique_ptr<Metric>> metrics;
+};
+
+/**
+ * @brief Upper bounds (seconds) of the exported latency buckets; +Inf is implicit.
+ */
+extern const std::vector<double> kMetricLatencyBuckets;
+
+/**
+ * @brief Serves MetricsRegistry::render() over HTTP from a background thread.
+ *
+ * Endpoints: `unix:/path` (curl --unix-socket /path http://x/metrics), or
+ * `host:port` / `port` on a loopback address. One request per connection
+ * (`Connection: close`); GET /metrics and GET / return the metrics, anything
+ * else 404. Each connection gets one second in total to send its request and
+ * take the answer. stop() (or the destructor) wakes the thread through an eventfd.
+ */
+class MetricsServer {
+public:
+    explicit MetricsServer(const MetricsRegistry& registry);
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    /** @return false with @p error set if the endpoint cannot be parsed or bound. */
+    bool start(const std::string& endpoint, std::string& error);
+    void stop();
+
+    bool running() const { return worker.joinable(); }
+    const std::string& endpoint() const { return where; }
+    std::uint64_t scrapes() const { return served.load(std::memory_order_relaxed); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void run();
+    void serve(int client);
+    /** @brief Wait for @p events on @p client. false on deadline, error or stop(). */
+    bool waitClient(int client, short events, Clock::time_point deadline) const;
+
+    const MetricsRegistry& registry;
+    std::string where;
+    std::string unixPath;  // Unlinked on stop()
+    int listenFd = -1;
+    int wakeFd = -1;
+    std::thread worker;
+    std::atomic<std::uint64_t> served{0};
+};
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "ipv6.h"
+
+/**
+ * @brief ICMPv6 types (RFC 4443 / RFC 4861).
+ */
+namespace Icmpv6Type {
+static constexpr std::uint8_t EchoRequest = 128;
+static constexpr std::uint8_t EchoReply = 129;
+static constexpr std::uint8_t RouterSolicitation = 133;
+static constexpr std::uint8_t RouterAdvertisement = 134;
+static constexpr std::uint8_t NeighborSolicitation = 135;
+static constexpr std::uint8_t NeighborAdvertisement = 136;
+}  // namespace Icmpv6Type
+
+/**
+ * @brief NDP option types carrying link-layer addresses.
+ */
+namespace NdpOption {
+static constexpr std::uint8_t SourceLinkAddress = 1;
+static constexpr std::uint8_t TargetLinkAddress = 2;
+}  // namespace NdpOption
+
+/**
+ * @brief Flags of a Neighbor Advertisement (first word after the checksum, host order).
+ */
+namespace NdpFlag {
+static constexpr std::uint32_t Router = 0x80000000u;
+static constexpr std::uint32_t Solicited = 0x40000000u;
+static constexpr std::uint32_t Override = 0x20000000u;
+}  // namespace NdpFlag
+
+#pragma pack(push, 1)
+/**
+ * @brief Neighbor Solicitation / Advertisement body without options (RFC 4861 4.3, 4.4).
+ */
+struct NdpNeighborMessage {
+    std::uint8_t type;
+    std::uint8_t code;
+    std::uint16_t checksum;
+    std::uint32_t flags;  // Reserved (NS) or R|S|O (NA), big-endian
+    std::uint8_t target[16];
+};
+#pragma pack(pop)
+
+/** @brief NS/NA with one link-layer address option, the size this stack sends. */
+static constexpr std::size_t kNdpMessageSize = sizeof(NdpNeighborMessage) + 8;
+
+/**
+ * @brief Neighbor Unreachability Detection states (RFC 4861 7.3.2).
+ */
+enum class NeighborState : std::uint8_t {
+    Incomplete,  // Multicast NS sent, no answer yet
+    Reachable,   // Confirmed within the last reachable time
+    Stale,       // Address known, reachability unconfirmed
+    Delay,       // Stale entry used for sending; waiting for upper-layer confirmation
+    Probe        // Unicast NS being retransmitted
+};
+
+const char* neighborStateName(NeighborState state);
+
+struct NeighborEntry {
+    Ipv6Address ip{};
+    MacAddress mac{};
+    NeighborState state = NeighborState::Incomplete;
+    bool router = false;
+    std::uint8_t probes = 0;                               // Solicitations sent in this state
+    std::chrono::steady_clock::time_point deadline{};      // Next state timer
+    std::chrono::steady_clock::time_point updated{};       // Last state change
+};
+
+/**
+ * @brief Fixed-size neighbor cache: open addressing with linear probing over
+ * 128-bit keys.
+ *
+ * Keys live in their own dense array (four per cache line) next to a parallel
+ * entry array, so a lookup compares two 64-bit words per probe and touches an
+ * entry only on a hit. The unspecified address is never a neighbor and marks
+ * empty slots. Deletion shifts the following run back instead of leaving
+ * tombstones, so probe lengths don't degrade with churn. The table is sized
+ * once (load factor <= 1/2); when it is full, insert() evicts the least
+ * recently updated entry, preferring ones that are not REACHABLE.
+ *
+ * insert() and erase() may move entries: pointers from find() are only valid
+ * until the next modification.
+ */
+class NeighborCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit NeighborCache(std::size_t maxEntries = 256);
+
+    NeighborEntry* find(const Ipv6Address& ip);
+    const NeighborEntry* find(const Ipv6Address& ip) const;
+
+    /**
+     * @brief Entry for @p ip, created as INCOMPLETE if missing.
+     * @return nullptr for the unspecified address.
+     */
+    NeighborEntry* insert(const Ipv6Address& ip, Clock::time_point now, bool* created = nullptr);
+
+    bool erase(const Ipv6Address& ip);
+    void clear();
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const
+    {
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            if (keys[i].hi | keys[i].lo) fn(entries[i]);
+        }
+    }
+
+    template <typename Fn>
+    void forEach(Fn&& fn)
+    {
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            if (keys[i].hi | keys[i].lo) fn(entries[i]);
+        }
+    }
+
+    std::size_t size() const { return count; }
+    std::size_t maxEntries() const { return limit; }
+    std::size_t slotCount() const { return keys.size(); }
+    std::uint64_t evictions() const { return evicted; }
+
+private:
+    struct Key {
+        std::uint64_t hi = 0;
+        std::uint64_t lo = 0;
+        bool operator==(const Key& other) const { return hi == other.hi && lo == other.lo; }
+    };
+
+    static Key keyOf(const Ipv6Address& ip);
+    std::size_t home(const Key& key) const;
+    std::size_t slotOf(const Key& key) const;  // keys.size() if absent
+    void eraseSlot(std::size_t slot);
+    void evictOne();
+
+    std::vector<Key> keys;
+    std::vector<NeighborEntry> entries;
+    std::size_t mask = 0;
+    std::size_t limit = 0;
+    std::size_t count = 0;
+    std::uint64_t evicted = 0;
+};
+
+/**
+ * @brief Neighbor Discovery timers and limits (RFC 4861 section 10 defaults).
+ */
+struct NdpConfig {
+    std::size_t cacheEntries = 256;
+    std::chrono::milliseconds reachableTime{30000};
+    std::chrono::milliseconds retransTimer{1000};
+    std::chrono::milliseconds delayFirstProbe{5000};
+    std::chrono::milliseconds staleTimeout{600000};  // Unused STALE entries are dropped after this
+    std::uint8_t maxMulticastSolicit = 3;
+    std::uint8_t maxUnicastSolicit = 3;
+};
+
+struct NdpStats {
+    std::uint64_t rxMessages = 0;
+    std::uint64_t solicitations = 0;
+    std::uint64_t advertisements = 0;
+    std::uint64_t advertisementsSent = 0;  // NA answered in place
+    std::uint64_t solicitationsSent = 0;
+    std::uint64_t checksumErrors = 0;
+    std::uint64_t malformed = 0;           // Failed the RFC 4861 validity checks
+    std::uint64_t notForUs = 0;            // NS for a target we don't own, NA for an unknown neighbor
+    std::uint64_t duplicateAddress = 0;    // NA claiming one of our addresses
+    std::uint64_t ignored = 0;             // Other ICMPv6 types
+    std::uint64_t resolutionFailed = 0;    // INCOMPLETE/PROBE entries that ran out of solicitations
+    std::uint64_t txErrors = 0;
+};
+
+/**
+ * @brief Neighbor Discovery (RFC 4861) on the ICMPv6 receive path.
+ *
+ * A Neighbor Solicitation for one of our addresses is turned into the
+ * Neighbor Advertisement inside the received buffer: the target stays where
+ * it is, the source link-layer option becomes a target link-layer option with
+ * our MAC, the addresses are rewritten and the frame goes straight back out
+ * through Ipv6Layer::send(). Solicitations and advertisements feed the
+ * neighbor cache, which runs the reachability state machine; expire() drives
+ * its timers and resolve() is the lookup for outgoing packets.
+ *
+ * Registers itself as the ICMPv6 handler of @p ipv6, so it must outlive it
+ * (and is neither copyable nor movable).
+ */
+class Ndp {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit Ndp(Ipv6Layer& ipv6, const NdpConfig& config = {});
+    Ndp(const Ndp&) = delete;
+    Ndp& operator=(const Ndp&) = delete;
+
+    void handle(Ipv6Packet& packet);
+
+    /**
+     * @brief Link address for sending to @p ip. Starts address resolution
+     * (multicast NS) for unknown neighbors and returns nullopt until it completes.
+     */
+    std::optional<MacAddress> resolve(const Ipv6Address& ip, Clock::time_point now);
+
+    /** @brief Upper-layer reachability hint (e.g. a TCP ACK for new data). */
+    void confirm(const Ipv6Address& ip, Clock::time_point now);
+
+    /** @brief Run the state timers: probes, retransmissions and ageing. @return Entries removed. */
+    std::size_t expire(Clock::time_point now);
+
+    const NeighborCache& neighbors() const { return cache; }
+    const NdpStats& stats() const { return counters; }
+
+private:
+    void onSolicitation(Ipv6Packet& packet, const Ipv6Address& target, const std::uint8_t* sourceMac);
+    void onAdvertisement(const Ipv6Packet& packet, const Ipv6Address& target, std::uint32_t flags,
+                         const std::uint8_t* targetMac);
+    bool solicit(const Ipv6Address& target, const MacAddress* unicast);
+
+    Ipv6Layer& ipv6;
+    NdpConfig config;
+    NeighborCache cache;
+    NdpStats counters;
+    std::vector<Ipv6Address> scratch;  // expire(): entries to remove
+    std::array<std::uint8_t, kIpv6PayloadOffset + kNdpMessageSize> txFrame{};
+};
+
+/**
+ * @brief Neighbor cache as text lines for the UI ("IP -> MAC STATE (age s)").
+ */
+std::vector<std::string> formatNeighborCache(const NeighborCache& cache, std::chrono::steady_clock::time_point now);
@@ -6,6 +6,8 @@
 #include <string>
 #include <vector>
 
+#include <sys/types.h>
+
 #include "ethernet.h"
 
 /**
@@ -24,11 +26,21 @@ EthernetFrame makeDefaultDemoFrame(int modeBit);
 bool ensureCustomPacketTemplate(const std::filesystem::path& packetFile, std::string& outMsg);
 
 /**
- * @brief Open a file in an editor and wait for it to close.
+ * @brief Start an editor on a file without waiting for it.
  *
- * Blocks until the editor exits. Uses $VISUAL/$EDITOR or defaults to nano.
+ * Runs $VISUAL/$EDITOR (default nano) through /bin/sh in a child process that
+ * inherits the terminal, so the caller must leave the terminal alone (endwin())
+ * until editorFinished() reports it closed. Like system(), SIGINT and SIGQUIT
+ * are ignored by the caller meanwhile.
+ * @return Child pid, or -1 with @p outMsg set.
+ */
+pid_t startEditor(const std::filesystem::path& file, std::string& outMsg);
+
+/**
+ * @brief Non-blocking check on an editor started with startEditor().
+ * @return true once it has exited (and been reaped), with @p outMsg describing how.
  */
-void openFileInEditor(const std::filesystem::path& file, std::string& outMsg);
+bool editorFinished(pid_t pid, std::string& outMsg);
 
 /**
  * @brief Save a received Ethernet frame to the custom packet file (as hex).
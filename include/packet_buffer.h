@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class PacketPool;
+
+/**
+ * @brief Fixed-size packet buffer owned by a PacketPool.
+ *
+ * Valid bytes live in [data(), data() + size()). The headroom in front of
+ * data() lets each layer prepend its header on the way down without moving
+ * the payload (UDP -> IPv4 -> Ethernet).
+ */
+class PacketBuffer {
+public:
+    std::uint8_t* data() { return base + head; }
+    const std::uint8_t* data() const { return base + head; }
+    std::size_t size() const { return length; }
+    std::size_t headroom() const { return head; }
+    std::size_t tailroom() const { return capacity - head - length; }
+
+    /** @brief Grow the front by @p n bytes. @return New data() or nullptr if no headroom. */
+    std::uint8_t* prepend(std::size_t n);
+
+    /** @brief Grow the back by @p n bytes. @return Start of the new area or nullptr. */
+    std::uint8_t* append(std::size_t n);
+
+    /** @brief Drop @p n bytes from the front (e.g. after consuming a header). */
+    void pull(std::size_t n);
+
+    /** @brief Set the number of valid bytes (bounded by the tailroom). */
+    void resize(std::size_t n);
+
+    /** @brief Empty the buffer and place data() @p headroom bytes into it. */
+    void reset(std::size_t headroom);
+
+private:
+    friend class PacketPool;
+
+    std::uint8_t* base = nullptr;
+    std::size_t capacity = 0;
+    std::size_t head = 0;
+    std::size_t length = 0;
+    std::uint32_t refs = 0;
+};
+
+struct PacketPoolStats {
+    std::uint64_t acquired = 0;
+    std::uint64_t exhausted = 0;  // acquire() calls that found the pool empty
+};
+
+/**
+ * @brief Preallocated pool of reference-counted packet buffers.
+ *
+ * All memory is allocated in the constructor; acquire/retain/release are O(1)
+ * and never allocate. Single-threaded: the pool belongs to the packet loop.
+ */
+class PacketPool {
+public:
+    PacketPool(std::size_t count, std::size_t bufferSize = 2048, std::size_t headroom = 128);
+    PacketPool(const PacketPool&) = delete;
+    PacketPool& operator=(const PacketPool&) = delete;
+
+    /** @brief Take a buffer (refcount 1, empty, default headroom) or nullptr if exhausted. */
+    PacketBuffer* acquire();
+
+    /** @brief Add a reference (e.g. a queue keeping an RX buffer alive). */
+    void retain(PacketBuffer* buffer);
+
+    /** @brief Drop a reference; the buffer returns to the pool at zero. */
+    void release(PacketBuffer* buffer);
+
+    std::size_t available() const { return freeList.size(); }
+    std::size_t count() const { return buffers.size(); }
+    std::size_t bufferSize() const { return stride; }
+    std::size_t defaultHeadroom() const { return headroom; }
+    const PacketPoolStats& stats() const { return counters; }
+
+private:
+    std::size_t stride = 0;
+    std::size_t headroom = 0;
+    std::vector<std::uint8_t> arena;
+    std::vector<PacketBuffer> buffers;
+    std::vector<PacketBuffer*> freeList;
+    PacketPoolStats counters;
+};
+
+/**
+ * @brief Move-only owning reference to a pooled buffer (releases on destruction).
+ */
+class PacketRef {
+public:
+    PacketRef() = default;
+    PacketRef(PacketPool* pool, PacketBuffer* buffer) : pool(pool), buffer(buffer) {}
+    PacketRef(const PacketRef&) = delete;
+    PacketRef& operator=(const PacketRef&) = delete;
+    PacketRef(PacketRef&& other) noexcept : pool(other.pool), buffer(other.buffer) { other.buffer = nullptr; }
+    PacketRef& operator=(PacketRef&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            pool = other.pool;
+            buffer = other.buffer;
+            other.buffer = nullptr;
+        }
+        return *this;
+    }
+    ~PacketRef() { reset(); }
+
+    void reset()
+    {
+        if (buffer && pool) pool->release(buffer);
+        buffer = nullptr;
+    }
+
+    /** @brief Give up ownership without releasing. */
+    PacketBuffer* detach()
+    {
+        PacketBuffer* out = buffer;
+        buffer = nullptr;
+        return out;
+    }
+
+    PacketBuffer* get() const { return buffer; }
+    PacketBuffer* operator->() const { return buffer; }
+    explicit operator bool() const { return buffer != nullptr; }
+
+private:
+    PacketPool* pool = nullptr;
+    PacketBuffer* buffer = nullptr;
+};
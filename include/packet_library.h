@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief One frame of a PacketLibrary, pointing into the mapped file.
+ *
+ * Valid until the library is closed or reloaded (refresh() that recompiles).
+ */
+struct PacketView {
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+    std::string_view name;  // Text after the separator, may be empty
+};
+
+/**
+ * @brief Library of test frames compiled from text and memory-mapped.
+ *
+ * Source format: the custom_packet.hex syntax (hex bytes, `#` and `//`
+ * comments), with frames separated by lines that start with `---`; the rest
+ * of the separator line names the frame that follows:
+ *
+ *     --- arp who-has 192.168.100.50
+ *     ff ff ff ff ff ff 02 00 00 00 00 02 08 06 ...
+ *     --- echo request
+ *     ...
+ *
+ * The source is compiled once into `<source>.bin` (header, frame bytes,
+ * names, fixed-size offset index) and mapped read-only, so frame(i) is an
+ * index lookup with no parsing or copying. The binary records the source's
+ * mtime and size; open() reuses it while they match and refresh() recompiles
+ * only when they change. The binary uses host byte order and is rebuilt if
+ * its header does not match.
+ */
+class PacketLibrary {
+public:
+    PacketLibrary() = default;
+    ~PacketLibrary();
+
+    PacketLibrary(const PacketLibrary&) = delete;
+    PacketLibrary& operator=(const PacketLibrary&) = delete;
+
+    /**
+     * @brief Map the compiled form of @p source, compiling it first if it is
+     * missing or stale. @return false with @p error set; frames from a stale
+     * binary stay mapped if the source no longer compiles.
+     */
+    bool open(const std::filesystem::path& source, std::string& error);
+
+    /**
+     * @brief Recompile and remap if the source's mtime or size changed (one
+     * stat() otherwise). On failure the previous frames stay mapped.
+     * @return false with @p error set if recompiling failed.
+     */
+    bool refresh(std::string& error);
+
+    void close();
+
+    bool isOpen() const { return base != nullptr; }
+    std::size_t size() const { return count; }
+
+    /** @brief Frame @p index (< size()), O(1). */
+    PacketView frame(std::size_t index) const;
+
+    const std::filesystem::path& sourcePath() const { return source; }
+    std::filesystem::path compiledPath() const { return compiledPathFor(source); }
+
+    /** @brief True if the last open()/refresh() had to compile the source. */
+    bool compiledOnLastLoad() const { return compiled; }
+
+    /** @brief Bumped every time a different file gets mapped. */
+    std::uint64_t generation() const { return loads; }
+
+    static std::filesystem::path compiledPathFor(const std::filesystem::path& source);
+
+    /**
+     * @brief Compile @p source into @p output (written to a temporary file
+     * and renamed into place, so a mapped older version stays intact).
+     * @return Number of frames, or -1 with @p error set.
+     */
+    static long compile(const std::filesystem::path& source, const std::filesystem::path& output, std::string& error);
+
+private:
+    bool mapCompiled(std::string& error);
+    bool sourceChanged(std::string& error) const;
+
+    std::filesystem::path source;
+    const std::uint8_t* base = nullptr;
+    std::size_t mappedSize = 0;
+    std::size_t count = 0;
+    const void* index = nullptr;
+    std::int64_t sourceMtimeNs = 0;
+    std::uint64_t sourceSize = 0;
+    bool compiled = false;
+    std::uint64_t loads = 0;
+};
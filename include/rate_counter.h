@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief Events-per-second counter over one-second tumbling windows.
+ *
+ * Cheap enough for the packet path: one comparison and two increments per
+ * event. perSecond() reports the last complete second.
+ */
+struct RateCounter {
+    using Clock = std::chrono::steady_clock;
+
+    std::uint64_t total = 0;
+    std::uint64_t current = 0;     // Events in the running window
+    std::uint64_t lastSecond = 0;  // Events in the last complete window
+    Clock::time_point windowStart{};
+
+    void add(Clock::time_point now, std::uint64_t n = 1)
+    {
+        roll(now);
+        current += n;
+        total += n;
+    }
+
+    std::uint64_t perSecond(Clock::time_point now)
+    {
+        roll(now);
+        return lastSecond;
+    }
+
+    void roll(Clock::time_point now)
+    {
+        const auto elapsed = now - windowStart;
+        if (elapsed < std::chrono::seconds(1)) return;
+        // A gap longer than one window means the previous second saw nothing.
+        lastSecond = (elapsed < std::chrono::seconds(2)) ? current : 0;
+        current = 0;
+        windowStart = now;
+    }
+};
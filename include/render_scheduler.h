@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief Parts of the TUI that are redrawn independently (bit mask).
+ */
+namespace RenderRegion {
+constexpr std::uint32_t Header = 1u << 0;
+constexpr std::uint32_t Log = 1u << 1;
+constexpr std::uint32_t TxPanel = 1u << 2;
+constexpr std::uint32_t RxPanel = 1u << 3;
+constexpr std::uint32_t Footer = 1u << 4;
+constexpr std::uint32_t Overlay = 1u << 5;  // Full-screen page or popup menu
+constexpr std::uint32_t All = (1u << 6) - 1;
+}  // namespace RenderRegion
+
+/**
+ * @brief Decides when the TUI draws, independently of how often the packet
+ * loop runs.
+ *
+ * The loop marks regions dirty as the model changes (invalidate()) and asks
+ * beginFrame() once per iteration: a frame is started only if something is
+ * dirty and at least 1/fps has passed since the previous one, so an idle UI
+ * draws nothing and a flood of frames costs at most fps redraws per second.
+ * Regions invalidated between frames are merged into the next one.
+ */
+class RenderScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr unsigned kDefaultFps = 30;
+
+    explicit RenderScheduler(unsigned fps = kDefaultFps) { setFps(fps); }
+
+    /** @brief Frame rate cap; 0 selects kDefaultFps. */
+    void setFps(unsigned fps)
+    {
+        fpsValue = fps ? fps : kDefaultFps;
+        interval = std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(1)) / fpsValue;
+    }
+
+    unsigned fps() const { return fpsValue; }
+
+    void invalidate(std::uint32_t regions) { dirty |= regions; }
+
+    std::uint32_t pending() const { return dirty; }
+
+    /**
+     * @brief Regions to draw now (and forget), or 0 if nothing is dirty or
+     * the previous frame was less than 1/fps ago.
+     */
+    std::uint32_t beginFrame(Clock::time_point now)
+    {
+        if (dirty == 0 || now < nextFrame) return 0;
+        const std::uint32_t regions = dirty;
+        dirty = 0;
+        nextFrame = now + interval;
+        ++frameCount;
+        return regions;
+    }
+
+    /** @brief Frames started so far. */
+    std::uint64_t frames() const { return frameCount; }
+
+private:
+    unsigned fpsValue = kDefaultFps;
+    Clock::duration interval{};
+    Clock::time_point nextFrame{};
+    std::uint32_t dirty = RenderRegion::All;  // First frame draws everything
+    std::uint64_t frameCount = 0;
+};
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "dissector.h"
+#include "spsc_queue.h"
+
+static constexpr std::size_t kRssKeySize = 40;      // As on NICs: covers a 36-byte IPv6 4-tuple
+static constexpr std::size_t kRssMaxInputSize = 36;  // src(16) dst(16) sport(2) dport(2)
+
+/**
+ * @brief Microsoft RSS verification key (the NIC default; not symmetric).
+ */
+extern const std::uint8_t kRssMicrosoftKey[kRssKeySize];
+
+/**
+ * @brief 0x6d5a repeated: with a key that repeats every 16 bits, swapping
+ * source and destination (fields of 2/4/6/16 bytes) leaves the Toeplitz
+ * hash unchanged, so both directions of a conversation go to the same worker.
+ */
+extern const std::uint8_t kRssSymmetricKey[kRssKeySize];
+
+/**
+ * @brief Toeplitz hash (the RSS function) with per-byte lookup tables.
+ *
+ * Bit i of the input contributes the 32 key bits starting at bit i; the
+ * contribution of each (byte position, byte value) is precomputed, so a
+ * 12-byte IPv4 4-tuple costs 12 table loads and XORs.
+ */
+class ToeplitzHash {
+public:
+    explicit ToeplitzHash(const std::uint8_t* key = kRssSymmetricKey);
+
+    /** @param size At most kRssMaxInputSize bytes. */
+    std::uint32_t hash(const std::uint8_t* input, std::size_t size) const;
+
+    /**
+     * @brief Hash of a dissected frame, with the input NICs use:
+     * IPv4/IPv6 addresses + ports for TCP/UDP, addresses only for other IP
+     * (and fragments), the MAC pair for non-IP frames.
+     */
+    std::uint32_t hashFrame(const FrameDescriptor& frame) const;
+
+    /** @brief Bit-at-a-time definition, for checking the tables. */
+    static std::uint32_t reference(const std::uint8_t* key, const std::uint8_t* input, std::size_t size);
+
+private:
+    std::vector<std::uint32_t> table;  // [position * 256 + byte]
+};
+
+/**
+ * @brief One frame handed to a worker. The dispatcher does not own @p data;
+ * @p context is passed through untouched (e.g. a pool buffer index).
+ */
+struct RssItem {
+    const std::uint8_t* data;
+    std::uint32_t size;
+    std::uint32_t hash;
+    void* context;
+};
+
+struct RssConfig {
+    std::size_t workers = 2;
+    std::size_t indirectionSize = 128;  // Buckets (power of two), as on most NICs
+    std::size_t queueDepth = 4096;      // Per worker
+    const std::uint8_t* key = kRssSymmetricKey;
+};
+
+struct RssWorkerStats {
+    std::uint64_t enqueued = 0;
+    std::uint64_t dropped = 0;    // Queue full
+    std::uint64_t processed = 0;  // Handled by the worker thread
+};
+
+/**
+ * @brief Software RSS stage: Toeplitz hash -> indirection table -> per-worker SPSC queue.
+ *
+ * One producer thread calls dispatch(); each worker thread drains its own
+ * queue and runs the handler. Every frame of a flow maps to the same bucket
+ * and so to the same worker, which keeps per-flow order.
+ *
+ * rebalance() moves buckets from loaded to idle workers. A move only takes
+ * effect once the old worker has processed everything already queued for
+ * that bucket (checked on the next frame of the bucket), so order is kept
+ * across moves too.
+ */
+class RssDispatcher {
+public:
+    using Handler = std::function<void(std::size_t worker, const RssItem& item)>;
+
+    RssDispatcher(const RssConfig& config, Handler handler);
+    ~RssDispatcher();
+
+    RssDispatcher(const RssDispatcher&) = delete;
+    RssDispatcher& operator=(const RssDispatcher&) = delete;
+
+    void start();
+    /** @brief Let workers drain their queues, then join them. */
+    void stop();
+
+    /**
+     * @brief Queue @p item for the worker of @p item.hash (producer thread only).
+     * @return false if that worker's queue was full (frame dropped and counted).
+     */
+    bool dispatch(const RssItem& item);
+
+    /** @brief Hash @p frame and dispatch it. */
+    bool dispatch(const FrameDescriptor& frame, const std::uint8_t* data, void* context = nullptr);
+
+    /** @brief Spin until every queued frame has been processed (producer thread). */
+    void waitIdle() const;
+
+    /**
+     * @brief Plan bucket moves from the busiest workers to the idlest based on
+     * the frames each bucket received since the last call (producer thread).
+     * @return Buckets scheduled to move.
+     */
+    std::size_t rebalance();
+
+    /** @brief Replace the whole indirection table (entries are worker indexes; producer thread). */
+    bool setIndirection(const std::vector<std::uint16_t>& workerOfBucket);
+
+    std::size_t workerFor(std::uint32_t hash) const { return table[hash & mask]; }
+    const std::vector<std::uint16_t>& indirection() const { return table; }
+    std::size_t workerCount() const { return workers.size(); }
+    RssWorkerStats stats(std::size_t worker) const;
+    const ToeplitzHash& hasher() const { return toeplitz; }
+
+private:
+    struct Worker {
+        explicit Worker(std::size_t depth) : queue(depth) {}
+        SpscQueue<RssItem> queue;
+        alignas(64) std::atomic<std::uint64_t> done{0};  // Frames fully handled (worker writes)
+        alignas(64) std::uint64_t enqueued = 0;          // Producer side
+        std::uint64_t dropped = 0;
+        std::thread thread;
+    };
+
+    void run(std::size_t index);
+
+    RssConfig cfg;
+    Handler handler;
+    ToeplitzHash toeplitz;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::uint16_t> table;       // Bucket -> worker in use
+    std::vector<std::uint16_t> target;      // Bucket -> worker planned by rebalance()
+    std::vector<std::uint64_t> lastQueued;  // Bucket -> old worker's push count after its last frame
+    std::vector<std::uint64_t> load;        // Bucket -> frames since the last rebalance()
+    std::size_t mask = 0;
+    std::atomic<bool> running{false};
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Bounded lock-free queue for exactly one producer and one consumer thread.
+ *
+ * Head and tail are monotonic 64-bit counters on separate cache lines; each
+ * side keeps a private copy of the other's counter and only re-reads the
+ * shared one when the queue looks full/empty, so the steady state costs one
+ * release store per push/pop batch and no shared-line ping-pong.
+ */
+template <typename T>
+class SpscQueue {
+    static_assert(std::is_trivially_copyable<T>::value, "SpscQueue holds plain values");
+
+public:
+    /** @param capacity Rounded up to a power of two. */
+    explicit SpscQueue(std::size_t capacity)
+    {
+        std::size_t size = 2;
+        while (size < capacity) size <<= 1;
+        items.resize(size);
+        mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /** @brief Producer side. @return false if full. */
+    bool tryPush(const T& item)
+    {
+        const std::uint64_t t = producer.tail;
+        if (t - producer.cachedHead > mask)
+        {
+            producer.cachedHead = head.value.load(std::memory_order_acquire);
+            if (t - producer.cachedHead > mask) return false;
+        }
+        items[t & mask] = item;
+        producer.tail = t + 1;
+        tail.value.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Consumer side: pop up to @p max items into @p out.
+     * @return Items popped (0 if empty).
+     */
+    std::size_t popBatch(T* out, std::size_t max)
+    {
+        const std::uint64_t h = consumer.head;
+        if (consumer.cachedTail == h)
+        {
+            consumer.cachedTail = tail.value.load(std::memory_order_acquire);
+            if (consumer.cachedTail == h) return 0;
+        }
+        std::size_t n = static_cast<std::size_t>(consumer.cachedTail - h);
+        if (n > max) n = max;
+        for (std::size_t i = 0; i < n; ++i) out[i] = items[(h + i) & mask];
+        consumer.head = h + n;
+        head.value.store(h + n, std::memory_order_release);
+        return n;
+    }
+
+    bool tryPop(T& out) { return popBatch(&out, 1) == 1; }
+
+    /** @brief Items ever pushed (producer thread: exact; others: a recent value). */
+    std::uint64_t pushed() const { return tail.value.load(std::memory_order_acquire); }
+
+    /** @brief Items ever popped; safe from any thread. */
+    std::uint64_t popped() const { return head.value.load(std::memory_order_acquire); }
+
+    std::size_t capacity() const { return mask + 1; }
+
+private:
+    struct alignas(64) Counter {
+        std::atomic<std::uint64_t> value{0};
+    };
+    struct alignas(64) ProducerState {
+        std::uint64_t tail = 0;
+        std::uint64_t cachedHead = 0;
+    };
+    struct alignas(64) ConsumerState {
+        std::uint64_t head = 0;
+        std::uint64_t cachedTail = 0;
+    };
+
+    Counter head;
+    Counter tail;
+    ProducerState producer;
+    ConsumerState consumer;
+    std::vector<T> items;
+    std::size_t mask = 0;
+};
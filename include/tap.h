@@ -1,5 +1,11 @@
 #pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
+
+struct sock_filter;
 
 /**
  * @brief Thin wrapper around a Linux TAP device (Ethernet L2 frames).
@@ -58,6 +64,42 @@ public:
      */
     int write(const unsigned char* buffer, size_t size);
 
+    /**
+     * @brief Attach a classic BPF program to the TAP (TUNATTACHFILTER).
+     *
+     * The kernel runs it on every frame it would queue to us and drops the
+     * ones it rejects before they are copied to userspace. Replaces any
+     * filter already attached.
+     *
+     * @return false on error (check `errno`).
+     */
+    bool attachFilter(const sock_filter* code, std::size_t count);
+
+    /** @brief Remove the attached filter (TUNDETACHFILTER). @return false on error. */
+    bool detachFilter();
+
+    /**
+     * @brief Program the destination-MAC TX filter (TUNSETTXFILTER).
+     *
+     * The driver compares the first 8 addresses exactly and hashes the
+     * remaining ones, which must be multicast, into a 64-bit mask; list
+     * unicast addresses first. @p allMulticast accepts every multicast frame.
+     * An empty list removes the filter.
+     *
+     * @return false on error (check `errno`).
+     */
+    bool setMacFilter(const std::vector<std::array<std::uint8_t, 6>>& addresses, bool allMulticast);
+
+    /** @brief Remove the TX filter: every frame is queued again. @return false on error. */
+    bool clearMacFilter() { return setMacFilter({}, false); }
+
+    /**
+     * @brief Frames the kernel dropped on their way to us (`tx_dropped` of the
+     * interface, read from sysfs). Includes frames rejected by the attached
+     * filter and by the MAC filter. @return 0 if the counter cannot be read.
+     */
+    std::uint64_t droppedByKernel() const;
+
     /** @brief Returns the kernel-assigned interface name (e.g. "tap0"). */
     const std::string& name() const { return dev_name; }
 
@@ -0,0 +1,366 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "ipv4.h"
+#include "packet_buffer.h"
+#include "timer_wheel.h"
+
+#pragma pack(push, 1)
+/**
+ * @brief TCP header without options (RFC 793). Multi-byte fields are big-endian.
+ */
+struct TcpHeader {
+    std::uint16_t srcPort;
+    std::uint16_t dstPort;
+    std::uint32_t seq;
+    std::uint32_t ack;
+    std::uint8_t dataOffset;  // Header length in 32-bit words << 4
+    std::uint8_t flags;
+    std::uint16_t window;
+    std::uint16_t checksum;
+    std::uint16_t urgent;
+};
+#pragma pack(pop)
+
+namespace TcpFlag {
+static constexpr std::uint8_t FIN = 0x01;
+static constexpr std::uint8_t SYN = 0x02;
+static constexpr std::uint8_t RST = 0x04;
+static constexpr std::uint8_t PSH = 0x08;
+static constexpr std::uint8_t ACK = 0x10;
+}  // namespace TcpFlag
+
+/**
+ * @brief Ports of the built-in test services (see TcpLayer::enableServices()).
+ */
+namespace TcpPort {
+static constexpr std::uint16_t Echo = 7;
+static constexpr std::uint16_t Discard = 9;
+static constexpr std::uint16_t Chargen = 19;
+static constexpr std::uint16_t Http = 80;
+}  // namespace TcpPort
+
+enum class TcpState {
+    Closed,
+    SynSent,
+    SynReceived,
+    Established,
+    FinWait1,
+    FinWait2,
+    CloseWait,
+    Closing,
+    LastAck,
+    TimeWait
+};
+
+/** @brief RFC 793 state name ("ESTABLISHED", ...) for logs and UI. */
+const char* tcpStateName(TcpState state);
+
+struct TcpConfig {
+    std::size_t maxConnections = 256;
+    std::size_t sendBuffer = 256u * 1024u;     // Per connection, rounded up to a power of two
+    std::size_t receiveWindow = 256u * 1024u;  // Unread + out-of-order bytes per connection
+    std::size_t maxHeldSegments = 256;         // RX buffers one connection may keep referenced
+    std::size_t maxHeldTotal = 0;              // RX buffers all connections together may keep; 0 = half the pool
+    std::size_t txReserve = 64;                // Free pool buffers held data never takes (ACKs, RST, UDP replies)
+    std::uint16_t mss = 1460;
+    std::chrono::milliseconds initialRto{1000};
+    std::chrono::milliseconds minRto{200};
+    std::chrono::milliseconds maxRto{60000};
+    std::chrono::milliseconds delayedAck{40};
+    std::chrono::milliseconds timeWait{2000};  // 2*MSL, kept short for a test stack
+    unsigned maxRetransmits = 8;
+};
+
+struct TcpStats {
+    std::uint64_t rxSegments = 0;
+    std::uint64_t rxBytes = 0;           // In-order payload accepted
+    std::uint64_t rxMalformed = 0;
+    std::uint64_t rxChecksumErrors = 0;
+    std::uint64_t rxNoConnection = 0;    // Answered with RST
+    std::uint64_t rxOutOfOrder = 0;
+    std::uint64_t rxDuplicate = 0;
+    std::uint64_t rxDropped = 0;         // No buffer / hold limit / outside the window
+    std::uint64_t txSegments = 0;
+    std::uint64_t txBytes = 0;           // Payload, retransmissions included
+    std::uint64_t txRetransmits = 0;
+    std::uint64_t txResets = 0;
+    std::uint64_t txNoBuffer = 0;
+    std::uint64_t txErrors = 0;
+    std::uint64_t timeouts = 0;
+    std::uint64_t fastRetransmits = 0;
+    std::uint64_t delayedAcks = 0;       // ACKs sent by the delayed-ACK timer
+    std::uint64_t accepted = 0;
+    std::uint64_t connected = 0;
+    std::uint64_t refused = 0;           // Connection table full
+    std::uint64_t resets = 0;            // Connections closed by RST or retransmission limit
+};
+
+class TcpConnection;
+
+/**
+ * @brief Application callbacks of a connection (all optional).
+ *
+ * @c received gets a view into the RX buffer and returns how many bytes it
+ * consumed; the rest stays queued by reference (no copy), shrinks the
+ * advertised window and is offered again later (after ACKs free send space,
+ * or on TcpConnection::resumeReceive()). Without @c received all data is
+ * consumed.
+ */
+struct TcpCallbacks {
+    std::function<void(TcpConnection&)> connected;  // Handshake complete
+    std::function<std::size_t(TcpConnection&, const std::uint8_t* data, std::size_t size)> received;
+    std::function<void(TcpConnection&)> writable;    // Send space was freed
+    std::function<void(TcpConnection&)> peerClosed;  // FIN received and all data delivered
+    std::function<void(TcpConnection&)> closed;      // Last callback; the object is reused afterwards
+};
+
+class TcpLayer;
+
+/**
+ * @brief One TCP connection (transmission control block). Owned by TcpLayer;
+ * references stay valid until the @c closed callback.
+ */
+class TcpConnection {
+public:
+    TcpState state() const { return tcpState; }
+    const Ipv4Address& localAddress() const { return route.src; }
+    const Ipv4Address& remoteAddress() const { return route.dst; }
+    std::uint16_t localPort() const { return localPortNumber; }
+    std::uint16_t remotePort() const { return remotePortNumber; }
+
+    /** @brief Queue bytes for sending (copied into the send buffer). @return Bytes accepted. */
+    std::size_t send(const std::uint8_t* data, std::size_t size);
+    std::size_t sendSpace() const { return sendRing.size() - sndQueued; }
+
+    /** @brief Send FIN once queued data is out. */
+    void close();
+    /** @brief Send RST and drop the connection immediately. */
+    void abort();
+    /** @brief Offer queued receive data to the application again. */
+    void resumeReceive();
+
+    std::chrono::microseconds smoothedRtt() const { return srtt; }
+    std::chrono::milliseconds retransmitTimeout() const { return rto; }
+    std::size_t congestionWindow() const { return cwnd; }
+    std::size_t bytesReceived() const { return rxBytes; }
+    std::size_t bytesSent() const { return txBytes; }
+
+    std::uint64_t user = 0;  // Free for the application (service state)
+
+private:
+    friend class TcpLayer;
+
+    struct HeldSegment {
+        PacketBuffer* buffer = nullptr;
+        const std::uint8_t* data = nullptr;
+        std::uint32_t seq = 0;
+        std::uint32_t len = 0;
+        bool fin = false;
+    };
+
+    TcpLayer* layer = nullptr;
+    std::uint32_t index = 0;
+    std::uint32_t generation = 0;
+    TcpState tcpState = TcpState::Closed;
+    TcpCallbacks callbacks;
+    Ipv4Route route;
+    std::uint16_t localPortNumber = 0;
+    std::uint16_t remotePortNumber = 0;
+
+    // Send side (RFC 793 names).
+    std::uint32_t iss = 0;
+    std::uint32_t sndUna = 0;
+    std::uint32_t sndNxt = 0;
+    std::uint32_t sndMax = 0;  // Highest sequence sent (sndNxt rewinds on timeout)
+    std::uint32_t sndWl1 = 0;
+    std::uint32_t sndWl2 = 0;
+    std::size_t sndWnd = 0;
+    std::size_t maxSndWnd = 0;
+    std::uint8_t sndScale = 0;
+    std::uint8_t rcvScale = 0;
+    std::size_t mss = 536;
+    std::vector<std::uint8_t> sendRing;  // Bytes [sndUna, sndUna + sndQueued) start at sndHead
+    std::size_t sndHead = 0;
+    std::size_t sndQueued = 0;
+    bool finQueued = false;  // FIN goes out at sequence sndUna + sndQueued
+    bool windowScaling = false;
+
+    // Congestion control (Reno with NewReno partial ACKs).
+    std::size_t cwnd = 0;
+    std::size_t ssthresh = 0;
+    unsigned dupAcks = 0;
+    bool inRecovery = false;
+    std::uint32_t recover = 0;
+
+    // RTT estimation (RFC 6298, one timed segment at a time, Karn's rule).
+    bool rttValid = false;
+    bool rttTiming = false;
+    std::uint32_t rttSeq = 0;
+    std::chrono::steady_clock::time_point rttStart{};
+    std::chrono::microseconds srtt{0};
+    std::chrono::microseconds rttvar{0};
+    std::chrono::milliseconds rto{1000};
+    unsigned retries = 0;
+
+    // Receive side. Held segments are sorted by sequence: the ones below
+    // rcvNxt are in order but unread, the rest are out of order.
+    std::uint32_t irs = 0;
+    std::uint32_t rcvNxt = 0;
+    std::uint32_t rcvRead = 0;       // Next byte for the application
+    std::uint32_t rcvAdvertised = 0; // Right window edge last sent
+    std::vector<HeldSegment> held;
+    std::size_t heldInOrder = 0;  // Leading entries of held below rcvNxt
+    std::size_t ackPendingBytes = 0;
+    bool ackNow = false;
+    bool finReceived = false;
+    bool peerClosedNotified = false;
+
+    TimerId rtoTimer = 0;
+    TimerId ackTimer = 0;
+    TimerId waitTimer = 0;
+
+    std::size_t rxBytes = 0;
+    std::size_t txBytes = 0;
+};
+
+/**
+ * @brief TCP on top of Ipv4Layer.
+ *
+ * Connections live in a fixed table sized by TcpConfig::maxConnections and
+ * are found through an open-addressing hash on the 4-tuple. Retransmission,
+ * delayed ACK and TIME-WAIT use the shared TimerWheel. Out-of-order (and
+ * unread) data is kept as references to pooled RX buffers, so frames must be
+ * delivered with Ipv4Layer::input(PacketBuffer&) from the same @p pool;
+ * payloads without a pooled buffer (reassembled datagrams) are copied into one.
+ *
+ * Registers itself as the TCP handler of @p ipv4 (not copyable/movable).
+ */
+class TcpLayer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TcpLayer(Ipv4Layer& ipv4, PacketPool& pool, TimerWheel& timers, const TcpConfig& config = {});
+    ~TcpLayer();
+    TcpLayer(const TcpLayer&) = delete;
+    TcpLayer& operator=(const TcpLayer&) = delete;
+
+    /** @brief Accept connections on @p port; each one gets a copy of @p callbacks. */
+    bool listen(std::uint16_t port, TcpCallbacks callbacks);
+    void unlisten(std::uint16_t port);
+
+    /** @brief Active open from an ephemeral port. nullptr if no route or no free slot. */
+    TcpConnection* connect(const Ipv4Address& dst, std::uint16_t dstPort, TcpCallbacks callbacks);
+
+    /** @brief Listen on echo (7), discard (9), chargen (19) and a tiny HTTP server (80). */
+    void enableServices();
+
+    void input(Ipv4Packet& packet);
+
+    std::size_t activeConnections() const { return active; }
+    /** @brief Pool buffers currently kept by hold queues (out-of-order or unread data). */
+    std::size_t heldBuffers() const { return heldTotal; }
+    const TcpStats& stats() const { return counters; }
+
+    /** @brief Call @p fn for every open connection (UI listing). */
+    void forEachConnection(const std::function<void(const TcpConnection&)>& fn) const;
+
+private:
+    friend class TcpConnection;
+
+    struct Segment {
+        std::uint32_t seq = 0;
+        std::uint32_t ack = 0;
+        std::uint32_t window = 0;
+        std::uint8_t flags = 0;
+        const std::uint8_t* data = nullptr;
+        std::uint32_t len = 0;
+        std::uint16_t mss = 0;      // 0 = option absent
+        int windowScale = -1;       // -1 = option absent
+    };
+
+    struct TupleSlot {
+        std::uint64_t addresses = 0;  // remote << 32 | local
+        std::uint32_t ports = 0;      // remote << 16 | local
+        std::uint32_t index = 0;
+        std::uint8_t state = 0;       // 0 empty, 1 used, 2 deleted
+    };
+
+    struct Listener {
+        std::uint16_t port = 0;
+        TcpCallbacks callbacks;
+    };
+
+    // Connection table
+    std::size_t tupleSlot(std::uint64_t addresses, std::uint32_t ports) const;
+    TcpConnection* lookup(const Ipv4Address& remote, const Ipv4Address& local,
+                          std::uint16_t remotePort, std::uint16_t localPort);
+    TcpConnection* allocate(const Ipv4Route& route, std::uint16_t localPort, std::uint16_t remotePort);
+    void insertTuple(const TcpConnection& c);
+    void removeTuple(const TcpConnection& c);
+    void rebuildTuples();
+    void release(TcpConnection& c);
+    std::uint32_t initialSequence(const TcpConnection& c) const;
+
+    // Input
+    void handleSynSent(TcpConnection& c, const Segment& seg, const Ipv4Packet& packet);
+    void handleSegment(TcpConnection& c, const Segment& seg, const Ipv4Packet& packet);
+    bool processAck(TcpConnection& c, const Segment& seg);
+    void receiveData(TcpConnection& c, Segment seg, const Ipv4Packet& packet);
+    std::uint32_t hold(TcpConnection& c, std::uint32_t seq, const std::uint8_t* data, std::uint32_t len,
+                       bool fin, const Ipv4Packet& packet, std::size_t& position);
+    std::size_t deliver(TcpConnection& c, const std::uint8_t* data, std::size_t size);
+    void mergeOutOfOrder(TcpConnection& c);
+    void acceptFin(TcpConnection& c);
+    void deliverHeld(TcpConnection& c);
+    void releaseHeld(TcpConnection& c);
+    bool canHold() const;
+    void releaseSegment(const TcpConnection::HeldSegment& s);
+
+    // Output
+    void output(TcpConnection& c);
+    bool sendSegment(TcpConnection& c, std::uint32_t seq, std::size_t len, std::uint8_t flags);
+    void retransmitFirst(TcpConnection& c);
+    void sendAck(TcpConnection& c) { sendSegment(c, c.sndNxt, 0, TcpFlag::ACK); }
+    void scheduleAck(TcpConnection& c);
+    void sendReset(const Ipv4Packet& packet, const Segment& seg, std::uint16_t srcPort, std::uint16_t dstPort);
+    std::uint32_t receiveWindow(const TcpConnection& c) const;
+    /** @brief Sequence just past the queued data, i.e. where the FIN goes. */
+    static std::uint32_t sendEnd(const TcpConnection& c) { return c.sndUna + static_cast<std::uint32_t>(c.sndQueued); }
+    std::uint16_t windowField(TcpConnection& c, bool syn);
+    void startCongestionControl(TcpConnection& c);
+
+    // Timers
+    void armRetransmit(TcpConnection& c);
+    void onRetransmitTimeout(TcpConnection& c);
+    void updateRtt(TcpConnection& c, Clock::duration sample);
+    void enterTimeWait(TcpConnection& c);
+    void reset(TcpConnection& c);
+    bool alive(const TcpConnection& c, std::uint32_t generation) const
+    {
+        return c.generation == generation && c.tcpState != TcpState::Closed;
+    }
+
+    Ipv4Layer& ipv4;
+    PacketPool& pool;
+    TimerWheel& timers;
+    TcpConfig config;
+    TcpStats counters;
+    Clock::time_point now{};
+    TcpConnection* current = nullptr;  // Connection being processed; its sends are flushed at the end
+    std::vector<TcpConnection> connections;
+    std::vector<std::uint32_t> freeConnections;
+    std::vector<TupleSlot> tuples;
+    std::size_t tuplesUsed = 0;
+    std::size_t tuplesDeleted = 0;
+    std::size_t active = 0;
+    std::size_t heldTotal = 0;  // Buffers referenced from all hold queues
+    std::vector<Listener> listeners;
+    std::uint16_t nextEphemeral = 49152;
+    std::uint64_t secret = 0;  // Hash seed and ISN key
+};
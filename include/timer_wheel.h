@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Handle of a scheduled timer (0 = none). Stale handles are harmless:
+ * cancelling a timer that already fired or was reused does nothing.
+ */
+using TimerId = std::uint64_t;
+
+/**
+ * @brief Hashed timer wheel shared by the protocol timers (TCP retransmission,
+ * delayed ACK, TIME-WAIT...).
+ *
+ * schedule() and cancel() are O(1) and do not allocate once the node pool has
+ * grown to the peak number of pending timers (callbacks should fit the
+ * std::function small buffer, e.g. a lambda capturing one or two pointers).
+ * Timers further away than one turn of the wheel stay in their slot until
+ * their tick comes around.
+ *
+ * Single-threaded: owned by the packet loop, which calls advance() regularly.
+ */
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+
+    explicit TimerWheel(Clock::duration tick = std::chrono::milliseconds(1),
+                        std::size_t slots = 1024,
+                        Clock::time_point start = Clock::now());
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    /** @brief Run @p callback once, @p delay from the wheel's current time (rounded up to a tick). */
+    TimerId schedule(Clock::duration delay, Callback callback);
+
+    /** @brief Stop a pending timer. @return true if it was pending. */
+    bool cancel(TimerId id);
+
+    bool pending(TimerId id) const;
+
+    /**
+     * @brief Move the wheel to @p now and fire every timer that is due.
+     * Callbacks may schedule or cancel timers. @return Timers fired.
+     */
+    std::size_t advance(Clock::time_point now);
+
+    /** @brief Time of the wheel (last advance(), tick-aligned). */
+    Clock::time_point now() const { return start + tickLength * currentTick; }
+
+    std::size_t active() const { return armed; }
+
+private:
+    static constexpr std::uint32_t kNone = 0xFFFFFFFFu;
+
+    struct Node {
+        Callback callback;
+        std::uint64_t expires = 0;  // Absolute tick
+        std::uint32_t generation = 0;
+        std::uint32_t prev = kNone;
+        std::uint32_t next = kNone;
+        bool linked = false;
+    };
+
+    void link(std::uint32_t index);
+    void unlink(std::uint32_t index);
+    void freeNode(std::uint32_t index);
+    std::uint32_t indexOf(TimerId id) const;  // kNone if not pending
+    void collect(std::size_t slot, std::uint64_t upTo);
+
+    Clock::duration tickLength;
+    Clock::time_point start;
+    std::uint64_t currentTick = 0;
+    std::size_t mask = 0;
+    std::size_t armed = 0;
+    std::vector<std::uint32_t> heads;
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> freeNodes;
+    std::vector<TimerId> due;  // Scratch for advance()
+};
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "dissector.h"
+
+enum class TrafficDirection : std::uint8_t { Rx, Tx };
+
+/**
+ * @brief Address tracked by a SpaceSaving summary: a MAC in the first 6
+ * bytes (rest zero), an IPv6 address, or an IPv4 address as ::ffff:a.b.c.d.
+ */
+struct HeavyKey {
+    std::uint8_t bytes[16];
+};
+
+/**
+ * @brief One monitored key. The true count lies in [count - error, count].
+ * bytes only covers the time since the key was last (re)admitted.
+ */
+struct HeavyHitter {
+    HeavyKey key;
+    std::uint64_t count;
+    std::uint64_t error;
+    std::uint64_t bytes;
+};
+
+/**
+ * @brief Space-Saving top-K (Metwally et al.): a fixed set of counters.
+ *
+ * A monitored key just counts; an unmonitored one takes over the smallest
+ * counter, inheriting its count as the error bound. Any key seen more than
+ * total/capacity times is guaranteed to be monitored. Counters sit in a
+ * min-heap (position kept per entry) with an open-addressing index over
+ * them, so an update is a hash probe plus a short sift, and nothing is
+ * allocated after construction.
+ */
+class SpaceSaving {
+public:
+    explicit SpaceSaving(std::size_t capacity);
+
+    void add(const HeavyKey& key, std::uint32_t bytes);
+
+    /** @brief Up to @p count monitored keys, largest count first. */
+    std::vector<HeavyHitter> top(std::size_t count) const;
+
+    void clear();
+
+    std::size_t size() const { return used; }
+    std::size_t capacity() const { return entries.size(); }
+    std::uint64_t total() const { return stream; }
+    std::size_t memoryBytes() const;
+
+private:
+    struct Entry {
+        HeavyHitter hitter;
+        std::uint32_t heapPos;
+    };
+
+    struct Slot {
+        std::uint32_t hash;  // Low bits of the key's hash: probes and moves never rehash
+        std::int32_t id;     // Entry id or -1
+    };
+
+    std::size_t findSlot(const HeavyKey& key, std::uint32_t hash) const;  // Slot holding key, or an empty one
+    void eraseSlot(std::size_t slot);
+    void siftDown(std::size_t pos);
+    void siftUp(std::size_t pos);
+    void swapHeap(std::size_t a, std::size_t b);
+
+    std::vector<Entry> entries;
+    std::vector<std::uint32_t> heap;   // Entry ids, min count at the root
+    std::vector<Slot> index;           // Power-of-two size, at most half full
+    std::size_t used = 0;
+    std::uint64_t stream = 0;
+};
+
+/**
+ * @brief Frames and bytes of one class, with the last complete second.
+ */
+struct TrafficCounter {
+    std::uint64_t frames = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t framesLastSecond = 0;
+    std::uint64_t bytesLastSecond = 0;
+    std::uint64_t framesMark = 0;  // frames/bytes when the running second started
+    std::uint64_t bytesMark = 0;
+};
+
+/**
+ * @brief One second of traffic in the rate window.
+ */
+struct TrafficSecond {
+    std::uint64_t rxFrames = 0;
+    std::uint64_t rxBytes = 0;
+    std::uint64_t txFrames = 0;
+    std::uint64_t txBytes = 0;
+};
+
+/**
+ * @brief Protocol mix and heavy hitters of the TAP traffic in fixed memory.
+ *
+ * Exact counters per IP protocol (all 256) and per EtherType (the first
+ * EtherTypeSlots distinct values, later ones go to `other`); Space-Saving
+ * summaries for source/destination MACs and IPs; a ring of the last
+ * WindowSeconds one-second windows. Everything is sized in the constructor;
+ * add() is a handful of array updates plus four heap-ordered counters.
+ */
+class TrafficStats {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t EtherTypeSlots = 64;
+    static constexpr std::size_t WindowSeconds = 60;
+
+    struct EtherTypeCounter {
+        std::uint16_t type = 0;
+        bool used = false;
+        TrafficCounter counter;
+    };
+
+    explicit TrafficStats(std::size_t topK = 64);
+
+    /** @brief Count one dissected frame. */
+    void add(const FrameDescriptor& frame, TrafficDirection direction, Clock::time_point now);
+
+    /** @brief Close the seconds that ended before @p now (add() does this too). */
+    void roll(Clock::time_point now);
+
+    const TrafficCounter& total(TrafficDirection direction) const
+    {
+        return direction == TrafficDirection::Rx ? rx : tx;
+    }
+    const std::array<EtherTypeCounter, EtherTypeSlots>& etherTypes() const { return etherTypeTable; }
+    const TrafficCounter& otherEtherTypes() const { return etherTypeOther; }
+    const std::array<TrafficCounter, 256>& ipProtocols() const { return ipProtoTable; }
+
+    const SpaceSaving& srcMacs() const { return topSrcMac; }
+    const SpaceSaving& dstMacs() const { return topDstMac; }
+    const SpaceSaving& srcIps() const { return topSrcIp; }
+    const SpaceSaving& dstIps() const { return topDstIp; }
+
+    /** @brief Sum of the last @p seconds complete windows (at most WindowSeconds). */
+    TrafficSecond window(std::size_t seconds) const;
+
+    /** @brief Busiest complete second in the window (by frames, both directions). */
+    TrafficSecond peak() const;
+
+    void clear();
+
+    std::size_t memoryBytes() const;
+
+private:
+    TrafficCounter& etherTypeCounter(std::uint16_t type);
+
+    TrafficCounter rx;
+    TrafficCounter tx;
+    std::array<EtherTypeCounter, EtherTypeSlots> etherTypeTable{};
+    TrafficCounter etherTypeOther;
+    std::array<TrafficCounter, 256> ipProtoTable{};
+    SpaceSaving topSrcMac;
+    SpaceSaving topDstMac;
+    SpaceSaving topSrcIp;
+    SpaceSaving topDstIp;
+    std::array<TrafficSecond, WindowSeconds + 1> seconds{};  // Complete seconds plus the running one
+    std::size_t head = 0;       // Running second
+    std::size_t completed = 0;  // Complete seconds in the ring (up to WindowSeconds)
+    Clock::time_point secondStart{};
+    bool started = false;
+};
+
+/**
+ * @brief "Estadisticas" page for the TUI: rates, protocol mix and the top
+ * @p perList entries of each heavy-hitter summary.
+ */
+std::vector<std::string> formatTrafficStats(TrafficStats& stats, std::size_t perList, TrafficStats::Clock::time_point now);
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "ipv4.h"
+#include "packet_buffer.h"
+
+#pragma pack(push, 1)
+struct UdpHeader {
+    std::uint16_t srcPort;
+    std::uint16_t dstPort;
+    std::uint16_t length;    // Header + data
+    std::uint16_t checksum;  // 0 = not computed (IPv4 only)
+};
+#pragma pack(pop)
+
+/**
+ * @brief Well-known ports of the built-in test services.
+ */
+namespace UdpPort {
+static constexpr std::uint16_t Echo = 7;      // RFC 862
+static constexpr std::uint16_t Discard = 9;   // RFC 863
+static constexpr std::uint16_t Chargen = 19;  // RFC 864
+}  // namespace UdpPort
+
+/**
+ * @brief Received datagram. @c data points into the RX buffer (no copy) and is
+ * only valid during the receive callback.
+ */
+struct UdpDatagram {
+    const Ipv4Packet* packet = nullptr;  // Underlying IPv4 view (frame, rxTime)
+    MacAddress srcMac{};
+    Ipv4Address srcIp{};
+    Ipv4Address dstIp{};
+    std::uint16_t srcPort = 0;
+    std::uint16_t dstPort = 0;
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+};
+
+using UdpReceiveHandler = std::function<void(const UdpDatagram& datagram)>;
+
+struct UdpStats {
+    std::uint64_t rxDatagrams = 0;
+    std::uint64_t rxBytes = 0;
+    std::uint64_t rxMalformed = 0;
+    std::uint64_t rxChecksumErrors = 0;
+    std::uint64_t rxNoPort = 0;
+    std::uint64_t txDatagrams = 0;
+    std::uint64_t txBytes = 0;
+    std::uint64_t txErrors = 0;
+    std::uint64_t txNoBuffer = 0;
+    std::uint64_t echoDatagrams = 0;
+    std::uint64_t discardBytes = 0;
+    std::uint64_t chargenDatagrams = 0;
+};
+
+/**
+ * @brief UDP on top of Ipv4Layer with a socket-like API.
+ *
+ * Demultiplexing uses an open-addressing port table (linear probing, load
+ * kept under 1/2), so a lookup is one hash plus, on average, about one probe.
+ * Sends take a pooled buffer holding the payload and prepend the UDP, IPv4
+ * and Ethernet headers in its headroom.
+ *
+ * Registers itself as the UDP handler of @p ipv4 (not copyable/movable).
+ */
+class UdpLayer {
+public:
+    UdpLayer(Ipv4Layer& ipv4, PacketPool& pool);
+    UdpLayer(const UdpLayer&) = delete;
+    UdpLayer& operator=(const UdpLayer&) = delete;
+
+    /** @brief Deliver datagrams for @p port to @p handler. false if already bound. */
+    bool bind(std::uint16_t port, UdpReceiveHandler handler);
+    void unbind(std::uint16_t port);
+    bool isBound(std::uint16_t port) const;
+
+    /** @brief Buffer for an outgoing payload (headroom reserved), or nullptr if the pool is empty. */
+    PacketBuffer* allocate();
+
+    /**
+     * @brief Send @p payload (buffer data) to dst:dstPort. Takes ownership of
+     * the buffer. The next-hop MAC comes from the IPv4 neighbor resolver.
+     * @return Bytes handed to the TAP, or -1.
+     */
+    int sendTo(PacketBuffer* payload, std::uint16_t srcPort, const Ipv4Address& dst, std::uint16_t dstPort);
+
+    /** @brief sendTo() with an explicit route (no neighbor lookup). */
+    int sendTo(PacketBuffer* payload, std::uint16_t srcPort, const Ipv4Route& route, std::uint16_t dstPort);
+
+    /** @brief Answer a received datagram (back to its source MAC/IP/port). */
+    int reply(const UdpDatagram& to, PacketBuffer* payload);
+
+    /** @brief Bind echo (7), discard (9) and chargen (19). */
+    void enableServices(std::size_t chargenSize = 512);
+
+    void input(Ipv4Packet& packet);
+
+    const UdpStats& stats() const { return counters; }
+
+private:
+    struct PortSlot {
+        std::uint16_t port = 0;
+        std::uint8_t state = 0;  // 0 empty, 1 used, 2 deleted
+        UdpReceiveHandler handler;
+    };
+
+    std::size_t slotFor(std::uint16_t port) const;
+    std::size_t indexOf(std::uint16_t port) const;  // ports.size() if unbound
+    PortSlot* find(std::uint16_t port);
+    void rehash(std::size_t newCapacity);
+
+    Ipv4Layer& ipv4;
+    PacketPool& pool;
+    std::vector<PortSlot> ports;
+    std::size_t used = 0;
+    std::size_t deleted = 0;
+    unsigned hashShift = 0;
+    std::size_t chargenOffset = 0;
+    UdpStats counters;
+};
@@ -1,8 +1,10 @@
 #include "arp.h"
+#include "dissector.h"
 #include "ethernet.h"
 #include <algorithm>
 #include <arpa/inet.h>
 #include <cctype>
+#include <cstddef>
 #include <cstdio>
 #include <iomanip>
 #include <optional>
@@ -59,15 +61,13 @@ std::vector<std::string> formatArpTable(
 }
 
 // Manejo básico de ARP: solo imprime resumen de Request/Reply.
-// Parámetros: header ARP, MAC origen/destino e IPs origen/destino.
+// Parámetros: opcode (ya en orden de host), MAC origen/destino e IPs origen/destino.
 // (No responde ni actualiza tabla ARP todavía.)
-static void handleArp(const ArpHeader& header,
+static void handleArp(std::uint16_t opcode,
 					 const MacAddress& senderMac,
 					 const std::uint8_t* senderIp,
 					 const MacAddress& targetMac,
 					 const std::uint8_t* targetIp) {
-	// Opcode en el header está en big-endian, lo convertimos a host.
-	const std::uint16_t opcode = ntohs(header.opcode);
 	// Si opcode es 1, es una solicitud ARP.
 	if (opcode == 1)
 	{
@@ -91,35 +91,19 @@ static void handleArp(const ArpHeader& header,
 	}
 }
 
+// Los campos salen del dissector (una sola pasada, también con tags VLAN).
 std::optional<ArpInfo> parseArpFrame(const EthernetFrame& frame)
 {
-	if (frame.etherType != EtherType::ARP) return std::nullopt;
-	const std::vector<uint8_t>& payload = frame.payload;
-	if (payload.size() < sizeof(ArpHeader)) return std::nullopt;
-
-	const ArpHeader* header = reinterpret_cast<const ArpHeader*>(payload.data());
-	const std::uint16_t hardwareType = ntohs(header->hardwareType);
-	const std::uint16_t protocolType = ntohs(header->protocolType);
-	const std::uint16_t opcode = ntohs(header->opcode);
-	const std::uint8_t macLen = header->hardwareSize;
-	const std::uint8_t ipLen = header->protocolSize;
-
-	if (hardwareType != 1 || protocolType != EtherType::IPv4) return std::nullopt;
-	if (macLen != 6 || ipLen != 4) return std::nullopt;
-
-	const size_t offsetSenderMac = sizeof(ArpHeader);
-	const size_t offsetSenderIp  = offsetSenderMac + macLen;
-	const size_t offsetTargetMac = offsetSenderIp + ipLen;
-	const size_t offsetTargetIp  = offsetTargetMac + macLen;
-	const size_t minSize = offsetTargetIp + ipLen;
-	if (payload.size() < minSize) return std::nullopt;
+	FrameDescriptor decoded;
+	dissectEthernetFrame(frame, decoded);
+	if (!decoded.has(Layer::Arp)) return std::nullopt;
 
 	ArpInfo info{};
-	info.opcode = opcode;
-	std::copy_n(payload.data() + offsetSenderMac, 6, info.senderMac.begin());
-	std::copy_n(payload.data() + offsetTargetMac, 6, info.targetMac.begin());
-	std::copy_n(payload.data() + offsetSenderIp, 4, info.senderIp.begin());
-	std::copy_n(payload.data() + offsetTargetIp, 4, info.targetIp.begin());
+	info.opcode = decoded.arpOpcode;
+	std::copy_n(decoded.arpSenderMac, 6, info.senderMac.begin());
+	std::copy_n(decoded.arpTargetMac, 6, info.targetMac.begin());
+	std::copy_n(decoded.srcIp, 4, info.senderIp.begin());
+	std::copy_n(decoded.dstIp, 4, info.targetIp.begin());
 	return info;
 }
 
@@ -160,6 +144,65 @@ std::optional<EthernetFrame> makeArpReply(const EthernetFrame& frame,
 	return reply;
 }
 
+// Offsets fijos de un ARP Ethernet/IPv4, relativos al inicio del ARP (l3Offset).
+static constexpr std::size_t kArpOffsetSha = sizeof(ArpHeader);
+static constexpr std::size_t kArpOffsetSpa = kArpOffsetSha + 6;
+static constexpr std::size_t kArpOffsetTha = kArpOffsetSpa + 4;
+static constexpr std::size_t kArpOffsetTpa = kArpOffsetTha + 6;
+static constexpr std::size_t kArpSize = kArpOffsetTpa + 4;
+
+// Valida el request directamente sobre el buffer RX y lo convierte en reply in-place.
+// Sólo lee/escribe campos de tamaño fijo: sin parseEthernetII, sin vectores, sin strings.
+std::size_t arpReplyInPlace(std::uint8_t* frame,
+						   std::size_t size,
+						   std::size_t capacity,
+						   const MacAddress& myMac,
+						   const Ipv4Address& myIp,
+						   ArpInfo& request,
+						   std::size_t l3Offset)
+{
+	if (!frame || l3Offset < EthernetII::HeaderSize || size < l3Offset + kArpSize || capacity < size) return 0;
+	// EtherType ARP (big-endian en el wire), justo antes del ARP: tras los tags VLAN si los hay.
+	if (frame[l3Offset - 2] != 0x08 || frame[l3Offset - 1] != 0x06) return 0;
+	// Sólo lo que va a broadcast o a nosotros: en modo promiscuo no contestamos por otros.
+	static const MacAddress kBroadcast{0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+	if (std::memcmp(frame, kBroadcast.data(), 6) != 0 && std::memcmp(frame, myMac.data(), 6) != 0) return 0;
+
+	std::uint8_t* arp = frame + l3Offset;
+	ArpHeader header;
+	std::memcpy(&header, arp, sizeof(ArpHeader));
+	if (ntohs(header.hardwareType) != 1 || ntohs(header.protocolType) != EtherType::IPv4) return 0;
+	if (header.hardwareSize != 6 || header.protocolSize != 4) return 0;
+	if (ntohs(header.opcode) != 1) return 0;
+	if (!ipEquals(arp + kArpOffsetTpa, myIp)) return 0;
+
+	request.opcode = 1;
+	std::memcpy(request.senderMac.data(), arp + kArpOffsetSha, 6);
+	std::memcpy(request.senderIp.data(), arp + kArpOffsetSpa, 4);
+	std::memcpy(request.targetMac.data(), arp + kArpOffsetTha, 6);
+	std::memcpy(request.targetIp.data(), arp + kArpOffsetTpa, 4);
+
+	// Ethernet: dst = quien pregunta, src = nosotros (los tags VLAN y el EtherType no cambian).
+	std::memcpy(frame + 0, request.senderMac.data(), 6);
+	std::memcpy(frame + 6, myMac.data(), 6);
+
+	// ARP: opcode=2, target = sender original, sender = nosotros.
+	const std::uint16_t replyOpcode = htons(2);
+	std::memcpy(arp + offsetof(ArpHeader, opcode), &replyOpcode, sizeof(replyOpcode));
+	std::memcpy(arp + kArpOffsetTha, request.senderMac.data(), 6);
+	std::memcpy(arp + kArpOffsetTpa, request.senderIp.data(), 4);
+	std::memcpy(arp + kArpOffsetSha, myMac.data(), 6);
+	std::memcpy(arp + kArpOffsetSpa, myIp.data(), 4);
+
+	// Mismo padding mínimo que serializeEthernetII (60 bytes sin FCS).
+	if (size < EthernetII::MinFrameSize && capacity >= EthernetII::MinFrameSize)
+	{
+		std::memset(frame + size, 0, EthernetII::MinFrameSize - size);
+		return EthernetII::MinFrameSize;
+	}
+	return size;
+}
+
 // Construye un ARP Request (who-has) desde nuestra IP/MAC hacia un target IP.
 std::optional<EthernetFrame> makeArpRequest(const MacAddress& myMac,
 									 const Ipv4Address& myIp,
@@ -196,73 +239,29 @@ std::optional<EthernetFrame> makeArpRequest(const MacAddress& myMac,
 	return req;
 }
 
-// Detecta si el frame es ARP, valida tamaños, extrae MAC/IP y llama a handleArp().
+// Detecta si el frame es ARP y llama a handleArp() con los campos ya decodificados.
 void arpDetection(const EthernetFrame& frame) {
+	FrameDescriptor decoded;
+	dissectEthernetFrame(frame, decoded);
 	// Si el EtherType no es ARP, no hacemos nada (salimos rápido).
-	if (frame.etherType != EtherType::ARP)
+	if (decoded.etherType != EtherType::ARP)
 	{
 		return;
 	}
-	// Usamos la carga útil del frame como cuerpo ARP.
-	const std::vector<uint8_t>& payload = frame.payload;
-
-	// Necesitamos al menos el header fijo de ARP para continuar.
-	if (payload.size() < sizeof(ArpHeader)) {
-		printf("size error");
-		return;
-	}
-
-	// Interpretamos los primeros bytes del payload como ArpHeader.
-	const ArpHeader *header = reinterpret_cast<const ArpHeader*>(payload.data());
-	// Campos de tipo están en big-endian y se convierten a host.
-	const std::uint16_t hardwareType = ntohs(header->hardwareType);
-	const std::uint16_t protocolType = ntohs(header->protocolType);
-
-	// Leemos longitudes declaradas por el emisor.
-	uint8_t macLen = header->hardwareSize; // Debería ser 6 para Ethernet
-	uint8_t ipLen  = header->protocolSize; // Debería ser 4 para IPv4
-	// Calculamos offsets dentro del payload según el formato ARP.
-	size_t offsetSenderMac = sizeof(ArpHeader);
-	size_t offsetSenderIp  = offsetSenderMac + macLen;
-	size_t offsetTargetMac = offsetSenderIp + ipLen;
-	size_t offsetTargetIp  = offsetTargetMac + macLen;
-	// Tamaño mínimo requerido para leer todos los campos variables.
-	const size_t minSize = offsetTargetIp + ipLen;
-	// Validamos que el payload realmente tenga los bytes declarados.
-	if (payload.size() < minSize)
-	{
-		printf("ARP payload incompleto\n");
-		return;
-	}
-
-	// Aceptamos sólo Ethernet(6) + IPv4(4) en esta versión básica.
-	if (macLen != 6 || ipLen != 4)
+	// El dissector sólo acepta Ethernet(1)/IPv4(0x0800) con tamaños 6 y 4.
+	if (!decoded.has(Layer::Arp))
 	{
-		printf("ARP con tamaños no soportados: mac=%u ip=%u\n",
-				static_cast<unsigned>(macLen), static_cast<unsigned>(ipLen));
+		printf("ARP incompleto o no IPv4/Ethernet\n");
 		return;
 	}
 
-	// Aceptamos sólo hardware Ethernet (1) y protocolo IPv4 (0x0800).
-	if (hardwareType != 1 || protocolType != EtherType::IPv4)
-	{
-		printf("ARP no IPv4/Ethernet (htype=0x%04x ptype=0x%04x)\n",
-				hardwareType, protocolType);
-		return;
-	}
-
-	// Copiamos MAC origen/target a estructuras seguras de 6 bytes.
 	MacAddress senderMac{};
 	MacAddress targetMac{};
-	std::copy_n(payload.data() + offsetSenderMac, 6, senderMac.begin());
-	std::copy_n(payload.data() + offsetTargetMac, 6, targetMac.begin());
-
-	// Tomamos punteros a las IPs dentro del payload (4 bytes cada una).
-	const uint8_t* senderIpPtr = payload.data() + offsetSenderIp;
-	const uint8_t* targetIpPtr = payload.data() + offsetTargetIp;
+	std::copy_n(decoded.arpSenderMac, 6, senderMac.begin());
+	std::copy_n(decoded.arpTargetMac, 6, targetMac.begin());
 
 	// Log mínimo para indicar detección y origen.
-	printf("ARP IPv4 detectado. IP Origen: %s\n", ipToString(senderIpPtr).c_str());
+	printf("ARP IPv4 detectado. IP Origen: %s\n", ipToString(decoded.srcIp).c_str());
 	// Delegamos el resumen Request/Reply a handleArp().
-	handleArp(*header, senderMac, senderIpPtr, targetMac, targetIpPtr);
-}
\ No newline at end of file
+	handleArp(decoded.arpOpcode, senderMac, decoded.srcIp, targetMac, decoded.dstIp);
+}
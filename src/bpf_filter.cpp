@@ -0,0 +1,806 @@
+#include "bpf_filter.h"
+
+#include "ethernet.h"
+#include "ipv4.h"
+
+#include <arpa/inet.h>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Offsets in an untagged Ethernet II frame (what the generated code inspects).
+static constexpr std::uint32_t kOffEtherType = 12;
+static constexpr std::uint32_t kOffIpv4Frag = 20;  // Flags + fragment offset
+static constexpr std::uint32_t kOffIpv4Proto = 23;
+static constexpr std::uint32_t kOffIpv4Src = 26;
+static constexpr std::uint32_t kOffIpv4Dst = 30;
+static constexpr std::uint32_t kOffArpSenderIp = 28;
+static constexpr std::uint32_t kOffArpTargetIp = 38;
+static constexpr std::uint32_t kOffIpv6Next = 20;
+static constexpr std::uint32_t kOffIpv6Src = 22;
+static constexpr std::uint32_t kOffIpv6Dst = 38;
+static constexpr std::uint32_t kOffIpv6Ports = 54;  // No extension headers
+
+namespace {
+
+/**
+ * @brief One comparison: load a frame field, optionally mask it, jump on the result.
+ */
+struct BpfTest {
+    std::uint16_t load = 0;  // BPF_LD | size | mode
+    std::uint32_t offset = 0;
+    std::uint32_t mask = 0;  // 0: no BPF_AND
+    std::uint16_t jump = 0;  // BPF_JMP | op | BPF_K
+    std::uint32_t value = 0;
+};
+
+struct BpfNode {
+    enum Kind : std::uint8_t { Test, And, Or, Not };
+    Kind kind = Test;
+    int left = -1;
+    int right = -1;
+    BpfTest test;
+};
+
+enum class Direction { Any, Src, Dst };
+
+static constexpr unsigned kPortTcp = 1;
+static constexpr unsigned kPortUdp = 2;
+
+/**
+ * @brief Recursive-descent parser from tokens to a tree of BpfNode (indexes into nodes).
+ */
+class FilterParser {
+public:
+    FilterParser(std::vector<std::string> words, std::string& errorOut) : tokens(std::move(words)), error(errorOut) {}
+
+    int parseExpression();
+    bool atEnd() const { return pos >= tokens.size(); }
+    const std::string& current() const { return tokens[pos]; }
+
+    std::vector<BpfNode> nodes;
+
+private:
+    int parseUnary();
+    int parsePrimitive();
+    int parseHost(Direction dir);
+    int parseNet(Direction dir);
+    int parsePort(Direction dir, unsigned protocols);
+    int parseEther();
+
+    int fail(const std::string& message)
+    {
+        if (error.empty()) error = message;
+        return -1;
+    }
+    bool accept(const char* word)
+    {
+        if (atEnd() || tokens[pos] != word) return false;
+        ++pos;
+        return true;
+    }
+    bool next(std::string& word)
+    {
+        if (atEnd()) return false;
+        word = tokens[pos++];
+        return true;
+    }
+
+    int add(const BpfNode& node)
+    {
+        nodes.push_back(node);
+        return static_cast<int>(nodes.size() - 1);
+    }
+    int test(std::uint16_t size, std::uint32_t offset, std::uint16_t op, std::uint32_t value, std::uint32_t mask = 0,
+             std::uint16_t mode = BPF_ABS)
+    {
+        BpfNode node;
+        node.test.load = static_cast<std::uint16_t>(BPF_LD | size | mode);
+        node.test.offset = offset;
+        node.test.mask = mask;
+        node.test.jump = static_cast<std::uint16_t>(BPF_JMP | op | BPF_K);
+        node.test.value = value;
+        return add(node);
+    }
+    int combine(BpfNode::Kind kind, int left, int right)
+    {
+        if (left < 0 || right < 0) return -1;
+        BpfNode node;
+        node.kind = kind;
+        node.left = left;
+        node.right = right;
+        return add(node);
+    }
+    int both(int left, int right) { return combine(BpfNode::And, left, right); }
+    int either(int left, int right) { return combine(BpfNode::Or, left, right); }
+    int negate(int inner)
+    {
+        if (inner < 0) return -1;
+        BpfNode node;
+        node.kind = BpfNode::Not;
+        node.left = inner;
+        return add(node);
+    }
+
+    int etherIs(std::uint16_t type) { return test(BPF_H, kOffEtherType, BPF_JEQ, type); }
+    int byDirection(Direction dir, int src, int dst)
+    {
+        if (dir == Direction::Src) return src;
+        if (dir == Direction::Dst) return dst;
+        return either(src, dst);
+    }
+    int macAt(std::uint32_t offset, const MacAddress& mac);
+    int ipProtocol(std::uint8_t proto);
+    int number(std::uint32_t max, const char* what, std::uint32_t& out);
+
+    std::vector<std::string> tokens;
+    std::size_t pos = 0;
+    std::string& error;
+};
+
+/**
+ * @brief Short-circuit code generation: every node jumps to a true or a false label.
+ */
+class FilterCodegen {
+public:
+    explicit FilterCodegen(const std::vector<BpfNode>& tree) : nodes(tree) {}
+
+    bool generate(int root, std::vector<sock_filter>& out, std::string& error);
+
+private:
+    /** @brief What A/X hold on every path into a label (all jumps are forward). */
+    struct Registers {
+        bool reached = false;
+        bool haveA = false;  // A holds the field of `loaded`
+        bool haveX = false;  // X holds the IPv4 header length
+        BpfTest loaded;
+    };
+
+    int newLabel()
+    {
+        labels.push_back(-1);
+        entry.emplace_back();
+        return static_cast<int>(labels.size() - 1);
+    }
+    void jumpTo(int label)
+    {
+        Registers& in = entry[static_cast<std::size_t>(label)];
+        if (!in.reached)
+        {
+            in = regs;
+            in.reached = true;
+            return;
+        }
+        in.haveA = in.haveA && regs.haveA && sameField(in.loaded, regs.loaded);
+        in.haveX = in.haveX && regs.haveX;
+    }
+    void place(int label)
+    {
+        labels[static_cast<std::size_t>(label)] = static_cast<int>(code.size());
+        // Code before a label always ends in a jump or ret: only the recorded jumps reach it.
+        regs = entry[static_cast<std::size_t>(label)];
+    }
+    static bool sameField(const BpfTest& a, const BpfTest& b)
+    {
+        return a.load == b.load && a.offset == b.offset && a.mask == b.mask;
+    }
+    void build(int root);
+    void emit(int node, int whenTrue, int whenFalse);
+    void emitTest(const BpfTest& test, int whenTrue, int whenFalse);
+
+    struct Fixup {
+        std::size_t at;
+        int whenTrue;
+        int whenFalse;
+        bool far;  // Followed by "ja whenTrue; ja whenFalse"
+    };
+
+    const std::vector<BpfNode>& nodes;
+    std::vector<sock_filter> code;
+    std::vector<int> labels;
+    std::vector<Registers> entry;
+    std::vector<Fixup> fixups;
+    std::vector<bool> farJumps;  // By fixup index; kept across rebuilds
+    Registers regs;
+};
+
+}  // namespace
+
+static std::vector<std::string> tokenize(std::string_view text)
+{
+    std::vector<std::string> tokens;
+    auto isSpecial = [](char c) { return c == '(' || c == ')' || c == '!' || c == '&' || c == '|'; };
+    std::size_t i = 0;
+    while (i < text.size())
+    {
+        const char c = text[i];
+        if (std::isspace(static_cast<unsigned char>(c)))
+        {
+            ++i;
+        }
+        else if ((c == '&' || c == '|') && i + 1 < text.size() && text[i + 1] == c)
+        {
+            tokens.push_back(c == '&' ? "and" : "or");
+            i += 2;
+        }
+        else if (isSpecial(c))
+        {
+            tokens.push_back(c == '!' ? "not" : std::string(1, c));
+            ++i;
+        }
+        else
+        {
+            std::size_t j = i;
+            while (j < text.size() && !std::isspace(static_cast<unsigned char>(text[j])) && !isSpecial(text[j])) ++j;
+            std::string word(text.substr(i, j - i));
+            for (char& ch : word) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+            tokens.push_back(std::move(word));
+            i = j;
+        }
+    }
+    return tokens;
+}
+
+// ---------------------------------------------------------------------------
+// Parser
+// ---------------------------------------------------------------------------
+
+int FilterParser::parseExpression()
+{
+    int left = parseUnary();
+    while (left >= 0 && !atEnd() && (current() == "and" || current() == "or"))
+    {
+        const bool isAnd = current() == "and";
+        ++pos;
+        const int right = parseUnary();
+        left = isAnd ? both(left, right) : either(left, right);
+    }
+    return left;
+}
+
+int FilterParser::parseUnary()
+{
+    if (accept("not")) return negate(parseUnary());
+    if (accept("("))
+    {
+        const int inner = parseExpression();
+        if (inner < 0) return -1;
+        if (!accept(")")) return fail("falta ')'");
+        return inner;
+    }
+    return parsePrimitive();
+}
+
+int FilterParser::number(std::uint32_t max, const char* what, std::uint32_t& out)
+{
+    std::string word;
+    if (!next(word)) return fail(std::string("falta ") + what);
+    char* end = nullptr;
+    const unsigned long long value = std::strtoull(word.c_str(), &end, 0);
+    if (word[0] == '-' || end == word.c_str() || *end != '\0' || value > max)
+    {
+        return fail(std::string(what) + " inválido: '" + word + "'");
+    }
+    out = static_cast<std::uint32_t>(value);
+    return 0;
+}
+
+int FilterParser::macAt(std::uint32_t offset, const MacAddress& mac)
+{
+    const std::uint32_t high = (static_cast<std::uint32_t>(mac[0]) << 8) | mac[1];
+    const std::uint32_t low = (static_cast<std::uint32_t>(mac[2]) << 24) | (static_cast<std::uint32_t>(mac[3]) << 16) |
+                              (static_cast<std::uint32_t>(mac[4]) << 8) | mac[5];
+    return both(test(BPF_W, offset + 2, BPF_JEQ, low), test(BPF_H, offset, BPF_JEQ, high));
+}
+
+int FilterParser::ipProtocol(std::uint8_t proto)
+{
+    return either(both(etherIs(EtherType::IPv4), test(BPF_B, kOffIpv4Proto, BPF_JEQ, proto)),
+                  both(etherIs(EtherType::IPv6), test(BPF_B, kOffIpv6Next, BPF_JEQ, proto)));
+}
+
+int FilterParser::parsePrimitive()
+{
+    std::string word;
+    if (!next(word)) return fail("expresión incompleta");
+
+    Direction dir = Direction::Any;
+    if (word == "src" || word == "dst")
+    {
+        dir = word == "src" ? Direction::Src : Direction::Dst;
+        if (!next(word) || (word != "host" && word != "net" && word != "port"))
+        {
+            return fail("se esperaba host, net o port tras src/dst");
+        }
+    }
+    if (word == "host") return parseHost(dir);
+    if (word == "net") return parseNet(dir);
+    if (word == "port") return parsePort(dir, kPortTcp | kPortUdp);
+    if (word == "ether") return parseEther();
+    if (word == "broadcast") return macAt(0, MacAddress{0xff, 0xff, 0xff, 0xff, 0xff, 0xff});
+    if (word == "multicast") return test(BPF_B, 0, BPF_JSET, 0x01);
+
+    if (word == "tcp" || word == "udp")
+    {
+        const unsigned protocols = word == "tcp" ? kPortTcp : kPortUdp;
+        if (!atEnd() && (current() == "src" || current() == "dst" || current() == "port"))
+        {
+            Direction portDir = Direction::Any;
+            if (accept("src")) portDir = Direction::Src;
+            else if (accept("dst")) portDir = Direction::Dst;
+            if (!accept("port")) return fail("se esperaba port tras " + word);
+            return parsePort(portDir, protocols);
+        }
+        return ipProtocol(word == "tcp" ? IpProto::TCP : IpProto::UDP);
+    }
+    if (word == "ip" || word == "ip6")
+    {
+        const bool v4 = word == "ip";
+        if (accept("proto"))
+        {
+            std::uint32_t proto = 0;
+            if (number(0xff, "protocolo", proto) < 0) return -1;
+            return both(etherIs(v4 ? EtherType::IPv4 : EtherType::IPv6),
+                        test(BPF_B, v4 ? kOffIpv4Proto : kOffIpv6Next, BPF_JEQ, proto));
+        }
+        return etherIs(v4 ? EtherType::IPv4 : EtherType::IPv6);
+    }
+    if (word == "arp") return etherIs(EtherType::ARP);
+    if (word == "vlan") return either(etherIs(0x8100), etherIs(0x88a8));
+    if (word == "icmp") return both(etherIs(EtherType::IPv4), test(BPF_B, kOffIpv4Proto, BPF_JEQ, IpProto::ICMP));
+    if (word == "icmp6") return both(etherIs(EtherType::IPv6), test(BPF_B, kOffIpv6Next, BPF_JEQ, IpProto::ICMPv6));
+    if (word == "less" || word == "greater")
+    {
+        std::uint32_t length = 0;
+        if (number(0xffffffffu, "longitud", length) < 0) return -1;
+        // less N: len <= N; greater N: len >= N.
+        if (word == "less") return negate(test(BPF_W, 0, BPF_JGT, length, 0, BPF_LEN));
+        return test(BPF_W, 0, BPF_JGE, length, 0, BPF_LEN);
+    }
+    return fail("primitiva desconocida: '" + word + "'");
+}
+
+int FilterParser::parseHost(Direction dir)
+{
+    std::string word;
+    if (!next(word)) return fail("falta la dirección de host");
+
+    std::uint8_t address[16];
+    if (inet_pton(AF_INET, word.c_str(), address) == 1)
+    {
+        std::uint32_t value;
+        std::memcpy(&value, address, 4);
+        value = ntohl(value);
+        // Como tcpdump: "host" también casa con los ARP de esa dirección.
+        const int ip = both(etherIs(EtherType::IPv4),
+                            byDirection(dir, test(BPF_W, kOffIpv4Src, BPF_JEQ, value),
+                                        test(BPF_W, kOffIpv4Dst, BPF_JEQ, value)));
+        const int arp = both(etherIs(EtherType::ARP),
+                             byDirection(dir, test(BPF_W, kOffArpSenderIp, BPF_JEQ, value),
+                                         test(BPF_W, kOffArpTargetIp, BPF_JEQ, value)));
+        return either(ip, arp);
+    }
+    if (inet_pton(AF_INET6, word.c_str(), address) == 1)
+    {
+        auto matchAt = [&](std::uint32_t offset) {
+            int all = -1;
+            for (std::uint32_t i = 0; i < 4; ++i)
+            {
+                std::uint32_t value;
+                std::memcpy(&value, address + i * 4, 4);
+                const int word32 = test(BPF_W, offset + i * 4, BPF_JEQ, ntohl(value));
+                all = all < 0 ? word32 : both(all, word32);
+            }
+            return all;
+        };
+        return both(etherIs(EtherType::IPv6), byDirection(dir, matchAt(kOffIpv6Src), matchAt(kOffIpv6Dst)));
+    }
+    return fail("dirección IP inválida: '" + word + "'");
+}
+
+int FilterParser::parseNet(Direction dir)
+{
+    std::string word;
+    if (!next(word)) return fail("falta la red (A.B.C.D/len)");
+    const std::size_t slash = word.find('/');
+    std::uint32_t prefix = 32;
+    if (slash != std::string::npos)
+    {
+        char* end = nullptr;
+        const unsigned long value = std::strtoul(word.c_str() + slash + 1, &end, 10);
+        if (end == word.c_str() + slash + 1 || *end != '\0' || value > 32) return fail("prefijo inválido: '" + word + "'");
+        prefix = static_cast<std::uint32_t>(value);
+    }
+    std::uint8_t address[4];
+    if (inet_pton(AF_INET, word.substr(0, slash).c_str(), address) != 1)
+    {
+        return fail("red IPv4 inválida: '" + word + "' (net solo admite IPv4)");
+    }
+    if (prefix == 0) return etherIs(EtherType::IPv4);
+
+    std::uint32_t value;
+    std::memcpy(&value, address, 4);
+    const std::uint32_t mask = prefix == 32 ? 0xffffffffu : ~(0xffffffffu >> prefix);
+    value = ntohl(value) & mask;
+    const std::uint32_t masked = mask == 0xffffffffu ? 0 : mask;
+    return both(etherIs(EtherType::IPv4), byDirection(dir, test(BPF_W, kOffIpv4Src, BPF_JEQ, value, masked),
+                                                      test(BPF_W, kOffIpv4Dst, BPF_JEQ, value, masked)));
+}
+
+int FilterParser::parsePort(Direction dir, unsigned protocols)
+{
+    std::uint32_t port = 0;
+    if (number(0xffff, "puerto", port) < 0) return -1;
+
+    auto protoAt = [&](std::uint32_t offset) {
+        if (protocols == kPortTcp) return test(BPF_B, offset, BPF_JEQ, IpProto::TCP);
+        if (protocols == kPortUdp) return test(BPF_B, offset, BPF_JEQ, IpProto::UDP);
+        return either(test(BPF_B, offset, BPF_JEQ, IpProto::TCP), test(BPF_B, offset, BPF_JEQ, IpProto::UDP));
+    };
+
+    // IPv4: ports sit after a variable-length header (X = IHL * 4); only the first fragment has them.
+    const int notFragment = negate(test(BPF_H, kOffIpv4Frag, BPF_JSET, 0x1fff));
+    const int v4Ports = byDirection(dir, test(BPF_H, EthernetII::HeaderSize, BPF_JEQ, port, 0, BPF_IND),
+                                    test(BPF_H, EthernetII::HeaderSize + 2, BPF_JEQ, port, 0, BPF_IND));
+    const int v4 = both(both(etherIs(EtherType::IPv4), protoAt(kOffIpv4Proto)), both(notFragment, v4Ports));
+
+    const int v6Ports = byDirection(dir, test(BPF_H, kOffIpv6Ports, BPF_JEQ, port),
+                                    test(BPF_H, kOffIpv6Ports + 2, BPF_JEQ, port));
+    const int v6 = both(both(etherIs(EtherType::IPv6), protoAt(kOffIpv6Next)), v6Ports);
+    return either(v4, v6);
+}
+
+int FilterParser::parseEther()
+{
+    std::string word;
+    if (!next(word)) return fail("falta src/dst/host/proto tras ether");
+    if (word == "broadcast") return macAt(0, MacAddress{0xff, 0xff, 0xff, 0xff, 0xff, 0xff});
+    if (word == "multicast") return test(BPF_B, 0, BPF_JSET, 0x01);
+    if (word == "proto")
+    {
+        if (accept("ip")) return etherIs(EtherType::IPv4);
+        if (accept("ip6")) return etherIs(EtherType::IPv6);
+        if (accept("arp")) return etherIs(EtherType::ARP);
+        std::uint32_t type = 0;
+        if (number(0xffff, "EtherType", type) < 0) return -1;
+        return etherIs(static_cast<std::uint16_t>(type));
+    }
+    if (word != "src" && word != "dst" && word != "host") return fail("ether " + word + " no soportado");
+
+    std::string text;
+    if (!next(text)) return fail("falta la MAC");
+    const auto mac = parseMac(text);
+    if (!mac) return fail("MAC inválida: '" + text + "'");
+    // Destination MAC at offset 0, source at 6.
+    if (word == "src") return macAt(6, *mac);
+    if (word == "dst") return macAt(0, *mac);
+    return either(macAt(6, *mac), macAt(0, *mac));
+}
+
+// ---------------------------------------------------------------------------
+// Code generation
+// ---------------------------------------------------------------------------
+
+void FilterCodegen::emitTest(const BpfTest& test, int whenTrue, int whenFalse)
+{
+    if (BPF_MODE(test.load) == BPF_IND && !regs.haveX)
+    {
+        code.push_back(BPF_STMT(BPF_LDX | BPF_B | BPF_MSH, kOffEtherType + 2));
+        regs.haveX = true;
+    }
+    // Reuse A when the previous test on every incoming path loaded the same field.
+    if (!regs.haveA || !sameField(regs.loaded, test))
+    {
+        code.push_back(BPF_STMT(test.load, test.offset));
+        if (test.mask != 0) code.push_back(BPF_STMT(BPF_ALU | BPF_AND | BPF_K, test.mask));
+        regs.loaded = test;
+        regs.haveA = true;
+    }
+    const std::size_t index = fixups.size();
+    const bool far = index < farJumps.size() && farJumps[index];
+    fixups.push_back(Fixup{code.size(), whenTrue, whenFalse, far});
+    if (far)
+    {
+        code.push_back(BPF_JUMP(test.jump, test.value, 0, 1));
+        code.push_back(BPF_STMT(BPF_JMP | BPF_JA, 0));
+        code.push_back(BPF_STMT(BPF_JMP | BPF_JA, 0));
+    }
+    else
+    {
+        code.push_back(BPF_JUMP(test.jump, test.value, 0, 0));
+    }
+    jumpTo(whenTrue);
+    jumpTo(whenFalse);
+}
+
+void FilterCodegen::emit(int index, int whenTrue, int whenFalse)
+{
+    const BpfNode& node = nodes[static_cast<std::size_t>(index)];
+    switch (node.kind)
+    {
+    case BpfNode::Test:
+        emitTest(node.test, whenTrue, whenFalse);
+        break;
+    case BpfNode::Not:
+        emit(node.left, whenFalse, whenTrue);
+        break;
+    case BpfNode::And:
+    {
+        const int rightLabel = newLabel();
+        emit(node.left, rightLabel, whenFalse);
+        place(rightLabel);
+        emit(node.right, whenTrue, whenFalse);
+        break;
+    }
+    case BpfNode::Or:
+    {
+        const int rightLabel = newLabel();
+        emit(node.left, whenTrue, rightLabel);
+        place(rightLabel);
+        emit(node.right, whenTrue, whenFalse);
+        break;
+    }
+    }
+}
+
+void FilterCodegen::build(int root)
+{
+    code.clear();
+    labels.clear();
+    entry.clear();
+    fixups.clear();
+    regs = Registers{};
+
+    const int accept = newLabel();
+    const int reject = newLabel();
+    emit(root, accept, reject);
+    place(accept);
+    code.push_back(BPF_STMT(BPF_RET | BPF_K, kBpfAcceptAll));
+    place(reject);
+    code.push_back(BPF_STMT(BPF_RET | BPF_K, 0));
+}
+
+bool FilterCodegen::generate(int root, std::vector<sock_filter>& out, std::string& error)
+{
+    // Conditional offsets are 8 bits. A jump that does not fit is rebuilt as
+    // "jxx jt 0 jf 1; ja T; ja F" and the code regenerated; far jumps only
+    // grow the code, so the set converges.
+    for (;;)
+    {
+        build(root);
+        bool rebuild = false;
+        for (std::size_t i = 0; i < fixups.size(); ++i)
+        {
+            const Fixup& fix = fixups[i];
+            if (fix.far) continue;
+            const int base = static_cast<int>(fix.at) + 1;
+            if (labels[fix.whenTrue] - base > 255 || labels[fix.whenFalse] - base > 255)
+            {
+                if (farJumps.size() <= i) farJumps.resize(i + 1, false);
+                farJumps[i] = true;
+                rebuild = true;
+            }
+        }
+        if (!rebuild) break;
+    }
+    if (code.size() > BPF_MAXINSNS)
+    {
+        error = "filtro demasiado largo (" + std::to_string(code.size()) + " instrucciones)";
+        return false;
+    }
+
+    // Every jump is forward.
+    for (const Fixup& fix : fixups)
+    {
+        if (fix.far)
+        {
+            code[fix.at + 1].k = static_cast<std::uint32_t>(labels[fix.whenTrue] - static_cast<int>(fix.at + 2));
+            code[fix.at + 2].k = static_cast<std::uint32_t>(labels[fix.whenFalse] - static_cast<int>(fix.at + 3));
+            continue;
+        }
+        const int base = static_cast<int>(fix.at) + 1;
+        code[fix.at].jt = static_cast<std::uint8_t>(labels[fix.whenTrue] - base);
+        code[fix.at].jf = static_cast<std::uint8_t>(labels[fix.whenFalse] - base);
+    }
+    out = std::move(code);
+    return true;
+}
+
+std::optional<BpfProgram> compileBpfFilter(std::string_view expression, std::string& error)
+{
+    error.clear();
+    BpfProgram program;
+    program.expression = std::string(expression);
+
+    FilterParser parser(tokenize(expression), error);
+    if (parser.atEnd())
+    {
+        program.code.push_back(BPF_STMT(BPF_RET | BPF_K, kBpfAcceptAll));
+        return program;
+    }
+    const int root = parser.parseExpression();
+    if (root < 0)
+    {
+        if (error.empty()) error = "expresión inválida";
+        return std::nullopt;
+    }
+    if (!parser.atEnd())
+    {
+        error = "sobra '" + parser.current() + "'";
+        return std::nullopt;
+    }
+    FilterCodegen codegen(parser.nodes);
+    if (!codegen.generate(root, program.code, error)) return std::nullopt;
+    return program;
+}
+
+// ---------------------------------------------------------------------------
+// Interpreter and disassembler
+// ---------------------------------------------------------------------------
+
+static bool loadField(const std::uint8_t* frame, std::size_t size, std::uint32_t offset, std::uint16_t width,
+                      std::uint32_t& out)
+{
+    const std::size_t bytes = width == BPF_W ? 4 : width == BPF_H ? 2 : 1;
+    if (offset > size || bytes > size - offset) return false;
+    const std::uint8_t* p = frame + offset;
+    if (bytes == 4) out = (static_cast<std::uint32_t>(p[0]) << 24) | (static_cast<std::uint32_t>(p[1]) << 16) |
+                          (static_cast<std::uint32_t>(p[2]) << 8) | p[3];
+    else if (bytes == 2) out = (static_cast<std::uint32_t>(p[0]) << 8) | p[1];
+    else out = p[0];
+    return true;
+}
+
+std::uint32_t runBpfFilter(const std::vector<sock_filter>& code, const std::uint8_t* frame, std::size_t size)
+{
+    std::uint32_t a = 0;
+    std::uint32_t x = 0;
+    std::uint32_t mem[BPF_MEMWORDS] = {};
+    for (std::size_t pc = 0; pc < code.size(); ++pc)
+    {
+        const sock_filter& in = code[pc];
+        switch (BPF_CLASS(in.code))
+        {
+        case BPF_LD:
+            switch (BPF_MODE(in.code))
+            {
+            case BPF_IMM: a = in.k; break;
+            case BPF_LEN: a = static_cast<std::uint32_t>(size); break;
+            case BPF_MEM: a = mem[in.k % BPF_MEMWORDS]; break;
+            case BPF_ABS:
+                if (!loadField(frame, size, in.k, BPF_SIZE(in.code), a)) return 0;  // Out of bounds drops, as in the kernel
+                break;
+            case BPF_IND:
+                if (!loadField(frame, size, x + in.k, BPF_SIZE(in.code), a)) return 0;
+                break;
+            default: return 0;
+            }
+            break;
+        case BPF_LDX:
+            switch (BPF_MODE(in.code))
+            {
+            case BPF_IMM: x = in.k; break;
+            case BPF_LEN: x = static_cast<std::uint32_t>(size); break;
+            case BPF_MEM: x = mem[in.k % BPF_MEMWORDS]; break;
+            case BPF_MSH:
+                if (in.k >= size) return 0;
+                x = 4u * (frame[in.k] & 0x0f);
+                break;
+            default: return 0;
+            }
+            break;
+        case BPF_ST: mem[in.k % BPF_MEMWORDS] = a; break;
+        case BPF_STX: mem[in.k % BPF_MEMWORDS] = x; break;
+        case BPF_ALU:
+        {
+            const std::uint32_t operand = BPF_SRC(in.code) == BPF_X ? x : in.k;
+            switch (BPF_OP(in.code))
+            {
+            case BPF_ADD: a += operand; break;
+            case BPF_SUB: a -= operand; break;
+            case BPF_MUL: a *= operand; break;
+            case BPF_DIV: if (operand == 0) return 0; a /= operand; break;
+            case BPF_MOD: if (operand == 0) return 0; a %= operand; break;
+            case BPF_AND: a &= operand; break;
+            case BPF_OR: a |= operand; break;
+            case BPF_XOR: a ^= operand; break;
+            case BPF_LSH: a = operand < 32 ? a << operand : 0; break;
+            case BPF_RSH: a = operand < 32 ? a >> operand : 0; break;
+            case BPF_NEG: a = 0u - a; break;
+            default: return 0;
+            }
+            break;
+        }
+        case BPF_JMP:
+        {
+            if (BPF_OP(in.code) == BPF_JA)
+            {
+                pc += in.k;
+                break;
+            }
+            const std::uint32_t operand = BPF_SRC(in.code) == BPF_X ? x : in.k;
+            bool taken = false;
+            switch (BPF_OP(in.code))
+            {
+            case BPF_JEQ: taken = a == operand; break;
+            case BPF_JGT: taken = a > operand; break;
+            case BPF_JGE: taken = a >= operand; break;
+            case BPF_JSET: taken = (a & operand) != 0; break;
+            default: return 0;
+            }
+            pc += taken ? in.jt : in.jf;
+            break;
+        }
+        case BPF_RET:
+            return BPF_RVAL(in.code) == BPF_A ? a : in.k;
+        case BPF_MISC:
+            if (BPF_MISCOP(in.code) == BPF_TAX) x = a;
+            else a = x;
+            break;
+        }
+    }
+    return 0;
+}
+
+std::vector<std::string> disassembleBpf(const std::vector<sock_filter>& code)
+{
+    static const char* const kSize[] = {"ld", "ldh", "ldb", "ld?"};  // BPF_W, BPF_H, BPF_B
+    std::vector<std::string> lines;
+    lines.reserve(code.size());
+    char text[96];
+    for (std::size_t pc = 0; pc < code.size(); ++pc)
+    {
+        const sock_filter& in = code[pc];
+        const unsigned k = in.k;
+        switch (BPF_CLASS(in.code))
+        {
+        case BPF_LD:
+        {
+            const char* op = kSize[BPF_SIZE(in.code) >> 3];
+            if (BPF_MODE(in.code) == BPF_ABS) std::snprintf(text, sizeof(text), "%-8s [%u]", op, k);
+            else if (BPF_MODE(in.code) == BPF_IND) std::snprintf(text, sizeof(text), "%-8s [x + %u]", op, k);
+            else if (BPF_MODE(in.code) == BPF_LEN) std::snprintf(text, sizeof(text), "%-8s #pktlen", "ld");
+            else if (BPF_MODE(in.code) == BPF_IMM) std::snprintf(text, sizeof(text), "%-8s #0x%x", "ld", k);
+            else std::snprintf(text, sizeof(text), "%-8s M[%u]", "ld", k);
+            break;
+        }
+        case BPF_LDX:
+            if (BPF_MODE(in.code) == BPF_MSH) std::snprintf(text, sizeof(text), "%-8s 4*([%u]&0xf)", "ldxb", k);
+            else std::snprintf(text, sizeof(text), "%-8s #0x%x", "ldx", k);
+            break;
+        case BPF_ALU:
+        {
+            static const char* const kAlu[] = {"add", "sub", "mul", "div", "or", "and", "lsh", "rsh",
+                                               "neg", "mod", "xor", "alu?", "alu?", "alu?", "alu?", "alu?"};
+            const char* op = kAlu[BPF_OP(in.code) >> 4];
+            if (BPF_SRC(in.code) == BPF_X) std::snprintf(text, sizeof(text), "%-8s x", op);
+            else std::snprintf(text, sizeof(text), "%-8s #0x%x", op, k);
+            break;
+        }
+        case BPF_JMP:
+        {
+            if (BPF_OP(in.code) == BPF_JA)
+            {
+                std::snprintf(text, sizeof(text), "%-8s %zu", "ja", pc + 1 + k);
+                break;
+            }
+            static const char* const kJmp[] = {"ja", "jeq", "jgt", "jge", "jset", "j?", "j?", "j?"};
+            std::snprintf(text, sizeof(text), "%-8s #0x%-14x jt %zu\tjf %zu", kJmp[BPF_OP(in.code) >> 4], k,
+                          pc + 1 + in.jt, pc + 1 + in.jf);
+            break;
+        }
+        case BPF_RET:
+            if (BPF_RVAL(in.code) == BPF_A) std::snprintf(text, sizeof(text), "%-8s a", "ret");
+            else std::snprintf(text, sizeof(text), "%-8s #%u", "ret", k);
+            break;
+        default:
+            std::snprintf(text, sizeof(text), "code=0x%02x jt=%u jf=%u k=0x%x", in.code, in.jt, in.jf, k);
+            break;
+        }
+        char prefix[32];
+        std::snprintf(prefix, sizeof(prefix), "(%03zu) ", pc);
+        lines.push_back(std::string(prefix) + text);
+    }
+    return lines;
+}
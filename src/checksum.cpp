@@ -0,0 +1,293 @@
+#include "checksum.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NETGUI_CHECKSUM_X86 1
+#endif
+
+/**
+ * @brief Fold a 64-bit one's-complement accumulator down to 16 bits.
+ */
+static std::uint32_t fold64(std::uint64_t acc)
+{
+    acc = (acc & 0xFFFFFFFFull) + (acc >> 32);
+    acc = (acc & 0xFFFFFFFFull) + (acc >> 32);
+    std::uint32_t s = static_cast<std::uint32_t>(acc);
+    s = (s & 0xFFFFu) + (s >> 16);
+    s = (s & 0xFFFFu) + (s >> 16);
+    return s;
+}
+
+/**
+ * @brief Scalar sum: 8 bytes per step into a 64-bit accumulator (carries are
+ * deferred to the final fold, which is what makes one's complement cheap).
+ */
+static std::uint32_t accumulateScalar(const void* data, std::size_t size, std::uint32_t sum)
+{
+    const auto* p = static_cast<const std::uint8_t*>(data);
+    std::uint64_t acc = sum;
+
+    while (size >= 32)
+    {
+        std::uint64_t w[4];
+        std::memcpy(w, p, sizeof(w));
+        acc += (w[0] & 0xFFFFFFFFull) + (w[0] >> 32);
+        acc += (w[1] & 0xFFFFFFFFull) + (w[1] >> 32);
+        acc += (w[2] & 0xFFFFFFFFull) + (w[2] >> 32);
+        acc += (w[3] & 0xFFFFFFFFull) + (w[3] >> 32);
+        p += 32;
+        size -= 32;
+    }
+    while (size >= 8)
+    {
+        std::uint64_t w;
+        std::memcpy(&w, p, sizeof(w));
+        acc += (w & 0xFFFFFFFFull) + (w >> 32);
+        p += 8;
+        size -= 8;
+    }
+    while (size >= 2)
+    {
+        std::uint16_t w;
+        std::memcpy(&w, p, sizeof(w));
+        acc += w;
+        p += 2;
+        size -= 2;
+    }
+    if (size)
+    {
+        // Odd trailing byte: padded with zero in memory order.
+        std::uint16_t w = 0;
+        std::memcpy(&w, p, 1);
+        acc += w;
+    }
+    return fold64(acc);
+}
+
+#if NETGUI_CHECKSUM_X86
+/**
+ * @brief SSE2 sum: each 16-byte load is split into four 32-bit words that are
+ * zero-extended into 64-bit lanes, so carries never need handling in the loop.
+ * Two accumulators hide the add latency; the tail goes through the scalar path.
+ */
+__attribute__((target("sse2"))) static std::uint32_t accumulateSse2(const void* data, std::size_t size,
+                                                                    std::uint32_t sum)
+{
+    const auto* p = static_cast<const std::uint8_t*>(data);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc0 = _mm_setzero_si128();
+    __m128i acc1 = _mm_setzero_si128();
+
+    while (size >= 64)
+    {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 48));
+        acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(a, zero));
+        acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(a, zero));
+        acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(b, zero));
+        acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(b, zero));
+        acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(c, zero));
+        acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(c, zero));
+        acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(d, zero));
+        acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(d, zero));
+        p += 64;
+        size -= 64;
+    }
+    while (size >= 16)
+    {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(a, zero));
+        acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(a, zero));
+        p += 16;
+        size -= 16;
+    }
+
+    std::uint64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), _mm_add_epi64(acc0, acc1));
+    // Each lane holds < 2^32 * (64 KiB / 4) at most, far from overflowing 64 bits.
+    const std::uint32_t partial = fold64(static_cast<std::uint64_t>(sum) + fold64(lanes[0]) + fold64(lanes[1]));
+    return accumulateScalar(p, size, partial);
+}
+
+/**
+ * @brief AVX2 sum: same scheme as SSE2 on 32-byte loads (unpack works per
+ * 128-bit half, which does not matter for a sum), four accumulators.
+ */
+__attribute__((target("avx2"))) static std::uint32_t accumulateAvx2(const void* data, std::size_t size,
+                                                                    std::uint32_t sum)
+{
+    const auto* p = static_cast<const std::uint8_t*>(data);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    __m256i acc2 = _mm256_setzero_si256();
+    __m256i acc3 = _mm256_setzero_si256();
+
+    while (size >= 128)
+    {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+        const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 64));
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 96));
+        acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(a, zero));
+        acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(a, zero));
+        acc2 = _mm256_add_epi64(acc2, _mm256_unpacklo_epi32(b, zero));
+        acc3 = _mm256_add_epi64(acc3, _mm256_unpackhi_epi32(b, zero));
+        acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(c, zero));
+        acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(c, zero));
+        acc2 = _mm256_add_epi64(acc2, _mm256_unpacklo_epi32(d, zero));
+        acc3 = _mm256_add_epi64(acc3, _mm256_unpackhi_epi32(d, zero));
+        p += 128;
+        size -= 128;
+    }
+    while (size >= 32)
+    {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(a, zero));
+        acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(a, zero));
+        p += 32;
+        size -= 32;
+    }
+
+    const __m256i total = _mm256_add_epi64(_mm256_add_epi64(acc0, acc1), _mm256_add_epi64(acc2, acc3));
+    std::uint64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), total);
+    std::uint64_t acc = sum;
+    for (std::uint64_t lane : lanes) acc += fold64(lane);
+    return accumulateScalar(p, size, fold64(acc));
+}
+#endif
+
+using AccumulateFn = std::uint32_t (*)(const void*, std::size_t, std::uint32_t);
+
+static AccumulateFn kernelFunction(ChecksumKernel kernel)
+{
+    switch (kernel)
+    {
+#if NETGUI_CHECKSUM_X86
+        case ChecksumKernel::Sse2: return accumulateSse2;
+        case ChecksumKernel::Avx2: return accumulateAvx2;
+#endif
+        default: return accumulateScalar;
+    }
+}
+
+static ChecksumKernel detectKernel()
+{
+#if NETGUI_CHECKSUM_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return ChecksumKernel::Avx2;
+    if (__builtin_cpu_supports("sse2")) return ChecksumKernel::Sse2;
+#endif
+    return ChecksumKernel::Scalar;
+}
+
+/**
+ * @brief Active kernel. Function-local so it is ready even for callers that
+ * run during static initialization (the benchmark frame builders do).
+ */
+static ChecksumKernel& activeKernel()
+{
+    static ChecksumKernel kernel = detectKernel();
+    return kernel;
+}
+
+static AccumulateFn& activeFunction()
+{
+    static AccumulateFn fn = kernelFunction(activeKernel());
+    return fn;
+}
+
+std::uint32_t checksumAccumulate(const void* data, std::size_t size, std::uint32_t sum)
+{
+    // Headers (20-60 bytes) gain nothing from vectors and would only pay for the indirect call.
+    if (size < kChecksumSimdThreshold) return accumulateScalar(data, size, sum);
+    return activeFunction()(data, size, sum);
+}
+
+std::uint32_t checksumAccumulateWith(ChecksumKernel kernel, const void* data, std::size_t size, std::uint32_t sum)
+{
+    return checksumKernelSupported(kernel) ? kernelFunction(kernel)(data, size, sum) : accumulateScalar(data, size, sum);
+}
+
+bool checksumKernelSupported(ChecksumKernel kernel)
+{
+    return kernel == ChecksumKernel::Scalar || static_cast<int>(kernel) <= static_cast<int>(detectKernel());
+}
+
+ChecksumKernel checksumKernel()
+{
+    return activeKernel();
+}
+
+bool setChecksumKernel(ChecksumKernel kernel)
+{
+    if (!checksumKernelSupported(kernel)) return false;
+    activeKernel() = kernel;
+    activeFunction() = kernelFunction(kernel);
+    return true;
+}
+
+const char* checksumKernelName(ChecksumKernel kernel)
+{
+    switch (kernel)
+    {
+        case ChecksumKernel::Scalar: return "scalar";
+        case ChecksumKernel::Sse2: return "sse2";
+        case ChecksumKernel::Avx2: return "avx2";
+    }
+    return "?";
+}
+
+std::uint16_t checksumFinish(std::uint32_t sum)
+{
+    sum = (sum & 0xFFFFu) + (sum >> 16);
+    sum = (sum & 0xFFFFu) + (sum >> 16);
+    return static_cast<std::uint16_t>(~sum & 0xFFFFu);
+}
+
+std::uint32_t checksumPseudoIpv4(const std::uint8_t* src, const std::uint8_t* dst,
+                                 std::uint8_t protocol, std::uint16_t length)
+{
+    // src(4) dst(4) zero(1) protocol(1) length(2), all in wire order.
+    std::uint32_t a;
+    std::uint32_t b;
+    std::memcpy(&a, src, 4);
+    std::memcpy(&b, dst, 4);
+    const std::uint8_t tail[4] = {0, protocol, static_cast<std::uint8_t>(length >> 8),
+                                  static_cast<std::uint8_t>(length & 0xFFu)};
+    std::uint32_t t;
+    std::memcpy(&t, tail, 4);
+    return fold64(static_cast<std::uint64_t>(a) + b + t);
+}
+
+std::uint32_t checksumPseudoIpv6(const std::uint8_t* src, const std::uint8_t* dst,
+                                 std::uint8_t nextHeader, std::uint32_t length)
+{
+    // src(16) dst(16) length(4) zero(3) next header(1), all in wire order.
+    std::uint32_t words[8];
+    std::memcpy(words, src, 16);
+    std::memcpy(words + 4, dst, 16);
+    const std::uint8_t tail[8] = {static_cast<std::uint8_t>(length >> 24), static_cast<std::uint8_t>(length >> 16),
+                                  static_cast<std::uint8_t>(length >> 8), static_cast<std::uint8_t>(length & 0xFFu),
+                                  0, 0, 0, nextHeader};
+    std::uint32_t t[2];
+    std::memcpy(t, tail, 8);
+    std::uint64_t acc = static_cast<std::uint64_t>(t[0]) + t[1];
+    for (std::uint32_t w : words) acc += w;
+    return fold64(acc);
+}
+
+std::uint16_t checksumUpdate(std::uint16_t checksum, const void* oldData, const void* newData, std::size_t size)
+{
+    // RFC 1624 eqn. 3 generalised: ~HC + sum(~m) + sum(m'). The complement of a
+    // one's-complement sum is the sum of the complements, so ~sum(m) works too.
+    const std::uint16_t oldSum = static_cast<std::uint16_t>(~checksumFinish(accumulateScalar(oldData, size, 0)));
+    std::uint32_t sum = static_cast<std::uint16_t>(~checksum);
+    sum += static_cast<std::uint16_t>(~oldSum);
+    return checksumFinish(accumulateScalar(newData, size, sum));
+}
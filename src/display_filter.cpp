@@ -0,0 +1,701 @@
+#include "display_filter.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cctype>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/**
+ * @brief Bytecode operations (DisplayFilterInsn::op).
+ */
+namespace DfOp {
+enum : std::uint8_t {
+    Ld8,       // dst = u8 at descriptor + arg
+    Ld16,      // dst = u16 at descriptor + arg
+    Ld32,      // dst = u32 at descriptor + arg
+    LdBit,     // dst = (u8 at descriptor + arg) & b ? 1 : 0
+    LdIpLen,   // dst = end of the L3 datagram - l3Offset
+    HasLayer,  // dst = any layer of mask arg present
+    Bytes,     // dst = a bytes at descriptor + (arg & 0xffff) equal pool[arg >> 16] under its mask
+    Eq,        // dst = r[a] == arg (Ne..Ge likewise)
+    Ne,
+    Lt,
+    Le,
+    Gt,
+    Ge,
+    Test,      // dst = (r[a] & arg) != 0
+    And,       // dst = r[a] & r[b]
+    Or,        // dst = r[a] | r[b]
+    Not,       // dst = r[a] ^ 1
+    Ret,       // verdict = r[a]
+};
+}  // namespace DfOp
+
+static constexpr std::uint8_t kMaxRegisters = 16;
+static constexpr std::uint16_t kNoOffset = 0xFFFF;
+
+static constexpr std::uint32_t layerBit(Layer layer)
+{
+    return 1u << static_cast<unsigned>(layer);
+}
+
+enum class FieldKind : std::uint8_t { Uint, Bit, IpLen, Bytes, Protocol };
+
+struct FieldDef {
+    const char* name;
+    FieldKind kind;
+    std::uint8_t width;    // 1/2/4 for Uint, byte count for Bytes, mask for Bit
+    std::uint16_t offset;
+    std::uint16_t other;   // Second offset for *.addr / *.port (either side matches)
+    std::uint32_t layers;  // Layer bits that must be present (0: always)
+};
+
+#define DF_AT(member) static_cast<std::uint16_t>(offsetof(FrameDescriptor, member))
+
+static const FieldDef kFields[] = {
+    {"frame.len", FieldKind::Uint, 2, DF_AT(frameSize), kNoOffset, 0},
+    {"eth", FieldKind::Protocol, 0, 0, kNoOffset, layerBit(Layer::Ethernet)},
+    {"eth.dst", FieldKind::Bytes, 6, DF_AT(dstMac), kNoOffset, layerBit(Layer::Ethernet)},
+    {"eth.src", FieldKind::Bytes, 6, DF_AT(srcMac), kNoOffset, layerBit(Layer::Ethernet)},
+    {"eth.addr", FieldKind::Bytes, 6, DF_AT(srcMac), DF_AT(dstMac), layerBit(Layer::Ethernet)},
+    {"eth.type", FieldKind::Uint, 2, DF_AT(etherType), kNoOffset, layerBit(Layer::Ethernet)},
+    {"vlan", FieldKind::Protocol, 0, 0, kNoOffset, layerBit(Layer::Vlan)},
+    {"vlan.id", FieldKind::Uint, 2, DF_AT(vlan), kNoOffset, layerBit(Layer::Vlan)},
+    {"arp", FieldKind::Protocol, 0, 0, kNoOffset, layerBit(Layer::Arp)},
+    {"arp.opcode", FieldKind::Uint, 2, DF_AT(arpOpcode), kNoOffset, layerBit(Layer::Arp)},
+    {"arp.src.hw_mac", FieldKind::Bytes, 6, DF_AT(arpSenderMac), kNoOffset, layerBit(Layer::Arp)},
+    {"arp.dst.hw_mac", FieldKind::Bytes, 6, DF_AT(arpTargetMac), kNoOffset, layerBit(Layer::Arp)},
+    {"arp.src.proto_ipv4", FieldKind::Bytes, 4, DF_AT(srcIp), kNoOffset, layerBit(Layer::Arp)},
+    {"arp.dst.proto_ipv4", FieldKind::Bytes, 4, DF_AT(dstIp), kNoOffset, layerBit(Layer::Arp)},
+    {"ip", FieldKind::Protocol, 0, 0, kNoOffset, layerBit(Layer::Ipv4)},
+    {"ip.src", FieldKind::Bytes, 4, DF_AT(srcIp), kNoOffset, layerBit(Layer::Ipv4)},
+    {"ip.dst", FieldKind::Bytes, 4, DF_AT(dstIp), kNoOffset, layerBit(Layer::Ipv4)},
+    {"ip.addr", FieldKind::Bytes, 4, DF_AT(srcIp), DF_AT(dstIp), layerBit(Layer::Ipv4)},
+    {"ip.proto", FieldKind::Uint, 1, DF_AT(ipProto), kNoOffset, layerBit(Layer::Ipv4)},
+    {"ip.ttl", FieldKind::Uint, 1, DF_AT(ttl), kNoOffset, layerBit(Layer::Ipv4)},
+    {"ip.len", FieldKind::IpLen, 2, 0, kNoOffset, layerBit(Layer::Ipv4)},
+    {"ipv6", FieldKind::Protocol, 0, 0, kNoOffset, layerBit(Layer::Ipv6)},
+    {"ipv6.src", FieldKind::Bytes, 16, DF_AT(srcIp), kNoOffset, layerBit(Layer::Ipv6)},
+    {"ipv6.dst", FieldKind::Bytes, 16, DF_AT(dstIp), kNoOffset, layerBit(Layer::Ipv6)},
+    {"ipv6.addr", FieldKind::Bytes, 16, DF_AT(srcIp), DF_AT(dstIp), layerBit(Layer::Ipv6)},
+    {"ipv6.nxt", FieldKind::Uint, 1, DF_AT(ipProto), kNoOffset, layerBit(Layer::Ipv6)},
+    {"ipv6.hlim", FieldKind::Uint, 1, DF_AT(ttl), kNoOffset, layerBit(Layer::Ipv6)},
+    {"icmp", FieldKind::Protocol, 0, 0, kNoOffset, layerBit(Layer::Icmp)},
+    {"icmp.type", FieldKind::Uint, 1, DF_AT(icmpType), kNoOffset, layerBit(Layer::Icmp)},
+    {"icmp.code", FieldKind::Uint, 1, DF_AT(icmpCode), kNoOffset, layerBit(Layer::Icmp)},
+    {"icmpv6", FieldKind::Protocol, 0, 0, kNoOffset, layerBit(Layer::Icmpv6)},
+    {"icmpv6.type", FieldKind::Uint, 1, DF_AT(icmpType), kNoOffset, layerBit(Layer::Icmpv6)},
+    {"icmpv6.code", FieldKind::Uint, 1, DF_AT(icmpCode), kNoOffset, layerBit(Layer::Icmpv6)},
+    {"udp", FieldKind::Protocol, 0, 0, kNoOffset, layerBit(Layer::Udp)},
+    {"udp.srcport", FieldKind::Uint, 2, DF_AT(srcPort), kNoOffset, layerBit(Layer::Udp)},
+    {"udp.dstport", FieldKind::Uint, 2, DF_AT(dstPort), kNoOffset, layerBit(Layer::Udp)},
+    {"udp.port", FieldKind::Uint, 2, DF_AT(srcPort), DF_AT(dstPort), layerBit(Layer::Udp)},
+    {"udp.len", FieldKind::Uint, 2, DF_AT(payloadSize), kNoOffset, layerBit(Layer::Udp)},
+    {"tcp", FieldKind::Protocol, 0, 0, kNoOffset, layerBit(Layer::Tcp)},
+    {"tcp.srcport", FieldKind::Uint, 2, DF_AT(srcPort), kNoOffset, layerBit(Layer::Tcp)},
+    {"tcp.dstport", FieldKind::Uint, 2, DF_AT(dstPort), kNoOffset, layerBit(Layer::Tcp)},
+    {"tcp.port", FieldKind::Uint, 2, DF_AT(srcPort), DF_AT(dstPort), layerBit(Layer::Tcp)},
+    {"tcp.flags", FieldKind::Uint, 1, DF_AT(tcpFlags), kNoOffset, layerBit(Layer::Tcp)},
+    {"tcp.flags.fin", FieldKind::Bit, 0x01, DF_AT(tcpFlags), kNoOffset, layerBit(Layer::Tcp)},
+    {"tcp.flags.syn", FieldKind::Bit, 0x02, DF_AT(tcpFlags), kNoOffset, layerBit(Layer::Tcp)},
+    {"tcp.flags.rst", FieldKind::Bit, 0x04, DF_AT(tcpFlags), kNoOffset, layerBit(Layer::Tcp)},
+    {"tcp.flags.push", FieldKind::Bit, 0x08, DF_AT(tcpFlags), kNoOffset, layerBit(Layer::Tcp)},
+    {"tcp.flags.ack", FieldKind::Bit, 0x10, DF_AT(tcpFlags), kNoOffset, layerBit(Layer::Tcp)},
+    {"tcp.flags.urg", FieldKind::Bit, 0x20, DF_AT(tcpFlags), kNoOffset, layerBit(Layer::Tcp)},
+    {"tcp.seq", FieldKind::Uint, 4, DF_AT(tcpSeq), kNoOffset, layerBit(Layer::Tcp)},
+    {"tcp.ack", FieldKind::Uint, 4, DF_AT(tcpAck), kNoOffset, layerBit(Layer::Tcp)},
+    {"tcp.window_size", FieldKind::Uint, 2, DF_AT(tcpWindow), kNoOffset, layerBit(Layer::Tcp)},
+    {"tcp.len", FieldKind::Uint, 2, DF_AT(payloadSize), kNoOffset, layerBit(Layer::Tcp)},
+};
+
+#undef DF_AT
+
+static const FieldDef* findField(const std::string& name)
+{
+    for (const FieldDef& field : kFields)
+    {
+        if (name == field.name) return &field;
+    }
+    return nullptr;
+}
+
+static std::uint32_t layerBits(const FrameDescriptor& frame)
+{
+    std::uint32_t bits = 0;
+    for (std::size_t i = 0; i < frame.layerCount; ++i) bits |= layerBit(frame.layers[i].id);
+    return bits;
+}
+
+// ---------------------------------------------------------------------------
+// Parser
+// ---------------------------------------------------------------------------
+
+static std::vector<std::string> tokenizeFilter(std::string_view text)
+{
+    static const char* const kOperators[] = {"==", "!=", "<=", ">=", "&&", "||", "<", ">", "!", "&", "(", ")"};
+    std::vector<std::string> tokens;
+    std::size_t i = 0;
+    while (i < text.size())
+    {
+        if (std::isspace(static_cast<unsigned char>(text[i])))
+        {
+            ++i;
+            continue;
+        }
+        bool matched = false;
+        for (const char* op : kOperators)
+        {
+            const std::size_t length = std::strlen(op);
+            if (text.compare(i, length, op) == 0)
+            {
+                tokens.emplace_back(op);
+                i += length;
+                matched = true;
+                break;
+            }
+        }
+        if (matched) continue;
+        std::size_t j = i;
+        while (j < text.size() && !std::isspace(static_cast<unsigned char>(text[j])) &&
+               std::strchr("()!=<>&|", text[j]) == nullptr)
+        {
+            ++j;
+        }
+        std::string word(text.substr(i, j - i));
+        for (char& ch : word) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+        tokens.push_back(std::move(word));
+        i = j;
+    }
+    return tokens;
+}
+
+namespace {
+
+class DisplayFilterParser {
+public:
+    DisplayFilterParser(std::vector<std::string> words, std::vector<DisplayFilter::Node>& treeOut,
+                        std::string& errorOut)
+        : tokens(std::move(words)), tree(treeOut), error(errorOut)
+    {
+    }
+
+    int parseOr();
+    bool atEnd() const { return pos >= tokens.size(); }
+    const std::string& current() const { return tokens[pos]; }
+
+private:
+    int parseAnd();
+    int parseUnary();
+    int parseRelation();
+    bool parseValue(const FieldDef& field, const std::string& text, DisplayFilter::Node& node);
+
+    int tooDeep() { return fail("expresión demasiado anidada"); }
+    int fail(const std::string& message)
+    {
+        if (error.empty()) error = message;
+        return -1;
+    }
+    bool accept(const char* a, const char* b = nullptr)
+    {
+        if (atEnd() || (tokens[pos] != a && (!b || tokens[pos] != b))) return false;
+        ++pos;
+        return true;
+    }
+    int add(DisplayFilter::Node node, int height = 1)
+    {
+        tree.push_back(std::move(node));
+        heights.push_back(height);
+        return static_cast<int>(tree.size() - 1);
+    }
+    int combine(DisplayFilter::Node::Kind kind, int left, int right)
+    {
+        if (left < 0 || right < 0) return -1;
+        // Code generation and the reference evaluator recurse over the tree.
+        const int height = 1 + std::max(heights[static_cast<std::size_t>(left)], heights[static_cast<std::size_t>(right)]);
+        if (height > kDisplayFilterMaxDepth) return tooDeep();
+        DisplayFilter::Node node;
+        node.kind = kind;
+        node.left = left;
+        node.right = right;
+        return add(std::move(node), height);
+    }
+
+    std::vector<std::string> tokens;
+    std::size_t pos = 0;
+    int depth = 0;             // Open '(' and '!' being parsed
+    std::vector<int> heights;  // Subtree height of each tree node
+    std::vector<DisplayFilter::Node>& tree;
+    std::string& error;
+};
+
+}  // namespace
+
+int DisplayFilterParser::parseOr()
+{
+    int left = parseAnd();
+    while (left >= 0 && accept("||", "or")) left = combine(DisplayFilter::Node::Or, left, parseAnd());
+    return left;
+}
+
+int DisplayFilterParser::parseAnd()
+{
+    int left = parseUnary();
+    while (left >= 0 && accept("&&", "and")) left = combine(DisplayFilter::Node::And, left, parseUnary());
+    return left;
+}
+
+int DisplayFilterParser::parseUnary()
+{
+    if (accept("!", "not"))
+    {
+        if (++depth > kDisplayFilterMaxDepth) return tooDeep();
+        const int inner = parseUnary();
+        --depth;
+        return inner < 0 ? -1 : combine(DisplayFilter::Node::Not, inner, 0);
+    }
+    if (accept("("))
+    {
+        if (++depth > kDisplayFilterMaxDepth) return tooDeep();
+        const int inner = parseOr();
+        --depth;
+        if (inner < 0) return -1;
+        if (!accept(")")) return fail("falta ')'");
+        return inner;
+    }
+    return parseRelation();
+}
+
+int DisplayFilterParser::parseRelation()
+{
+    if (atEnd()) return fail("expresión incompleta");
+    const std::string name = tokens[pos++];
+    const FieldDef* field = findField(name);
+    if (!field) return fail("campo desconocido: '" + name + "'");
+
+    static const struct {
+        const char* symbol;
+        const char* word;
+        std::uint8_t op;
+    } kRelations[] = {
+        {"==", "eq", DfOp::Eq}, {"!=", "ne", DfOp::Ne}, {"<", "lt", DfOp::Lt}, {"<=", "le", DfOp::Le},
+        {">", "gt", DfOp::Gt},  {">=", "ge", DfOp::Ge}, {"&", "&", DfOp::Test},
+    };
+    DisplayFilter::Node node;
+    node.field = name;
+    bool relation = false;
+    for (const auto& r : kRelations)
+    {
+        if (accept(r.symbol, r.word))
+        {
+            node.op = r.op;
+            relation = true;
+            break;
+        }
+    }
+    if (!relation)
+    {
+        node.kind = DisplayFilter::Node::Present;
+        return add(std::move(node));
+    }
+    if (field->kind == FieldKind::Protocol) return fail("'" + name + "' es un protocolo, no un campo comparable");
+    if (atEnd()) return fail("falta el valor tras " + name);
+    const std::string value = tokens[pos++];
+    if (!parseValue(*field, value, node)) return -1;
+    return add(std::move(node));
+}
+
+bool DisplayFilterParser::parseValue(const FieldDef& field, const std::string& text, DisplayFilter::Node& node)
+{
+    if (field.kind != FieldKind::Bytes)
+    {
+        char* end = nullptr;
+        const unsigned long long value = std::strtoull(text.c_str(), &end, 0);
+        const unsigned long long max = field.kind == FieldKind::Bit ? 1
+                                     : field.width == 1           ? 0xFFull
+                                     : field.width == 2           ? 0xFFFFull
+                                                                  : 0xFFFFFFFFull;
+        if (text[0] == '-' || end == text.c_str() || *end != '\0' || value > max)
+        {
+            fail("valor inválido para " + node.field + ": '" + text + "'");
+            return false;
+        }
+        node.value = static_cast<std::uint32_t>(value);
+        return true;
+    }
+
+    if (node.op != DfOp::Eq && node.op != DfOp::Ne)
+    {
+        fail("con direcciones solo se admite == y !=");
+        return false;
+    }
+    node.bytes.assign(field.width, 0);
+    node.mask.assign(field.width, 0xFF);
+    if (field.width == 6)
+    {
+        const auto mac = parseMac(text);
+        if (!mac)
+        {
+            fail("MAC inválida: '" + text + "'");
+            return false;
+        }
+        std::copy(mac->begin(), mac->end(), node.bytes.begin());
+        return true;
+    }
+
+    const std::size_t slash = text.find('/');
+    const std::string address = text.substr(0, slash);
+    if (inet_pton(field.width == 4 ? AF_INET : AF_INET6, address.c_str(), node.bytes.data()) != 1)
+    {
+        fail("dirección inválida para " + node.field + ": '" + text + "'");
+        return false;
+    }
+    if (slash != std::string::npos)
+    {
+        char* end = nullptr;
+        const unsigned long prefix = std::strtoul(text.c_str() + slash + 1, &end, 10);
+        if (end == text.c_str() + slash + 1 || *end != '\0' || prefix > field.width * 8u)
+        {
+            fail("prefijo inválido: '" + text + "'");
+            return false;
+        }
+        for (std::size_t i = 0; i < field.width; ++i)
+        {
+            const long bits = static_cast<long>(prefix) - static_cast<long>(i * 8);
+            node.mask[i] = bits >= 8 ? 0xFF : bits <= 0 ? 0x00 : static_cast<std::uint8_t>(0xFF << (8 - bits));
+            node.bytes[i] &= node.mask[i];
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Code generation
+// ---------------------------------------------------------------------------
+
+namespace {
+
+/**
+ * @brief Tree -> straight-line code; a node evaluated into register r may use r+1.. as scratch.
+ */
+class DisplayFilterCodegen {
+public:
+    DisplayFilterCodegen(const std::vector<DisplayFilter::Node>& treeIn, std::vector<DisplayFilterInsn>& codeOut,
+                         std::vector<std::uint8_t>& poolOut)
+        : tree(treeIn), code(codeOut), pool(poolOut)
+    {
+    }
+
+    bool generate(int node, std::uint8_t dst);
+    std::uint8_t used = 0;
+
+private:
+    bool reserve(std::uint8_t reg)
+    {
+        if (reg >= kMaxRegisters) return false;
+        if (reg + 1 > used) used = static_cast<std::uint8_t>(reg + 1);
+        return true;
+    }
+    void put(std::uint8_t op, std::uint8_t dst, std::uint8_t a = 0, std::uint8_t b = 0, std::uint32_t arg = 0)
+    {
+        code.push_back(DisplayFilterInsn{op, dst, a, b, arg});
+    }
+    bool compareSide(const DisplayFilter::Node& node, const FieldDef& field, std::uint16_t offset, std::uint8_t dst);
+
+    /** @brief Registers needed to evaluate @p index. */
+    int need(int index) const
+    {
+        const DisplayFilter::Node& node = tree[static_cast<std::size_t>(index)];
+        switch (node.kind)
+        {
+        case DisplayFilter::Node::Present: return 1;
+        case DisplayFilter::Node::Compare: return 2;
+        case DisplayFilter::Node::Not: return need(node.left);
+        default: break;
+        }
+        const int l = need(node.left);
+        const int r = need(node.right);
+        return l == r ? l + 1 : std::max(l, r);
+    }
+
+    const std::vector<DisplayFilter::Node>& tree;
+    std::vector<DisplayFilterInsn>& code;
+    std::vector<std::uint8_t>& pool;
+};
+
+}  // namespace
+
+bool DisplayFilterCodegen::compareSide(const DisplayFilter::Node& node, const FieldDef& field, std::uint16_t offset,
+                                       std::uint8_t dst)
+{
+    switch (field.kind)
+    {
+    case FieldKind::Bytes:
+    {
+        const std::size_t at = pool.size();
+        if (at > 0xFFFF) return false;
+        pool.insert(pool.end(), node.bytes.begin(), node.bytes.end());
+        pool.insert(pool.end(), node.mask.begin(), node.mask.end());
+        put(DfOp::Bytes, dst, field.width, 0, static_cast<std::uint32_t>(at << 16) | offset);
+        return true;  // Equality only; != is negated by the caller
+    }
+    case FieldKind::Bit:
+        put(DfOp::LdBit, dst, 0, field.width, offset);
+        break;
+    case FieldKind::IpLen:
+        put(DfOp::LdIpLen, dst);
+        break;
+    default:
+        put(field.width == 1 ? DfOp::Ld8 : field.width == 2 ? DfOp::Ld16 : DfOp::Ld32, dst, 0, 0, offset);
+        break;
+    }
+    put(node.op == DfOp::Ne ? DfOp::Eq : node.op, dst, dst, 0, node.value);
+    return true;
+}
+
+bool DisplayFilterCodegen::generate(int index, std::uint8_t dst)
+{
+    if (!reserve(dst)) return false;
+    const DisplayFilter::Node& node = tree[static_cast<std::size_t>(index)];
+    switch (node.kind)
+    {
+    case DisplayFilter::Node::And:
+    case DisplayFilter::Node::Or:
+    {
+        // Both operands are always evaluated, so the order is free: the side
+        // needing more registers goes first (Sethi-Ullman).
+        const bool rightFirst = need(node.right) > need(node.left);
+        const int first = rightFirst ? node.right : node.left;
+        const int second = rightFirst ? node.left : node.right;
+        if (!generate(first, dst) || !generate(second, static_cast<std::uint8_t>(dst + 1))) return false;
+        put(node.kind == DisplayFilter::Node::And ? DfOp::And : DfOp::Or, dst, dst, static_cast<std::uint8_t>(dst + 1));
+        return true;
+    }
+    case DisplayFilter::Node::Not:
+        if (!generate(node.left, dst)) return false;
+        put(DfOp::Not, dst, dst);
+        return true;
+    case DisplayFilter::Node::Present:
+        put(DfOp::HasLayer, dst, 0, 0, findField(node.field)->layers);
+        return true;
+    case DisplayFilter::Node::Compare:
+        break;
+    }
+
+    const FieldDef& field = *findField(node.field);
+    const auto scratch = static_cast<std::uint8_t>(dst + 1);
+    if (!reserve(scratch)) return false;
+    if (!compareSide(node, field, field.offset, dst)) return false;
+    if (field.other != kNoOffset)
+    {
+        if (!compareSide(node, field, field.other, scratch)) return false;
+        put(DfOp::Or, dst, dst, scratch);
+    }
+    if (field.layers != 0)
+    {
+        put(DfOp::HasLayer, scratch, 0, 0, field.layers);
+        put(DfOp::And, dst, dst, scratch);
+    }
+    if (node.op == DfOp::Ne) put(DfOp::Not, dst, dst);
+    return true;
+}
+
+std::optional<DisplayFilter> compileDisplayFilter(std::string_view expression, std::string& error)
+{
+    error.clear();
+    DisplayFilter filter;
+    filter.text = std::string(expression);
+
+    DisplayFilterParser parser(tokenizeFilter(expression), filter.tree, error);
+    if (parser.atEnd()) return filter;  // Empty: matches everything
+    filter.root = parser.parseOr();
+    if (filter.root < 0)
+    {
+        if (error.empty()) error = "expresión inválida";
+        return std::nullopt;
+    }
+    if (!parser.atEnd())
+    {
+        error = "sobra '" + parser.current() + "'";
+        return std::nullopt;
+    }
+
+    DisplayFilterCodegen codegen(filter.tree, filter.code, filter.pool);
+    if (!codegen.generate(filter.root, 0))
+    {
+        error = "expresión demasiado anidada";
+        return std::nullopt;
+    }
+    filter.code.push_back(DisplayFilterInsn{DfOp::Ret, 0, 0, 0, 0});
+    filter.registers = codegen.used;
+    return filter;
+}
+
+// ---------------------------------------------------------------------------
+// Execution
+// ---------------------------------------------------------------------------
+
+bool DisplayFilter::matches(const FrameDescriptor& frame) const
+{
+    if (code.empty()) return true;
+    const auto* base = reinterpret_cast<const std::uint8_t*>(&frame);
+    const std::uint32_t present = layerBits(frame);
+    std::uint32_t r[kMaxRegisters];
+    for (const DisplayFilterInsn& in : code)
+    {
+        switch (in.op)
+        {
+        case DfOp::Ld8: r[in.dst] = base[in.arg]; break;
+        case DfOp::Ld16:
+        {
+            std::uint16_t v;
+            std::memcpy(&v, base + in.arg, sizeof(v));
+            r[in.dst] = v;
+            break;
+        }
+        case DfOp::Ld32: std::memcpy(&r[in.dst], base + in.arg, sizeof(std::uint32_t)); break;
+        case DfOp::LdBit: r[in.dst] = (base[in.arg] & in.b) != 0; break;
+        case DfOp::LdIpLen:
+            r[in.dst] = static_cast<std::uint32_t>(frame.payloadOffset + frame.payloadSize - frame.l3Offset);
+            break;
+        case DfOp::HasLayer: r[in.dst] = (present & in.arg) != 0; break;
+        case DfOp::Bytes:
+        {
+            const std::uint8_t* field = base + (in.arg & 0xFFFF);
+            const std::uint8_t* value = pool.data() + (in.arg >> 16);
+            const std::uint8_t* mask = value + in.a;
+            std::uint8_t diff = 0;
+            for (std::size_t i = 0; i < in.a; ++i) diff |= static_cast<std::uint8_t>((field[i] ^ value[i]) & mask[i]);
+            r[in.dst] = diff == 0;
+            break;
+        }
+        case DfOp::Eq: r[in.dst] = r[in.a] == in.arg; break;
+        case DfOp::Ne: r[in.dst] = r[in.a] != in.arg; break;
+        case DfOp::Lt: r[in.dst] = r[in.a] < in.arg; break;
+        case DfOp::Le: r[in.dst] = r[in.a] <= in.arg; break;
+        case DfOp::Gt: r[in.dst] = r[in.a] > in.arg; break;
+        case DfOp::Ge: r[in.dst] = r[in.a] >= in.arg; break;
+        case DfOp::Test: r[in.dst] = (r[in.a] & in.arg) != 0; break;
+        case DfOp::And: r[in.dst] = r[in.a] & r[in.b]; break;
+        case DfOp::Or: r[in.dst] = r[in.a] | r[in.b]; break;
+        case DfOp::Not: r[in.dst] = r[in.a] ^ 1u; break;
+        case DfOp::Ret: return r[in.a] != 0;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Field value as the reference evaluator sees it: raw bytes, or a number.
+ */
+static std::uint32_t readScalar(const FrameDescriptor& frame, const FieldDef& field, std::uint16_t offset)
+{
+    const auto* base = reinterpret_cast<const std::uint8_t*>(&frame);
+    if (field.kind == FieldKind::IpLen) return static_cast<std::uint32_t>(frame.payloadOffset + frame.payloadSize - frame.l3Offset);
+    if (field.kind == FieldKind::Bit) return (base[offset] & field.width) != 0;
+    if (field.width == 1) return base[offset];
+    if (field.width == 2)
+    {
+        std::uint16_t v;
+        std::memcpy(&v, base + offset, sizeof(v));
+        return v;
+    }
+    std::uint32_t v;
+    std::memcpy(&v, base + offset, sizeof(v));
+    return v;
+}
+
+bool DisplayFilter::evaluate(int index, const FrameDescriptor& frame) const
+{
+    const Node& node = tree[static_cast<std::size_t>(index)];
+    switch (node.kind)
+    {
+    case Node::And: return evaluate(node.left, frame) && evaluate(node.right, frame);
+    case Node::Or: return evaluate(node.left, frame) || evaluate(node.right, frame);
+    case Node::Not: return !evaluate(node.left, frame);
+    default: break;
+    }
+
+    const FieldDef* field = findField(node.field);
+    bool present = field->layers == 0;
+    for (std::size_t i = 0; i < frame.layerCount && !present; ++i)
+    {
+        present = (field->layers & layerBit(frame.layers[i].id)) != 0;
+    }
+    if (node.kind == Node::Present) return present;
+
+    auto sideMatches = [&](std::uint16_t offset) {
+        if (field->kind == FieldKind::Bytes)
+        {
+            const auto* base = reinterpret_cast<const std::uint8_t*>(&frame) + offset;
+            std::vector<std::uint8_t> value(base, base + field->width);
+            for (std::size_t i = 0; i < value.size(); ++i) value[i] &= node.mask[i];
+            return value == node.bytes;
+        }
+        const std::uint32_t v = readScalar(frame, *field, offset);
+        switch (node.op)
+        {
+        case DfOp::Lt: return v < node.value;
+        case DfOp::Le: return v <= node.value;
+        case DfOp::Gt: return v > node.value;
+        case DfOp::Ge: return v >= node.value;
+        case DfOp::Test: return (v & node.value) != 0;
+        default: return v == node.value;  // Eq, and Ne before negation
+        }
+    };
+    bool match = present && (sideMatches(field->offset) || (field->other != kNoOffset && sideMatches(field->other)));
+    return node.op == DfOp::Ne ? !match : match;
+}
+
+bool DisplayFilter::reference(const FrameDescriptor& frame) const
+{
+    return root < 0 || evaluate(root, frame);
+}
+
+std::vector<std::string> DisplayFilter::disassemble() const
+{
+    static const char* const kNames[] = {"ld8",  "ld16", "ld32", "ldbit", "ldiplen", "haslayer", "bytes",
+                                         "eq",   "ne",   "lt",   "le",    "gt",      "ge",       "test",
+                                         "and",  "or",   "not",  "ret"};
+    std::vector<std::string> lines;
+    char text[96];
+    for (std::size_t pc = 0; pc < code.size(); ++pc)
+    {
+        const DisplayFilterInsn& in = code[pc];
+        const char* name = in.op < sizeof(kNames) / sizeof(kNames[0]) ? kNames[in.op] : "?";
+        switch (in.op)
+        {
+        case DfOp::Ld8:
+        case DfOp::Ld16:
+        case DfOp::Ld32:
+            std::snprintf(text, sizeof(text), "(%03zu) %-8s r%u, [desc+%u]", pc, name, in.dst, in.arg);
+            break;
+        case DfOp::LdBit:
+            std::snprintf(text, sizeof(text), "(%03zu) %-8s r%u, [desc+%u] & 0x%x", pc, name, in.dst, in.arg, in.b);
+            break;
+        case DfOp::HasLayer:
+            std::snprintf(text, sizeof(text), "(%03zu) %-8s r%u, 0x%x", pc, name, in.dst, in.arg);
+            break;
+        case DfOp::Bytes:
+            std::snprintf(text, sizeof(text), "(%03zu) %-8s r%u, [desc+%u], pool+%u, %u", pc, name, in.dst,
+                          in.arg & 0xFFFF, in.arg >> 16, in.a);
+            break;
+        case DfOp::And:
+        case DfOp::Or:
+            std::snprintf(text, sizeof(text), "(%03zu) %-8s r%u, r%u, r%u", pc, name, in.dst, in.a, in.b);
+            break;
+        case DfOp::Not:
+        case DfOp::Ret:
+        case DfOp::LdIpLen:
+            std::snprintf(text, sizeof(text), "(%03zu) %-8s r%u", pc, name, in.op == DfOp::Ret ? in.a : in.dst);
+            break;
+        default:
+            std::snprintf(text, sizeof(text), "(%03zu) %-8s r%u, r%u, #%u", pc, name, in.dst, in.a, in.arg);
+            break;
+        }
+        lines.emplace_back(text);
+    }
+    return lines;
+}
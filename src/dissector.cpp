@@ -0,0 +1,461 @@
+#include "dissector.h"
+#include "arp.h"
+#include "ipv4.h"
+#include "ipv6.h"
+#include "tcp.h"
+#include "udp.h"
+
+#include <cstdio>
+#include <cstring>
+
+/**
+ * @brief Big-endian loads straight from the buffer (no alignment assumptions).
+ */
+static inline std::uint16_t load16(const std::uint8_t* p)
+{
+    return static_cast<std::uint16_t>((p[0] << 8) | p[1]);
+}
+
+static inline std::uint32_t load32(const std::uint8_t* p)
+{
+    return (static_cast<std::uint32_t>(p[0]) << 24) | (static_cast<std::uint32_t>(p[1]) << 16) |
+           (static_cast<std::uint32_t>(p[2]) << 8) | static_cast<std::uint32_t>(p[3]);
+}
+
+/**
+ * @brief Record a layer at the cursor and move past its header.
+ */
+static inline void pushLayer(DissectCursor& cursor, FrameDescriptor& out, Layer id, std::size_t length)
+{
+    if (cursor.layerCount < FrameDescriptor::kMaxLayers)
+    {
+        out.layers[cursor.layerCount++] = FrameLayer{static_cast<std::uint16_t>(cursor.offset + cursor.bias),
+                                                  static_cast<std::uint16_t>(length), id};
+    }
+    cursor.offset += length;
+}
+
+/**
+ * @brief Point the payload fields at whatever follows the last header.
+ */
+static inline void setPayload(const DissectCursor& cursor, FrameDescriptor& out)
+{
+    out.payloadOffset = static_cast<std::uint16_t>(cursor.offset + cursor.bias);
+    out.payloadSize = static_cast<std::uint16_t>(cursor.end > cursor.offset ? cursor.end - cursor.offset : 0);
+}
+
+const char* layerName(Layer layer)
+{
+    switch (layer)
+    {
+        case Layer::Ethernet: return "Ethernet";
+        case Layer::Vlan: return "802.1Q";
+        case Layer::Arp: return "ARP";
+        case Layer::Ipv4: return "IPv4";
+        case Layer::Ipv6: return "IPv6";
+        case Layer::Icmp: return "ICMP";
+        case Layer::Icmpv6: return "ICMPv6";
+        case Layer::Udp: return "UDP";
+        case Layer::Tcp: return "TCP";
+    }
+    return "?";
+}
+
+bool LinkStage::run(DissectCursor& cursor, FrameDescriptor& out)
+{
+    const std::uint8_t* p = cursor.data + cursor.offset;
+    if (cursor.bias == 0)
+    {
+        if (cursor.size < EthernetII::HeaderSize)
+        {
+            out.flags |= DissectFlag::Truncated;
+            return false;
+        }
+        std::memcpy(out.dstMac, p, 6);
+        std::memcpy(out.srcMac, p + 6, 6);
+        cursor.next = load16(p + 12);
+        pushLayer(cursor, out, Layer::Ethernet, EthernetII::HeaderSize);
+    }
+
+    // 802.1ad outer + 802.1Q inner, or a single 802.1Q tag.
+    std::uint8_t tags = 0;
+    while (cursor.next == EtherTypeVlan::Dot1Q || cursor.next == EtherTypeVlan::Dot1AD)
+    {
+        if (cursor.size - cursor.offset < 4)
+        {
+            out.flags |= DissectFlag::Truncated;
+            return false;
+        }
+        if (tags == 2)
+        {
+            out.flags |= DissectFlag::Malformed;
+            return false;
+        }
+        p = cursor.data + cursor.offset;
+        out.vlan[tags++] = load16(p) & 0x0FFFu;
+        out.vlanCount = tags;
+        cursor.next = load16(p + 2);
+        pushLayer(cursor, out, Layer::Vlan, 4);
+    }
+    out.etherType = cursor.next;
+    setPayload(cursor, out);
+    return true;
+}
+
+/**
+ * @brief IPv4: header length checked against the buffer, payload trimmed to the total length.
+ */
+static bool dissectIpv4(DissectCursor& cursor, FrameDescriptor& out)
+{
+    const std::size_t available = cursor.size - cursor.offset;
+    if (available < kIpv4HeaderSize)
+    {
+        out.flags |= DissectFlag::Truncated;
+        return false;
+    }
+    const std::uint8_t* p = cursor.data + cursor.offset;
+    const std::size_t headerSize = static_cast<std::size_t>(p[0] & 0x0Fu) * 4;
+    const std::size_t totalLength = load16(p + 2);
+    if ((p[0] >> 4) != 4 || headerSize < kIpv4HeaderSize || totalLength < headerSize)
+    {
+        out.flags |= DissectFlag::Malformed;
+        return false;
+    }
+    if (headerSize > available)
+    {
+        out.flags |= DissectFlag::Truncated;
+        return false;
+    }
+
+    out.ipVersion = 4;
+    out.ttl = p[8];
+    out.ipProto = p[9];
+    cursor.next = p[9];
+    out.fragment = load16(p + 6);
+    std::memcpy(out.srcIp, p + 12, 4);
+    std::memcpy(out.dstIp, p + 16, 4);
+    out.l3Offset = static_cast<std::uint16_t>(cursor.offset + cursor.bias);
+
+    if (totalLength > available) out.flags |= DissectFlag::Truncated;
+    else cursor.end = cursor.offset + totalLength;
+    pushLayer(cursor, out, Layer::Ipv4, headerSize);
+    setPayload(cursor, out);
+
+    if ((out.fragment & (kIpv4FlagMoreFragments | kIpv4OffsetMask)) != 0)
+    {
+        out.flags |= DissectFlag::Fragment;
+        return (out.fragment & kIpv4OffsetMask) == 0;  // Only the first fragment has the L4 header
+    }
+    return true;
+}
+
+/**
+ * @brief IPv6 plus the extension headers in front of the upper layer.
+ */
+static bool dissectIpv6(DissectCursor& cursor, FrameDescriptor& out)
+{
+    const std::size_t available = cursor.size - cursor.offset;
+    if (available < kIpv6HeaderSize)
+    {
+        out.flags |= DissectFlag::Truncated;
+        return false;
+    }
+    const std::uint8_t* p = cursor.data + cursor.offset;
+    if ((p[0] >> 4) != 6)
+    {
+        out.flags |= DissectFlag::Malformed;
+        return false;
+    }
+    const std::size_t payloadLength = load16(p + 4);
+    out.ipVersion = 6;
+    out.ttl = p[7];
+    std::uint8_t upper = p[6];
+    std::memcpy(out.srcIp, p + 8, 16);
+    std::memcpy(out.dstIp, p + 24, 16);
+    out.l3Offset = static_cast<std::uint16_t>(cursor.offset + cursor.bias);
+
+    if (kIpv6HeaderSize + payloadLength > available) out.flags |= DissectFlag::Truncated;
+    else cursor.end = cursor.offset + kIpv6HeaderSize + payloadLength;
+
+    // Hop-by-hop, routing, fragment and destination options are all part of the L3 header here.
+    std::size_t headerSize = kIpv6HeaderSize;
+    for (int hops = 0; hops < 8; ++hops)
+    {
+        const std::uint8_t next = upper;
+        if (next != 0 && next != 43 && next != 44 && next != 60) break;
+        const std::uint8_t* ext = p + headerSize;
+        if (headerSize + 8 > available)
+        {
+            out.flags |= DissectFlag::Truncated;
+            out.ipProto = upper;
+            pushLayer(cursor, out, Layer::Ipv6, headerSize);
+            setPayload(cursor, out);
+            return false;
+        }
+        upper = ext[0];
+        if (next == 44)
+        {
+            headerSize += 8;
+            out.flags |= DissectFlag::Fragment;
+            if ((load16(ext + 2) & 0xFFF8u) != 0)
+            {
+                out.ipProto = upper;
+                pushLayer(cursor, out, Layer::Ipv6, headerSize);
+                setPayload(cursor, out);
+                return false;
+            }
+        }
+        else
+        {
+            headerSize += (static_cast<std::size_t>(ext[1]) + 1) * 8;
+        }
+    }
+    out.ipProto = upper;
+    cursor.next = upper;
+    if (headerSize > available)
+    {
+        out.flags |= DissectFlag::Truncated;
+        return false;
+    }
+    pushLayer(cursor, out, Layer::Ipv6, headerSize);
+    setPayload(cursor, out);
+    return true;
+}
+
+static bool dissectArp(DissectCursor& cursor, FrameDescriptor& out)
+{
+    constexpr std::size_t kArpSize = sizeof(ArpHeader) + 2 * 6 + 2 * 4;
+    if (cursor.size - cursor.offset < kArpSize)
+    {
+        out.flags |= DissectFlag::Truncated;
+        return false;
+    }
+    const std::uint8_t* p = cursor.data + cursor.offset;
+    // Only Ethernet/IPv4 ARP: hardware 1, protocol 0x0800, sizes 6 and 4.
+    if (load16(p) != 1 || load16(p + 2) != EtherType::IPv4 || p[4] != 6 || p[5] != 4)
+    {
+        out.flags |= DissectFlag::Malformed;
+        return false;
+    }
+    out.arpOpcode = load16(p + 6);
+    std::memcpy(out.arpSenderMac, p + 8, 6);
+    std::memcpy(out.srcIp, p + 14, 4);
+    std::memcpy(out.arpTargetMac, p + 18, 6);
+    std::memcpy(out.dstIp, p + 24, 4);
+    out.l3Offset = static_cast<std::uint16_t>(cursor.offset + cursor.bias);
+    cursor.end = cursor.offset + kArpSize;
+    pushLayer(cursor, out, Layer::Arp, kArpSize);
+    setPayload(cursor, out);
+    return false;  // Nothing above ARP
+}
+
+bool NetworkStage::run(DissectCursor& cursor, FrameDescriptor& out)
+{
+    switch (cursor.next)
+    {
+        case EtherType::IPv4: return dissectIpv4(cursor, out);
+        case EtherType::IPv6: return dissectIpv6(cursor, out);
+        case EtherType::ARP: return dissectArp(cursor, out);
+        default: return false;
+    }
+}
+
+bool TransportStage::run(DissectCursor& cursor, FrameDescriptor& out)
+{
+    const std::size_t available = (cursor.end > cursor.offset ? cursor.end : cursor.offset) - cursor.offset;
+    const std::uint8_t* p = cursor.data + cursor.offset;
+    const std::uint16_t l4Offset = static_cast<std::uint16_t>(cursor.offset + cursor.bias);
+
+    switch (cursor.next)
+    {
+        case IpProto::ICMP:
+        case IpProto::ICMPv6:
+        {
+            const bool v6 = cursor.next == IpProto::ICMPv6;
+            if ((v6 && out.ipVersion != 6) || (!v6 && out.ipVersion != 4)) return false;
+            if (available < 4)
+            {
+                out.flags |= DissectFlag::Truncated;
+                return false;
+            }
+            out.icmpType = p[0];
+            out.icmpCode = p[1];
+            out.l4Offset = l4Offset;
+            pushLayer(cursor, out, v6 ? Layer::Icmpv6 : Layer::Icmp, 4);
+            break;
+        }
+        case IpProto::UDP:
+        {
+            if (available < sizeof(UdpHeader))
+            {
+                out.flags |= DissectFlag::Truncated;
+                return false;
+            }
+            out.srcPort = load16(p);
+            out.dstPort = load16(p + 2);
+            const std::size_t length = load16(p + 4);
+            if (length >= sizeof(UdpHeader) && length <= available) cursor.end = cursor.offset + length;
+            out.l4Offset = l4Offset;
+            pushLayer(cursor, out, Layer::Udp, sizeof(UdpHeader));
+            break;
+        }
+        case IpProto::TCP:
+        {
+            if (available < sizeof(TcpHeader))
+            {
+                out.flags |= DissectFlag::Truncated;
+                return false;
+            }
+            const std::size_t headerSize = static_cast<std::size_t>(p[12] >> 4) * 4;
+            if (headerSize < sizeof(TcpHeader))
+            {
+                out.flags |= DissectFlag::Malformed;
+                return false;
+            }
+            if (headerSize > available)
+            {
+                out.flags |= DissectFlag::Truncated;
+                return false;
+            }
+            out.srcPort = load16(p);
+            out.dstPort = load16(p + 2);
+            out.tcpSeq = load32(p + 4);
+            out.tcpAck = load32(p + 8);
+            out.tcpFlags = p[13];
+            out.tcpWindow = load16(p + 14);
+            out.l4Offset = l4Offset;
+            pushLayer(cursor, out, Layer::Tcp, headerSize);
+            break;
+        }
+        default:
+            return false;
+    }
+    setPayload(cursor, out);
+    return true;
+}
+
+bool dissectFrame(const std::uint8_t* data, std::size_t size, FrameDescriptor& out)
+{
+    return dissectWith<FullDissector>(data, size, out);
+}
+
+bool dissectEthernetFrame(const EthernetFrame& frame, FrameDescriptor& out)
+{
+    std::memset(&out, 0, sizeof(out));
+    const std::size_t size = EthernetII::HeaderSize + frame.payload.size();
+    if (size > 0xFFFF) return false;
+    out.frameSize = static_cast<std::uint16_t>(size);
+    std::memcpy(out.dstMac, frame.dst.data(), 6);
+    std::memcpy(out.srcMac, frame.src.data(), 6);
+    out.layers[0] = FrameLayer{0, static_cast<std::uint16_t>(EthernetII::HeaderSize), Layer::Ethernet};
+
+    // The payload vector starts right after the Ethernet header: offsets are biased by 14.
+    DissectCursor cursor;
+    cursor.data = frame.payload.data();
+    cursor.size = frame.payload.size();
+    cursor.end = cursor.size;
+    cursor.bias = EthernetII::HeaderSize;
+    cursor.next = frame.etherType;
+    cursor.layerCount = 1;
+    FullDissector::run(cursor, out);
+    return true;
+}
+
+std::string frameProtocolLabel(const FrameDescriptor& frame)
+{
+    if (frame.layerCount == 0) return "?";
+    std::string label;
+    for (std::size_t i = 1; i < frame.layerCount; ++i)
+    {
+        if (!label.empty()) label += '/';
+        label += layerName(frame.layers[i].id);
+    }
+    if (label.empty() || frame.top() == Layer::Vlan)
+    {
+        char text[16];
+        std::snprintf(text, sizeof(text), "0x%04X", frame.etherType);
+        if (!label.empty()) label += '/';
+        label += frame.etherType == EtherType::Demo ? "DEMO" : text;
+    }
+    return label;
+}
+
+static std::string tcpFlagsText(std::uint8_t flags)
+{
+    std::string text;
+    if (flags & TcpFlag::SYN) text += 'S';
+    if (flags & TcpFlag::FIN) text += 'F';
+    if (flags & TcpFlag::RST) text += 'R';
+    if (flags & TcpFlag::PSH) text += 'P';
+    if (flags & TcpFlag::ACK) text += '.';
+    return text.empty() ? "none" : text;
+}
+
+static std::string ipText(const FrameDescriptor& frame, const std::uint8_t* ip)
+{
+    if (frame.ipVersion == 6)
+    {
+        Ipv6Address a;
+        std::memcpy(a.data(), ip, 16);
+        return ipv6ToString(a);
+    }
+    Ipv4Address a;
+    std::memcpy(a.data(), ip, 4);
+    return ipv4ToString(a);
+}
+
+std::string describeFrame(const FrameDescriptor& frame)
+{
+    MacAddress src;
+    MacAddress dst;
+    std::memcpy(src.data(), frame.srcMac, 6);
+    std::memcpy(dst.data(), frame.dstMac, 6);
+    std::string text = macToString(src) + " -> " + macToString(dst) + " " + frameProtocolLabel(frame);
+    if (frame.vlanCount > 0)
+    {
+        text += " vlan=" + std::to_string(frame.vlan[0]);
+        if (frame.vlanCount > 1) text += "." + std::to_string(frame.vlan[1]);
+    }
+
+    if (frame.has(Layer::Arp))
+    {
+        Ipv4Address sender;
+        Ipv4Address target;
+        std::memcpy(sender.data(), frame.srcIp, 4);
+        std::memcpy(target.data(), frame.dstIp, 4);
+        if (frame.arpOpcode == 1) text += " who-has " + ipv4ToString(target) + " tell " + ipv4ToString(sender);
+        else if (frame.arpOpcode == 2)
+        {
+            MacAddress mac;
+            std::memcpy(mac.data(), frame.arpSenderMac, 6);
+            text += " " + ipv4ToString(sender) + " is-at " + macToString(mac);
+        }
+        else text += " op=" + std::to_string(frame.arpOpcode);
+    }
+    else if (frame.ipVersion != 0)
+    {
+        const bool ports = frame.has(Layer::Udp) || frame.has(Layer::Tcp);
+        const bool brackets = ports && frame.ipVersion == 6;  // [2001:db8::1]:80
+        auto endpoint = [&](const std::uint8_t* ip, std::uint16_t port) {
+            std::string address = ipText(frame, ip);
+            if (!ports) return address;
+            if (brackets) address = "[" + address + "]";
+            return address + ":" + std::to_string(port);
+        };
+        text += " " + endpoint(frame.srcIp, frame.srcPort) + " -> " + endpoint(frame.dstIp, frame.dstPort);
+        if (frame.has(Layer::Tcp)) text += " [" + tcpFlagsText(frame.tcpFlags) + "]";
+        if (frame.has(Layer::Icmp) || frame.has(Layer::Icmpv6))
+        {
+            text += " type=" + std::to_string(frame.icmpType) + " code=" + std::to_string(frame.icmpCode);
+        }
+        if (!frame.has(Layer::Udp) && !frame.has(Layer::Tcp) && !frame.has(Layer::Icmp) && !frame.has(Layer::Icmpv6))
+        {
+            text += " proto=" + std::to_string(frame.ipProto);
+        }
+        if (frame.flags & DissectFlag::Fragment) text += " frag";
+    }
+    text += " len=" + std::to_string(frame.payloadSize) + "B";
+    if (frame.flags & DissectFlag::Truncated) text += " [truncado]";
+    if (frame.flags & DissectFlag::Malformed) text += " [malformado]";
+    return text;
+}
@@ -1,8 +1,9 @@
 #include "ethernet.h"
+#include "hex_codec.h"
 
 #include <algorithm>
-#include <cctype>
 #include <cstdio>
+#include <cstring>
 #include <iomanip>
 #include <optional>
 #include <sstream>
@@ -13,103 +14,52 @@
  */
 std::string macToString(const MacAddress& mac)
 {
-    std::ostringstream oss;
-    oss << std::hex << std::setfill('0');
-    for (std::size_t i = 0; i < mac.size(); i++)
-    {
-        if (i) oss << ':';
-        oss << std::setw(2) << static_cast<int>(mac[i]);
-    }
-    return oss.str();
+    std::string out(hexEncodedSize(mac.size(), ':'), '\0');
+    hexEncode(mac.data(), mac.size(), &out[0], ':');
+    return out;
 }
 
 /**
- * @brief True if the character is a hexadecimal digit.
+ * @brief Whitespace as std::istream sees it in the C locale.
  */
-static bool isHexDigit(char c)
+static bool isSpace(char c)
 {
-    return std::isxdigit(static_cast<unsigned char>(c)) != 0;
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
 }
 
-/**
- * @brief Parse a MAC address from a string.
- */
 /**
  * @brief Parse a MAC address from a string (supports "aa:bb:cc:dd:ee:ff" or "aabbccddeeff").
  */
 std::optional<MacAddress> parseMac(std::string_view text)
 {
-    // Convert to string and remove all whitespace
-    std::string s(text);
-    s.erase(std::remove_if(s.begin(), s.end(), [](unsigned char ch) { return std::isspace(ch) != 0; }), s.end());
+    // Whitespace is ignored anywhere. A MAC has 6 bytes of 2 hex digits each:
+    // 12 characters without separators, 12 + 5 colons = 17 with them.
+    char s[17];
+    std::size_t length = 0;
+    for (char c : text)
+    {
+        if (isSpace(c)) continue;
+        if (length == sizeof(s)) return std::nullopt;
+        s[length++] = c;
+    }
 
     MacAddress mac{};
 
-    if (s.size() == 17)
+    if (length == 17)
     {
-        // Parse colon-separated format: aa:bb:cc:dd:ee:ff
-        int outIndex = 0;
-        for (std::size_t i = 0; i < s.size();)
+        // Colon-separated format: aa:bb:cc:dd:ee:ff
+        for (std::size_t i = 0; i < mac.size(); i++)
         {
-
-            /*        
-            Looking at the colon-separated MAC address parsing (the 17-character format `aa:bb:cc:dd:ee:ff`):
-
-            - **`6`** – A MAC address has exactly 6 bytes (12/6 = 2 hex digits per byte)
-            - **`17`** – The string length: 6 bytes × 2 hex digits + 5 colons = `12 + 5 = 17` characters
-            - **`2`** – Each byte is represented by 2 hexadecimal digits
-            - **`12`** – The continuous format (no colons): 6 bytes × 2 hex digits = 12 characters
-
-            The validation checks ensure:
-            1. `outIndex >= 6` – Prevents writing beyond the 6-byte MAC address array
-            2. `i + 1 >= s.size()` – Ensures at least 2 characters remain to read (current hex digit + next hex digit)
-            3. `isHexDigit()` calls – Validates both characters are valid hexadecimal (0-9, a-f, A-F)
-
-            These are standard constraints for parsing a 48-bit MAC address (6 octets).
-            */
-            // Ensure we don't write past 6 bytes
-            if (outIndex >= 6) return std::nullopt;
-            // Ensure at least 2 hex digits remain
-            if (i + 1 >= s.size()) return std::nullopt;
-            // Validate both characters are hex digits
-            if (!isHexDigit(s[i]) || !isHexDigit(s[i + 1])) return std::nullopt;
-            
-            // Convert 2-character hex string to a byte value
-            unsigned int byte = 0;
-            std::stringstream ss;
-            ss << std::hex << s.substr(i, 2);
-            ss >> byte;
-            mac[outIndex++] = static_cast<std::uint8_t>(byte & 0xFFu);
-            i += 2;
-            
-            // Expect a colon separator between pairs (except after the last pair)
-            if (i < s.size())
-            {
-                if (s[i] != ':') return std::nullopt;
-                i++;
-            }
+            if (i + 1 < mac.size() && s[i * 3 + 2] != ':') return std::nullopt;
+            if (!hexDecode(s + i * 3, 1, &mac[i])) return std::nullopt;
         }
         return mac;
     }
 
-    if (s.size() == 12)
+    if (length == 12)
     {
-        // Parse continuous hex format: aabbccddeeff (no separators)
-        for (int outIndex = 0; outIndex < 6; outIndex++)
-        {
-            // Extract two hex digits for each byte
-            const char h0 = s[outIndex * 2 + 0];
-            const char h1 = s[outIndex * 2 + 1];
-            // Validate both are hex digits
-            if (!isHexDigit(h0) || !isHexDigit(h1)) return std::nullopt;
-            
-            // Convert 2-character hex pair to a byte value
-            unsigned int byte = 0;
-            std::stringstream ss;
-            ss << std::hex << s.substr(outIndex * 2, 2);
-            ss >> byte;
-            mac[outIndex] = static_cast<std::uint8_t>(byte & 0xFFu);
-        }
+        // Continuous hex format: aabbccddeeff (no separators)
+        if (!hexDecode(s, mac.size(), mac.data())) return std::nullopt;
         return mac;
     }
 
@@ -143,6 +93,17 @@ std::vector<std::uint8_t> serializeEthernetII(const EthernetFrame& frame)
     return out;
 }
 
+/**
+ * @brief Write dst/src/EtherType in wire order.
+ */
+void writeEthernetHeader(std::uint8_t* out, const MacAddress& dst, const MacAddress& src, std::uint16_t etherType)
+{
+    std::copy_n(dst.begin(), 6, out + 0);
+    std::copy_n(src.begin(), 6, out + 6);
+    out[12] = static_cast<std::uint8_t>((etherType >> 8) & 0xFFu);
+    out[13] = static_cast<std::uint8_t>(etherType & 0xFFu);
+}
+
 /**
  * @brief Parse Ethernet II header fields from a raw buffer.
  */
@@ -179,33 +140,32 @@ std::string toHex(const std::uint8_t* data, std::size_t size, std::size_t maxByt
     if (!data || size == 0) return {};
 
     const std::size_t n = std::min(size, maxBytes);
-    std::ostringstream oss;
-    oss << std::hex << std::setfill('0');
+    std::string out(hexEncodedSize(n, ' '), '\0');
+    if (n > 0) hexEncode(data, n, &out[0], ' ');
 
-    for (std::size_t i = 0; i < n; i++)
-    {
-        if (i) oss << ' ';
-        oss << std::setw(2) << static_cast<int>(data[i]);
-    }
-
-    if (n < size) oss << " ... (" << (size - n) << " more bytes)";
-    return oss.str();
+    if (n < size) out += " ... (" + std::to_string(size - n) + " more bytes)";
+    return out;
 }
 
 /**
- * @brief Strip inline comments (# or //) from a line.
+ * @brief Decode one whitespace-delimited token of a hex file and append it.
+ *
+ * Accepts an optional 0x prefix, ignores punctuation around the digits
+ * ("ff," or "(aa)") and splits runs like "aabbcc" into bytes.
+ * @return false if the token has an odd number of digits or a non-hex character inside.
  */
-static std::string stripComments(const std::string& line)
+static bool appendHexToken(const char* first, const char* last, std::vector<std::uint8_t>& bytes)
 {
-    std::size_t cut = std::string::npos;
-    const auto hash = line.find('#');
-    if (hash != std::string::npos) cut = std::min(cut, hash);
-
-    const auto slashslash = line.find("//");
-    if (slashslash != std::string::npos) cut = std::min(cut, slashslash);
-
-    if (cut == std::string::npos) return line;
-    return line.substr(0, cut);
+    if (last - first >= 2 && first[0] == '0' && (first[1] == 'x' || first[1] == 'X')) first += 2;
+    while (first < last && !isHexDigitChar(last[-1])) --last;
+    while (first < last && !isHexDigitChar(*first)) ++first;
+    if (first == last) return true;
+
+    const std::size_t digits = static_cast<std::size_t>(last - first);
+    if (digits % 2 != 0) return false;
+    const std::size_t at = bytes.size();
+    bytes.resize(at + digits / 2);
+    return hexDecode(first, digits / 2, bytes.data() + at);
 }
 
 /**
@@ -214,48 +174,36 @@ static std::string stripComments(const std::string& line)
 std::optional<std::vector<std::uint8_t>> parseHexBytesFile(const std::string& fileContent)
 {
     std::vector<std::uint8_t> bytes;
+    bytes.reserve(fileContent.size() / 3 + 1);  // "aa " per byte at most
 
-    std::istringstream in(fileContent);
-    std::string line;
-    while (std::getline(in, line))
+    const char* p = fileContent.data();
+    const char* const end = p + fileContent.size();
+    while (p < end)
     {
-        line = stripComments(line);
-        std::istringstream iss(line);
-        std::string tok;
-        while (iss >> tok)
-        {
-            if (tok.rfind("0x", 0) == 0 || tok.rfind("0X", 0) == 0) tok = tok.substr(2);
-            if (tok.empty()) continue;
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+        if (!eol) eol = end;
 
-            // Allow tokens like "ff," by stripping trailing punctuation.
-            while (!tok.empty() && !isHexDigit(tok.back())) tok.pop_back();
-            while (!tok.empty() && !isHexDigit(tok.front())) tok.erase(tok.begin());
-            if (tok.empty()) continue;
-
-            if (tok.size() != 2)
+        // Inline comments (# or //) run to the end of the line.
+        const char* lineEnd = eol;
+        for (const char* c = p; c < eol; ++c)
+        {
+            if (*c == '#' || (*c == '/' && c + 1 < eol && c[1] == '/'))
             {
-                // Support aabbcc... groups by splitting into pairs.
-                if (tok.size() % 2 != 0) return std::nullopt;
-                for (std::size_t i = 0; i < tok.size(); i += 2)
-                {
-                    const std::string byteStr = tok.substr(i, 2);
-                    if (!isHexDigit(byteStr[0]) || !isHexDigit(byteStr[1])) return std::nullopt;
-                    unsigned int v = 0;
-                    std::stringstream ss;
-                    ss << std::hex << byteStr;
-                    ss >> v;
-                    bytes.push_back(static_cast<std::uint8_t>(v & 0xFFu));
-                }
-                continue;
+                lineEnd = c;
+                break;
             }
+        }
 
-            if (!isHexDigit(tok[0]) || !isHexDigit(tok[1])) return std::nullopt;
-            unsigned int v = 0;
-            std::stringstream ss;
-            ss << std::hex << tok;
-            ss >> v;
-            bytes.push_back(static_cast<std::uint8_t>(v & 0xFFu));
+        const char* tok = p;
+        while (tok < lineEnd)
+        {
+            while (tok < lineEnd && isSpace(*tok)) ++tok;
+            const char* tokEnd = tok;
+            while (tokEnd < lineEnd && !isSpace(*tokEnd)) ++tokEnd;
+            if (tok < tokEnd && !appendHexToken(tok, tokEnd, bytes)) return std::nullopt;
+            tok = tokEnd;
         }
+        p = eol + 1;
     }
 
     if (bytes.empty()) return std::nullopt;
@@ -0,0 +1,167 @@
+#include "event_log.h"
+
+#include <cstring>
+
+static Ipv4Address ipv4At(const std::uint8_t* bytes)
+{
+    Ipv4Address ip;
+    std::memcpy(ip.data(), bytes, ip.size());
+    return ip;
+}
+
+static MacAddress macAt(const std::uint8_t* bytes)
+{
+    MacAddress mac;
+    std::memcpy(mac.data(), bytes, mac.size());
+    return mac;
+}
+
+// ---------------------------------------------------------------------------
+// Recording (RX path: plain stores only)
+// ---------------------------------------------------------------------------
+
+EventRecord makeRxEvent(const FrameDescriptor& frame, std::int64_t timestampNs)
+{
+    EventRecord event;
+    std::memset(&event, 0, sizeof(event));
+    event.timestampNs = timestampNs;
+    event.kind = EventKind::RxFrame;
+    event.layerCount = frame.layerCount;
+    event.flags = frame.flags;
+    event.ipVersion = frame.ipVersion;
+    for (std::size_t i = 0; i < frame.layerCount; ++i) event.layers[i] = frame.layers[i].id;
+    event.vlanCount = frame.vlanCount;
+    event.ipProto = frame.ipProto;
+    event.tcpFlags = frame.tcpFlags;
+    event.icmpType = frame.icmpType;
+    event.icmpCode = frame.icmpCode;
+    event.etherType = frame.etherType;
+    event.payloadSize = frame.payloadSize;
+    event.srcPort = frame.srcPort;
+    event.dstPort = frame.dstPort;
+    event.arpOpcode = frame.arpOpcode;
+    event.vlan[0] = frame.vlan[0];
+    event.vlan[1] = frame.vlan[1];
+    std::memcpy(event.srcMac, frame.srcMac, sizeof(event.srcMac));
+    std::memcpy(event.dstMac, frame.dstMac, sizeof(event.dstMac));
+    std::memcpy(event.arpSenderMac, frame.arpSenderMac, sizeof(event.arpSenderMac));
+    std::memcpy(event.srcIp, frame.srcIp, sizeof(event.srcIp));
+    std::memcpy(event.dstIp, frame.dstIp, sizeof(event.dstIp));
+    return event;
+}
+
+EventRecord makeRxRawEvent(std::size_t size, std::int64_t timestampNs)
+{
+    EventRecord event;
+    std::memset(&event, 0, sizeof(event));
+    event.timestampNs = timestampNs;
+    event.kind = EventKind::RxRaw;
+    event.value = static_cast<std::int32_t>(size);
+    return event;
+}
+
+EventRecord makeArpEvent(EventKind kind, const Ipv4Address& sender, const Ipv4Address& target,
+                         const MacAddress& mac, std::int64_t timestampNs, int sent)
+{
+    EventRecord event;
+    std::memset(&event, 0, sizeof(event));
+    event.timestampNs = timestampNs;
+    event.kind = kind;
+    event.value = sent;
+    event.etherType = EtherType::ARP;
+    std::memcpy(event.srcIp, sender.data(), sender.size());
+    std::memcpy(event.dstIp, target.data(), target.size());
+    std::memcpy(event.arpSenderMac, mac.data(), mac.size());
+    return event;
+}
+
+// ---------------------------------------------------------------------------
+// Formatting (only for rows that are drawn)
+// ---------------------------------------------------------------------------
+
+LogTag eventTag(const EventRecord& event)
+{
+    switch (event.kind)
+    {
+    case EventKind::RxFrame:
+    case EventKind::RxRaw:
+        return LogTag::Rx;
+    case EventKind::ArpRequest:
+    case EventKind::ArpReply:
+        return LogTag::Info;
+    case EventKind::ArpFastReply:
+        return LogTag::Tx;
+    }
+    return LogTag::None;
+}
+
+bool eventIsArp(const EventRecord& event)
+{
+    return event.kind != EventKind::RxRaw && event.etherType == EtherType::ARP;
+}
+
+void formatEvent(const EventRecord& event, std::string& out)
+{
+    switch (event.kind)
+    {
+    case EventKind::RxFrame:
+    {
+        // describeFrame() only reads the fields the record keeps; offsets stay 0.
+        FrameDescriptor frame;
+        std::memset(&frame, 0, sizeof(frame));
+        frame.layerCount = event.layerCount;
+        frame.flags = event.flags;
+        frame.ipVersion = event.ipVersion;
+        for (std::size_t i = 0; i < event.layerCount; ++i) frame.layers[i].id = event.layers[i];
+        frame.vlanCount = event.vlanCount;
+        frame.ipProto = event.ipProto;
+        frame.tcpFlags = event.tcpFlags;
+        frame.icmpType = event.icmpType;
+        frame.icmpCode = event.icmpCode;
+        frame.etherType = event.etherType;
+        frame.payloadSize = event.payloadSize;
+        frame.srcPort = event.srcPort;
+        frame.dstPort = event.dstPort;
+        frame.arpOpcode = event.arpOpcode;
+        frame.vlan[0] = event.vlan[0];
+        frame.vlan[1] = event.vlan[1];
+        std::memcpy(frame.srcMac, event.srcMac, sizeof(frame.srcMac));
+        std::memcpy(frame.dstMac, event.dstMac, sizeof(frame.dstMac));
+        std::memcpy(frame.arpSenderMac, event.arpSenderMac, sizeof(frame.arpSenderMac));
+        std::memcpy(frame.srcIp, event.srcIp, sizeof(frame.srcIp));
+        std::memcpy(frame.dstIp, event.dstIp, sizeof(frame.dstIp));
+        out = describeFrame(frame);
+        return;
+    }
+    case EventKind::RxRaw:
+        out = std::to_string(event.value) + " bytes (raw)";
+        return;
+    case EventKind::ArpRequest:
+        out = "ARP REQ: who-has " + ipv4ToString(ipv4At(event.dstIp)) + " tell " + ipv4ToString(ipv4At(event.srcIp));
+        return;
+    case EventKind::ArpReply:
+        out = "ARP REP: " + ipv4ToString(ipv4At(event.srcIp)) + " is-at " + macToString(macAt(event.arpSenderMac));
+        return;
+    case EventKind::ArpFastReply:
+        out = "ARP Reply (fast path): " + ipv4ToString(ipv4At(event.dstIp)) + " is-at " +
+              macToString(macAt(event.arpSenderMac)) + " -> " +
+              (event.value > 0 ? "TX OK (" + std::to_string(event.value) + " bytes)" : std::string("TX ERROR"));
+        return;
+    }
+    out.clear();
+}
+
+std::string eventArpSummary(const EventRecord& event)
+{
+    switch (event.kind)
+    {
+    case EventKind::ArpRequest:
+        return "REQ who-has " + ipv4ToString(ipv4At(event.dstIp)) + " tell " + ipv4ToString(ipv4At(event.srcIp));
+    case EventKind::ArpReply:
+        return "REP " + ipv4ToString(ipv4At(event.srcIp)) + " is-at " + macToString(macAt(event.arpSenderMac));
+    case EventKind::ArpFastReply:
+        return "REP " + ipv4ToString(ipv4At(event.dstIp)) + " is-at " + macToString(macAt(event.arpSenderMac));
+    default:
+        return "-";
+    }
+}
@@ -0,0 +1,61 @@
+#include "file_watcher.h"
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+FileWatcher::~FileWatcher()
+{
+    close();
+}
+
+void FileWatcher::close()
+{
+    if (inotifyFd >= 0) ::close(inotifyFd);
+    inotifyFd = -1;
+    fileName.clear();
+}
+
+bool FileWatcher::watch(const std::filesystem::path& file, std::string& error)
+{
+    close();
+    const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+    {
+        error = std::string("inotify_init1: ") + std::strerror(errno);
+        return false;
+    }
+    const std::filesystem::path directory = file.has_parent_path() ? file.parent_path() : ".";
+    if (inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        error = "inotify_add_watch " + directory.string() + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    inotifyFd = fd;
+    fileName = file.filename().string();
+    return true;
+}
+
+bool FileWatcher::changed()
+{
+    if (inotifyFd < 0) return false;
+
+    bool hit = false;
+    alignas(struct inotify_event) char buffer[4096];
+    for (;;)
+    {
+        const ssize_t n = ::read(inotifyFd, buffer, sizeof(buffer));
+        if (n <= 0) break;  // EAGAIN: drained
+        for (ssize_t pos = 0; pos < n;)
+        {
+            const auto* event = reinterpret_cast<const struct inotify_event*>(buffer + pos);
+            // Events about the directory itself carry no name; after an overflow, assume the worst.
+            if ((event->mask & IN_Q_OVERFLOW) || (event->len > 0 && fileName == event->name)) hit = true;
+            pos += static_cast<ssize_t>(sizeof(struct inotify_event) + event->len);
+        }
+    }
+    return hit;
+}
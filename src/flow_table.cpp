@@ -0,0 +1,422 @@
+#include "flow_table.h"
+
+#include "ipv4.h"
+#include "ipv6.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <queue>
+#include <sys/mman.h>
+
+FlowKey makeFlowKey(const FrameDescriptor& frame)
+{
+    FlowKey key;
+    std::memset(&key, 0, sizeof(key));
+    if (frame.layerCount == 0) return key;
+
+    if (frame.ipVersion == 4 || frame.ipVersion == 6)
+    {
+        const std::size_t addressSize = frame.ipVersion == 4 ? 4 : 16;
+        std::memcpy(key.src, frame.srcIp, addressSize);
+        std::memcpy(key.dst, frame.dstIp, addressSize);
+        key.family = frame.ipVersion == 4 ? FlowFamily::Ipv4 : FlowFamily::Ipv6;
+        key.proto = frame.ipProto;
+        if (frame.has(Layer::Tcp) || frame.has(Layer::Udp))
+        {
+            key.srcPort = frame.srcPort;
+            key.dstPort = frame.dstPort;
+        }
+        else if (frame.has(Layer::Icmp) || frame.has(Layer::Icmpv6))
+        {
+            key.dstPort = static_cast<std::uint16_t>((frame.icmpType << 8) | frame.icmpCode);
+        }
+        return key;
+    }
+
+    // ARP and anything else without an IP header: the MAC pair is the conversation.
+    std::memcpy(key.src, frame.srcMac, 6);
+    std::memcpy(key.dst, frame.dstMac, 6);
+    key.dstPort = frame.etherType;
+    key.family = FlowFamily::Link;
+    return key;
+}
+
+static bool sameKey(const FlowKey& stored, const std::uint64_t* words)
+{
+    std::uint64_t x[5];
+    std::memcpy(x, &stored, sizeof(x));
+    return ((x[0] ^ words[0]) | (x[1] ^ words[1]) | (x[2] ^ words[2]) | (x[3] ^ words[3]) | (x[4] ^ words[4])) == 0;
+}
+
+FlowTable::SlotArray::SlotArray(std::size_t slotCount)
+{
+    const std::size_t bytes = slotCount * sizeof(FlowEntry);
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    madvise(memory, bytes, MADV_HUGEPAGE);  // Best effort; THP may be disabled
+#endif
+    base = static_cast<FlowEntry*>(memory);  // Anonymous pages are zero: every slot starts empty
+    count = slotCount;
+}
+
+FlowTable::SlotArray::~SlotArray()
+{
+    if (base) munmap(base, count * sizeof(FlowEntry));
+}
+
+std::size_t FlowTable::slotsFor(std::size_t memoryBytes)
+{
+    std::size_t slotCount = 64;
+    while (slotCount * 2 * sizeof(FlowEntry) <= memoryBytes) slotCount <<= 1;
+    return slotCount;
+}
+
+FlowTable::FlowTable(const FlowConfig& config) : cfg(config), slots(slotsFor(config.memoryBytes)), epoch(Clock::now())
+{
+    mask = slots.size() - 1;
+    limit = slots.size() / 4 * 3;  // Linear probing degrades quickly past ~75% load
+    if (cfg.sweepSlots == 0) cfg.sweepSlots = 1;
+}
+
+/**
+ * @brief 64x64 -> 128 multiply folded to 64 bits (the wyhash mixing step).
+ */
+static std::uint64_t mix(std::uint64_t a, std::uint64_t b)
+{
+    const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    return static_cast<std::uint64_t>(product) ^ static_cast<std::uint64_t>(product >> 64);
+}
+
+std::uint64_t FlowTable::hashOf(const std::uint64_t* words)
+{
+    // Tag excluded: lookups hash before they know it. The three multiplies are
+    // independent, so the hash costs about one multiply of latency, not five.
+    const std::uint64_t last = words[4] & 0x0000FFFFFFFFFFFFull;
+    const std::uint64_t a = mix(words[0] ^ 0xA0761D6478BD642Full, words[1] ^ 0xE7037ED1A0B428DBull);
+    const std::uint64_t b = mix(words[2] ^ 0x8EBC6AF09C88C6E3ull, words[3] ^ 0x589965CC75374CC3ull);
+    const std::uint64_t c = mix(last ^ 0x1D8E4E27C47D124Full, 0x9E3779B97F4A7C15ull);
+    return mix(a ^ c, b ^ 0xE7037ED1A0B428DBull);
+}
+
+FlowTable::Probe FlowTable::probeFor(const FlowKey& key) const
+{
+    // Loaded once as words, tag merged arithmetically: building a FlowKey copy
+    // with a 2-byte tag store and reading it back as words stalls store forwarding.
+    Probe probe;
+    std::memcpy(probe.words, &key, sizeof(probe.words));
+    const std::uint64_t h = hashOf(probe.words);
+    probe.words[4] = (probe.words[4] & 0x0000FFFFFFFFFFFFull) | (h & 0xFFFF000000000000ull);
+    probe.home = static_cast<std::size_t>(h) & mask;
+    return probe;
+}
+
+std::uint32_t FlowTable::toMs(Clock::time_point now) const
+{
+    if (now <= epoch) return 0;
+    return static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now - epoch).count());
+}
+
+std::size_t FlowTable::slotOf(const Probe& probe) const
+{
+    for (std::size_t i = probe.home;; i = (i + 1) & mask)
+    {
+        const FlowEntry& entry = slots[i];
+        if (entry.key.family == 0) return slots.size();
+        if (sameKey(entry.key, probe.words)) return i;
+    }
+}
+
+FlowEntry* FlowTable::insertAt(const Probe& probe, std::uint32_t nowMs)
+{
+    const std::size_t home = probe.home;
+    std::size_t slot = slots.size();
+    if (count >= limit)
+    {
+        // Full: replace the least recently seen of the first few entries on this
+        // key's own probe path. The slot stays occupied, so no other key's path
+        // changes and no backward shift is needed.
+        static constexpr std::size_t kCandidates = 8;
+        std::size_t victim = slots.size();
+        std::uint32_t oldestAge = 0;
+        for (std::size_t i = home, n = 0; n < kCandidates && slots[i].key.family != 0; i = (i + 1) & mask, ++n)
+        {
+            const std::uint32_t age = nowMs - slots[i].lastSeenMs;
+            if (victim == slots.size() || age > oldestAge)
+            {
+                victim = i;
+                oldestAge = age;
+            }
+        }
+        if (victim != slots.size())
+        {
+            slot = victim;
+            --count;
+            ++counters.evicted;
+        }
+        else
+        {
+            evictNear(home, nowMs);  // Home slot empty: make room elsewhere
+        }
+    }
+    if (slot == slots.size())
+    {
+        slot = home;
+        while (slots[slot].key.family != 0) slot = (slot + 1) & mask;
+    }
+
+    FlowEntry& entry = slots[slot];
+    std::memcpy(&entry.key, probe.words, sizeof(entry.key));
+    entry.packets = 0;
+    entry.bytes = 0;
+    entry.firstSeenMs = nowMs;
+    entry.lastSeenMs = nowMs;
+    ++count;
+    ++counters.created;
+    return &entry;
+}
+
+FlowEntry* FlowTable::updateProbe(const Probe& probe, std::uint32_t bytes, std::uint32_t nowMs)
+{
+    const std::size_t slot = slotOf(probe);
+    FlowEntry* entry = slot != slots.size() ? &slots[slot] : insertAt(probe, nowMs);
+    ++entry->packets;
+    entry->bytes += bytes;
+    entry->lastSeenMs = nowMs;
+    ++counters.updates;
+    return entry;
+}
+
+FlowEntry* FlowTable::update(const FlowKey& key, std::uint32_t bytes, Clock::time_point now)
+{
+    if (key.family == 0)
+    {
+        ++counters.ignored;
+        return nullptr;
+    }
+    return updateProbe(probeFor(key), bytes, toMs(now));
+}
+
+FlowEntry* FlowTable::update(const FrameDescriptor& frame, Clock::time_point now)
+{
+    return update(makeFlowKey(frame), frame.frameSize, now);
+}
+
+void FlowTable::updateBatch(const FlowKey* keys, const std::uint32_t* bytes, std::size_t total, Clock::time_point now)
+{
+    // Software pipeline: the home slot of frame i + kDistance is prefetched while
+    // frame i is updated, so DRAM misses overlap instead of queueing.
+    static constexpr std::size_t kDistance = 8;
+    Probe probes[kDistance];
+    const std::uint32_t nowMs = toMs(now);
+
+    const std::size_t lead = std::min(kDistance, total);
+    for (std::size_t i = 0; i < lead; ++i)
+    {
+        probes[i] = probeFor(keys[i]);
+        __builtin_prefetch(&slots[probes[i].home], 1);
+    }
+    for (std::size_t i = 0; i < total; ++i)
+    {
+        const Probe probe = probes[i % kDistance];
+        if (i + kDistance < total)
+        {
+            Probe& ahead = probes[i % kDistance];
+            ahead = probeFor(keys[i + kDistance]);
+            __builtin_prefetch(&slots[ahead.home], 1);
+        }
+        if (keys[i].family == 0)
+        {
+            ++counters.ignored;
+            continue;
+        }
+        updateProbe(probe, bytes[i], nowMs);
+    }
+}
+
+const FlowEntry* FlowTable::find(const FlowKey& key) const
+{
+    if (key.family == 0) return nullptr;
+    const std::size_t slot = slotOf(probeFor(key));
+    return slot == slots.size() ? nullptr : &slots[slot];
+}
+
+void FlowTable::eraseSlot(std::size_t slot)
+{
+    // Backward shift, as in NeighborCache::eraseSlot.
+    std::size_t hole = slot;
+    for (std::size_t i = (hole + 1) & mask;; i = (i + 1) & mask)
+    {
+        if (slots[i].key.family == 0) break;
+        std::uint64_t words[5];
+        std::memcpy(words, &slots[i].key, sizeof(words));
+        const std::size_t h = static_cast<std::size_t>(hashOf(words)) & mask;
+        const bool movable = hole <= i ? (h <= hole || h > i) : (h <= hole && h > i);
+        if (!movable) continue;
+        slots[hole] = slots[i];
+        hole = i;
+    }
+    slots[hole].key.family = 0;
+    --count;
+}
+
+void FlowTable::evictNear(std::size_t home, std::uint32_t nowMs)
+{
+    // Home slot is free but the table is at its limit: erase the least recently
+    // seen of the next few entries (bounded work). The shift stays behind the
+    // free home slot, so the caller can still insert there.
+    static constexpr std::size_t kCandidates = 8;
+    std::size_t victim = slots.size();
+    std::uint32_t oldestAge = 0;
+    std::size_t seen = 0;
+    for (std::size_t i = home; seen < kCandidates && seen < count; i = (i + 1) & mask)
+    {
+        if (slots[i].key.family == 0) continue;
+        ++seen;
+        const std::uint32_t age = nowMs - slots[i].lastSeenMs;
+        if (victim == slots.size() || age > oldestAge)
+        {
+            victim = i;
+            oldestAge = age;
+        }
+    }
+    if (victim == slots.size()) return;
+    eraseSlot(victim);
+    ++counters.evicted;
+}
+
+std::size_t FlowTable::expire(Clock::time_point now)
+{
+    const std::uint32_t nowMs = toMs(now);
+    const auto timeout = static_cast<std::uint32_t>(cfg.idleTimeout.count());
+    std::size_t removed = 0;
+    for (std::size_t n = 0; n < cfg.sweepSlots && count > 0; ++n)
+    {
+        FlowEntry& entry = slots[sweepCursor];
+        if (entry.key.family != 0 && nowMs - entry.lastSeenMs >= timeout)
+        {
+            // The shift may pull a later entry into this slot: look at it again.
+            eraseSlot(sweepCursor);
+            ++removed;
+            continue;
+        }
+        sweepCursor = (sweepCursor + 1) & mask;
+    }
+    counters.expired += removed;
+    return removed;
+}
+
+void FlowTable::clear()
+{
+    for (auto& entry : slots) entry.key.family = 0;
+    count = 0;
+    sweepCursor = 0;
+}
+
+std::vector<FlowEntry> FlowTable::topFlows(std::size_t wanted) const
+{
+    std::vector<FlowEntry> top;
+    if (wanted == 0) return top;
+
+    // Min-heap of the best `wanted` seen so far: one pass, no copy of the table.
+    auto byBytes = [](const FlowEntry* a, const FlowEntry* b) { return a->bytes > b->bytes; };
+    std::priority_queue<const FlowEntry*, std::vector<const FlowEntry*>, decltype(byBytes)> heap(byBytes);
+    for (const auto& entry : slots)
+    {
+        if (entry.key.family == 0) continue;
+        if (heap.size() < wanted) heap.push(&entry);
+        else if (entry.bytes > heap.top()->bytes)
+        {
+            heap.pop();
+            heap.push(&entry);
+        }
+    }
+    top.resize(heap.size());
+    for (std::size_t i = top.size(); i-- > 0;)
+    {
+        top[i] = *heap.top();
+        heap.pop();
+    }
+    return top;
+}
+
+static std::string flowProtoName(const FlowKey& key)
+{
+    if (key.family == FlowFamily::Link)
+    {
+        char text[8];
+        std::snprintf(text, sizeof(text), "0x%04X", key.dstPort);
+        return key.dstPort == EtherType::ARP ? "ARP" : text;
+    }
+    switch (key.proto)
+    {
+        case IpProto::TCP: return "TCP";
+        case IpProto::UDP: return "UDP";
+        case IpProto::ICMP: return "ICMP";
+        case IpProto::ICMPv6: return "ICMPv6";
+        default: return "IP/" + std::to_string(key.proto);
+    }
+}
+
+static std::string flowEndpoint(const FlowKey& key, const std::uint8_t* address, std::uint16_t port, bool withPort)
+{
+    std::string text;
+    if (key.family == FlowFamily::Ipv4)
+    {
+        Ipv4Address ip;
+        std::memcpy(ip.data(), address, 4);
+        text = ipv4ToString(ip);
+    }
+    else if (key.family == FlowFamily::Ipv6)
+    {
+        Ipv6Address ip;
+        std::memcpy(ip.data(), address, 16);
+        text = ipv6ToString(ip);
+        if (withPort) text = "[" + text + "]";
+    }
+    else
+    {
+        MacAddress mac;
+        std::memcpy(mac.data(), address, 6);
+        return macToString(mac);
+    }
+    return withPort ? text + ":" + std::to_string(port) : text;
+}
+
+static std::string humanBytes(std::uint64_t bytes)
+{
+    char text[32];
+    if (bytes >= (1ull << 30)) std::snprintf(text, sizeof(text), "%.1fG", bytes / double(1ull << 30));
+    else if (bytes >= (1ull << 20)) std::snprintf(text, sizeof(text), "%.1fM", bytes / double(1ull << 20));
+    else if (bytes >= (1ull << 10)) std::snprintf(text, sizeof(text), "%.1fK", bytes / double(1ull << 10));
+    else std::snprintf(text, sizeof(text), "%lluB", static_cast<unsigned long long>(bytes));
+    return text;
+}
+
+std::vector<std::string> formatTopFlows(const FlowTable& table, std::size_t count, FlowTable::Clock::time_point now)
+{
+    const auto top = table.topFlows(count);
+    const std::uint32_t nowMs = table.toMs(now);
+    std::vector<std::string> lines;
+    lines.reserve(top.size() + 1);
+    lines.push_back("PROTO ORIGEN -> DESTINO PAQ BYTES (duracion s / inactivo s)");
+    for (const auto& flow : top)
+    {
+        const FlowKey& key = flow.key;
+        const bool ports = key.family != FlowFamily::Link && (key.proto == IpProto::TCP || key.proto == IpProto::UDP);
+        std::string line = flowProtoName(key) + " " + flowEndpoint(key, key.src, key.srcPort, ports) + " -> " +
+                           flowEndpoint(key, key.dst, key.dstPort, ports);
+        if (key.family != FlowFamily::Link && (key.proto == IpProto::ICMP || key.proto == IpProto::ICMPv6))
+        {
+            line += " type=" + std::to_string(key.dstPort >> 8) + "/" + std::to_string(key.dstPort & 0xFF);
+        }
+        line += " " + std::to_string(flow.packets) + " " + humanBytes(flow.bytes) + " (" +
+                std::to_string((flow.lastSeenMs - flow.firstSeenMs) / 1000) + " / " +
+                std::to_string((nowMs - flow.lastSeenMs) / 1000) + ")";
+        lines.push_back(line);
+    }
+    return lines;
+}
@@ -0,0 +1,62 @@
+#include "frame_history.h"
+
+#include <algorithm>
+#include <cstring>
+
+FrameHistory::FrameHistory(std::size_t maxFrames, std::size_t maxBytes)
+    : arena(std::max<std::size_t>(maxBytes, 1)), entries(std::max<std::size_t>(maxFrames, 1))
+{
+}
+
+void FrameHistory::evictOldest()
+{
+    bytesKept -= entries[oldestSeq % entries.size()].size;
+    ++oldestSeq;
+}
+
+bool FrameHistory::push(FrameDirection direction, const std::uint8_t* data, std::size_t length, std::int64_t timestampNs)
+{
+    const std::uint64_t arenaSize = arena.size();
+    if (length == 0 || length > arenaSize) return false;
+
+    // Frames are contiguous in the arena: skip the tail if this one does not fit before the end.
+    std::uint64_t position = writePosition;
+    const std::uint64_t offset = position % arenaSize;
+    if (offset + length > arenaSize) position += arenaSize - offset;
+    const std::uint64_t end = position + length;
+
+    // A frame survives while it starts within the last arenaSize bytes written.
+    while (!empty() && (size() == entries.size() || entries[oldestSeq % entries.size()].position + arenaSize < end))
+    {
+        evictOldest();
+    }
+
+    std::memcpy(arena.data() + position % arenaSize, data, length);
+    Entry& entry = entries[nextSeq % entries.size()];
+    entry.position = position;
+    entry.timestampNs = timestampNs;
+    entry.size = static_cast<std::uint32_t>(length);
+    entry.direction = direction;
+    ++nextSeq;
+    writePosition = end;
+    bytesKept += length;
+    return true;
+}
+
+bool FrameHistory::get(std::uint64_t seq, HistoryFrame& out) const
+{
+    if (seq < oldestSeq || seq >= nextSeq) return false;
+    const Entry& entry = entries[seq % entries.size()];
+    out.seq = seq;
+    out.timestampNs = entry.timestampNs;
+    out.data = arena.data() + entry.position % arena.size();
+    out.size = entry.size;
+    out.direction = entry.direction;
+    return true;
+}
+
+void FrameHistory::clear()
+{
+    oldestSeq = nextSeq;
+    bytesKept = 0;
+}
@@ -0,0 +1,373 @@
+#include "hex_codec.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NETGUI_HEX_X86 1
+#endif
+
+// ---------------------------------------------------------------------------
+// Tables
+// ---------------------------------------------------------------------------
+
+// Both tables are constant expressions, so they are ready before any dynamic
+// initializer (the benchmark fixtures) runs.
+const std::array<std::uint8_t, 256> kHexDigitValue = [] {
+    std::array<std::uint8_t, 256> table{};
+    for (auto& v : table) v = 0xFF;
+    for (int i = 0; i < 10; ++i) table['0' + i] = static_cast<std::uint8_t>(i);
+    for (int i = 0; i < 6; ++i)
+    {
+        table['a' + i] = static_cast<std::uint8_t>(10 + i);
+        table['A' + i] = static_cast<std::uint8_t>(10 + i);
+    }
+    return table;
+}();
+
+static constexpr char kHexDigits[] = "0123456789abcdef";
+
+/**
+ * @brief Both digits of every byte value, so encoding is one 16-bit copy per byte.
+ */
+static const std::array<char, 512> kHexPairs = [] {
+    std::array<char, 512> table{};
+    for (int i = 0; i < 256; ++i)
+    {
+        table[i * 2] = kHexDigits[i >> 4];
+        table[i * 2 + 1] = kHexDigits[i & 0x0F];
+    }
+    return table;
+}();
+
+// ---------------------------------------------------------------------------
+// Scalar
+// ---------------------------------------------------------------------------
+
+static char* encodeScalar(const std::uint8_t* data, std::size_t size, char* out, char separator)
+{
+    if (!separator)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            std::memcpy(out, &kHexPairs[data[i] * 2], 2);
+            out += 2;
+        }
+        return out;
+    }
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        if (i) *out++ = separator;
+        std::memcpy(out, &kHexPairs[data[i] * 2], 2);
+        out += 2;
+    }
+    return out;
+}
+
+static bool decodeScalar(const char* text, std::size_t pairs, std::uint8_t* out)
+{
+    for (std::size_t i = 0; i < pairs; ++i)
+    {
+        const std::uint8_t hi = kHexDigitValue[static_cast<unsigned char>(text[i * 2])];
+        const std::uint8_t lo = kHexDigitValue[static_cast<unsigned char>(text[i * 2 + 1])];
+        if ((hi | lo) & 0xF0) return false;  // 0xFF marks a non-digit
+        out[i] = static_cast<std::uint8_t>((hi << 4) | lo);
+    }
+    return true;
+}
+
+#if NETGUI_HEX_X86
+// ---------------------------------------------------------------------------
+// SSSE3
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief 16 bytes -> 32 digits in two registers (pshufb looks up each nibble).
+ */
+__attribute__((target("ssse3"))) static inline void encodeBlockSsse3(__m128i v, __m128i& first, __m128i& second)
+{
+    const __m128i digits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(kHexDigits));
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+    const __m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(v, mask));
+    first = _mm_unpacklo_epi8(hi, lo);
+    second = _mm_unpackhi_epi8(hi, lo);
+}
+
+/**
+ * @brief Output of one separated block: 16 bytes -> 48 characters, each byte's
+ * two digits followed by the separator. Character p belongs to byte p / 3;
+ * these pick it from the interleaved digit pairs (-1 = separator slot or the
+ * other source register).
+ */
+#define HEX_SEP_INDEX(p, base) \
+    static_cast<char>(((p) % 3 == 2 || ((p) / 3 * 2 + (p) % 3) / 16 != (base)) ? -1 : ((p) / 3 * 2 + (p) % 3) % 16)
+#define HEX_SEP_ROW(start, base)                                                                             \
+    HEX_SEP_INDEX(start + 0, base), HEX_SEP_INDEX(start + 1, base), HEX_SEP_INDEX(start + 2, base),          \
+        HEX_SEP_INDEX(start + 3, base), HEX_SEP_INDEX(start + 4, base), HEX_SEP_INDEX(start + 5, base),      \
+        HEX_SEP_INDEX(start + 6, base), HEX_SEP_INDEX(start + 7, base), HEX_SEP_INDEX(start + 8, base),      \
+        HEX_SEP_INDEX(start + 9, base), HEX_SEP_INDEX(start + 10, base), HEX_SEP_INDEX(start + 11, base),    \
+        HEX_SEP_INDEX(start + 12, base), HEX_SEP_INDEX(start + 13, base), HEX_SEP_INDEX(start + 14, base),   \
+        HEX_SEP_INDEX(start + 15, base)
+
+alignas(16) static const char kSeparatedFromFirst[3][16] = {{HEX_SEP_ROW(0, 0)}, {HEX_SEP_ROW(16, 0)}, {HEX_SEP_ROW(32, 0)}};
+alignas(16) static const char kSeparatedFromSecond[3][16] = {{HEX_SEP_ROW(0, 1)}, {HEX_SEP_ROW(16, 1)}, {HEX_SEP_ROW(32, 1)}};
+
+#undef HEX_SEP_ROW
+#undef HEX_SEP_INDEX
+
+__attribute__((target("ssse3"))) static char* encodeSsse3(const std::uint8_t* data, std::size_t size, char* out,
+                                                          char separator)
+{
+    if (!separator)
+    {
+        while (size >= 16)
+        {
+            __m128i first, second;
+            encodeBlockSsse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), first, second);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), first);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), second);
+            data += 16;
+            size -= 16;
+            out += 32;
+        }
+        return encodeScalar(data, size, out, separator);
+    }
+
+    // The shuffles leave the p % 3 == 2 slots zero; OR the separator into them.
+    __m128i fill[3];
+    for (int k = 0; k < 3; ++k)
+    {
+        alignas(16) char row[16];
+        for (int j = 0; j < 16; ++j) row[j] = ((16 * k + j) % 3 == 2) ? separator : 0;
+        fill[k] = _mm_load_si128(reinterpret_cast<const __m128i*>(row));
+    }
+    const auto row = [](const char (*table)[16], int k) {
+        return _mm_load_si128(reinterpret_cast<const __m128i*>(table[k]));
+    };
+    // Characters 0-15 only need digits from `first` and 32-47 only from `second`.
+    const __m128i first0 = row(kSeparatedFromFirst, 0);
+    const __m128i first1 = row(kSeparatedFromFirst, 1), second1 = row(kSeparatedFromSecond, 1);
+    const __m128i second2 = row(kSeparatedFromSecond, 2);
+    const __m128i fill0 = fill[0], fill1 = fill[1], fill2 = fill[2];
+
+    // Strictly more than 16 bytes left: every block is followed by another byte,
+    // so its trailing separator belongs in the output.
+    while (size > 16)
+    {
+        __m128i first, second;
+        encodeBlockSsse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), first, second);
+        const __m128i out0 = _mm_or_si128(_mm_shuffle_epi8(first, first0), fill0);
+        const __m128i out1 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(first, first1), _mm_shuffle_epi8(second, second1)), fill1);
+        const __m128i out2 = _mm_or_si128(_mm_shuffle_epi8(second, second2), fill2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), out0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), out1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 32), out2);
+        data += 16;
+        size -= 16;
+        out += 48;
+    }
+    return encodeScalar(data, size, out, separator);
+}
+
+/**
+ * @brief 16 characters -> 16 nibble values plus a validity mask (all ones if
+ * every character is a digit). Works on the unsigned distance to '0' and to
+ * 'a' (after folding case), so no signed-compare corner cases.
+ */
+__attribute__((target("ssse3"))) static inline __m128i digitValuesSsse3(__m128i c, __m128i& valid)
+{
+    const __m128i digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    const __m128i letter = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    const __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    const __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+    valid = _mm_or_si128(isDigit, isLetter);
+    return _mm_or_si128(_mm_and_si128(isDigit, digit),
+                        _mm_and_si128(isLetter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+
+__attribute__((target("ssse3"))) static bool decodeSsse3(const char* text, std::size_t pairs, std::uint8_t* out)
+{
+    // maddubs: each 16-bit lane = high nibble * 16 + low nibble.
+    const __m128i weights = _mm_set1_epi16(0x0110);
+    while (pairs >= 16)
+    {
+        __m128i valid0, valid1;
+        const __m128i v0 = digitValuesSsse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text)), valid0);
+        const __m128i v1 = digitValuesSsse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + 16)), valid1);
+        if (_mm_movemask_epi8(_mm_and_si128(valid0, valid1)) != 0xFFFF) return false;
+        const __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(v0, weights), _mm_maddubs_epi16(v1, weights));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), bytes);
+        text += 32;
+        out += 16;
+        pairs -= 16;
+    }
+    return decodeScalar(text, pairs, out);
+}
+
+// ---------------------------------------------------------------------------
+// AVX2
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Unseparated encoding, 32 bytes per step. unpack works per 128-bit
+ * half, so the two halves are reassembled with permute2x128.
+ */
+__attribute__((target("avx2"))) static char* encodeAvx2(const std::uint8_t* data, std::size_t size, char* out,
+                                                        char separator)
+{
+    if (separator) return encodeSsse3(data, size, out, separator);
+    const __m256i digits = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(kHexDigits)));
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    while (size >= 32)
+    {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        const __m256i hi = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+        const __m256i lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(v, mask));
+        const __m256i a = _mm256_unpacklo_epi8(hi, lo);  // Bytes 0-7 | 16-23
+        const __m256i b = _mm256_unpackhi_epi8(hi, lo);  // Bytes 8-15 | 24-31
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32), _mm256_permute2x128_si256(a, b, 0x31));
+        data += 32;
+        size -= 32;
+        out += 64;
+    }
+    // The tail runs legacy-encoded SSE: clear the upper halves first or every
+    // SSE instruction there pays the AVX transition penalty (the compiler does
+    // not insert vzeroupper before a tail call).
+    _mm256_zeroupper();
+    return encodeSsse3(data, size, out, separator);
+}
+
+__attribute__((target("avx2"))) static inline __m256i digitValuesAvx2(__m256i c, __m256i& valid)
+{
+    const __m256i digit = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+    const __m256i letter = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    const __m256i isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    const __m256i isLetter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+    valid = _mm256_or_si256(isDigit, isLetter);
+    return _mm256_or_si256(_mm256_and_si256(isDigit, digit),
+                           _mm256_and_si256(isLetter, _mm256_add_epi8(letter, _mm256_set1_epi8(10))));
+}
+
+__attribute__((target("avx2"))) static bool decodeAvx2(const char* text, std::size_t pairs, std::uint8_t* out)
+{
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+    while (pairs >= 32)
+    {
+        __m256i valid0, valid1;
+        const __m256i v0 = digitValuesAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text)), valid0);
+        const __m256i v1 = digitValuesAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + 32)), valid1);
+        if (_mm256_movemask_epi8(_mm256_and_si256(valid0, valid1)) != -1) return false;
+        // packus interleaves the halves (0-7, 16-23, 8-15, 24-31); permute4x64 restores order.
+        const __m256i packed = _mm256_packus_epi16(_mm256_maddubs_epi16(v0, weights), _mm256_maddubs_epi16(v1, weights));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute4x64_epi64(packed, 0xD8));
+        text += 64;
+        out += 32;
+        pairs -= 32;
+    }
+    _mm256_zeroupper();  // See encodeAvx2
+    return decodeSsse3(text, pairs, out);
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------
+
+using EncodeFn = char* (*)(const std::uint8_t*, std::size_t, char*, char);
+using DecodeFn = bool (*)(const char*, std::size_t, std::uint8_t*);
+
+struct HexFunctions {
+    EncodeFn encode;
+    DecodeFn decode;
+};
+
+static HexFunctions kernelFunctions(HexKernel kernel)
+{
+    switch (kernel)
+    {
+#if NETGUI_HEX_X86
+        case HexKernel::Ssse3: return {encodeSsse3, decodeSsse3};
+        case HexKernel::Avx2: return {encodeAvx2, decodeAvx2};
+#endif
+        default: return {encodeScalar, decodeScalar};
+    }
+}
+
+static HexKernel detectKernel()
+{
+#if NETGUI_HEX_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return HexKernel::Avx2;
+    if (__builtin_cpu_supports("ssse3")) return HexKernel::Ssse3;
+#endif
+    return HexKernel::Scalar;
+}
+
+/**
+ * @brief Active kernel; function-local so static initializers can encode too.
+ */
+static HexKernel& activeKernel()
+{
+    static HexKernel kernel = detectKernel();
+    return kernel;
+}
+
+static HexFunctions& activeFunctions()
+{
+    static HexFunctions fns = kernelFunctions(activeKernel());
+    return fns;
+}
+
+char* hexEncode(const std::uint8_t* data, std::size_t size, char* out, char separator)
+{
+    // MAC addresses and short log excerpts: the tables beat the indirect call.
+    if (size < kHexSimdThreshold) return encodeScalar(data, size, out, separator);
+    return activeFunctions().encode(data, size, out, separator);
+}
+
+bool hexDecode(const char* text, std::size_t pairs, std::uint8_t* out)
+{
+    if (pairs < kHexSimdThreshold) return decodeScalar(text, pairs, out);
+    return activeFunctions().decode(text, pairs, out);
+}
+
+char* hexEncodeWith(HexKernel kernel, const std::uint8_t* data, std::size_t size, char* out, char separator)
+{
+    return (hexKernelSupported(kernel) ? kernelFunctions(kernel).encode : encodeScalar)(data, size, out, separator);
+}
+
+bool hexDecodeWith(HexKernel kernel, const char* text, std::size_t pairs, std::uint8_t* out)
+{
+    return (hexKernelSupported(kernel) ? kernelFunctions(kernel).decode : decodeScalar)(text, pairs, out);
+}
+
+bool hexKernelSupported(HexKernel kernel)
+{
+    return kernel == HexKernel::Scalar || static_cast<int>(kernel) <= static_cast<int>(detectKernel());
+}
+
+HexKernel hexKernel()
+{
+    return activeKernel();
+}
+
+bool setHexKernel(HexKernel kernel)
+{
+    if (!hexKernelSupported(kernel)) return false;
+    activeKernel() = kernel;
+    activeFunctions() = kernelFunctions(kernel);
+    return true;
+}
+
+const char* hexKernelName(HexKernel kernel)
+{
+    switch (kernel)
+    {
+        case HexKernel::Scalar: return "scalar";
+        case HexKernel::Ssse3: return "ssse3";
+        case HexKernel::Avx2: return "avx2";
+    }
+    return "?";
+}
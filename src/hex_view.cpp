@@ -0,0 +1,238 @@
+#include "hex_view.h"
+
+#include "hex_codec.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+
+static HexStyle styleOf(Layer layer)
+{
+    switch (layer)
+    {
+    case Layer::Ethernet:
+        return HexStyle::Link;
+    case Layer::Vlan:
+        return HexStyle::Tag;
+    case Layer::Arp:
+    case Layer::Ipv4:
+    case Layer::Ipv6:
+        return HexStyle::Network;
+    case Layer::Icmp:
+    case Layer::Icmpv6:
+    case Layer::Udp:
+    case Layer::Tcp:
+        return HexStyle::Transport;
+    }
+    return HexStyle::Plain;
+}
+
+// ---------------------------------------------------------------------------
+// Frame and geometry
+// ---------------------------------------------------------------------------
+
+void HexView::setFrame(const std::uint8_t* data, std::size_t size, const FrameDescriptor* dissection)
+{
+    frameSize = size;
+    const std::size_t n = std::min(size, kMaxBytes);
+    bytes.assign(data, data + n);
+    styles.assign(n, HexStyle::Plain);
+    if (dissection)
+    {
+        auto paint = [&](std::size_t offset, std::size_t length, HexStyle style) {
+            const std::size_t end = std::min(n, offset + length);
+            for (std::size_t i = offset; i < end; ++i) styles[i] = style;
+        };
+        paint(dissection->payloadOffset, dissection->payloadSize, HexStyle::Payload);
+        for (std::size_t i = 0; i < dissection->layerCount; ++i)
+        {
+            const FrameLayer& layer = dissection->layers[i];
+            paint(layer.offset, layer.length, styleOf(layer.id));
+        }
+    }
+    top = 0;
+    matchStart = 0;
+    matchLength = 0;
+    rows.clear();
+    rows.resize(rowCount());
+}
+
+void HexView::setGeometry(int bytesPerRow, int visibleRows)
+{
+    bytesPerRow = std::max(1, bytesPerRow);
+    if (bytesPerRow != rowBytes)
+    {
+        const std::size_t firstByte = top * static_cast<std::size_t>(rowBytes);
+        rowBytes = bytesPerRow;
+        top = firstByte / static_cast<std::size_t>(rowBytes);
+        rows.clear();
+        rows.resize(rowCount());
+    }
+    screenRows = std::max(1, visibleRows);
+    top = std::min(top, maxTop());
+}
+
+std::size_t HexView::rowCount() const
+{
+    const std::size_t width = static_cast<std::size_t>(rowBytes);
+    return (bytes.size() + width - 1) / width;
+}
+
+std::size_t HexView::maxTop() const
+{
+    const std::size_t count = rowCount();
+    const std::size_t shown = static_cast<std::size_t>(screenRows);
+    return count > shown ? count - shown : 0;
+}
+
+// ---------------------------------------------------------------------------
+// Navigation
+// ---------------------------------------------------------------------------
+
+void HexView::scrollTo(std::size_t row)
+{
+    top = std::min(row, maxTop());
+}
+
+void HexView::scrollBy(long rows)
+{
+    if (rows < 0)
+    {
+        const std::size_t up = static_cast<std::size_t>(-rows);
+        scrollTo(top > up ? top - up : 0);
+    }
+    else
+    {
+        scrollTo(top + static_cast<std::size_t>(rows));
+    }
+}
+
+bool HexView::jumpTo(std::size_t offset)
+{
+    if (offset >= bytes.size()) return false;
+    const std::size_t row = offset / static_cast<std::size_t>(rowBytes);
+    if (row < top || row >= top + static_cast<std::size_t>(screenRows)) scrollTo(row);
+    return true;
+}
+
+bool HexView::find(const std::vector<std::uint8_t>& needle)
+{
+    if (hasMatch()) dropRows(matchStart, matchLength);
+    const std::size_t from = hasMatch() ? matchStart + 1 : 0;
+    matchLength = 0;
+    if (needle.empty() || needle.size() > bytes.size()) return false;
+
+    auto it = std::search(bytes.begin() + static_cast<std::ptrdiff_t>(std::min(from, bytes.size())), bytes.end(),
+                          needle.begin(), needle.end());
+    if (it == bytes.end())
+    {
+        it = std::search(bytes.begin(), bytes.end(), needle.begin(), needle.end());
+        if (it == bytes.end()) return false;
+    }
+    matchStart = static_cast<std::size_t>(it - bytes.begin());
+    matchLength = needle.size();
+    dropRows(matchStart, matchLength);
+    jumpTo(matchStart);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Rows
+// ---------------------------------------------------------------------------
+
+const HexRow& HexView::row(std::size_t index)
+{
+    HexRow& cached = rows[index];
+    if (cached.text.empty()) formatRow(index, cached);
+    return cached;
+}
+
+void HexView::dropRows(std::size_t fromByte, std::size_t length)
+{
+    if (length == 0) return;
+    const std::size_t width = static_cast<std::size_t>(rowBytes);
+    const std::size_t last = std::min((fromByte + length - 1) / width + 1, rows.size());
+    for (std::size_t r = fromByte / width; r < last; ++r)
+    {
+        rows[r].text.clear();
+        rows[r].segments.clear();
+    }
+}
+
+void HexView::formatRow(std::size_t index, HexRow& out) const
+{
+    const std::size_t width = static_cast<std::size_t>(rowBytes);
+    const std::size_t start = index * width;
+    const std::size_t n = std::min(width, bytes.size() - start);
+    const std::size_t asciiAt = static_cast<std::size_t>(asciiColumn());
+
+    // "OOOO " + hex padded to a full row + "  " + ASCII.
+    out.text.assign(asciiAt + n, ' ');
+    char offset[8];
+    std::snprintf(offset, sizeof(offset), "%04zX", start);
+    out.text.replace(0, 4, offset, 4);
+    char* hexEnd = hexEncode(bytes.data() + start, n, &out.text[5], ' ');
+    for (char* c = &out.text[5]; c != hexEnd; ++c) *c = static_cast<char>(std::toupper(static_cast<unsigned char>(*c)));
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const std::uint8_t byte = bytes[start + i];
+        out.text[asciiAt + i] = (byte >= 32 && byte <= 126) ? static_cast<char>(byte) : '.';
+    }
+
+    // Runs of equally styled bytes -> one segment over the hex columns and one over the ASCII ones.
+    out.segments.clear();
+    auto styleAt = [&](std::size_t i) {
+        const std::size_t at = start + i;
+        if (matchLength > 0 && at >= matchStart && at < matchStart + matchLength) return HexStyle::Match;
+        return styles[at];
+    };
+    for (std::size_t i = 0; i < n;)
+    {
+        const HexStyle style = styleAt(i);
+        std::size_t j = i + 1;
+        while (j < n && styleAt(j) == style) ++j;
+        if (style != HexStyle::Plain)
+        {
+            out.segments.push_back({static_cast<std::uint16_t>(5 + 3 * i), static_cast<std::uint16_t>(3 * (j - i) - 1),
+                                    style});
+        }
+        i = j;
+    }
+    const std::size_t hexSegments = out.segments.size();
+    for (std::size_t k = 0; k < hexSegments; ++k)
+    {
+        const HexSegment hex = out.segments[k];
+        out.segments.push_back({static_cast<std::uint16_t>(asciiAt + (hex.column - 5) / 3),
+                                static_cast<std::uint16_t>((hex.length + 1) / 3), hex.style});
+    }
+}
+
+std::vector<std::uint8_t> HexView::parseQuery(std::string_view query)
+{
+    while (!query.empty() && query.front() == ' ') query.remove_prefix(1);
+    while (!query.empty() && query.back() == ' ') query.remove_suffix(1);
+    if (query.size() >= 2 && query.front() == '"' && query.back() == '"')
+    {
+        query = query.substr(1, query.size() - 2);
+        return std::vector<std::uint8_t>(query.begin(), query.end());
+    }
+
+    std::string digits;
+    for (char c : query)
+    {
+        if (c == ' ' || c == ':' || c == '-') continue;
+        if (!isHexDigitChar(c))
+        {
+            digits.clear();
+            break;
+        }
+        digits += c;
+    }
+    if (!digits.empty() && digits.size() % 2 == 0)
+    {
+        std::vector<std::uint8_t> out(digits.size() / 2);
+        hexDecode(digits.data(), out.size(), out.data());
+        return out;
+    }
+    return std::vector<std::uint8_t>(query.begin(), query.end());
+}
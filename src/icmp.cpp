@@ -0,0 +1,114 @@
+#include "icmp.h"
+#include "checksum.h"
+
+#include <cstddef>
+#include <cstring>
+
+/**
+ * @brief Load/store a 16-bit word in memory order (for checksum patching).
+ */
+static std::uint16_t loadWord(const std::uint8_t* p)
+{
+    std::uint16_t w;
+    std::memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+static void storeWord(std::uint8_t* p, std::uint16_t w)
+{
+    std::memcpy(p, &w, sizeof(w));
+}
+
+IcmpEchoResponder::IcmpEchoResponder(Ipv4Layer& layer) : ipv4(layer)
+{
+    ipv4.setHandler(IpProto::ICMP, [this](Ipv4Packet& packet) { handle(packet); });
+}
+
+void IcmpEchoResponder::handle(Ipv4Packet& packet)
+{
+    ++counters.rxMessages;
+    if (packet.payloadSize < sizeof(IcmpEchoHeader))
+    {
+        ++counters.malformed;
+        return;
+    }
+
+    std::uint8_t* icmp = packet.payload();
+    if (icmp[0] != IcmpType::EchoRequest || icmp[1] != 0)
+    {
+        ++counters.ignored;
+        return;
+    }
+    // Like Linux' icmp_echo_ignore_broadcasts: never answer broadcast pings.
+    static const Ipv4Address kBroadcast{255, 255, 255, 255};
+    if (packet.dst == kBroadcast)
+    {
+        ++counters.ignored;
+        return;
+    }
+    if (verifyChecksum && internetChecksum(icmp, packet.payloadSize) != 0)
+    {
+        ++counters.checksumErrors;
+        return;
+    }
+
+    ++counters.echoRequests;
+    requestRate.add(packet.rxTime);
+
+    // ICMP: type 8 -> 0. Word 0 holds (type, code).
+    const std::uint16_t oldTypeCode = loadWord(icmp);
+    icmp[0] = IcmpType::EchoReply;
+    const std::uint16_t newTypeCode = loadWord(icmp);
+    const std::size_t icmpChecksumAt = offsetof(IcmpEchoHeader, checksum);
+    storeWord(icmp + icmpChecksumAt, checksumUpdate16(loadWord(icmp + icmpChecksumAt), oldTypeCode, newTypeCode));
+
+    int sent = -1;
+    if (packet.reassembled)
+    {
+        // Reassembled request: headers are rebuilt (and fragmented) by output().
+        Ipv4Route route;
+        std::memcpy(route.dstMac.data(), packet.frame + 6, 6);
+        std::memcpy(route.srcMac.data(), packet.frame + 0, 6);
+        route.src = packet.dst;
+        route.dst = packet.src;
+        sent = ipv4.output(packet.frame, packet.payloadSize, packet.capacity, route, IpProto::ICMP);
+    }
+    else
+    {
+        // Ethernet: swap MACs.
+        std::uint8_t mac[6];
+        std::memcpy(mac, packet.frame, 6);
+        std::memcpy(packet.frame, packet.frame + 6, 6);
+        std::memcpy(packet.frame + 6, mac, 6);
+
+        // IPv4: swap addresses (sum unchanged) and reset TTL (patch the word holding ttl/protocol).
+        std::uint8_t* ip = packet.header();
+        std::uint8_t addr[4];
+        std::memcpy(addr, ip + offsetof(Ipv4Header, src), 4);
+        std::memcpy(ip + offsetof(Ipv4Header, src), ip + offsetof(Ipv4Header, dst), 4);
+        std::memcpy(ip + offsetof(Ipv4Header, dst), addr, 4);
+
+        const std::size_t ttlAt = offsetof(Ipv4Header, ttl);
+        const std::size_t ipChecksumAt = offsetof(Ipv4Header, checksum);
+        const std::uint16_t oldTtlProto = loadWord(ip + ttlAt);
+        ip[ttlAt] = 64;
+        const std::uint16_t newTtlProto = loadWord(ip + ttlAt);
+        storeWord(ip + ipChecksumAt, checksumUpdate16(loadWord(ip + ipChecksumAt), oldTtlProto, newTtlProto));
+
+        std::size_t size = packet.frameSize;
+        if (size < EthernetII::MinFrameSize && packet.capacity >= EthernetII::MinFrameSize)
+        {
+            std::memset(packet.frame + size, 0, EthernetII::MinFrameSize - size);
+            size = EthernetII::MinFrameSize;
+        }
+        sent = ipv4.send(packet.frame, size);
+    }
+
+    if (sent < 0)
+    {
+        ++counters.txErrors;
+        return;
+    }
+    ++counters.echoReplies;
+    replyRate.add(packet.rxTime);
+}
@@ -0,0 +1,474 @@
+#include "ipv4.h"
+#include "checksum.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstring>
+
+/**
+ * @brief Header checksum check; the 20-byte case is summed as five 32-bit words.
+ */
+static bool ipv4ChecksumOk(const std::uint8_t* header, std::size_t headerSize)
+{
+    if (headerSize != kIpv4HeaderSize) return internetChecksum(header, headerSize) == 0;
+
+    std::uint32_t w[5];
+    std::memcpy(w, header, sizeof(w));
+    std::uint64_t acc = static_cast<std::uint64_t>(w[0]) + w[1] + w[2] + w[3] + w[4];
+    acc = (acc & 0xFFFFFFFFull) + (acc >> 32);
+    std::uint32_t s = static_cast<std::uint32_t>(acc);
+    s = (s & 0xFFFFu) + (s >> 16);
+    s = (s & 0xFFFFu) + (s >> 16);
+    return s == 0xFFFFu;
+}
+
+Ipv4Status parseIpv4(std::uint8_t* frame, std::size_t size, std::size_t capacity,
+                     std::size_t l3Offset, Ipv4Packet& out)
+{
+    if (!frame || size < l3Offset + kIpv4HeaderSize) return Ipv4Status::TooShort;
+
+    const std::uint8_t* l3 = frame + l3Offset;
+    Ipv4Header header;
+    std::memcpy(&header, l3, sizeof(header));
+
+    if ((header.versionIhl >> 4) != 4) return Ipv4Status::BadVersion;
+    const std::size_t headerSize = static_cast<std::size_t>(header.versionIhl & 0x0Fu) * 4;
+    if (headerSize < kIpv4HeaderSize || l3Offset + headerSize > size) return Ipv4Status::BadHeaderLength;
+
+    const std::size_t totalLength = ntohs(header.totalLength);
+    if (totalLength < headerSize || l3Offset + totalLength > size) return Ipv4Status::BadTotalLength;
+
+    if (!ipv4ChecksumOk(l3, headerSize)) return Ipv4Status::BadChecksum;
+
+    // Martian sources: multicast (224/4) or limited broadcast.
+    if ((header.src[0] & 0xF0u) == 0xE0u ||
+        (header.src[0] == 255 && header.src[1] == 255 && header.src[2] == 255 && header.src[3] == 255))
+    {
+        return Ipv4Status::BadAddress;
+    }
+
+    const std::uint16_t flagsFragment = ntohs(header.flagsFragment);
+    const std::size_t fragOffset = static_cast<std::size_t>(flagsFragment & kIpv4OffsetMask) * 8;
+    if (fragOffset + totalLength > kIpv4MaxDatagram) return Ipv4Status::BadFragment;
+
+    out.frame = frame;
+    out.frameSize = l3Offset + totalLength;
+    out.capacity = capacity;
+    out.l3Offset = l3Offset;
+    out.headerSize = headerSize;
+    out.payloadSize = totalLength - headerSize;
+    std::copy_n(header.src, 4, out.src.begin());
+    std::copy_n(header.dst, 4, out.dst.begin());
+    out.protocol = header.protocol;
+    out.ttl = header.ttl;
+    out.identification = ntohs(header.identification);
+    out.flagsFragment = flagsFragment;
+    out.reassembled = false;
+    return Ipv4Status::Ok;
+}
+
+void writeIpv4Header(std::uint8_t* out,
+                     const Ipv4Address& src,
+                     const Ipv4Address& dst,
+                     std::uint8_t protocol,
+                     std::uint16_t totalLength,
+                     std::uint16_t identification,
+                     std::uint16_t flagsFragment,
+                     std::uint8_t ttl)
+{
+    Ipv4Header header{};
+    header.versionIhl = 0x45;
+    header.tos = 0;
+    header.totalLength = htons(totalLength);
+    header.identification = htons(identification);
+    header.flagsFragment = htons(flagsFragment);
+    header.ttl = ttl;
+    header.protocol = protocol;
+    header.checksum = 0;
+    std::copy_n(src.begin(), 4, header.src);
+    std::copy_n(dst.begin(), 4, header.dst);
+    header.checksum = internetChecksum(&header, sizeof(header));
+    std::memcpy(out, &header, sizeof(header));
+}
+
+std::string ipv4ToString(const Ipv4Address& ip)
+{
+    return std::to_string(ip[0]) + "." + std::to_string(ip[1]) + "." +
+           std::to_string(ip[2]) + "." + std::to_string(ip[3]);
+}
+
+// ---------------------------------------------------------------------------
+// Reassembly
+// ---------------------------------------------------------------------------
+
+Ipv4Reassembler::Ipv4Reassembler(const Ipv4ReassemblyConfig& cfg) : config(cfg)
+{
+    // Rebuilt Ethernet + IPv4 header in front of the largest possible payload.
+    slotStride = (kIpv4PayloadOffset + (kIpv4MaxDatagram - kIpv4HeaderSize) + 63) & ~static_cast<std::size_t>(63);
+    const std::size_t perSlot = slotStride + sizeof(Slot);
+    const std::size_t count = std::max<std::size_t>(1, config.memoryBudget / perSlot);
+    arena.assign(count * slotStride, 0);
+    slots.resize(count);
+}
+
+std::size_t Ipv4Reassembler::inFlight() const
+{
+    return static_cast<std::size_t>(std::count_if(slots.begin(), slots.end(),
+                                                  [](const Slot& s) { return s.inUse; }));
+}
+
+void Ipv4Reassembler::drop(Slot& slot)
+{
+    slot.inUse = false;
+    slot.complete = false;
+}
+
+Ipv4Reassembler::Slot* Ipv4Reassembler::findOrCreate(const Ipv4Packet& fragment, Clock::time_point now)
+{
+    Slot* freeSlot = nullptr;
+    Slot* oldest = nullptr;
+    std::size_t fromSource = 0;
+
+    for (auto& slot : slots)
+    {
+        if (!slot.inUse)
+        {
+            if (!freeSlot) freeSlot = &slot;
+            continue;
+        }
+        if (slot.identification == fragment.identification && slot.protocol == fragment.protocol &&
+            slot.src == fragment.src && slot.dst == fragment.dst)
+        {
+            return slot.complete ? nullptr : &slot;
+        }
+        if (slot.src == fragment.src) ++fromSource;
+        if (!slot.complete && (!oldest || slot.created < oldest->created)) oldest = &slot;
+    }
+
+    if (fromSource >= config.maxDatagramsPerSource)
+    {
+        ++counters.sourceLimited;
+        return nullptr;
+    }
+
+    Slot* slot = freeSlot;
+    if (!slot)
+    {
+        if (!oldest) return nullptr;
+        ++counters.evicted;
+        slot = oldest;
+    }
+
+    slot->inUse = true;
+    slot->complete = false;
+    slot->src = fragment.src;
+    slot->dst = fragment.dst;
+    slot->identification = fragment.identification;
+    slot->protocol = fragment.protocol;
+    slot->created = now;
+    slot->deadline = now + config.timeout;
+    slot->received = 0;
+    slot->totalSize = 0;
+    slot->highest = 0;
+    slot->fragments = 0;
+    slot->blocks.fill(0);
+    return slot;
+}
+
+std::optional<Ipv4Packet> Ipv4Reassembler::add(const Ipv4Packet& fragment, Clock::time_point now)
+{
+    ++counters.fragments;
+
+    Slot* slot = findOrCreate(fragment, now);
+    if (!slot) return std::nullopt;
+
+    const std::size_t offset = fragment.fragmentOffset();
+    const std::size_t len = fragment.payloadSize;
+    const std::size_t end = offset + len;
+    const bool last = (fragment.flagsFragment & kIpv4FlagMoreFragments) == 0;
+    const std::size_t maxPayload = kIpv4MaxDatagram - kIpv4HeaderSize;
+
+    // Non-last fragments must carry a non-empty multiple of 8 bytes.
+    bool malformed = end > maxPayload || (!last && (len == 0 || (len % 8) != 0));
+    if (slot->totalSize && end > slot->totalSize) malformed = true;
+    if (last && (slot->totalSize ? slot->totalSize != end : slot->highest > end)) malformed = true;
+    if (malformed)
+    {
+        ++counters.malformed;
+        drop(*slot);
+        return std::nullopt;
+    }
+
+    if (++slot->fragments > config.maxFragmentsPerDatagram)
+    {
+        ++counters.tooManyFragments;
+        drop(*slot);
+        return std::nullopt;
+    }
+
+    // Overlap check + mark blocks [offset/8, ceil(end/8)).
+    const std::size_t firstBlock = offset / 8;
+    const std::size_t endBlock = (end + 7) / 8;
+    for (std::size_t b = firstBlock; b < endBlock; ++b)
+    {
+        if (slot->blocks[b / 64] & (1ull << (b % 64)))
+        {
+            ++counters.overlaps;
+            drop(*slot);
+            return std::nullopt;
+        }
+    }
+    for (std::size_t b = firstBlock; b < endBlock; ++b)
+    {
+        slot->blocks[b / 64] |= (1ull << (b % 64));
+    }
+
+    const std::size_t index = static_cast<std::size_t>(slot - slots.data());
+    std::uint8_t* base = slotData(index);
+    std::memcpy(base + kIpv4PayloadOffset + offset, fragment.payload(), len);
+    slot->received += len;
+    slot->highest = std::max(slot->highest, end);
+    if (last) slot->totalSize = end;
+
+    if (offset == 0)
+    {
+        // Link header and the fixed part of the IP header come from the first fragment.
+        std::memcpy(base, fragment.frame, 12);
+        base[12] = static_cast<std::uint8_t>(EtherType::IPv4 >> 8);
+        base[13] = static_cast<std::uint8_t>(EtherType::IPv4 & 0xFFu);
+        std::memcpy(base + EthernetII::HeaderSize, fragment.header(), kIpv4HeaderSize);
+    }
+
+    if (!slot->totalSize || slot->received != slot->totalSize) return std::nullopt;
+
+    // Complete: rebuild an unfragmented 20-byte header (options are not kept).
+    Ipv4Header header;
+    std::memcpy(&header, base + EthernetII::HeaderSize, sizeof(header));
+    writeIpv4Header(base + EthernetII::HeaderSize, slot->src, slot->dst, slot->protocol,
+                    static_cast<std::uint16_t>(kIpv4HeaderSize + slot->totalSize),
+                    slot->identification, 0, header.ttl);
+    slot->complete = true;
+    ++counters.reassembled;
+
+    Ipv4Packet out;
+    out.frame = base;
+    out.frameSize = kIpv4PayloadOffset + slot->totalSize;
+    out.capacity = slotStride;
+    out.l3Offset = EthernetII::HeaderSize;
+    out.headerSize = kIpv4HeaderSize;
+    out.payloadSize = slot->totalSize;
+    out.src = slot->src;
+    out.dst = slot->dst;
+    out.protocol = slot->protocol;
+    out.ttl = header.ttl;
+    out.identification = slot->identification;
+    out.flagsFragment = 0;
+    out.reassembled = true;
+    return out;
+}
+
+void Ipv4Reassembler::release(const Ipv4Packet& datagram)
+{
+    if (!datagram.reassembled || datagram.frame < arena.data()) return;
+    const std::size_t index = static_cast<std::size_t>(datagram.frame - arena.data()) / slotStride;
+    if (index < slots.size()) drop(slots[index]);
+}
+
+std::size_t Ipv4Reassembler::expire(Clock::time_point now)
+{
+    std::size_t dropped = 0;
+    for (auto& slot : slots)
+    {
+        if (slot.inUse && !slot.complete && slot.deadline <= now)
+        {
+            drop(slot);
+            ++dropped;
+        }
+    }
+    counters.timeouts += dropped;
+    return dropped;
+}
+
+// ---------------------------------------------------------------------------
+// Layer
+// ---------------------------------------------------------------------------
+
+Ipv4Layer::Ipv4Layer(const Ipv4ReassemblyConfig& reassembly) : reassembler(reassembly)
+{
+}
+
+void Ipv4Layer::addLocalAddress(const Ipv4Address& ip)
+{
+    if (!isLocal(ip)) locals.push_back(ip);
+}
+
+bool Ipv4Layer::isLocal(const Ipv4Address& ip) const
+{
+    return std::find(locals.begin(), locals.end(), ip) != locals.end();
+}
+
+void Ipv4Layer::setHandler(std::uint8_t protocol, Ipv4Handler handler)
+{
+    handlers[protocol] = std::move(handler);
+}
+
+bool Ipv4Layer::deliver(Ipv4Packet& packet)
+{
+    Ipv4Handler& handler = handlers[packet.protocol];
+    if (!handler)
+    {
+        ++counters.rxNoProtocol;
+        return false;
+    }
+    ++counters.rxDelivered;
+    handler(packet);
+    return true;
+}
+
+bool Ipv4Layer::input(std::uint8_t* frame, std::size_t size, std::size_t capacity,
+                      Clock::time_point now, std::size_t l3Offset)
+{
+    return receive(frame, size, capacity, now, l3Offset, nullptr);
+}
+
+bool Ipv4Layer::input(PacketBuffer& buffer, Clock::time_point now, std::size_t l3Offset)
+{
+    return receive(buffer.data(), buffer.size(), buffer.size() + buffer.tailroom(), now, l3Offset, &buffer);
+}
+
+bool Ipv4Layer::receive(std::uint8_t* frame, std::size_t size, std::size_t capacity,
+                        Clock::time_point now, std::size_t l3Offset, PacketBuffer* buffer)
+{
+    ++counters.rxPackets;
+    counters.rxBytes += size;
+
+    Ipv4Packet packet;
+    const Ipv4Status status = parseIpv4(frame, size, capacity, l3Offset, packet);
+    if (status == Ipv4Status::BadChecksum)
+    {
+        ++counters.rxChecksumErrors;
+        return false;
+    }
+    if (status != Ipv4Status::Ok)
+    {
+        ++counters.rxHeaderErrors;
+        return false;
+    }
+
+    packet.rxTime = now;
+    packet.buffer = buffer;
+
+    static const Ipv4Address kBroadcast{255, 255, 255, 255};
+    if (!isLocal(packet.dst) && packet.dst != kBroadcast)
+    {
+        ++counters.rxNotLocal;
+        return false;
+    }
+
+    if (!packet.isFragment()) return deliver(packet);
+
+    auto whole = reassembler.add(packet, now);
+    if (!whole) return false;
+    whole->rxTime = now;
+    const bool delivered = deliver(*whole);
+    reassembler.release(*whole);
+    return delivered;
+}
+
+int Ipv4Layer::send(const std::uint8_t* frame, std::size_t size)
+{
+    const int sent = sendFrame ? sendFrame(frame, size) : -1;
+    if (sent < 0) ++counters.txErrors;
+    else ++counters.txPackets;
+    return sent;
+}
+
+int Ipv4Layer::output(std::uint8_t* frame, std::size_t payloadSize, std::size_t capacity,
+                      const Ipv4Route& route, std::uint8_t protocol, std::uint8_t ttl)
+{
+    if (!frame || kIpv4PayloadOffset + payloadSize > capacity) return -1;
+    if (kIpv4HeaderSize + payloadSize > kIpv4MaxDatagram) return -1;
+
+    const std::uint16_t id = nextId++;
+
+    if (kIpv4HeaderSize + payloadSize <= mtu)
+    {
+        writeEthernetHeader(frame, route.dstMac, route.srcMac, EtherType::IPv4);
+        writeIpv4Header(frame + EthernetII::HeaderSize, route.src, route.dst, protocol,
+                        static_cast<std::uint16_t>(kIpv4HeaderSize + payloadSize), id, 0, ttl);
+        std::size_t size = kIpv4PayloadOffset + payloadSize;
+        if (size < EthernetII::MinFrameSize && capacity >= EthernetII::MinFrameSize)
+        {
+            std::memset(frame + size, 0, EthernetII::MinFrameSize - size);
+            size = EthernetII::MinFrameSize;
+        }
+        return send(frame, size);
+    }
+
+    // Fragment: every piece but the last carries a multiple of 8 bytes.
+    const std::size_t chunk = (mtu - kIpv4HeaderSize) & ~static_cast<std::size_t>(7);
+    if (chunk == 0) return -1;
+    fragmentScratch.resize(EthernetII::HeaderSize + mtu + EthernetII::MinFrameSize);
+
+    const std::uint8_t* payload = frame + kIpv4PayloadOffset;
+    int total = 0;
+    for (std::size_t offset = 0; offset < payloadSize; offset += chunk)
+    {
+        const std::size_t len = std::min(chunk, payloadSize - offset);
+        const bool more = offset + len < payloadSize;
+        std::uint8_t* out = fragmentScratch.data();
+        writeEthernetHeader(out, route.dstMac, route.srcMac, EtherType::IPv4);
+        writeIpv4Header(out + EthernetII::HeaderSize, route.src, route.dst, protocol,
+                        static_cast<std::uint16_t>(kIpv4HeaderSize + len), id,
+                        static_cast<std::uint16_t>((more ? kIpv4FlagMoreFragments : 0) | (offset / 8)), ttl);
+        std::memcpy(out + kIpv4PayloadOffset, payload + offset, len);
+        std::size_t size = kIpv4PayloadOffset + len;
+        if (size < EthernetII::MinFrameSize)
+        {
+            std::memset(out + size, 0, EthernetII::MinFrameSize - size);
+            size = EthernetII::MinFrameSize;
+        }
+        const int sent = send(out, size);
+        if (sent < 0) return -1;
+        ++counters.txFragments;
+        total += sent;
+    }
+    return total;
+}
+
+int Ipv4Layer::output(PacketBuffer& packet, const Ipv4Route& route, std::uint8_t protocol, std::uint8_t ttl)
+{
+    const std::size_t payloadSize = packet.size();
+    std::uint8_t* frame = packet.prepend(kIpv4PayloadOffset);
+    if (!frame) return -1;
+    return output(frame, payloadSize, packet.size() + packet.tailroom(), route, protocol, ttl);
+}
+
+std::optional<Ipv4Route> Ipv4Layer::route(const Ipv4Address& dst)
+{
+    static const Ipv4Address kBroadcast{255, 255, 255, 255};
+    if (locals.empty())
+    {
+        ++counters.txNoRoute;
+        return std::nullopt;
+    }
+
+    Ipv4Route out;
+    out.srcMac = linkAddress;
+    out.src = locals.front();
+    out.dst = dst;
+    if (dst == kBroadcast)
+    {
+        out.dstMac = MacAddress{0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+        return out;
+    }
+
+    auto mac = resolveNeighbor ? resolveNeighbor(dst) : std::nullopt;
+    if (!mac)
+    {
+        ++counters.txNoRoute;
+        return std::nullopt;
+    }
+    out.dstMac = *mac;
+    return out;
+}
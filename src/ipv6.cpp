@@ -0,0 +1,254 @@
+#include "ipv6.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstdio>
+#include <cstring>
+
+static std::uint32_t low32(const std::uint8_t* bytes)
+{
+    return (static_cast<std::uint32_t>(bytes[0]) << 24) | (static_cast<std::uint32_t>(bytes[1]) << 16) |
+           (static_cast<std::uint32_t>(bytes[2]) << 8) | static_cast<std::uint32_t>(bytes[3]);
+}
+
+Ipv6Status parseIpv6(std::uint8_t* frame, std::size_t size, std::size_t capacity,
+                     std::size_t l3Offset, Ipv6Packet& out)
+{
+    if (!frame || size < l3Offset + kIpv6HeaderSize) return Ipv6Status::TooShort;
+
+    Ipv6Header header;
+    std::memcpy(&header, frame + l3Offset, sizeof(header));
+
+    if ((ntohl(header.versionClassFlow) >> 28) != 6) return Ipv6Status::BadVersion;
+    const std::size_t payloadLength = ntohs(header.payloadLength);
+    if (l3Offset + kIpv6HeaderSize + payloadLength > size) return Ipv6Status::BadPayloadLength;
+    if (header.src[0] == 0xff) return Ipv6Status::BadAddress;
+
+    out.frame = frame;
+    out.frameSize = l3Offset + kIpv6HeaderSize + payloadLength;
+    out.capacity = capacity;
+    out.l3Offset = l3Offset;
+    out.payloadSize = payloadLength;
+    std::copy_n(header.src, 16, out.src.begin());
+    std::copy_n(header.dst, 16, out.dst.begin());
+    out.nextHeader = header.nextHeader;
+    out.hopLimit = header.hopLimit;
+    return Ipv6Status::Ok;
+}
+
+void writeIpv6Header(std::uint8_t* out,
+                     const Ipv6Address& src,
+                     const Ipv6Address& dst,
+                     std::uint8_t nextHeader,
+                     std::uint16_t payloadLength,
+                     std::uint8_t hopLimit)
+{
+    Ipv6Header header{};
+    header.versionClassFlow = htonl(6u << 28);
+    header.payloadLength = htons(payloadLength);
+    header.nextHeader = nextHeader;
+    header.hopLimit = hopLimit;
+    std::copy(src.begin(), src.end(), header.src);
+    std::copy(dst.begin(), dst.end(), header.dst);
+    std::memcpy(out, &header, sizeof(header));
+}
+
+std::string ipv6ToString(const Ipv6Address& ip)
+{
+    std::uint16_t words[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        words[i] = static_cast<std::uint16_t>((ip[2 * i] << 8) | ip[2 * i + 1]);
+    }
+
+    // Longest run of two or more zero words becomes "::" (first one on ties).
+    int bestStart = -1;
+    int bestLen = 1;
+    for (int i = 0; i < 8;)
+    {
+        if (words[i] != 0)
+        {
+            ++i;
+            continue;
+        }
+        int j = i;
+        while (j < 8 && words[j] == 0) ++j;
+        if (j - i > bestLen)
+        {
+            bestStart = i;
+            bestLen = j - i;
+        }
+        i = j;
+    }
+
+    std::string out;
+    out.reserve(39);
+    char text[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        if (i == bestStart)
+        {
+            out += "::";
+            i += bestLen - 1;
+            continue;
+        }
+        if (!out.empty() && out.back() != ':') out += ':';
+        std::snprintf(text, sizeof(text), "%x", words[i]);
+        out += text;
+    }
+    return out;
+}
+
+Ipv6Address ipv6SolicitedNode(const Ipv6Address& ip)
+{
+    Ipv6Address group{0xff, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01, 0xff};
+    std::copy(ip.begin() + 13, ip.end(), group.begin() + 13);
+    return group;
+}
+
+MacAddress ipv6MulticastMac(const Ipv6Address& group)
+{
+    return MacAddress{0x33, 0x33, group[12], group[13], group[14], group[15]};
+}
+
+Ipv6Address ipv6LinkLocal(const MacAddress& mac)
+{
+    return Ipv6Address{0xfe, 0x80, 0, 0, 0, 0, 0, 0,
+                       static_cast<std::uint8_t>(mac[0] ^ 0x02), mac[1], mac[2], 0xff,
+                       0xfe, mac[3], mac[4], mac[5]};
+}
+
+// ---------------------------------------------------------------------------
+// Layer
+// ---------------------------------------------------------------------------
+
+Ipv6Layer::Ipv6Layer()
+{
+    joinGroup(kIpv6AllNodes);
+}
+
+void Ipv6Layer::addLocalAddress(const Ipv6Address& ip)
+{
+    if (isLocal(ip) || ipv6IsMulticast(ip) || ipv6IsUnspecified(ip)) return;
+    locals.push_back(ip);
+    joinGroup(ipv6SolicitedNode(ip));
+}
+
+bool Ipv6Layer::isLocal(const Ipv6Address& ip) const
+{
+    return std::find(locals.begin(), locals.end(), ip) != locals.end();
+}
+
+void Ipv6Layer::joinGroup(const Ipv6Address& group)
+{
+    for (Group& g : groups)
+    {
+        if (g.address == group)
+        {
+            ++g.refs;
+            return;
+        }
+    }
+    groups.push_back(Group{group, low32(group.data() + 12), 1});
+    if (groupListener) groupListener(group, true);
+}
+
+void Ipv6Layer::leaveGroup(const Ipv6Address& group)
+{
+    for (auto it = groups.begin(); it != groups.end(); ++it)
+    {
+        if (it->address != group) continue;
+        if (--it->refs == 0)
+        {
+            const Ipv6Address address = it->address;  // @p group may alias the entry
+            groups.erase(it);
+            if (groupListener) groupListener(address, false);
+        }
+        return;
+    }
+}
+
+bool Ipv6Layer::isMember(const Ipv6Address& group) const
+{
+    return std::any_of(groups.begin(), groups.end(), [&](const Group& g) { return g.address == group; });
+}
+
+void Ipv6Layer::setGroupListener(Ipv6GroupListener listener)
+{
+    groupListener = std::move(listener);
+    if (!groupListener) return;
+    for (const Group& g : groups) groupListener(g.address, true);
+}
+
+bool Ipv6Layer::acceptsLinkDestination(const std::uint8_t* mac) const
+{
+    if (mac[0] == 0x33 && mac[1] == 0x33)
+    {
+        const std::uint32_t low = low32(mac + 2);
+        return std::any_of(groups.begin(), groups.end(), [low](const Group& g) { return g.low32 == low; });
+    }
+    return std::memcmp(mac, linkAddress.data(), linkAddress.size()) == 0;
+}
+
+void Ipv6Layer::setHandler(std::uint8_t nextHeader, Ipv6Handler handler)
+{
+    handlers[nextHeader] = std::move(handler);
+}
+
+bool Ipv6Layer::input(std::uint8_t* frame, std::size_t size, std::size_t capacity,
+                      Clock::time_point now, std::size_t l3Offset)
+{
+    return receive(frame, size, capacity, now, l3Offset, nullptr);
+}
+
+bool Ipv6Layer::input(PacketBuffer& buffer, Clock::time_point now, std::size_t l3Offset)
+{
+    return receive(buffer.data(), buffer.size(), buffer.size() + buffer.tailroom(), now, l3Offset, &buffer);
+}
+
+bool Ipv6Layer::receive(std::uint8_t* frame, std::size_t size, std::size_t capacity,
+                        Clock::time_point now, std::size_t l3Offset, PacketBuffer* buffer)
+{
+    ++counters.rxPackets;
+    counters.rxBytes += size;
+
+    // Link filter first: cheapest reject for the multicast chatter on a shared segment.
+    if (!frame || size < EthernetII::HeaderSize || !acceptsLinkDestination(frame))
+    {
+        ++counters.rxLinkFiltered;
+        return false;
+    }
+
+    Ipv6Packet packet;
+    if (parseIpv6(frame, size, capacity, l3Offset, packet) != Ipv6Status::Ok)
+    {
+        ++counters.rxHeaderErrors;
+        return false;
+    }
+    packet.rxTime = now;
+    packet.buffer = buffer;
+
+    if (ipv6IsMulticast(packet.dst) ? !isMember(packet.dst) : !isLocal(packet.dst))
+    {
+        ++counters.rxNotLocal;
+        return false;
+    }
+
+    Ipv6Handler& handler = handlers[packet.nextHeader];
+    if (!handler)
+    {
+        ++counters.rxNoNextHeader;
+        return false;
+    }
+    ++counters.rxDelivered;
+    handler(packet);
+    return true;
+}
+
+int Ipv6Layer::send(const std::uint8_t* frame, std::size_t size)
+{
+    const int sent = sendFrame ? sendFrame(frame, size) : -1;
+    if (sent < 0) ++counters.txErrors;
+    else ++counters.txPackets;
+    return sent;
+}
@@ -0,0 +1,175 @@
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cstdio>
+
+// ---------------------------------------------------------------------------
+// Clock
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Nanoseconds per tick as 32.32 fixed point, measured once against
+ * steady_clock over a short busy wait.
+ */
+static std::uint64_t ticksToNsFactor()
+{
+#if NETGUI_LATENCY_TSC
+    static const std::uint64_t factor = [] {
+        using Clock = std::chrono::steady_clock;
+        const auto wallStart = Clock::now();
+        const std::uint64_t tickStart = __rdtsc();
+        while (Clock::now() - wallStart < std::chrono::milliseconds(5))
+        {
+        }
+        const std::uint64_t ticks = __rdtsc() - tickStart;
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - wallStart).count();
+        if (ticks == 0) return std::uint64_t{1} << 32;
+        return static_cast<std::uint64_t>((static_cast<unsigned __int128>(ns) << 32) / ticks);
+    }();
+    return factor;
+#else
+    return std::uint64_t{1} << 32;
+#endif
+}
+
+std::uint64_t LatencyClock::nanoseconds(std::uint64_t start, std::uint64_t end)
+{
+    if (end <= start) return 0;
+    return static_cast<std::uint64_t>((static_cast<unsigned __int128>(end - start) * ticksToNsFactor()) >> 32);
+}
+
+// ---------------------------------------------------------------------------
+// Histogram
+// ---------------------------------------------------------------------------
+
+std::size_t LatencyHistogram::bucketIndex(std::uint64_t ns)
+{
+    if (ns < 2 * SubBuckets) return static_cast<std::size_t>(ns);
+    const unsigned msb = 63u - static_cast<unsigned>(__builtin_clzll(ns));
+    if (msb >= MaxExponent) return BucketCount - 1;
+    const unsigned shift = msb - SubBucketBits;
+    return (shift + 1) * SubBuckets + static_cast<std::size_t>((ns >> shift) - SubBuckets);
+}
+
+std::uint64_t LatencyHistogram::bucketUpperBound(std::size_t index)
+{
+    if (index < 2 * SubBuckets) return index;
+    const std::size_t shift = index / SubBuckets - 1;
+    const std::uint64_t sub = index % SubBuckets + SubBuckets;
+    return ((sub + 1) << shift) - 1;
+}
+
+LatencyHistogram::~LatencyHistogram()
+{
+    for (auto& slot : shards) delete slot.load(std::memory_order_relaxed);
+}
+
+LatencyHistogram::Shard& LatencyHistogram::shard()
+{
+    static std::atomic<unsigned> nextThread{0};
+    thread_local const unsigned thread = nextThread.fetch_add(1, std::memory_order_relaxed) % MaxThreads;
+
+    std::atomic<Shard*>& slot = shards[thread];
+    Shard* s = slot.load(std::memory_order_acquire);
+    if (s) return *s;
+    Shard* fresh = new Shard();
+    if (slot.compare_exchange_strong(s, fresh, std::memory_order_acq_rel)) return *fresh;
+    delete fresh;  // A thread sharing this slot got there first
+    return *s;
+}
+
+void LatencyHistogram::record(std::uint64_t ns)
+{
+    Shard& s = shard();
+    // Single writer per shard: plain load + store, no read-modify-write.
+    auto bump = [](std::atomic<std::uint64_t>& a, std::uint64_t n) {
+        a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    };
+    bump(s.counts[bucketIndex(ns)], 1);
+    bump(s.sum, ns);
+    if (ns > s.max.load(std::memory_order_relaxed)) s.max.store(ns, std::memory_order_relaxed);
+}
+
+LatencySnapshot LatencyHistogram::snapshot() const
+{
+    LatencySnapshot out;
+    out.buckets.assign(BucketCount, 0);
+    for (const auto& slot : shards)
+    {
+        const Shard* s = slot.load(std::memory_order_acquire);
+        if (!s) continue;
+        for (std::size_t i = 0; i < BucketCount; ++i) out.buckets[i] += s->counts[i].load(std::memory_order_relaxed);
+        out.sum += s->sum.load(std::memory_order_relaxed);
+        out.max = std::max(out.max, s->max.load(std::memory_order_relaxed));
+    }
+    // Count from the buckets themselves so percentiles stay consistent with a
+    // record() that lands between the reads.
+    for (std::uint64_t c : out.buckets) out.count += c;
+    return out;
+}
+
+std::uint64_t LatencySnapshot::percentile(double q) const
+{
+    if (count == 0) return 0;
+    q = std::min(std::max(q, 0.0), 1.0);
+    const std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(q * static_cast<double>(count) + 0.5));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < buckets.size(); ++i)
+    {
+        seen += buckets[i];
+        if (seen >= rank) return std::min(LatencyHistogram::bucketUpperBound(i), max);
+    }
+    return max;
+}
+
+std::uint64_t LatencySnapshot::countAtOrBelow(std::uint64_t ns) const
+{
+    const std::size_t last = LatencyHistogram::bucketIndex(ns);
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i <= last && i < buckets.size(); ++i) total += buckets[i];
+    return total;
+}
+
+// ---------------------------------------------------------------------------
+// Pipeline
+// ---------------------------------------------------------------------------
+
+const char* pipelineStageName(PipelineStage stage)
+{
+    switch (stage)
+    {
+        case PipelineStage::Dissect: return "read->dissect";
+        case PipelineStage::Handle: return "dissect->handler";
+        case PipelineStage::Write: return "tap.write";
+        case PipelineStage::RxToTx: return "read->write";
+    }
+    return "?";
+}
+
+static std::string latencyText(std::uint64_t ns)
+{
+    char text[32];
+    if (ns >= 1000000000ull) std::snprintf(text, sizeof(text), "%.2fs", ns / 1e9);
+    else if (ns >= 1000000ull) std::snprintf(text, sizeof(text), "%.2fms", ns / 1e6);
+    else if (ns >= 1000ull) std::snprintf(text, sizeof(text), "%.1fus", ns / 1e3);
+    else std::snprintf(text, sizeof(text), "%lluns", static_cast<unsigned long long>(ns));
+    return text;
+}
+
+std::vector<std::string> formatPipelineLatency(const PipelineLatency& latency)
+{
+    std::vector<std::string> lines;
+    lines.push_back("Latencia por etapa (muestras / p50 / p99 / p99.9 / max)");
+    for (std::size_t i = 0; i < kPipelineStages; ++i)
+    {
+        const auto stage = static_cast<PipelineStage>(i);
+        const LatencySnapshot snap = latency[stage].snapshot();
+        char text[160];
+        std::snprintf(text, sizeof(text), "  %-17s %10llu %9s %9s %9s %9s", pipelineStageName(stage),
+                      static_cast<unsigned long long>(snap.count), latencyText(snap.percentile(0.50)).c_str(),
+                      latencyText(snap.percentile(0.99)).c_str(), latencyText(snap.percentile(0.999)).c_str(),
+                      latencyText(snap.max).c_str());
+        lines.push_back(text);
+    }
+    return lines;
+}
@@ -0,0 +1,397 @@
+#include "log_ring.h"
+#include "event_log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Text reserved per spilled line; longer lines shorten how far back the file reaches.
+static constexpr std::uint64_t kSpillBytesPerLine = 128;
+
+// SpillEntry::flags: the text is an EventRecord, not a line body.
+static constexpr std::uint16_t kSpillEvent = 0x0001;
+
+struct LogRing::SpillEntry {
+    std::uint64_t dataPos;  // Logical position in the text ring
+    std::uint64_t rowsBefore;
+    std::uint32_t length;
+    LogTag tag;
+    std::uint8_t isArp;
+    std::uint16_t flags;
+};
+
+const char* logTagText(LogTag tag)
+{
+    switch (tag)
+    {
+    case LogTag::Rx:
+        return "[RX]";
+    case LogTag::Tx:
+        return "[TX]";
+    case LogTag::Info:
+        return "[INFO]";
+    case LogTag::Warn:
+        return "[WARN]";
+    case LogTag::None:
+        break;
+    }
+    return "";
+}
+
+/**
+ * @brief Columns taken by the tag and its space on every row of a line.
+ */
+static int tagWidth(LogTag tag)
+{
+    return tag == LogTag::None ? 0 : static_cast<int>(std::strlen(logTagText(tag))) + 1;
+}
+
+LogRing::LogRing(std::size_t memoryLines)
+    : lines(std::max<std::size_t>(memoryLines, 1)), events(lines.size()), memoryCapacity(lines.size())
+{
+}
+
+LogRing::~LogRing()
+{
+    unmapSpill();
+}
+
+// ---------------------------------------------------------------------------
+// Spill file
+// ---------------------------------------------------------------------------
+
+void LogRing::unmapSpill()
+{
+    if (spillBase) munmap(spillBase, spillMapped);
+    spillBase = nullptr;
+    spillMapped = 0;
+    spillSlots = 0;
+    spillBytes = 0;
+    spillWritePos = 0;
+}
+
+bool LogRing::enableSpill(std::size_t capacity, const std::filesystem::path& directory, std::string& error)
+{
+    static_assert(sizeof(SpillEntry) == 24, "spill entry layout");
+    unmapSpill();
+    firstSeq = nextSeq - memoryCount;
+    if (capacity <= memoryCapacity) return true;  // Everything fits in RAM
+
+    const std::size_t slots = capacity - memoryCapacity;
+    const std::size_t indexSize = slots * sizeof(SpillEntry);
+    const std::size_t size = indexSize + slots * kSpillBytesPerLine;
+
+    std::string path = (directory / "netgui-log-XXXXXX").string();
+    const int fd = mkostemp(&path[0], O_CLOEXEC);
+    if (fd < 0)
+    {
+        error = path + ": " + std::strerror(errno);
+        return false;
+    }
+    // Nobody else needs the name; the space is released when the mapping goes away.
+    unlink(path.c_str());
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        error = path + ": ftruncate: " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        error = path + ": mmap: " + std::strerror(errno);
+        return false;
+    }
+
+    spillBase = static_cast<std::uint8_t*>(mapped);
+    spillMapped = size;
+    spillSlots = slots;
+    spillBytes = slots * kSpillBytesPerLine;
+    return true;
+}
+
+void LogRing::spill(std::uint64_t seq, const Line& line, const EventRecord& event)
+{
+    auto* entries = reinterpret_cast<SpillEntry*>(spillBase);
+    std::uint8_t* data = spillBase + spillSlots * sizeof(SpillEntry);
+
+    // The oldest spilled line gives up its slot.
+    if (seq - firstSeq >= spillSlots) ++firstSeq;
+
+    // Lines never straddle the end of the ring, so readers get one contiguous view.
+    const void* text = line.isEvent ? static_cast<const void*>(&event) : line.body.data();
+    const std::uint64_t length =
+        std::min<std::uint64_t>(line.isEvent ? sizeof(EventRecord) : line.body.size(), spillBytes);
+    std::uint64_t pos = spillWritePos;
+    if (pos % spillBytes + length > spillBytes) pos += spillBytes - pos % spillBytes;
+    std::memcpy(data + pos % spillBytes, text, length);
+    spillWritePos = pos + length;
+
+    SpillEntry& entry = entries[seq % spillSlots];
+    entry.dataPos = pos;
+    entry.rowsBefore = line.rowsBefore;
+    entry.length = static_cast<std::uint32_t>(length);
+    entry.tag = line.tag;
+    entry.isArp = line.isArp;
+    entry.flags = line.isEvent ? kSpillEvent : 0;
+
+    // Lines whose text has been overwritten are no longer reachable.
+    while (firstSeq < seq && spillWritePos > spillBytes &&
+           entries[firstSeq % spillSlots].dataPos < spillWritePos - spillBytes)
+    {
+        ++firstSeq;
+    }
+}
+
+std::string_view LogRing::spilledBody(std::uint64_t seq) const
+{
+    const auto* entries = reinterpret_cast<const SpillEntry*>(spillBase);
+    const SpillEntry& entry = entries[seq % spillSlots];
+    const std::uint8_t* data = spillBase + spillSlots * sizeof(SpillEntry);
+    return std::string_view(reinterpret_cast<const char*>(data + entry.dataPos % spillBytes), entry.length);
+}
+
+// ---------------------------------------------------------------------------
+// Lines and layout
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Make room for line nextSeq (spilling or dropping the oldest) and return its slot.
+ */
+LogRing::Line& LogRing::claimSlot()
+{
+    if (memoryCount == memoryCapacity)
+    {
+        const std::uint64_t oldest = nextSeq - memoryCount;
+        const std::size_t slot = oldest % memoryCapacity;
+        if (spillBase)
+        {
+            spill(oldest, lines[slot], events[slot]);
+        }
+        else
+        {
+            firstSeq = oldest + 1;
+        }
+        --memoryCount;
+    }
+    return lines[nextSeq % memoryCapacity];
+}
+
+void LogRing::push(std::string_view text)
+{
+    Line& line = claimSlot();
+    line.isEvent = false;
+    line.tag = LogTag::None;
+    for (const LogTag tag : {LogTag::Rx, LogTag::Tx, LogTag::Info, LogTag::Warn})
+    {
+        const std::string_view prefix = logTagText(tag);
+        if (text.compare(0, prefix.size(), prefix) == 0)
+        {
+            line.tag = tag;
+            text.remove_prefix(prefix.size());
+            if (!text.empty() && text[0] == ' ') text.remove_prefix(1);
+            break;
+        }
+    }
+    line.isArp = text.find("ARP") != std::string_view::npos;
+    line.body.assign(text.data(), text.size());  // Reuses the slot's buffer
+    line.rowsBefore = rowsEnd;
+    if (layoutWidth >= 0)
+    {
+        wrapLine(line.body, line.tag, line.spans);
+    }
+    else
+    {
+        line.spans.clear();
+    }
+    rowsEnd += std::max<std::size_t>(line.spans.size(), 1);
+    ++nextSeq;
+    ++memoryCount;
+}
+
+void LogRing::pushEvent(const EventRecord& event)
+{
+    Line& line = claimSlot();
+    events[nextSeq % memoryCapacity] = event;  // After claimSlot(): the slot may have held the spilled line
+    line.isEvent = true;
+    line.tag = eventTag(event);
+    line.isArp = eventIsArp(event);
+    line.body.clear();
+    line.spans.clear();
+    line.rowsBefore = rowsEnd;
+    rowsEnd += 1;
+    ++nextSeq;
+    ++memoryCount;
+}
+
+/**
+ * @brief Word-wrap @p body to the width left after the tag. Leading spaces of
+ * each row are dropped; words longer than a row are cut.
+ */
+void LogRing::wrapLine(std::string_view body, LogTag tag, std::vector<Span>& out) const
+{
+    out.clear();
+    const std::size_t width = static_cast<std::size_t>(std::max(0, layoutWidth - tagWidth(tag)));
+    if (width == 0) return;
+
+    std::size_t pos = 0;
+    while (pos < body.size())
+    {
+        while (pos < body.size() && body[pos] == ' ') ++pos;
+        if (pos >= body.size()) break;
+
+        const std::size_t start = pos;
+        const std::size_t end = std::min(body.size(), start + width);
+        if (end == body.size())
+        {
+            out.push_back({static_cast<std::uint32_t>(start), static_cast<std::uint32_t>(end - start)});
+            break;
+        }
+        const std::size_t space = body.substr(start, end - start).rfind(' ');
+        if (space != std::string_view::npos && space > 0)
+        {
+            out.push_back({static_cast<std::uint32_t>(start), static_cast<std::uint32_t>(space)});
+            pos = start + space + 1;
+        }
+        else
+        {
+            out.push_back({static_cast<std::uint32_t>(start), static_cast<std::uint32_t>(width)});
+            pos = start + width;
+        }
+    }
+}
+
+void LogRing::relayout(int width)
+{
+    layoutWidth = width;
+    std::uint64_t rows = 0;
+    for (std::uint64_t seq = firstSeq; seq < nextSeq; ++seq)
+    {
+        std::size_t lineRows;
+        if (inMemory(seq))
+        {
+            Line& line = lines[seq % memoryCapacity];
+            line.rowsBefore = rows;
+            if (!line.isEvent) wrapLine(line.body, line.tag, line.spans);
+            lineRows = line.spans.size();
+        }
+        else
+        {
+            SpillEntry& entry = reinterpret_cast<SpillEntry*>(spillBase)[seq % spillSlots];
+            entry.rowsBefore = rows;
+            scratch.clear();
+            if (!(entry.flags & kSpillEvent)) wrapLine(spilledBody(seq), entry.tag, scratch);
+            lineRows = scratch.size();
+        }
+        rows += std::max<std::size_t>(lineRows, 1);
+    }
+    rowsEnd = rows;
+}
+
+std::uint64_t LogRing::rowsBefore(std::uint64_t seq) const
+{
+    if (seq == nextSeq) return rowsEnd;
+    if (inMemory(seq)) return lines[seq % memoryCapacity].rowsBefore;
+    return reinterpret_cast<const SpillEntry*>(spillBase)[seq % spillSlots].rowsBefore;
+}
+
+std::uint64_t LogRing::totalRows(int width)
+{
+    if (width != layoutWidth) relayout(width);
+    return rowsEnd - rowsBefore(firstSeq);
+}
+
+void LogRing::rows(int width, std::uint64_t first, std::size_t count, std::vector<LogRow>& out)
+{
+    out.clear();
+    if (count == 0 || first >= totalRows(width)) return;
+
+    // Last line starting at or before the requested row.
+    const std::uint64_t target = rowsBefore(firstSeq) + first;
+    std::uint64_t lo = firstSeq;
+    std::uint64_t hi = nextSeq;
+    while (hi - lo > 1)
+    {
+        const std::uint64_t mid = lo + (hi - lo) / 2;
+        if (rowsBefore(mid) <= target)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    if (formatted.size() < count)
+    {
+        std::size_t size = 256;
+        while (size < count) size <<= 1;
+        formatted.assign(size, FormattedEvent{});
+    }
+    std::size_t skip = static_cast<std::size_t>(target - rowsBefore(lo));
+    for (std::uint64_t seq = lo; seq < nextSeq && out.size() < count; ++seq)
+    {
+        std::string_view body;
+        const std::vector<Span>* spans;
+        const EventRecord* event = nullptr;
+        EventRecord spilledEvent;
+        LogRow row;
+        if (inMemory(seq))
+        {
+            const Line& line = lines[seq % memoryCapacity];
+            body = line.body;
+            spans = &line.spans;
+            row.tag = line.tag;
+            row.isArp = line.isArp;
+            if (line.isEvent) event = &events[seq % memoryCapacity];
+        }
+        else
+        {
+            const SpillEntry& entry = reinterpret_cast<const SpillEntry*>(spillBase)[seq % spillSlots];
+            body = spilledBody(seq);
+            row.tag = entry.tag;
+            row.isArp = entry.isArp != 0;
+            scratch.clear();
+            if (entry.flags & kSpillEvent)
+            {
+                std::memcpy(&spilledEvent, body.data(), sizeof(spilledEvent));
+                event = &spilledEvent;
+            }
+            else
+            {
+                wrapLine(body, entry.tag, scratch);
+            }
+            spans = &scratch;
+        }
+
+        if (event)
+        {
+            // Events are one row: this is the only place their text is built.
+            FormattedEvent& cached = formatted[seq & (formatted.size() - 1)];
+            if (cached.seq != seq)
+            {
+                formatEvent(*event, cached.text);
+                cached.seq = seq;
+            }
+            row.firstRow = true;
+            row.text = cached.text;
+            out.push_back(row);
+            skip = 0;
+            continue;
+        }
+
+        const std::size_t lineRows = std::max<std::size_t>(spans->size(), 1);
+        for (std::size_t i = skip; i < lineRows && out.size() < count; ++i)
+        {
+            row.firstRow = i == 0;
+            row.text = spans->empty() ? std::string_view() : body.substr((*spans)[i].offset, (*spans)[i].length);
+            out.push_back(row);
+        }
+        skip = 0;
+    }
+}
@@ -0,0 +1,236 @@
+#include "mac_filter.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+static constexpr std::uint64_t kBroadcastKey = 0xffffffffffffULL;
+
+static std::uint64_t macKey(const std::uint8_t* mac)
+{
+    std::uint64_t key = 0;
+    std::memcpy(&key, mac, 6);  // Low 48 bits; the I/G bit is bit 0 of the first byte
+    return key;
+}
+
+static bool isMulticastKey(std::uint64_t key)
+{
+    return (key & 1) != 0;
+}
+
+static MacAddress keyMac(std::uint64_t key)
+{
+    MacAddress mac{};
+    std::memcpy(mac.data(), &key, mac.size());
+    return mac;
+}
+
+/**
+ * @brief ether_crc() of the kernel: CRC-32 (0x04c11db7), register shifted left,
+ * each octet fed LSB first, no final inversion. One table lookup per byte on
+ * the bit-reversed octet gives the same register.
+ */
+static std::uint32_t etherCrc(const std::uint8_t* data, std::size_t size)
+{
+    static const std::array<std::uint32_t, 256> table = [] {
+        std::array<std::uint32_t, 256> t{};
+        for (std::uint32_t i = 0; i < 256; ++i)
+        {
+            std::uint32_t crc = i << 24;
+            for (int bit = 0; bit < 8; ++bit) crc = (crc << 1) ^ ((crc & 0x80000000u) ? 0x04c11db7u : 0);
+            t[i] = crc;
+        }
+        return t;
+    }();
+    static const std::array<std::uint8_t, 256> reversed = [] {
+        std::array<std::uint8_t, 256> r{};
+        for (unsigned i = 0; i < 256; ++i)
+        {
+            unsigned v = 0;
+            for (int bit = 0; bit < 8; ++bit) v |= ((i >> bit) & 1u) << (7 - bit);
+            r[i] = static_cast<std::uint8_t>(v);
+        }
+        return r;
+    }();
+
+    std::uint32_t crc = 0xffffffffu;
+    for (std::size_t i = 0; i < size; ++i) crc = (crc << 8) ^ table[(crc >> 24) ^ reversed[data[i]]];
+    return crc;
+}
+
+unsigned MacFilter::hashBucket(const std::uint8_t* mac)
+{
+    return etherCrc(mac, 6) >> 26;
+}
+
+MacFilter::MacFilter()
+{
+    rebuild();
+}
+
+bool MacFilter::addUnicast(const MacAddress& mac)
+{
+    const std::uint64_t key = macKey(mac.data());
+    if (isMulticastKey(key)) return false;
+    if (std::find(unicast.begin(), unicast.end(), key) == unicast.end())
+    {
+        unicast.push_back(key);
+        ++version;
+    }
+    return true;
+}
+
+void MacFilter::removeUnicast(const MacAddress& mac)
+{
+    const auto it = std::find(unicast.begin(), unicast.end(), macKey(mac.data()));
+    if (it == unicast.end()) return;
+    unicast.erase(it);
+    ++version;
+}
+
+bool MacFilter::join(const MacAddress& group)
+{
+    const std::uint64_t key = macKey(group.data());
+    if (!isMulticastKey(key) || key == kBroadcastKey) return false;
+    for (Group& g : groups)
+    {
+        if (g.key == key)
+        {
+            ++g.refs;
+            return true;
+        }
+    }
+    groups.push_back(Group{key, 1});
+    rebuild();
+    return true;
+}
+
+void MacFilter::leave(const MacAddress& group)
+{
+    const std::uint64_t key = macKey(group.data());
+    for (auto it = groups.begin(); it != groups.end(); ++it)
+    {
+        if (it->key != key) continue;
+        if (--it->refs == 0)
+        {
+            groups.erase(it);
+            rebuild();
+        }
+        return;
+    }
+}
+
+bool MacFilter::isMember(const MacAddress& group) const
+{
+    return inGroupSet(macKey(group.data()));
+}
+
+void MacFilter::setAcceptBroadcast(bool accept)
+{
+    if (broadcast == accept) return;
+    broadcast = accept;
+    rebuild();
+}
+
+void MacFilter::setAllMulticast(bool accept)
+{
+    if (allMulti == accept) return;
+    allMulti = accept;
+    ++version;
+}
+
+void MacFilter::rebuild()
+{
+    std::size_t size = 8;
+    while (size < groups.size() * 2) size <<= 1;
+    table.assign(size, 0);
+    shift = 64;
+    for (std::size_t s = size; s > 1; s >>= 1) --shift;
+
+    mask = 0;
+    if (broadcast) mask |= 1ULL << hashBucket(keyMac(kBroadcastKey).data());
+    for (const Group& g : groups)
+    {
+        std::size_t slot = static_cast<std::size_t>((g.key * 0x9E3779B97F4A7C15ULL) >> shift);
+        while (table[slot] != 0) slot = (slot + 1) & (size - 1);
+        table[slot] = g.key;
+        mask |= 1ULL << hashBucket(keyMac(g.key).data());
+    }
+    ++version;
+}
+
+bool MacFilter::inGroupSet(std::uint64_t key) const
+{
+    const std::size_t last = table.size() - 1;
+    std::size_t slot = static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ULL) >> shift);
+    while (table[slot] != 0)
+    {
+        if (table[slot] == key) return true;
+        slot = (slot + 1) & last;
+    }
+    return false;
+}
+
+bool MacFilter::accepts(const std::uint8_t* mac) const
+{
+    const std::uint64_t key = macKey(mac);
+    if (!isMulticastKey(key)) return std::find(unicast.begin(), unicast.end(), key) != unicast.end();
+    if (key == kBroadcastKey) return broadcast;
+    return allMulti || inGroupSet(key);
+}
+
+bool MacFilter::accept(const std::uint8_t* frame, std::size_t size)
+{
+    if (size < EthernetII::HeaderSize)
+    {
+        ++counters.rejectedRunt;
+        return false;
+    }
+    const std::uint64_t key = macKey(frame);
+    if (!isMulticastKey(key))
+    {
+        if (std::find(unicast.begin(), unicast.end(), key) != unicast.end())
+        {
+            ++counters.accepted;
+            return true;
+        }
+        ++counters.rejectedUnicast;
+        return false;
+    }
+    if (key == kBroadcastKey)
+    {
+        if (broadcast)
+        {
+            ++counters.accepted;
+            return true;
+        }
+        ++counters.rejectedBroadcast;
+        return false;
+    }
+    if (allMulti || inGroupSet(key))
+    {
+        ++counters.accepted;
+        return true;
+    }
+    // Only rejects pay for the CRC: it tells which stage the kernel would have stopped it at.
+    if ((mask >> hashBucket(frame)) & 1)
+    {
+        ++counters.rejectedGroup;
+    }
+    else
+    {
+        ++counters.rejectedHash;
+    }
+    return false;
+}
+
+std::vector<MacAddress> MacFilter::kernelAddresses() const
+{
+    std::vector<MacAddress> out;
+    if (unicast.size() > KernelExactSlots) return out;
+    out.reserve(unicast.size() + groups.size() + 1);
+    for (std::uint64_t key : unicast) out.push_back(keyMac(key));
+    if (broadcast) out.push_back(keyMac(kBroadcastKey));
+    for (const Group& g : groups) out.push_back(keyMac(g.key));
+    return out;
+}
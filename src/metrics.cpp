@@ -0,0 +1,345 @@
+#include "metrics.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+const std::vector<double> kMetricLatencyBuckets = {
+    1e-6, 2.5e-6, 5e-6, 1e-5, 2.5e-5, 5e-5, 1e-4, 2.5e-4, 5e-4, 1e-3, 2.5e-3, 5e-3, 1e-2, 0.1, 1.0,
+};
+
+// ---------------------------------------------------------------------------
+// Registry
+// ---------------------------------------------------------------------------
+
+MetricsRegistry::Metric& MetricsRegistry::add(const std::string& name, const std::string& help,
+                                              const std::string& labels, MetricType type)
+{
+    metrics.push_back(std::make_unique<Metric>());
+    Metric& m = *metrics.back();
+    m.name = name;
+    m.help = help;
+    m.labels = labels;
+    m.type = type;
+    return m;
+}
+
+MetricCounter& MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels)
+{
+    return add(name, help, labels, MetricType::Counter).counter;
+}
+
+MetricGauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const std::string& labels)
+{
+    return add(name, help, labels, MetricType::Gauge).gauge;
+}
+
+void MetricsRegistry::histogram(const std::string& name, const std::string& help, const LatencyHistogram& histogram,
+                                const std::string& labels)
+{
+    add(name, help, labels, MetricType::Histogram).histogram = &histogram;
+}
+
+void MetricsRegistry::callback(const std::string& name, const std::string& help, MetricType type,
+                               std::function<double()> read, const std::string& labels)
+{
+    add(name, help, labels, type).read = std::move(read);
+}
+
+static const char* metricTypeName(MetricType type)
+{
+    switch (type)
+    {
+        case MetricType::Counter: return "counter";
+        case MetricType::Gauge: return "gauge";
+        case MetricType::Histogram: return "histogram";
+    }
+    return "untyped";
+}
+
+static std::string seriesName(const std::string& name, const std::string& suffix, const std::string& labels,
+                              const std::string& extra = "")
+{
+    std::string out = name + suffix;
+    if (labels.empty() && extra.empty()) return out;
+    out += '{';
+    out += labels;
+    if (!labels.empty() && !extra.empty()) out += ',';
+    out += extra;
+    out += '}';
+    return out;
+}
+
+static std::string number(double v)
+{
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.9g", v);
+    return text;
+}
+
+static std::string number(std::uint64_t v)
+{
+    return std::to_string(v);
+}
+
+std::string MetricsRegistry::render() const
+{
+    std::string out;
+    out.reserve(metrics.size() * 96);
+    std::vector<bool> done(metrics.size(), false);
+    for (std::size_t i = 0; i < metrics.size(); ++i)
+    {
+        if (done[i]) continue;
+        const Metric& head = *metrics[i];
+        out += "# HELP " + head.name + " " + head.help + "\n";
+        out += "# TYPE " + head.name + " " + metricTypeName(head.type) + "\n";
+        for (std::size_t j = i; j < metrics.size(); ++j)
+        {
+            const Metric& m = *metrics[j];
+            if (done[j] || m.name != head.name) continue;
+            done[j] = true;
+            if (m.type == MetricType::Histogram)
+            {
+                const LatencySnapshot snap = m.histogram->snapshot();
+                for (double bound : kMetricLatencyBuckets)
+                {
+                    const auto ns = static_cast<std::uint64_t>(bound * 1e9);
+                    out += seriesName(m.name, "_bucket", m.labels, "le=\"" + number(bound) + "\"") + " " +
+                           number(snap.countAtOrBelow(ns)) + "\n";
+                }
+                out += seriesName(m.name, "_bucket", m.labels, "le=\"+Inf\"") + " " + number(snap.count) + "\n";
+                out += seriesName(m.name, "_sum", m.labels) + " " + number(static_cast<double>(snap.sum) / 1e9) + "\n";
+                out += seriesName(m.name, "_count", m.labels) + " " + number(snap.count) + "\n";
+            }
+            else if (m.read)
+            {
+                out += seriesName(m.name, "", m.labels) + " " + number(m.read()) + "\n";
+            }
+            else if (m.type == MetricType::Counter)
+            {
+                out += seriesName(m.name, "", m.labels) + " " + number(m.counter.get()) + "\n";
+            }
+            else
+            {
+                out += seriesName(m.name, "", m.labels) + " " + number(m.gauge.get()) + "\n";
+            }
+        }
+    }
+    return out;
+}
+
+// ---------------------------------------------------------------------------
+// Server
+// ---------------------------------------------------------------------------
+
+MetricsServer::MetricsServer(const MetricsRegistry& registry) : registry(registry)
+{
+}
+
+MetricsServer::~MetricsServer()
+{
+    stop();
+}
+
+static int listenUnix(const std::string& path, std::string& error)
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path))
+    {
+        error = "ruta de socket Unix inválida";
+        return -1;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0)
+    {
+        error = std::string("socket: ") + std::strerror(errno);
+        return -1;
+    }
+    unlink(path.c_str());  // Left over from a previous run
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(fd, 8) < 0)
+    {
+        error = path + ": " + std::strerror(errno);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int listenLoopback(const std::string& host, const std::string& portText, std::string& error)
+{
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    const std::string ip = (host.empty() || host == "localhost") ? "127.0.0.1" : host;
+    if (inet_pton(AF_INET, ip.c_str(), &addr.sin_addr) != 1 || (ntohl(addr.sin_addr.s_addr) >> 24) != 127)
+    {
+        error = "solo se admiten direcciones de loopback (127.0.0.0/8): " + host;
+        return -1;
+    }
+    char* end = nullptr;
+    const unsigned long port = std::strtoul(portText.c_str(), &end, 10);
+    if (portText.empty() || *end != '\0' || port == 0 || port > 65535)
+    {
+        error = "puerto inválido: " + portText;
+        return -1;
+    }
+    addr.sin_port = htons(static_cast<std::uint16_t>(port));
+    const int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0)
+    {
+        error = std::string("socket: ") + std::strerror(errno);
+        return -1;
+    }
+    const int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(fd, 8) < 0)
+    {
+        error = ip + ":" + portText + ": " + std::strerror(errno);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool MetricsServer::start(const std::string& endpoint, std::string& error)
+{
+    stop();
+    if (endpoint.rfind("unix:", 0) == 0)
+    {
+        unixPath = endpoint.substr(5);
+        listenFd = listenUnix(unixPath, error);
+        if (listenFd < 0) unixPath.clear();
+    }
+    else
+    {
+        const std::size_t colon = endpoint.rfind(':');
+        listenFd = colon == std::string::npos ? listenLoopback("", endpoint, error)
+                                              : listenLoopback(endpoint.substr(0, colon), endpoint.substr(colon + 1), error);
+    }
+    if (listenFd < 0) return false;
+
+    wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeFd < 0)
+    {
+        error = std::string("eventfd: ") + std::strerror(errno);
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    where = endpoint;
+    worker = std::thread([this] { run(); });
+    return true;
+}
+
+void MetricsServer::stop()
+{
+    if (worker.joinable())
+    {
+        const std::uint64_t one = 1;
+        if (write(wakeFd, &one, sizeof(one)) < 0)
+        {
+            // eventfd only fails if the counter would overflow: the thread is already being woken
+        }
+        worker.join();
+    }
+    if (listenFd >= 0) close(listenFd);
+    if (wakeFd >= 0) close(wakeFd);
+    listenFd = -1;
+    wakeFd = -1;
+    if (!unixPath.empty()) unlink(unixPath.c_str());
+    unixPath.clear();
+}
+
+void MetricsServer::run()
+{
+    for (;;)
+    {
+        pollfd fds[2] = {{listenFd, POLLIN, 0}, {wakeFd, POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (fds[1].revents) return;
+        if (!(fds[0].revents & POLLIN)) continue;
+        const int client = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+        if (client < 0) continue;
+        serve(client);
+        close(client);
+    }
+}
+
+bool MetricsServer::waitClient(int client, short events, Clock::time_point deadline) const
+{
+    for (;;)
+    {
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        if (left <= 0) return false;
+        pollfd fds[2] = {{client, events, 0}, {wakeFd, POLLIN, 0}};
+        const int ready = poll(fds, 2, static_cast<int>(left));
+        if (ready < 0 && errno == EINTR) continue;
+        return ready > 0 && !fds[1].revents && (fds[0].revents & (events | POLLERR | POLLHUP));
+    }
+}
+
+void MetricsServer::serve(int client)
+{
+    // One deadline for the whole exchange: a client trickling bytes (or not
+    // reading the answer) cannot hold the only scrape thread for longer.
+    const Clock::time_point deadline = Clock::now() + std::chrono::seconds(1);
+
+    // Read the request head; a scraper sends it in one segment.
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.find("\n\n") == std::string::npos &&
+           request.size() < 8192)
+    {
+        const ssize_t n = read(client, buffer, sizeof(buffer));
+        if (n < 0 && (errno == EAGAIN || errno == EINTR))
+        {
+            if (!waitClient(client, POLLIN, deadline)) break;
+            continue;
+        }
+        if (n <= 0) break;
+        request.append(buffer, static_cast<std::size_t>(n));
+    }
+
+    const bool get = request.rfind("GET ", 0) == 0;
+    const std::size_t pathEnd = request.find(' ', 4);
+    const std::string path = get && pathEnd != std::string::npos ? request.substr(4, pathEnd - 4) : "";
+    std::string status = "200 OK";
+    std::string body;
+    if (path == "/metrics" || path == "/")
+    {
+        body = registry.render();
+        served.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        status = get ? "404 Not Found" : "400 Bad Request";
+        body = status + "\n";
+    }
+    const std::string response = "HTTP/1.1 " + status +
+                                 "\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: " +
+                                 std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+    std::size_t offset = 0;
+    while (offset < response.size())
+    {
+        const ssize_t n = send(client, response.data() + offset, response.size() - offset, MSG_NOSIGNAL);
+        if (n < 0 && (errno == EAGAIN || errno == EINTR))
+        {
+            if (!waitClient(client, POLLOUT, deadline)) break;
+            continue;
+        }
+        if (n <= 0) break;
+        offset += static_cast<std::size_t>(n);
+    }
+}
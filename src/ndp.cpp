@@ -0,0 +1,491 @@
+#include "ndp.h"
+#include "checksum.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstring>
+
+const char* neighborStateName(NeighborState state)
+{
+    switch (state)
+    {
+        case NeighborState::Incomplete: return "INCOMPLETE";
+        case NeighborState::Reachable: return "REACHABLE";
+        case NeighborState::Stale: return "STALE";
+        case NeighborState::Delay: return "DELAY";
+        case NeighborState::Probe: return "PROBE";
+    }
+    return "?";
+}
+
+// ---------------------------------------------------------------------------
+// Neighbor cache
+// ---------------------------------------------------------------------------
+
+NeighborCache::NeighborCache(std::size_t maxEntries) : limit(std::max<std::size_t>(maxEntries, 1))
+{
+    std::size_t slots = 2;
+    while (slots < limit * 2) slots <<= 1;
+    keys.assign(slots, Key{});
+    entries.assign(slots, NeighborEntry{});
+    mask = slots - 1;
+}
+
+NeighborCache::Key NeighborCache::keyOf(const Ipv6Address& ip)
+{
+    Key key;
+    std::memcpy(&key.hi, ip.data(), 8);
+    std::memcpy(&key.lo, ip.data() + 8, 8);
+    return key;
+}
+
+std::size_t NeighborCache::home(const Key& key) const
+{
+    // Neighbors mostly share the prefix and differ in the interface ID: mix both halves.
+    std::uint64_t x = key.lo ^ (key.hi * 0x9E3779B97F4A7C15ull);
+    x ^= x >> 32;
+    x *= 0xD6E8FEB86659FD93ull;
+    x ^= x >> 32;
+    return static_cast<std::size_t>(x) & mask;
+}
+
+std::size_t NeighborCache::slotOf(const Key& key) const
+{
+    for (std::size_t i = home(key);; i = (i + 1) & mask)
+    {
+        const Key& k = keys[i];
+        if (k == key) return i;
+        if ((k.hi | k.lo) == 0) return keys.size();
+    }
+}
+
+NeighborEntry* NeighborCache::find(const Ipv6Address& ip)
+{
+    const Key key = keyOf(ip);
+    if ((key.hi | key.lo) == 0) return nullptr;
+    const std::size_t slot = slotOf(key);
+    return slot == keys.size() ? nullptr : &entries[slot];
+}
+
+const NeighborEntry* NeighborCache::find(const Ipv6Address& ip) const
+{
+    return const_cast<NeighborCache*>(this)->find(ip);
+}
+
+NeighborEntry* NeighborCache::insert(const Ipv6Address& ip, Clock::time_point now, bool* created)
+{
+    if (created) *created = false;
+    const Key key = keyOf(ip);
+    if ((key.hi | key.lo) == 0) return nullptr;
+
+    std::size_t slot = slotOf(key);
+    if (slot != keys.size()) return &entries[slot];
+
+    if (count >= limit) evictOne();
+    slot = home(key);
+    while (keys[slot].hi | keys[slot].lo) slot = (slot + 1) & mask;
+
+    keys[slot] = key;
+    NeighborEntry& entry = entries[slot];
+    entry = NeighborEntry{};
+    entry.ip = ip;
+    entry.updated = now;
+    ++count;
+    if (created) *created = true;
+    return &entry;
+}
+
+bool NeighborCache::erase(const Ipv6Address& ip)
+{
+    const Key key = keyOf(ip);
+    if ((key.hi | key.lo) == 0) return false;
+    const std::size_t slot = slotOf(key);
+    if (slot == keys.size()) return false;
+    eraseSlot(slot);
+    return true;
+}
+
+void NeighborCache::eraseSlot(std::size_t slot)
+{
+    // Backward shift: pull later members of the run into the hole unless that
+    // would move them in front of their home slot.
+    std::size_t hole = slot;
+    for (std::size_t i = (hole + 1) & mask;; i = (i + 1) & mask)
+    {
+        if ((keys[i].hi | keys[i].lo) == 0) break;
+        const std::size_t h = home(keys[i]);
+        const bool movable = hole <= i ? (h <= hole || h > i) : (h <= hole && h > i);
+        if (!movable) continue;
+        keys[hole] = keys[i];
+        entries[hole] = entries[i];
+        hole = i;
+    }
+    keys[hole] = Key{};
+    --count;
+}
+
+void NeighborCache::evictOne()
+{
+    std::size_t victim = keys.size();
+    for (std::size_t i = 0; i < keys.size(); ++i)
+    {
+        if ((keys[i].hi | keys[i].lo) == 0) continue;
+        if (victim == keys.size())
+        {
+            victim = i;
+            continue;
+        }
+        const NeighborEntry& a = entries[i];
+        const NeighborEntry& b = entries[victim];
+        const bool aReachable = a.state == NeighborState::Reachable;
+        const bool bReachable = b.state == NeighborState::Reachable;
+        if (aReachable != bReachable ? !aReachable : a.updated < b.updated) victim = i;
+    }
+    if (victim == keys.size()) return;
+    eraseSlot(victim);
+    ++evicted;
+}
+
+void NeighborCache::clear()
+{
+    std::fill(keys.begin(), keys.end(), Key{});
+    count = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Neighbor Discovery
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Fill an NS/NA with one link-layer option at @p l4 and compute its
+ * checksum over the IPv6 pseudo-header.
+ */
+static void writeNeighborMessage(std::uint8_t* l4, std::uint8_t type, std::uint32_t flags,
+                                 const Ipv6Address& target, std::uint8_t option, const MacAddress& mac,
+                                 const Ipv6Address& src, const Ipv6Address& dst)
+{
+    NdpNeighborMessage message{};
+    message.type = type;
+    message.flags = htonl(flags);
+    std::copy(target.begin(), target.end(), message.target);
+    std::memcpy(l4, &message, sizeof(message));
+
+    std::uint8_t* opt = l4 + sizeof(message);
+    opt[0] = option;
+    opt[1] = 1;  // Length in units of 8 bytes
+    std::memcpy(opt + 2, mac.data(), mac.size());
+
+    std::uint32_t sum = checksumPseudoIpv6(src.data(), dst.data(), IpProto::ICMPv6, kNdpMessageSize);
+    const std::uint16_t checksum = checksumFinish(checksumAccumulate(l4, kNdpMessageSize, sum));
+    std::memcpy(l4 + offsetof(NdpNeighborMessage, checksum), &checksum, sizeof(checksum));
+}
+
+Ndp::Ndp(Ipv6Layer& layer, const NdpConfig& cfg) : ipv6(layer), config(cfg), cache(cfg.cacheEntries)
+{
+    ipv6.setHandler(IpProto::ICMPv6, [this](Ipv6Packet& packet) { handle(packet); });
+}
+
+void Ndp::handle(Ipv6Packet& packet)
+{
+    ++counters.rxMessages;
+    if (packet.payloadSize < 4)
+    {
+        ++counters.malformed;
+        return;
+    }
+
+    std::uint8_t* icmp = packet.payload();
+    const std::uint8_t type = icmp[0];
+    if (type != Icmpv6Type::NeighborSolicitation && type != Icmpv6Type::NeighborAdvertisement)
+    {
+        ++counters.ignored;
+        return;
+    }
+    if (type == Icmpv6Type::NeighborSolicitation) ++counters.solicitations;
+    else ++counters.advertisements;
+
+    // RFC 4861 7.1: hop limit 255 proves the sender is on-link; code 0; fixed part present.
+    if (packet.hopLimit != 255 || icmp[1] != 0 || packet.payloadSize < sizeof(NdpNeighborMessage))
+    {
+        ++counters.malformed;
+        return;
+    }
+    const std::uint32_t sum = checksumPseudoIpv6(packet.src.data(), packet.dst.data(), IpProto::ICMPv6,
+                                                 static_cast<std::uint32_t>(packet.payloadSize));
+    if (checksumFinish(checksumAccumulate(icmp, packet.payloadSize, sum)) != 0)
+    {
+        ++counters.checksumErrors;
+        return;
+    }
+
+    NdpNeighborMessage message;
+    std::memcpy(&message, icmp, sizeof(message));
+    Ipv6Address target;
+    std::copy_n(message.target, 16, target.begin());
+    if (ipv6IsMulticast(target))
+    {
+        ++counters.malformed;
+        return;
+    }
+
+    // Options: every one needs a non-zero length; only the link-layer addresses matter here.
+    const std::uint8_t* linkAddress = nullptr;
+    const std::uint8_t wanted = type == Icmpv6Type::NeighborSolicitation ? NdpOption::SourceLinkAddress
+                                                                         : NdpOption::TargetLinkAddress;
+    for (std::size_t at = sizeof(NdpNeighborMessage); at < packet.payloadSize;)
+    {
+        if (packet.payloadSize - at < 2 || icmp[at + 1] == 0)
+        {
+            ++counters.malformed;
+            return;
+        }
+        const std::size_t len = static_cast<std::size_t>(icmp[at + 1]) * 8;
+        if (len > packet.payloadSize - at)
+        {
+            ++counters.malformed;
+            return;
+        }
+        if (icmp[at] == wanted && len == 8) linkAddress = icmp + at + 2;
+        at += len;
+    }
+
+    if (type == Icmpv6Type::NeighborSolicitation) onSolicitation(packet, target, linkAddress);
+    else onAdvertisement(packet, target, ntohl(message.flags), linkAddress);
+}
+
+void Ndp::onSolicitation(Ipv6Packet& packet, const Ipv6Address& target, const std::uint8_t* sourceMac)
+{
+    const bool dad = ipv6IsUnspecified(packet.src);
+    // DAD probes come from :: to the solicited-node group and never carry a source link address.
+    if (dad && (packet.dst != ipv6SolicitedNode(target) || sourceMac))
+    {
+        ++counters.malformed;
+        return;
+    }
+    if (!ipv6.isLocal(target))
+    {
+        ++counters.notForUs;
+        return;
+    }
+
+    // RFC 4861 7.2.3: the sender's link address creates or refreshes a STALE entry.
+    if (!dad && sourceMac)
+    {
+        bool created = false;
+        NeighborEntry* entry = cache.insert(packet.src, packet.rxTime, &created);
+        if (entry && (created || std::memcmp(entry->mac.data(), sourceMac, 6) != 0))
+        {
+            std::memcpy(entry->mac.data(), sourceMac, 6);
+            entry->state = NeighborState::Stale;
+            entry->probes = 0;
+            entry->deadline = packet.rxTime + config.staleTimeout;
+            entry->updated = packet.rxTime;
+        }
+    }
+
+    // Answer in place. A DAD probe is answered to all-nodes (defending our address).
+    const std::size_t replySize = packet.l3Offset + kIpv6HeaderSize + kNdpMessageSize;
+    if (packet.capacity < replySize)
+    {
+        ++counters.txErrors;
+        return;
+    }
+
+    const Ipv6Address replyDst = dad ? kIpv6AllNodes : packet.src;
+    MacAddress dstMac;
+    if (dad) dstMac = ipv6MulticastMac(kIpv6AllNodes);
+    else if (sourceMac) std::memcpy(dstMac.data(), sourceMac, 6);
+    else std::memcpy(dstMac.data(), packet.frame + 6, 6);
+
+    // Ethernet: only the MACs change (the EtherType, and a VLAN tag if any, stay).
+    std::memcpy(packet.frame, dstMac.data(), 6);
+    std::memcpy(packet.frame + 6, ipv6.link().data(), 6);
+
+    writeIpv6Header(packet.header(), target, replyDst, IpProto::ICMPv6, kNdpMessageSize, 255);
+    const std::uint32_t flags = NdpFlag::Override | (dad ? 0 : NdpFlag::Solicited);
+    writeNeighborMessage(packet.payload(), Icmpv6Type::NeighborAdvertisement, flags, target,
+                         NdpOption::TargetLinkAddress, ipv6.link(), target, replyDst);
+
+    if (ipv6.send(packet.frame, replySize) < 0)
+    {
+        ++counters.txErrors;
+        return;
+    }
+    ++counters.advertisementsSent;
+}
+
+void Ndp::onAdvertisement(const Ipv6Packet& packet, const Ipv6Address& target, std::uint32_t flags,
+                          const std::uint8_t* targetMac)
+{
+    const bool solicited = (flags & NdpFlag::Solicited) != 0;
+    if (solicited && ipv6IsMulticast(packet.dst))
+    {
+        ++counters.malformed;
+        return;
+    }
+    if (ipv6.isLocal(target))
+    {
+        ++counters.duplicateAddress;
+        return;
+    }
+
+    // RFC 4861 7.2.5: advertisements never create entries.
+    NeighborEntry* entry = cache.find(target);
+    if (!entry)
+    {
+        ++counters.notForUs;
+        return;
+    }
+
+    const Clock::time_point now = packet.rxTime;
+    const bool override = (flags & NdpFlag::Override) != 0;
+    auto setState = [&](NeighborState state) {
+        entry->state = state;
+        entry->probes = 0;
+        entry->updated = now;
+        entry->deadline = now + (state == NeighborState::Reachable ? config.reachableTime : config.staleTimeout);
+    };
+
+    if (entry->state == NeighborState::Incomplete)
+    {
+        if (!targetMac) return;
+        std::memcpy(entry->mac.data(), targetMac, 6);
+        entry->router = (flags & NdpFlag::Router) != 0;
+        setState(solicited ? NeighborState::Reachable : NeighborState::Stale);
+        return;
+    }
+
+    const bool different = targetMac && std::memcmp(entry->mac.data(), targetMac, 6) != 0;
+    if (!override && different)
+    {
+        // Keep the cached address, but stop trusting it.
+        if (entry->state == NeighborState::Reachable) setState(NeighborState::Stale);
+        return;
+    }
+
+    if (targetMac) std::memcpy(entry->mac.data(), targetMac, 6);
+    entry->router = (flags & NdpFlag::Router) != 0;
+    if (solicited) setState(NeighborState::Reachable);
+    else if (different) setState(NeighborState::Stale);
+}
+
+bool Ndp::solicit(const Ipv6Address& target, const MacAddress* unicast)
+{
+    const auto& locals = ipv6.localAddresses();
+    if (locals.empty()) return false;
+
+    const Ipv6Address dst = unicast ? target : ipv6SolicitedNode(target);
+    std::uint8_t* frame = txFrame.data();
+    writeEthernetHeader(frame, unicast ? *unicast : ipv6MulticastMac(dst), ipv6.link(), EtherType::IPv6);
+    writeIpv6Header(frame + EthernetII::HeaderSize, locals.front(), dst, IpProto::ICMPv6, kNdpMessageSize, 255);
+    writeNeighborMessage(frame + kIpv6PayloadOffset, Icmpv6Type::NeighborSolicitation, 0, target,
+                         NdpOption::SourceLinkAddress, ipv6.link(), locals.front(), dst);
+
+    if (ipv6.send(frame, txFrame.size()) < 0)
+    {
+        ++counters.txErrors;
+        return false;
+    }
+    ++counters.solicitationsSent;
+    return true;
+}
+
+std::optional<MacAddress> Ndp::resolve(const Ipv6Address& ip, Clock::time_point now)
+{
+    if (ipv6IsMulticast(ip)) return ipv6MulticastMac(ip);
+
+    if (NeighborEntry* entry = cache.find(ip))
+    {
+        switch (entry->state)
+        {
+            case NeighborState::Incomplete:
+                return std::nullopt;
+            case NeighborState::Stale:
+                // First use of a stale entry: give upper layers a chance to confirm before probing.
+                entry->state = NeighborState::Delay;
+                entry->deadline = now + config.delayFirstProbe;
+                entry->updated = now;
+                return entry->mac;
+            default:
+                return entry->mac;
+        }
+    }
+
+    NeighborEntry* entry = cache.insert(ip, now);
+    if (!entry) return std::nullopt;
+    entry->state = NeighborState::Incomplete;
+    entry->probes = 1;
+    entry->deadline = now + config.retransTimer;
+    solicit(ip, nullptr);
+    return std::nullopt;
+}
+
+void Ndp::confirm(const Ipv6Address& ip, Clock::time_point now)
+{
+    NeighborEntry* entry = cache.find(ip);
+    if (!entry || entry->state == NeighborState::Incomplete) return;
+    entry->state = NeighborState::Reachable;
+    entry->probes = 0;
+    entry->deadline = now + config.reachableTime;
+    entry->updated = now;
+}
+
+std::size_t Ndp::expire(Clock::time_point now)
+{
+    scratch.clear();
+    cache.forEach([&](NeighborEntry& entry) {
+        if (now < entry.deadline) return;
+        switch (entry.state)
+        {
+            case NeighborState::Reachable:
+                entry.state = NeighborState::Stale;
+                entry.deadline = now + config.staleTimeout;
+                entry.updated = now;
+                break;
+            case NeighborState::Stale:
+                scratch.push_back(entry.ip);
+                break;
+            case NeighborState::Delay:
+                entry.state = NeighborState::Probe;
+                entry.probes = 1;
+                entry.deadline = now + config.retransTimer;
+                entry.updated = now;
+                solicit(entry.ip, &entry.mac);
+                break;
+            case NeighborState::Probe:
+            case NeighborState::Incomplete:
+            {
+                const bool probing = entry.state == NeighborState::Probe;
+                if (entry.probes >= (probing ? config.maxUnicastSolicit : config.maxMulticastSolicit))
+                {
+                    ++counters.resolutionFailed;
+                    scratch.push_back(entry.ip);
+                    break;
+                }
+                ++entry.probes;
+                entry.deadline = now + config.retransTimer;
+                solicit(entry.ip, probing ? &entry.mac : nullptr);
+                break;
+            }
+        }
+    });
+    for (const Ipv6Address& ip : scratch) cache.erase(ip);
+    return scratch.size();
+}
+
+std::vector<std::string> formatNeighborCache(const NeighborCache& cache, std::chrono::steady_clock::time_point now)
+{
+    std::vector<std::string> lines;
+    lines.reserve(cache.size() + 1);
+    lines.push_back("IPv6 -> MAC ESTADO (edad s)");
+    cache.forEach([&](const NeighborEntry& entry) {
+        long age = std::chrono::duration_cast<std::chrono::seconds>(now - entry.updated).count();
+        if (age < 0) age = 0;
+        std::string line = ipv6ToString(entry.ip) + " -> " +
+                           (entry.state == NeighborState::Incomplete ? std::string("?") : macToString(entry.mac)) +
+                           " " + neighborStateName(entry.state) + " (" + std::to_string(age) + ")" +
+                           (entry.router ? " [router]" : "");
+        lines.push_back(line);
+    });
+    return lines;
+}
@@ -1,10 +1,16 @@
 #include "netgui_actions.h"
 
+#include <cerrno>
+#include <csignal>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iterator>
 
+#include <sys/wait.h>
+#include <unistd.h>
+
 /**
  * @brief Read a whole text file into a string.
  */
@@ -71,20 +77,62 @@ bool ensureCustomPacketTemplate(const std::filesystem::path& packetFile, std::st
     return true;
 }
 
-void openFileInEditor(const std::filesystem::path& file, std::string& outMsg)
+// Disposición de SIGINT/SIGQUIT antes de abrir el editor (restaurada al cerrarlo).
+static struct sigaction savedSigint;
+static struct sigaction savedSigquit;
+
+pid_t startEditor(const std::filesystem::path& file, std::string& outMsg)
 {
-    // Terminal editor, blocking until exit.
     const char* editor = std::getenv("VISUAL");
     if (!editor || editor[0] == '\0') editor = std::getenv("EDITOR");
     if (!editor || editor[0] == '\0') editor = "nano";
 
-    std::string cmd = std::string(editor) + " \"" + file.string() + "\"";
-    int ret = std::system(cmd.c_str());
-    if (ret == 0) {
-        outMsg = "[INFO] Archivo editado: " + file.string();
+    // El editor puede traer argumentos ("code -w"): lo separa el shell; la ruta va aparte como $1.
+    const std::string script = std::string("exec ") + editor + " \"$1\"";
+    const std::string path = file.string();
+
+    struct sigaction ignore {};
+    ignore.sa_handler = SIG_IGN;
+    sigemptyset(&ignore.sa_mask);
+    sigaction(SIGINT, &ignore, &savedSigint);
+    sigaction(SIGQUIT, &ignore, &savedSigquit);
+
+    const pid_t pid = fork();
+    if (pid == 0) {
+        sigaction(SIGINT, &savedSigint, nullptr);
+        sigaction(SIGQUIT, &savedSigquit, nullptr);
+        execl("/bin/sh", "sh", "-c", script.c_str(), "sh", path.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    if (pid < 0) {
+        sigaction(SIGINT, &savedSigint, nullptr);
+        sigaction(SIGQUIT, &savedSigquit, nullptr);
+        outMsg = "[WARN] No se pudo lanzar " + std::string(editor) + ": " + std::strerror(errno);
+        return -1;
+    }
+    outMsg = "[INFO] Editando " + path + " con " + editor;
+    return pid;
+}
+
+bool editorFinished(pid_t pid, std::string& outMsg)
+{
+    int status = 0;
+    const pid_t ret = waitpid(pid, &status, WNOHANG);
+    if (ret == 0 || (ret < 0 && errno == EINTR)) return false;
+
+    sigaction(SIGINT, &savedSigint, nullptr);
+    sigaction(SIGQUIT, &savedSigquit, nullptr);
+    if (ret > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        outMsg = "[INFO] Editor cerrado";
+    } else if (ret > 0 && WIFEXITED(status)) {
+        outMsg = "[WARN] El editor terminó con código " + std::to_string(WEXITSTATUS(status)) +
+                 (WEXITSTATUS(status) == 127 ? " (¿no está instalado?)" : "");
+    } else if (ret > 0) {
+        outMsg = "[WARN] El editor terminó por una señal";
     } else {
-        outMsg = "[WARN] Error al editar con " + std::string(editor);
+        outMsg = std::string("[WARN] Error esperando al editor: ") + std::strerror(errno);
     }
+    return true;
 }
 
 bool saveRxFrameAsCustom(const EthernetFrame& frame, const std::filesystem::path& packetFile, std::string& outMsg)
@@ -0,0 +1,78 @@
+#include "packet_buffer.h"
+
+#include <algorithm>
+
+std::uint8_t* PacketBuffer::prepend(std::size_t n)
+{
+    if (n > head) return nullptr;
+    head -= n;
+    length += n;
+    return base + head;
+}
+
+std::uint8_t* PacketBuffer::append(std::size_t n)
+{
+    if (n > tailroom()) return nullptr;
+    std::uint8_t* out = base + head + length;
+    length += n;
+    return out;
+}
+
+void PacketBuffer::pull(std::size_t n)
+{
+    n = std::min(n, length);
+    head += n;
+    length -= n;
+}
+
+void PacketBuffer::resize(std::size_t n)
+{
+    length = std::min(n, capacity - head);
+}
+
+void PacketBuffer::reset(std::size_t headroom)
+{
+    head = std::min(headroom, capacity);
+    length = 0;
+}
+
+PacketPool::PacketPool(std::size_t count, std::size_t bufferSize, std::size_t defaultHeadroom)
+    : stride((bufferSize + 63) & ~static_cast<std::size_t>(63)), headroom(std::min(defaultHeadroom, bufferSize))
+{
+    arena.assign(count * stride, 0);
+    buffers.resize(count);
+    freeList.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        PacketBuffer& b = buffers[i];
+        b.base = arena.data() + i * stride;
+        b.capacity = stride;
+        freeList.push_back(&buffers[count - 1 - i]);
+    }
+}
+
+PacketBuffer* PacketPool::acquire()
+{
+    if (freeList.empty())
+    {
+        ++counters.exhausted;
+        return nullptr;
+    }
+    PacketBuffer* b = freeList.back();
+    freeList.pop_back();
+    b->refs = 1;
+    b->reset(headroom);
+    ++counters.acquired;
+    return b;
+}
+
+void PacketPool::retain(PacketBuffer* buffer)
+{
+    if (buffer) ++buffer->refs;
+}
+
+void PacketPool::release(PacketBuffer* buffer)
+{
+    if (!buffer || buffer->refs == 0) return;
+    if (--buffer->refs == 0) freeList.push_back(buffer);
+}
@@ -0,0 +1,328 @@
+#include "packet_library.h"
+#include "ethernet.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Binary layout
+// ---------------------------------------------------------------------------
+
+namespace {
+
+constexpr char kMagic[8] = {'N', 'G', 'P', 'K', 'T', 'L', 'I', 'B'};
+constexpr std::uint32_t kVersion = 1;
+
+/**
+ * @brief File header. Frame bytes and names follow it; the index is last.
+ */
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t count;
+    std::int64_t sourceMtimeNs;
+    std::uint64_t sourceSize;
+    std::uint64_t indexOffset;
+    std::uint64_t fileSize;
+};
+
+struct IndexEntry {
+    std::uint64_t offset;
+    std::uint32_t length;
+    std::uint32_t nameOffset;
+    std::uint32_t nameLength;
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(Header) == 48, "packet library header layout");
+static_assert(sizeof(IndexEntry) == 24, "packet library index layout");
+
+struct SourceStat {
+    std::int64_t mtimeNs = 0;
+    std::uint64_t size = 0;
+};
+
+bool statSource(const std::filesystem::path& path, SourceStat& out, std::string& error)
+{
+    struct stat st{};
+    if (::stat(path.c_str(), &st) != 0)
+    {
+        error = path.string() + ": " + std::strerror(errno);
+        return false;
+    }
+    out.mtimeNs = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    out.size = static_cast<std::uint64_t>(st.st_size);
+    return true;
+}
+
+/**
+ * @brief True if the line has something besides whitespace and comments.
+ */
+bool hasContent(std::string_view line)
+{
+    for (std::size_t i = 0; i < line.size(); ++i)
+    {
+        const char c = line[i];
+        if (c == '#' || (c == '/' && i + 1 < line.size() && line[i + 1] == '/')) return false;
+        if (c != ' ' && c != '\t' && c != '\r' && c != '\v' && c != '\f') return true;
+    }
+    return false;
+}
+
+std::string_view trim(std::string_view text)
+{
+    const auto first = text.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos) return {};
+    const auto last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Compilation
+// ---------------------------------------------------------------------------
+
+std::filesystem::path PacketLibrary::compiledPathFor(const std::filesystem::path& source)
+{
+    std::filesystem::path out = source;
+    out += ".bin";
+    return out;
+}
+
+long PacketLibrary::compile(const std::filesystem::path& source, const std::filesystem::path& output, std::string& error)
+{
+    SourceStat st;
+    if (!statSource(source, st, error)) return -1;
+
+    std::string text;
+    {
+        std::FILE* in = std::fopen(source.c_str(), "rbe");  // e: O_CLOEXEC, like every fd the tool opens
+        if (!in)
+        {
+            error = source.string() + ": " + std::strerror(errno);
+            return -1;
+        }
+        text.resize(st.size);
+        const std::size_t got = std::fread(&text[0], 1, text.size(), in);
+        std::fclose(in);
+        text.resize(got);
+    }
+
+    std::vector<std::uint8_t> data(sizeof(Header));
+    std::string names;
+    std::vector<IndexEntry> entries;
+
+    // One section per separator; hex lines are gathered and parsed together.
+    std::string section;
+    std::string sectionName;
+    std::size_t sectionLine = 1;
+    auto flush = [&]() -> bool {
+        if (section.empty()) return true;  // Only comments or blank lines
+        const auto bytes = parseHexBytesFile(section);
+        if (!bytes)
+        {
+            error = source.string() + ":" + std::to_string(sectionLine) + ": trama " + std::to_string(entries.size()) +
+                    " con hex inválido";
+            return false;
+        }
+        IndexEntry entry{};
+        entry.offset = data.size();
+        entry.length = static_cast<std::uint32_t>(bytes->size());
+        entry.nameOffset = static_cast<std::uint32_t>(names.size());
+        entry.nameLength = static_cast<std::uint32_t>(sectionName.size());
+        data.insert(data.end(), bytes->begin(), bytes->end());
+        names += sectionName;
+        entries.push_back(entry);
+        section.clear();
+        return true;
+    };
+
+    std::size_t lineNumber = 0;
+    std::size_t pos = 0;
+    while (pos < text.size())
+    {
+        std::size_t eol = text.find('\n', pos);
+        if (eol == std::string::npos) eol = text.size();
+        const std::string_view line(text.data() + pos, eol - pos);
+        ++lineNumber;
+        pos = eol + 1;
+
+        const std::string_view trimmed = trim(line);
+        if (trimmed.compare(0, 3, "---") == 0)
+        {
+            if (!flush()) return -1;
+            sectionName = std::string(trim(trimmed.substr(3)));
+            sectionLine = lineNumber + 1;
+            continue;
+        }
+        if (!hasContent(line)) continue;
+        if (section.empty()) sectionLine = lineNumber;
+        section.append(line.data(), line.size());
+        section += '\n';
+    }
+    if (!flush()) return -1;
+
+    // Names, then the 8-byte aligned index.
+    for (auto& entry : entries) entry.nameOffset += static_cast<std::uint32_t>(data.size());
+    data.insert(data.end(), names.begin(), names.end());
+    data.resize((data.size() + 7) & ~std::size_t{7}, 0);
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.count = static_cast<std::uint32_t>(entries.size());
+    header.sourceMtimeNs = st.mtimeNs;
+    header.sourceSize = st.size;
+    header.indexOffset = data.size();
+    header.fileSize = data.size() + entries.size() * sizeof(IndexEntry);
+    std::memcpy(data.data(), &header, sizeof(header));
+    const std::size_t indexAt = data.size();
+    data.resize(header.fileSize);
+    if (!entries.empty()) std::memcpy(data.data() + indexAt, entries.data(), entries.size() * sizeof(IndexEntry));
+
+    std::filesystem::path temp = output;
+    temp += ".tmp";
+    std::FILE* out = std::fopen(temp.c_str(), "wbe");
+    if (!out)
+    {
+        error = temp.string() + ": " + std::strerror(errno);
+        return -1;
+    }
+    const bool written = std::fwrite(data.data(), 1, data.size(), out) == data.size();
+    const bool closed = std::fclose(out) == 0;
+    if (!written || !closed || std::rename(temp.c_str(), output.c_str()) != 0)
+    {
+        error = output.string() + ": " + std::strerror(errno);
+        std::remove(temp.c_str());
+        return -1;
+    }
+    return static_cast<long>(entries.size());
+}
+
+// ---------------------------------------------------------------------------
+// Mapping
+// ---------------------------------------------------------------------------
+
+PacketLibrary::~PacketLibrary()
+{
+    close();
+}
+
+void PacketLibrary::close()
+{
+    if (base) munmap(const_cast<std::uint8_t*>(base), mappedSize);
+    base = nullptr;
+    mappedSize = 0;
+    count = 0;
+    index = nullptr;
+}
+
+bool PacketLibrary::mapCompiled(std::string& error)
+{
+    const std::filesystem::path path = compiledPath();
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        error = path.string() + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Header))
+    {
+        error = path.string() + ": archivo compilado truncado";
+        ::close(fd);
+        return false;
+    }
+    const std::size_t size = static_cast<std::size_t>(st.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        error = path.string() + ": mmap: " + std::strerror(errno);
+        return false;
+    }
+
+    // Validate the header and every index entry once, so frame() needs no checks.
+    const auto* bytes = static_cast<const std::uint8_t*>(mapped);
+    Header header;
+    std::memcpy(&header, bytes, sizeof(header));
+    bool valid = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 && header.version == kVersion &&
+                 header.fileSize == size && header.indexOffset % alignof(IndexEntry) == 0 &&
+                 header.indexOffset <= size && (size - header.indexOffset) / sizeof(IndexEntry) >= header.count;
+    const auto* entries = reinterpret_cast<const IndexEntry*>(bytes + (valid ? header.indexOffset : 0));
+    for (std::uint32_t i = 0; valid && i < header.count; ++i)
+    {
+        valid = entries[i].offset <= header.indexOffset && entries[i].length <= header.indexOffset - entries[i].offset &&
+                entries[i].nameOffset <= header.indexOffset &&
+                entries[i].nameLength <= header.indexOffset - entries[i].nameOffset;
+    }
+    if (!valid)
+    {
+        munmap(mapped, size);
+        error = path.string() + ": formato no reconocido";
+        return false;
+    }
+
+    close();
+    base = bytes;
+    mappedSize = size;
+    count = header.count;
+    index = entries;
+    sourceMtimeNs = header.sourceMtimeNs;
+    sourceSize = header.sourceSize;
+    ++loads;
+    return true;
+}
+
+bool PacketLibrary::sourceChanged(std::string& error) const
+{
+    SourceStat st;
+    if (!statSource(source, st, error)) return false;
+    return st.mtimeNs != sourceMtimeNs || st.size != sourceSize;
+}
+
+bool PacketLibrary::open(const std::filesystem::path& sourcePath, std::string& error)
+{
+    close();
+    source = sourcePath;
+    compiled = false;
+
+    SourceStat st;
+    if (!statSource(source, st, error)) return false;
+    // Reuse the binary only if it is ours and was built from this exact source.
+    std::string ignored;
+    if (mapCompiled(ignored) && sourceMtimeNs == st.mtimeNs && sourceSize == st.size) return true;
+
+    // A stale binary stays mapped if the edited source does not compile.
+    if (compile(source, compiledPath(), error) < 0) return false;
+    compiled = true;
+    return mapCompiled(error);
+}
+
+bool PacketLibrary::refresh(std::string& error)
+{
+    compiled = false;
+    if (!isOpen()) return open(source, error);
+    error.clear();
+    if (!sourceChanged(error)) return error.empty();  // Unchanged, or stat() failed
+    if (compile(source, compiledPath(), error) < 0) return false;
+    compiled = true;
+    return mapCompiled(error);
+}
+
+PacketView PacketLibrary::frame(std::size_t i) const
+{
+    const IndexEntry& entry = static_cast<const IndexEntry*>(index)[i];
+    PacketView view;
+    view.data = base + entry.offset;
+    view.size = entry.length;
+    view.name = std::string_view(reinterpret_cast<const char*>(base + entry.nameOffset), entry.nameLength);
+    return view;
+}
@@ -0,0 +1,268 @@
+#include "rss.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+const std::uint8_t kRssMicrosoftKey[kRssKeySize] = {
+    0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2, 0x41, 0x67, 0x25, 0x3d, 0x43, 0xa3,
+    0x8f, 0xb0, 0xd0, 0xca, 0x2b, 0xcb, 0xae, 0x7b, 0x30, 0xb4, 0x77, 0xcb, 0x2d, 0xa3,
+    0x80, 0x30, 0xf2, 0x0c, 0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa};
+
+const std::uint8_t kRssSymmetricKey[kRssKeySize] = {
+    0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+    0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+    0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a};
+
+// ---------------------------------------------------------------------------
+// Toeplitz hash
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief The 32 key bits starting at bit @p bit (MSB first).
+ */
+static std::uint32_t keyWindow(const std::uint8_t* key, std::size_t bit)
+{
+    std::uint64_t window = 0;
+    const std::size_t byte = bit / 8;
+    for (std::size_t i = 0; i < 5; ++i)
+    {
+        window = (window << 8) | (byte + i < kRssKeySize ? key[byte + i] : 0);
+    }
+    return static_cast<std::uint32_t>(window >> (8 - bit % 8));
+}
+
+std::uint32_t ToeplitzHash::reference(const std::uint8_t* key, const std::uint8_t* input, std::size_t size)
+{
+    std::uint32_t result = 0;
+    for (std::size_t i = 0; i < size * 8; ++i)
+    {
+        if (input[i / 8] & (0x80u >> (i % 8))) result ^= keyWindow(key, i);
+    }
+    return result;
+}
+
+ToeplitzHash::ToeplitzHash(const std::uint8_t* key) : table(kRssMaxInputSize * 256)
+{
+    for (std::size_t position = 0; position < kRssMaxInputSize; ++position)
+    {
+        std::uint32_t bitWindow[8];
+        for (std::size_t bit = 0; bit < 8; ++bit) bitWindow[bit] = keyWindow(key, position * 8 + bit);
+        for (std::size_t value = 0; value < 256; ++value)
+        {
+            std::uint32_t h = 0;
+            for (std::size_t bit = 0; bit < 8; ++bit)
+            {
+                if (value & (0x80u >> bit)) h ^= bitWindow[bit];
+            }
+            table[position * 256 + value] = h;
+        }
+    }
+}
+
+std::uint32_t ToeplitzHash::hash(const std::uint8_t* input, std::size_t size) const
+{
+    const std::uint32_t* t = table.data();
+    std::uint32_t h = 0;
+    for (std::size_t i = 0; i < size; ++i, t += 256) h ^= t[input[i]];
+    return h;
+}
+
+std::uint32_t ToeplitzHash::hashFrame(const FrameDescriptor& frame) const
+{
+    std::uint8_t input[kRssMaxInputSize];
+    std::size_t size = 0;
+    if (frame.ipVersion == 4 || frame.ipVersion == 6)
+    {
+        const std::size_t addressSize = frame.ipVersion == 4 ? 4 : 16;
+        std::memcpy(input, frame.srcIp, addressSize);
+        std::memcpy(input + addressSize, frame.dstIp, addressSize);
+        size = addressSize * 2;
+        // Fragments (first one included) hash on addresses only, so every piece
+        // of a datagram lands on the same worker.
+        const bool ports = (frame.has(Layer::Tcp) || frame.has(Layer::Udp)) && !(frame.flags & DissectFlag::Fragment);
+        if (ports)
+        {
+            input[size++] = static_cast<std::uint8_t>(frame.srcPort >> 8);
+            input[size++] = static_cast<std::uint8_t>(frame.srcPort);
+            input[size++] = static_cast<std::uint8_t>(frame.dstPort >> 8);
+            input[size++] = static_cast<std::uint8_t>(frame.dstPort);
+        }
+    }
+    else
+    {
+        std::memcpy(input, frame.srcMac, 6);
+        std::memcpy(input + 6, frame.dstMac, 6);
+        size = 12;
+    }
+    return hash(input, size);
+}
+
+// ---------------------------------------------------------------------------
+// Dispatcher
+// ---------------------------------------------------------------------------
+
+RssDispatcher::RssDispatcher(const RssConfig& config, Handler fn)
+    : cfg(config), handler(std::move(fn)), toeplitz(config.key ? config.key : kRssSymmetricKey)
+{
+    cfg.workers = std::clamp<std::size_t>(cfg.workers, 1, 0xFFFF);
+    std::size_t buckets = 1;
+    while (buckets < std::max(cfg.indirectionSize, cfg.workers)) buckets <<= 1;
+    mask = buckets - 1;
+
+    for (std::size_t i = 0; i < cfg.workers; ++i) workers.push_back(std::make_unique<Worker>(cfg.queueDepth));
+    table.resize(buckets);
+    for (std::size_t b = 0; b < buckets; ++b) table[b] = static_cast<std::uint16_t>(b % cfg.workers);
+    target = table;
+    lastQueued.assign(buckets, 0);
+    load.assign(buckets, 0);
+}
+
+RssDispatcher::~RssDispatcher()
+{
+    stop();
+}
+
+void RssDispatcher::start()
+{
+    if (running.exchange(true)) return;
+    for (std::size_t i = 0; i < workers.size(); ++i)
+    {
+        workers[i]->thread = std::thread([this, i] { run(i); });
+    }
+}
+
+void RssDispatcher::stop()
+{
+    if (!running.exchange(false)) return;
+    for (auto& worker : workers)
+    {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+static inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#endif
+}
+
+void RssDispatcher::run(std::size_t index)
+{
+    static constexpr std::size_t kBatch = 32;
+    Worker& self = *workers[index];
+    RssItem batch[kBatch];
+    unsigned idle = 0;
+    for (;;)
+    {
+        const std::size_t n = self.queue.popBatch(batch, kBatch);
+        if (n == 0)
+        {
+            // Stop is only requested by the producer after its last push, so an
+            // empty queue seen after the flag is really the end.
+            if (!running.load(std::memory_order_acquire) && self.queue.popped() == self.queue.pushed()) return;
+            if (++idle < 64) cpuRelax();
+            else std::this_thread::yield();  // Do not starve the producer on small machines
+            continue;
+        }
+        idle = 0;
+        for (std::size_t i = 0; i < n; ++i) handler(index, batch[i]);
+        self.done.store(self.done.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+}
+
+bool RssDispatcher::dispatch(const RssItem& item)
+{
+    const std::size_t bucket = item.hash & mask;
+    std::size_t w = table[bucket];
+    if (target[bucket] != w && workers[w]->done.load(std::memory_order_acquire) >= lastQueued[bucket])
+    {
+        // Old worker finished every frame of this bucket: the move cannot reorder it.
+        w = table[bucket] = target[bucket];
+    }
+
+    Worker& worker = *workers[w];
+    if (!worker.queue.tryPush(item))
+    {
+        ++worker.dropped;
+        return false;
+    }
+    lastQueued[bucket] = ++worker.enqueued;
+    ++load[bucket];
+    return true;
+}
+
+bool RssDispatcher::dispatch(const FrameDescriptor& frame, const std::uint8_t* data, void* context)
+{
+    return dispatch(RssItem{data, frame.frameSize, toeplitz.hashFrame(frame), context});
+}
+
+void RssDispatcher::waitIdle() const
+{
+    for (const auto& worker : workers)
+    {
+        while (worker->done.load(std::memory_order_acquire) < worker->enqueued)
+        {
+            if (running.load(std::memory_order_relaxed)) std::this_thread::yield();
+            else return;  // Nobody would drain it
+        }
+    }
+}
+
+std::size_t RssDispatcher::rebalance()
+{
+    std::vector<std::uint64_t> workerLoad(workers.size(), 0);
+    for (std::size_t b = 0; b < target.size(); ++b) workerLoad[target[b]] += load[b];
+
+    std::size_t moves = 0;
+    for (std::size_t step = 0; step < target.size(); ++step)
+    {
+        const auto hi = static_cast<std::size_t>(std::max_element(workerLoad.begin(), workerLoad.end()) -
+                                                 workerLoad.begin());
+        const auto lo = static_cast<std::size_t>(std::min_element(workerLoad.begin(), workerLoad.end()) -
+                                                 workerLoad.begin());
+        const std::uint64_t gap = workerLoad[hi] - workerLoad[lo];
+
+        // Largest bucket of the busiest worker that still narrows the gap (load < gap).
+        std::size_t best = target.size();
+        for (std::size_t b = 0; b < target.size(); ++b)
+        {
+            if (target[b] != hi || load[b] == 0 || load[b] >= gap) continue;
+            if (best == target.size() || load[b] > load[best]) best = b;
+        }
+        if (best == target.size()) break;
+
+        target[best] = static_cast<std::uint16_t>(lo);
+        workerLoad[hi] -= load[best];
+        workerLoad[lo] += load[best];
+        ++moves;
+    }
+    std::fill(load.begin(), load.end(), 0);
+    return moves;
+}
+
+bool RssDispatcher::setIndirection(const std::vector<std::uint16_t>& workerOfBucket)
+{
+    if (workerOfBucket.size() != target.size()) return false;
+    for (std::uint16_t w : workerOfBucket)
+    {
+        if (w >= workers.size()) return false;
+    }
+    // Applied bucket by bucket, with the same drain check as rebalance().
+    target = workerOfBucket;
+    return true;
+}
+
+RssWorkerStats RssDispatcher::stats(std::size_t worker) const
+{
+    RssWorkerStats st;
+    if (worker >= workers.size()) return st;
+    st.enqueued = workers[worker]->enqueued;
+    st.dropped = workers[worker]->dropped;
+    st.processed = workers[worker]->done.load(std::memory_order_acquire);
+    return st;
+}
@@ -2,11 +2,14 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <linux/if.h>
 #include <linux/if_tun.h>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
 #include <stdexcept>
 #include <iostream>
 
@@ -18,7 +21,8 @@
  */
 TapDevice::TapDevice(const std::string& name) : dev_name(name) {
     // Abrir el dispositivo clonador TUN/TAP
-    if ((fd = open("/dev/net/tun", O_RDWR)) < 0) {
+    // O_CLOEXEC: los hijos (el editor) no deben heredar el TAP y mantenerlo vivo.
+    if ((fd = open("/dev/net/tun", O_RDWR | O_CLOEXEC)) < 0) {
         perror("Error opening /dev/net/tun");
         throw std::runtime_error("Failed to open TUN device");
     }
@@ -92,4 +96,51 @@ void TapDevice::setNonBlocking(bool non_blocking) {
     if (fcntl(fd, F_SETFL, flags) == -1) {
         perror("TapDevice::setNonBlocking (SETFL)");
     }
-}
\ No newline at end of file
+}
+/**
+ * @brief Attach a socket filter to the TAP queue.
+ *
+ * The tun driver applies it in its transmit path (kernel -> TAP fd); frames
+ * it rejects are counted in the interface's tx_dropped.
+ */
+bool TapDevice::attachFilter(const sock_filter* code, std::size_t count) {
+    struct sock_fprog program;
+    program.len = static_cast<unsigned short>(count);
+    program.filter = const_cast<sock_filter*>(code);
+    return ioctl(fd, TUNATTACHFILTER, &program) == 0;
+}
+
+bool TapDevice::detachFilter() {
+    struct sock_fprog program;
+    std::memset(&program, 0, sizeof(program));
+    return ioctl(fd, TUNDETACHFILTER, &program) == 0;
+}
+
+bool TapDevice::setMacFilter(const std::vector<std::array<std::uint8_t, 6>>& addresses, bool allMulticast) {
+    // struct tun_filter termina en un array flexible de direcciones de 6 bytes.
+    std::vector<unsigned char> request(sizeof(struct tun_filter) + addresses.size() * ETH_ALEN);
+    auto* filter = reinterpret_cast<struct tun_filter*>(request.data());
+    filter->flags = allMulticast ? TUN_FLT_ALLMULTI : 0;
+    filter->count = static_cast<unsigned short>(addresses.size());
+    for (std::size_t i = 0; i < addresses.size(); ++i) {
+        std::memcpy(request.data() + sizeof(struct tun_filter) + i * ETH_ALEN, addresses[i].data(), ETH_ALEN);
+    }
+    return ioctl(fd, TUNSETTXFILTER, request.data()) >= 0;
+}
+
+std::uint64_t TapDevice::droppedByKernel() const {
+    // Se lee también desde el hilo de métricas: el descriptor no debe colarse en un fork() concurrente.
+    const std::string path = "/sys/class/net/" + dev_name + "/statistics/tx_dropped";
+    const int in = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        return 0;
+    }
+    char text[32];
+    const ssize_t n = ::read(in, text, sizeof(text) - 1);
+    ::close(in);
+    if (n <= 0) {
+        return 0;
+    }
+    text[n] = '\0';
+    return std::strtoull(text, nullptr, 10);
+}
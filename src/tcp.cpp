@@ -0,0 +1,1488 @@
+#include "tcp.h"
+#include "checksum.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+static constexpr std::size_t kTcpHeaderSize = sizeof(TcpHeader);
+static constexpr std::uint8_t kOptionEnd = 0;
+static constexpr std::uint8_t kOptionNop = 1;
+static constexpr std::uint8_t kOptionMss = 2;
+static constexpr std::uint8_t kOptionWindowScale = 3;
+static constexpr std::uint8_t kMaxWindowScale = 14;
+static constexpr std::uint16_t kDefaultMss = 536;  // RFC 1122 when the peer sends no MSS option
+
+// Sequence number comparisons modulo 2^32.
+static bool seqLt(std::uint32_t a, std::uint32_t b) { return static_cast<std::int32_t>(a - b) < 0; }
+static bool seqLeq(std::uint32_t a, std::uint32_t b) { return static_cast<std::int32_t>(a - b) <= 0; }
+static bool seqGt(std::uint32_t a, std::uint32_t b) { return seqLt(b, a); }
+static bool seqGeq(std::uint32_t a, std::uint32_t b) { return seqLeq(b, a); }
+
+static std::uint32_t ipKey(const Ipv4Address& ip)
+{
+    return (static_cast<std::uint32_t>(ip[0]) << 24) | (static_cast<std::uint32_t>(ip[1]) << 16) |
+           (static_cast<std::uint32_t>(ip[2]) << 8) | static_cast<std::uint32_t>(ip[3]);
+}
+
+static std::uint8_t windowScaleFor(std::size_t window)
+{
+    std::uint8_t scale = 0;
+    while ((window >> scale) > 0xFFFF && scale < kMaxWindowScale) ++scale;
+    return scale;
+}
+
+/** @brief Fill the fixed header and the checksum of a segment laid out at @p tcp. */
+static void finishSegment(std::uint8_t* tcp, std::size_t size, std::size_t headerSize, const Ipv4Route& route,
+                          std::uint16_t srcPort, std::uint16_t dstPort, std::uint32_t seq, std::uint32_t ack,
+                          std::uint8_t flags, std::uint16_t window)
+{
+    TcpHeader header{};
+    header.srcPort = htons(srcPort);
+    header.dstPort = htons(dstPort);
+    header.seq = htonl(seq);
+    header.ack = htonl(ack);
+    header.dataOffset = static_cast<std::uint8_t>((headerSize / 4) << 4);
+    header.flags = flags;
+    header.window = htons(window);
+    std::memcpy(tcp, &header, sizeof(header));
+
+    const std::uint32_t sum = checksumPseudoIpv4(route.src.data(), route.dst.data(), IpProto::TCP,
+                                                 static_cast<std::uint16_t>(size));
+    const std::uint16_t checksum = checksumFinish(checksumAccumulate(tcp, size, sum));
+    std::memcpy(tcp + offsetof(TcpHeader, checksum), &checksum, sizeof(checksum));
+}
+
+const char* tcpStateName(TcpState state)
+{
+    switch (state)
+    {
+    case TcpState::Closed: return "CLOSED";
+    case TcpState::SynSent: return "SYN-SENT";
+    case TcpState::SynReceived: return "SYN-RECEIVED";
+    case TcpState::Established: return "ESTABLISHED";
+    case TcpState::FinWait1: return "FIN-WAIT-1";
+    case TcpState::FinWait2: return "FIN-WAIT-2";
+    case TcpState::CloseWait: return "CLOSE-WAIT";
+    case TcpState::Closing: return "CLOSING";
+    case TcpState::LastAck: return "LAST-ACK";
+    case TcpState::TimeWait: return "TIME-WAIT";
+    }
+    return "?";
+}
+
+// ---------------------------------------------------------------------------
+// Connection (application side)
+// ---------------------------------------------------------------------------
+
+std::size_t TcpConnection::send(const std::uint8_t* data, std::size_t size)
+{
+    if (finQueued) return 0;
+    if (tcpState != TcpState::SynSent && tcpState != TcpState::SynReceived &&
+        tcpState != TcpState::Established && tcpState != TcpState::CloseWait)
+    {
+        return 0;
+    }
+
+    const std::size_t n = std::min(size, sendSpace());
+    if (n == 0) return 0;
+    const std::size_t mask = sendRing.size() - 1;
+    const std::size_t tail = (sndHead + sndQueued) & mask;
+    const std::size_t first = std::min(n, sendRing.size() - tail);
+    std::memcpy(sendRing.data() + tail, data, first);
+    std::memcpy(sendRing.data(), data + first, n - first);
+    sndQueued += n;
+
+    // Inside a callback the layer flushes once the segment is processed.
+    if (layer->current != this) layer->output(*this);
+    return n;
+}
+
+void TcpConnection::close()
+{
+    switch (tcpState)
+    {
+    case TcpState::SynSent:
+        layer->release(*this);
+        return;
+    case TcpState::SynReceived:
+    case TcpState::Established:
+        finQueued = true;
+        tcpState = TcpState::FinWait1;
+        break;
+    case TcpState::CloseWait:
+        finQueued = true;
+        tcpState = TcpState::LastAck;
+        break;
+    default:
+        return;
+    }
+    if (layer->current != this) layer->output(*this);
+}
+
+void TcpConnection::abort()
+{
+    if (tcpState == TcpState::Closed) return;
+    if (tcpState != TcpState::SynSent)
+    {
+        layer->sendSegment(*this, sndNxt, 0, TcpFlag::RST | TcpFlag::ACK);
+        ++layer->counters.txResets;
+    }
+    layer->release(*this);
+}
+
+void TcpConnection::resumeReceive()
+{
+    if (tcpState == TcpState::Closed) return;
+    TcpConnection* previous = layer->current;
+    layer->current = this;
+    layer->deliverHeld(*this);
+    layer->current = previous;
+    if (tcpState != TcpState::Closed) layer->output(*this);
+}
+
+// ---------------------------------------------------------------------------
+// Connection table
+// ---------------------------------------------------------------------------
+
+TcpLayer::TcpLayer(Ipv4Layer& layer, PacketPool& buffers, TimerWheel& wheel, const TcpConfig& cfg)
+    : ipv4(layer), pool(buffers), timers(wheel), config(cfg)
+{
+    std::size_t ring = 1;
+    while (ring < config.sendBuffer) ring <<= 1;
+    config.sendBuffer = ring;
+    config.maxConnections = std::max<std::size_t>(config.maxConnections, 1);
+    config.receiveWindow = std::min<std::size_t>(std::max<std::size_t>(config.receiveWindow, config.mss),
+                                                 std::size_t{0xFFFF} << kMaxWindowScale);
+    // Held segments share the pool with RX and every TX path: cap them all
+    // together and always leave some buffers free for ACKs and replies.
+    if (config.maxHeldTotal == 0) config.maxHeldTotal = pool.count() / 2;
+    config.txReserve = std::min(config.txReserve, pool.count() / 4);
+
+    connections.resize(config.maxConnections);
+    freeConnections.reserve(config.maxConnections);
+    for (std::size_t i = 0; i < connections.size(); ++i)
+    {
+        connections[i].layer = this;
+        connections[i].index = static_cast<std::uint32_t>(i);
+        freeConnections.push_back(static_cast<std::uint32_t>(connections.size() - 1 - i));
+    }
+
+    std::size_t slots = 16;
+    while (slots < config.maxConnections * 2) slots <<= 1;
+    tuples.resize(slots);
+
+    std::random_device rd;
+    secret = (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+
+    ipv4.setHandler(IpProto::TCP, [this](Ipv4Packet& packet) { input(packet); });
+}
+
+TcpLayer::~TcpLayer()
+{
+    ipv4.setHandler(IpProto::TCP, nullptr);
+    for (auto& c : connections)
+    {
+        if (c.tcpState == TcpState::Closed) continue;
+        timers.cancel(c.rtoTimer);
+        timers.cancel(c.ackTimer);
+        timers.cancel(c.waitTimer);
+        releaseHeld(c);
+    }
+}
+
+std::size_t TcpLayer::tupleSlot(std::uint64_t addresses, std::uint32_t ports) const
+{
+    // Keyed with a per-run secret so remote peers can't aim at one chain.
+    std::uint64_t h = (addresses ^ secret) * 0x9E3779B97F4A7C15ull;
+    h ^= (static_cast<std::uint64_t>(ports) + (secret >> 17)) * 0xC2B2AE3D27D4EB4Full;
+    h ^= h >> 32;
+    return static_cast<std::size_t>(h) & (tuples.size() - 1);
+}
+
+TcpConnection* TcpLayer::lookup(const Ipv4Address& remote, const Ipv4Address& local,
+                                std::uint16_t remotePort, std::uint16_t localPort)
+{
+    const std::uint64_t addresses = (static_cast<std::uint64_t>(ipKey(remote)) << 32) | ipKey(local);
+    const std::uint32_t ports = (static_cast<std::uint32_t>(remotePort) << 16) | localPort;
+    const std::size_t mask = tuples.size() - 1;
+    for (std::size_t i = tupleSlot(addresses, ports);; i = (i + 1) & mask)
+    {
+        const TupleSlot& slot = tuples[i];
+        if (slot.state == 0) return nullptr;
+        if (slot.state == 1 && slot.addresses == addresses && slot.ports == ports) return &connections[slot.index];
+    }
+}
+
+void TcpLayer::insertTuple(const TcpConnection& c)
+{
+    // At most maxConnections live entries in >= 2x slots: rebuilding only clears tombstones.
+    if ((tuplesUsed + tuplesDeleted + 1) * 4 > tuples.size() * 3) rebuildTuples();
+
+    const std::uint64_t addresses = (static_cast<std::uint64_t>(ipKey(c.route.dst)) << 32) | ipKey(c.route.src);
+    const std::uint32_t ports = (static_cast<std::uint32_t>(c.remotePortNumber) << 16) | c.localPortNumber;
+    const std::size_t mask = tuples.size() - 1;
+    for (std::size_t i = tupleSlot(addresses, ports);; i = (i + 1) & mask)
+    {
+        TupleSlot& slot = tuples[i];
+        if (slot.state == 1) continue;
+        if (slot.state == 2) --tuplesDeleted;
+        slot.addresses = addresses;
+        slot.ports = ports;
+        slot.index = c.index;
+        slot.state = 1;
+        ++tuplesUsed;
+        return;
+    }
+}
+
+void TcpLayer::removeTuple(const TcpConnection& c)
+{
+    const std::uint64_t addresses = (static_cast<std::uint64_t>(ipKey(c.route.dst)) << 32) | ipKey(c.route.src);
+    const std::uint32_t ports = (static_cast<std::uint32_t>(c.remotePortNumber) << 16) | c.localPortNumber;
+    const std::size_t mask = tuples.size() - 1;
+    for (std::size_t i = tupleSlot(addresses, ports);; i = (i + 1) & mask)
+    {
+        TupleSlot& slot = tuples[i];
+        if (slot.state == 0) return;
+        if (slot.state == 1 && slot.index == c.index)
+        {
+            slot.state = 2;
+            --tuplesUsed;
+            ++tuplesDeleted;
+            return;
+        }
+    }
+}
+
+void TcpLayer::rebuildTuples()
+{
+    std::fill(tuples.begin(), tuples.end(), TupleSlot{});
+    tuplesUsed = 0;
+    tuplesDeleted = 0;
+    for (const auto& c : connections)
+    {
+        if (c.tcpState != TcpState::Closed) insertTuple(c);
+    }
+}
+
+TcpConnection* TcpLayer::allocate(const Ipv4Route& route, std::uint16_t localPort, std::uint16_t remotePort)
+{
+    if (freeConnections.empty())
+    {
+        ++counters.refused;
+        return nullptr;
+    }
+    const std::uint32_t index = freeConnections.back();
+    freeConnections.pop_back();
+
+    // Reset the block but keep the send ring and hold queue allocations.
+    TcpConnection& c = connections[index];
+    std::vector<std::uint8_t> ring = std::move(c.sendRing);
+    std::vector<TcpConnection::HeldSegment> held = std::move(c.held);
+    const std::uint32_t generation = c.generation + 1;
+    c = TcpConnection{};
+    c.layer = this;
+    c.index = index;
+    c.generation = generation;
+    c.sendRing = std::move(ring);
+    c.sendRing.resize(config.sendBuffer);
+    c.held = std::move(held);
+    c.held.clear();
+    c.held.reserve(config.maxHeldSegments);
+    c.route = route;
+    c.localPortNumber = localPort;
+    c.remotePortNumber = remotePort;
+    c.rto = config.initialRto;
+    insertTuple(c);
+    ++active;
+    return &c;
+}
+
+void TcpLayer::release(TcpConnection& c)
+{
+    if (c.tcpState == TcpState::Closed) return;
+    removeTuple(c);
+    timers.cancel(c.rtoTimer);
+    timers.cancel(c.ackTimer);
+    timers.cancel(c.waitTimer);
+    c.rtoTimer = c.ackTimer = c.waitTimer = 0;
+    releaseHeld(c);
+    c.tcpState = TcpState::Closed;
+    --active;
+    if (c.callbacks.closed) c.callbacks.closed(c);
+    freeConnections.push_back(c.index);
+}
+
+void TcpLayer::reset(TcpConnection& c)
+{
+    ++counters.resets;
+    release(c);
+}
+
+std::uint32_t TcpLayer::initialSequence(const TcpConnection& c) const
+{
+    // RFC 6528: keyed hash of the 4-tuple plus a 4 us clock.
+    std::uint64_t h = ((static_cast<std::uint64_t>(ipKey(c.route.dst)) << 32) | ipKey(c.route.src)) ^ secret;
+    h = (h ^ ((static_cast<std::uint64_t>(c.remotePortNumber) << 16) | c.localPortNumber)) * 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+    return static_cast<std::uint32_t>(h) + static_cast<std::uint32_t>(micros / 4);
+}
+
+bool TcpLayer::listen(std::uint16_t port, TcpCallbacks callbacks)
+{
+    for (const auto& l : listeners)
+    {
+        if (l.port == port) return false;
+    }
+    listeners.push_back(Listener{port, std::move(callbacks)});
+    return true;
+}
+
+void TcpLayer::unlisten(std::uint16_t port)
+{
+    listeners.erase(std::remove_if(listeners.begin(), listeners.end(),
+                                   [port](const Listener& l) { return l.port == port; }),
+                    listeners.end());
+}
+
+void TcpLayer::startCongestionControl(TcpConnection& c)
+{
+    c.cwnd = std::min<std::size_t>(10 * c.mss, std::max<std::size_t>(2 * c.mss, 14600));  // RFC 6928
+    c.ssthresh = std::numeric_limits<std::size_t>::max() / 2;
+}
+
+TcpConnection* TcpLayer::connect(const Ipv4Address& dst, std::uint16_t dstPort, TcpCallbacks callbacks)
+{
+    auto route = ipv4.route(dst);
+    if (!route) return nullptr;
+
+    std::uint16_t port = 0;
+    for (unsigned tries = 0; tries < 16384; ++tries)
+    {
+        const std::uint16_t candidate = nextEphemeral;
+        nextEphemeral = (nextEphemeral == 0xFFFF) ? 49152 : static_cast<std::uint16_t>(nextEphemeral + 1);
+        if (!lookup(dst, route->src, dstPort, candidate))
+        {
+            port = candidate;
+            break;
+        }
+    }
+    if (port == 0) return nullptr;
+
+    TcpConnection* c = allocate(*route, port, dstPort);
+    if (!c) return nullptr;
+    c->callbacks = std::move(callbacks);
+    c->iss = initialSequence(*c);
+    c->sndUna = c->iss;
+    c->sndNxt = c->iss + 1;
+    c->sndMax = c->sndNxt;
+    c->rcvScale = windowScaleFor(config.receiveWindow);
+    c->windowScaling = true;  // Offered in our SYN, confirmed by the SYN-ACK
+    c->tcpState = TcpState::SynSent;
+    sendSegment(*c, c->iss, 0, TcpFlag::SYN);
+    armRetransmit(*c);
+    return c;
+}
+
+void TcpLayer::forEachConnection(const std::function<void(const TcpConnection&)>& fn) const
+{
+    for (const auto& c : connections)
+    {
+        if (c.tcpState != TcpState::Closed) fn(c);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Input
+// ---------------------------------------------------------------------------
+
+void TcpLayer::input(Ipv4Packet& packet)
+{
+    if (packet.rxTime > now) now = packet.rxTime;
+    ++counters.rxSegments;
+
+    static const Ipv4Address kBroadcast{255, 255, 255, 255};
+    if (packet.payloadSize < kTcpHeaderSize || packet.dst == kBroadcast)
+    {
+        ++counters.rxMalformed;
+        return;
+    }
+
+    const std::uint8_t* tcp = packet.payload();
+    TcpHeader header;
+    std::memcpy(&header, tcp, sizeof(header));
+    const std::size_t headerSize = static_cast<std::size_t>(header.dataOffset >> 4) * 4;
+    if (headerSize < kTcpHeaderSize || headerSize > packet.payloadSize)
+    {
+        ++counters.rxMalformed;
+        return;
+    }
+
+    const std::uint32_t pseudo = checksumPseudoIpv4(packet.src.data(), packet.dst.data(), IpProto::TCP,
+                                                    static_cast<std::uint16_t>(packet.payloadSize));
+    if (checksumFinish(checksumAccumulate(tcp, packet.payloadSize, pseudo)) != 0)
+    {
+        ++counters.rxChecksumErrors;
+        return;
+    }
+
+    Segment seg;
+    seg.seq = ntohl(header.seq);
+    seg.ack = ntohl(header.ack);
+    seg.window = ntohs(header.window);
+    seg.flags = header.flags & 0x3F;
+    seg.data = tcp + headerSize;
+    seg.len = static_cast<std::uint32_t>(packet.payloadSize - headerSize);
+
+    if (seg.flags & TcpFlag::SYN)
+    {
+        // Only SYNs carry the options we use (MSS, window scale).
+        for (std::size_t i = kTcpHeaderSize; i < headerSize;)
+        {
+            const std::uint8_t kind = tcp[i];
+            if (kind == kOptionEnd) break;
+            if (kind == kOptionNop)
+            {
+                ++i;
+                continue;
+            }
+            if (i + 1 >= headerSize || tcp[i + 1] < 2 || i + tcp[i + 1] > headerSize) break;
+            if (kind == kOptionMss && tcp[i + 1] == 4) seg.mss = static_cast<std::uint16_t>((tcp[i + 2] << 8) | tcp[i + 3]);
+            if (kind == kOptionWindowScale && tcp[i + 1] == 3) seg.windowScale = std::min(tcp[i + 2], kMaxWindowScale);
+            i += tcp[i + 1];
+        }
+    }
+
+    const std::uint16_t remotePort = ntohs(header.srcPort);
+    const std::uint16_t localPort = ntohs(header.dstPort);
+    TcpConnection* c = lookup(packet.src, packet.dst, remotePort, localPort);
+
+    if (!c)
+    {
+        if ((seg.flags & (TcpFlag::SYN | TcpFlag::ACK | TcpFlag::RST)) == TcpFlag::SYN)
+        {
+            auto listener = std::find_if(listeners.begin(), listeners.end(),
+                                         [localPort](const Listener& l) { return l.port == localPort; });
+            if (listener != listeners.end())
+            {
+                Ipv4Route route;
+                route.srcMac = ipv4.link();
+                std::memcpy(route.dstMac.data(), packet.frame + 6, 6);
+                route.src = packet.dst;
+                route.dst = packet.src;
+                c = allocate(route, localPort, remotePort);
+                if (c)
+                {
+                    c->callbacks = listener->callbacks;
+                    c->irs = seg.seq;
+                    c->rcvNxt = seg.seq + 1;
+                    c->rcvRead = c->rcvNxt;
+                    c->iss = initialSequence(*c);
+                    c->sndUna = c->iss;
+                    c->sndNxt = c->iss + 1;
+                    c->sndMax = c->sndNxt;
+                    c->sndWnd = seg.window;  // Never scaled in a SYN
+                    c->maxSndWnd = c->sndWnd;
+                    c->sndWl1 = seg.seq;
+                    c->mss = std::min<std::size_t>(config.mss, seg.mss ? seg.mss : kDefaultMss);
+                    if (seg.windowScale >= 0)
+                    {
+                        c->windowScaling = true;
+                        c->sndScale = static_cast<std::uint8_t>(seg.windowScale);
+                        c->rcvScale = windowScaleFor(config.receiveWindow);
+                    }
+                    c->tcpState = TcpState::SynReceived;
+                    sendSegment(*c, c->iss, 0, TcpFlag::SYN | TcpFlag::ACK);
+                    armRetransmit(*c);
+                    return;
+                }
+            }
+        }
+        ++counters.rxNoConnection;
+        sendReset(packet, seg, localPort, remotePort);
+        return;
+    }
+
+    current = c;
+    if (c->tcpState == TcpState::SynSent) handleSynSent(*c, seg, packet);
+    else handleSegment(*c, seg, packet);
+    current = nullptr;
+}
+
+void TcpLayer::handleSynSent(TcpConnection& c, const Segment& seg, const Ipv4Packet& packet)
+{
+    if ((seg.flags & TcpFlag::ACK) && (seqLeq(seg.ack, c.iss) || seqGt(seg.ack, c.sndMax)))
+    {
+        sendReset(packet, seg, c.localPortNumber, c.remotePortNumber);
+        return;
+    }
+    if (seg.flags & TcpFlag::RST)
+    {
+        if (seg.flags & TcpFlag::ACK) reset(c);
+        return;
+    }
+    if (!(seg.flags & TcpFlag::SYN)) return;
+
+    c.irs = seg.seq;
+    c.rcvNxt = seg.seq + 1;
+    c.rcvRead = c.rcvNxt;
+    c.mss = std::min<std::size_t>(config.mss, seg.mss ? seg.mss : kDefaultMss);
+    if (seg.windowScale >= 0)
+    {
+        c.sndScale = static_cast<std::uint8_t>(seg.windowScale);
+    }
+    else
+    {
+        c.windowScaling = false;
+        c.rcvScale = 0;
+    }
+
+    if (!(seg.flags & TcpFlag::ACK))
+    {
+        // Simultaneous open.
+        c.tcpState = TcpState::SynReceived;
+        sendSegment(c, c.iss, 0, TcpFlag::SYN | TcpFlag::ACK);
+        return;
+    }
+
+    c.sndUna = seg.ack;
+    c.sndWnd = seg.window;
+    c.maxSndWnd = c.sndWnd;
+    c.sndWl1 = seg.seq;
+    c.sndWl2 = seg.ack;
+    c.retries = 0;
+    timers.cancel(c.rtoTimer);
+    c.rtoTimer = 0;
+    c.tcpState = TcpState::Established;
+    startCongestionControl(c);
+    ++counters.connected;
+    c.ackNow = true;
+
+    const std::uint32_t generation = c.generation;
+    if (c.callbacks.connected) c.callbacks.connected(c);
+    if (alive(c, generation)) output(c);
+}
+
+void TcpLayer::handleSegment(TcpConnection& c, const Segment& segment, const Ipv4Packet& packet)
+{
+    Segment seg = segment;
+    const std::uint32_t generation = c.generation;
+
+    // Our SYN-ACK was lost: the peer repeats its SYN.
+    if (c.tcpState == TcpState::SynReceived && (seg.flags & TcpFlag::SYN) && !(seg.flags & TcpFlag::ACK) &&
+        seg.seq == c.irs)
+    {
+        sendSegment(c, c.iss, 0, TcpFlag::SYN | TcpFlag::ACK);
+        return;
+    }
+
+    // RFC 793 acceptability test.
+    const std::uint32_t window = receiveWindow(c);
+    const std::uint32_t segLen = seg.len + ((seg.flags & TcpFlag::SYN) ? 1 : 0) + ((seg.flags & TcpFlag::FIN) ? 1 : 0);
+    auto inWindow = [&](std::uint32_t s) { return seqGeq(s, c.rcvNxt) && seqLt(s, c.rcvNxt + window); };
+    bool acceptable;
+    if (segLen == 0) acceptable = (window == 0) ? seg.seq == c.rcvNxt : inWindow(seg.seq);
+    else acceptable = window > 0 && (inWindow(seg.seq) || inWindow(seg.seq + segLen - 1));
+
+    if (!acceptable)
+    {
+        if (window == 0 && seg.seq == c.rcvNxt)
+        {
+            // Zero window: still process the ACK, drop the data.
+            if (seg.len > 0) ++counters.rxDropped;
+            seg.len = 0;
+            seg.flags &= static_cast<std::uint8_t>(~TcpFlag::FIN);
+        }
+        else
+        {
+            if (!(seg.flags & TcpFlag::RST))
+            {
+                ++counters.rxDuplicate;
+                sendAck(c);
+            }
+            return;
+        }
+    }
+
+    if (seg.flags & TcpFlag::RST)
+    {
+        // RFC 5961: only an exact match resets, anything else in the window gets a challenge ACK.
+        if (seg.seq == c.rcvNxt) reset(c);
+        else sendAck(c);
+        return;
+    }
+    if (seg.flags & TcpFlag::SYN)
+    {
+        sendAck(c);
+        return;
+    }
+    if (!(seg.flags & TcpFlag::ACK)) return;
+
+    if (c.tcpState == TcpState::SynReceived)
+    {
+        if (seqLeq(seg.ack, c.sndUna) || seqGt(seg.ack, c.sndMax))
+        {
+            sendReset(packet, seg, c.localPortNumber, c.remotePortNumber);
+            return;
+        }
+        c.sndUna = c.iss + 1;
+        c.sndWnd = static_cast<std::size_t>(seg.window) << c.sndScale;
+        c.maxSndWnd = std::max(c.maxSndWnd, c.sndWnd);
+        c.sndWl1 = seg.seq;
+        c.sndWl2 = seg.ack;
+        c.retries = 0;
+        c.rto = config.initialRto;
+        timers.cancel(c.rtoTimer);
+        c.rtoTimer = 0;
+        c.tcpState = TcpState::Established;
+        startCongestionControl(c);
+        ++counters.accepted;
+        if (c.callbacks.connected) c.callbacks.connected(c);
+        if (!alive(c, generation)) return;
+    }
+
+    if (!processAck(c, seg)) return;
+
+    if (seg.len > 0 || (seg.flags & TcpFlag::FIN))
+    {
+        if (c.tcpState == TcpState::Established || c.tcpState == TcpState::FinWait1 ||
+            c.tcpState == TcpState::FinWait2)
+        {
+            receiveData(c, seg, packet);
+            if (!alive(c, generation)) return;
+        }
+        else if (c.tcpState != TcpState::TimeWait || !(seg.flags & TcpFlag::FIN))
+        {
+            // Data after the peer's FIN: just acknowledge what we have.
+            c.ackNow = true;
+        }
+        else
+        {
+            // Retransmitted FIN in TIME-WAIT: ACK it and restart the 2*MSL wait.
+            c.ackNow = true;
+            enterTimeWait(c);
+        }
+    }
+
+    output(c);
+}
+
+bool TcpLayer::processAck(TcpConnection& c, const Segment& seg)
+{
+    if (seqGt(seg.ack, c.sndMax))
+    {
+        // Acknowledges something never sent.
+        sendAck(c);
+        return false;
+    }
+    if (seqLt(seg.ack, c.sndUna)) return true;  // Old duplicate, data may still be useful
+
+    bool windowChanged = false;
+    if (seqLt(c.sndWl1, seg.seq) || (c.sndWl1 == seg.seq && seqLeq(c.sndWl2, seg.ack)))
+    {
+        const std::size_t window = static_cast<std::size_t>(seg.window) << c.sndScale;
+        windowChanged = window != c.sndWnd;
+        c.sndWnd = window;
+        c.maxSndWnd = std::max(c.maxSndWnd, window);
+        c.sndWl1 = seg.seq;
+        c.sndWl2 = seg.ack;
+    }
+
+    const std::uint32_t acked = seg.ack - c.sndUna;
+    if (acked == 0)
+    {
+        // RFC 5681 duplicate ACK: no data, no window change, something outstanding.
+        if (seg.len == 0 && !(seg.flags & TcpFlag::FIN) && !windowChanged && c.sndMax != c.sndUna)
+        {
+            ++c.dupAcks;
+            if (c.dupAcks == 3 && !c.inRecovery)
+            {
+                const std::size_t flight = c.sndMax - c.sndUna;
+                c.ssthresh = std::max(flight / 2, 2 * c.mss);
+                c.recover = c.sndMax;
+                c.inRecovery = true;
+                retransmitFirst(c);
+                ++counters.fastRetransmits;
+                c.cwnd = c.ssthresh + 3 * c.mss;
+            }
+            else if (c.dupAcks > 3 && c.inRecovery)
+            {
+                c.cwnd += c.mss;
+            }
+        }
+        return true;
+    }
+
+    const std::uint32_t end = sendEnd(c);
+    const bool finAcked = c.finQueued && seqGt(seg.ack, end);
+    const std::size_t dataAcked = acked - (finAcked ? 1 : 0);
+    c.sndHead = (c.sndHead + dataAcked) & (c.sendRing.size() - 1);
+    c.sndQueued -= dataAcked;
+    c.sndUna = seg.ack;
+    if (seqLt(c.sndNxt, c.sndUna)) c.sndNxt = c.sndUna;
+
+    if (c.rttTiming && seqGeq(seg.ack, c.rttSeq))
+    {
+        updateRtt(c, now - c.rttStart);
+        c.rttTiming = false;
+    }
+    c.retries = 0;
+
+    if (c.inRecovery)
+    {
+        if (seqGeq(seg.ack, c.recover))
+        {
+            c.inRecovery = false;
+            c.cwnd = c.ssthresh;
+        }
+        else
+        {
+            // NewReno partial ACK: the next hole is lost too.
+            retransmitFirst(c);
+            c.cwnd = (c.cwnd > dataAcked ? c.cwnd - dataAcked : 0) + c.mss;
+        }
+    }
+    else if (c.cwnd < c.ssthresh)
+    {
+        c.cwnd += std::min(dataAcked, c.mss);  // Slow start (RFC 3465, L = 1 SMSS)
+    }
+    else
+    {
+        c.cwnd += std::max<std::size_t>(1, c.mss * c.mss / c.cwnd);
+    }
+    c.dupAcks = 0;
+
+    timers.cancel(c.rtoTimer);
+    c.rtoTimer = 0;
+    if (c.sndMax != c.sndUna) armRetransmit(c);
+
+    if (finAcked)
+    {
+        switch (c.tcpState)
+        {
+        case TcpState::FinWait1:
+            c.tcpState = TcpState::FinWait2;
+            break;
+        case TcpState::Closing:
+            enterTimeWait(c);
+            break;
+        case TcpState::LastAck:
+            release(c);
+            return false;
+        default:
+            break;
+        }
+    }
+
+    const std::uint32_t generation = c.generation;
+    if (dataAcked > 0 && c.callbacks.writable &&
+        (c.tcpState == TcpState::Established || c.tcpState == TcpState::CloseWait))
+    {
+        c.callbacks.writable(c);
+        if (!alive(c, generation)) return false;
+    }
+    if (c.heldInOrder > 0)
+    {
+        deliverHeld(c);
+        if (!alive(c, generation)) return false;
+    }
+    return true;
+}
+
+std::size_t TcpLayer::deliver(TcpConnection& c, const std::uint8_t* data, std::size_t size)
+{
+    if (!c.callbacks.received) return size;
+    return std::min(c.callbacks.received(c, data, size), size);
+}
+
+void TcpLayer::receiveData(TcpConnection& c, Segment seg, const Ipv4Packet& packet)
+{
+    const std::uint32_t generation = c.generation;
+    std::uint32_t seq = seg.seq;
+    const std::uint8_t* data = seg.data;
+    std::uint32_t len = seg.len;
+    bool fin = (seg.flags & TcpFlag::FIN) != 0;
+
+    // Drop what we already have.
+    if (seqLt(seq, c.rcvNxt))
+    {
+        const std::uint32_t skip = std::min(c.rcvNxt - seq, len);
+        seq += skip;
+        data += skip;
+        len -= skip;
+        if (seqLt(seq, c.rcvNxt))
+        {
+            ++counters.rxDuplicate;
+            c.ackNow = true;
+            return;
+        }
+    }
+
+    // ...and what doesn't fit the window we offered.
+    const std::uint32_t edge = c.rcvRead + static_cast<std::uint32_t>(config.receiveWindow);
+    if (seqGt(seq + len, edge))
+    {
+        len = seqGt(edge, seq) ? edge - seq : 0;
+        fin = false;
+        ++counters.rxDropped;
+    }
+    if (len == 0 && !fin)
+    {
+        c.ackNow = true;
+        return;
+    }
+
+    if (seq != c.rcvNxt)
+    {
+        // Out of order: keep a reference to the RX buffer, trimmed against its neighbours.
+        ++counters.rxOutOfOrder;
+        c.ackNow = true;  // Duplicate ACK for the sender's fast retransmit
+        std::size_t pos = c.heldInOrder;
+        while (pos < c.held.size() && seqLeq(c.held[pos].seq, seq)) ++pos;
+        if (pos > c.heldInOrder)
+        {
+            const auto& prev = c.held[pos - 1];
+            const std::uint32_t prevEnd = prev.seq + prev.len;
+            if (prev.fin) return;
+            if (seqGt(prevEnd, seq))
+            {
+                const std::uint32_t skip = std::min(prevEnd - seq, len);
+                seq += skip;
+                data += skip;
+                len -= skip;
+                if (len == 0 && !fin) return;
+            }
+        }
+        if (pos < c.held.size() && seqGt(seq + len, c.held[pos].seq))
+        {
+            len = c.held[pos].seq - seq;
+            fin = false;
+            if (len == 0) return;
+        }
+        hold(c, seq, data, len, fin, packet, pos);
+        return;
+    }
+
+    std::uint32_t accepted = 0;
+    if (c.rcvRead == c.rcvNxt && len > 0)
+    {
+        // Nothing unread in front: the application reads straight from the RX buffer.
+        accepted = static_cast<std::uint32_t>(deliver(c, data, len));
+        if (!alive(c, generation)) return;
+        c.rcvRead += accepted;
+    }
+    if (accepted < len)
+    {
+        std::size_t pos = c.heldInOrder;
+        accepted += hold(c, seq + accepted, data + accepted, len - accepted, false, packet, pos);
+        c.heldInOrder = pos;
+    }
+    c.rcvNxt += accepted;
+    c.rxBytes += accepted;
+    counters.rxBytes += accepted;
+    c.ackPendingBytes += accepted;
+
+    if (accepted < len) c.ackNow = true;  // Out of buffers: tell the sender where we stopped
+    else if (fin) acceptFin(c);
+    mergeOutOfOrder(c);
+
+    if (c.ackPendingBytes >= 2 * c.mss) c.ackNow = true;  // RFC 1122: ACK at least every second segment
+    else if (!c.ackNow) scheduleAck(c);
+
+    if (c.heldInOrder > 0 || (c.finReceived && !c.peerClosedNotified)) deliverHeld(c);
+}
+
+std::uint32_t TcpLayer::hold(TcpConnection& c, std::uint32_t seq, const std::uint8_t* data, std::uint32_t len,
+                             bool fin, const Ipv4Packet& packet, std::size_t& position)
+{
+    if (c.held.size() >= config.maxHeldSegments || (len > 0 && !canHold()))
+    {
+        ++counters.rxDropped;
+        return 0;
+    }
+
+    TcpConnection::HeldSegment segment;
+    segment.seq = seq;
+    segment.fin = fin;
+    if (len == 0 || packet.buffer)
+    {
+        if (len > 0)
+        {
+            pool.retain(packet.buffer);
+            ++heldTotal;
+        }
+        segment.buffer = (len > 0) ? packet.buffer : nullptr;
+        segment.data = data;
+        segment.len = len;
+        c.held.insert(c.held.begin() + static_cast<std::ptrdiff_t>(position++), segment);
+        return len;
+    }
+
+    // No pooled RX buffer behind the payload (reassembled datagram): copy it into pool buffers.
+    std::uint32_t done = 0;
+    while (done < len && c.held.size() < config.maxHeldSegments && canHold())
+    {
+        PacketBuffer* buffer = pool.acquire();
+        if (!buffer) break;
+        ++heldTotal;
+        buffer->reset(0);
+        const std::uint32_t chunk = static_cast<std::uint32_t>(std::min<std::size_t>(len - done, buffer->tailroom()));
+        std::uint8_t* out = buffer->append(chunk);
+        std::memcpy(out, data + done, chunk);
+        segment.buffer = buffer;
+        segment.data = out;
+        segment.seq = seq + done;
+        segment.len = chunk;
+        done += chunk;
+        segment.fin = fin && done == len;
+        c.held.insert(c.held.begin() + static_cast<std::ptrdiff_t>(position++), segment);
+    }
+    if (done < len) ++counters.rxDropped;
+    return done;
+}
+
+void TcpLayer::mergeOutOfOrder(TcpConnection& c)
+{
+    while (c.heldInOrder < c.held.size() && !c.finReceived)
+    {
+        auto& s = c.held[c.heldInOrder];
+        if (seqGt(s.seq, c.rcvNxt)) break;
+
+        const std::uint32_t end = s.seq + s.len;
+        if (seqLt(end, c.rcvNxt) || (end == c.rcvNxt && !s.fin))
+        {
+            // Entirely covered by data that arrived since.
+            releaseSegment(s);
+            c.held.erase(c.held.begin() + static_cast<std::ptrdiff_t>(c.heldInOrder));
+            continue;
+        }
+        const std::uint32_t skip = c.rcvNxt - s.seq;
+        s.seq += skip;
+        s.data += skip;
+        s.len -= skip;
+        c.rcvNxt += s.len;
+        c.rxBytes += s.len;
+        counters.rxBytes += s.len;
+        ++c.heldInOrder;
+        if (s.fin) acceptFin(c);
+    }
+}
+
+void TcpLayer::acceptFin(TcpConnection& c)
+{
+    c.rcvNxt += 1;
+    c.finReceived = true;
+    c.ackNow = true;
+    switch (c.tcpState)
+    {
+    case TcpState::Established:
+        c.tcpState = TcpState::CloseWait;
+        break;
+    case TcpState::FinWait1:
+        c.tcpState = TcpState::Closing;
+        break;
+    case TcpState::FinWait2:
+        enterTimeWait(c);
+        break;
+    default:
+        break;
+    }
+}
+
+void TcpLayer::deliverHeld(TcpConnection& c)
+{
+    const std::uint32_t generation = c.generation;
+    const std::uint32_t before = c.rcvRead;
+    while (c.heldInOrder > 0)
+    {
+        auto& s = c.held.front();
+        if (s.len > 0)
+        {
+            const std::size_t consumed = deliver(c, s.data, s.len);
+            if (!alive(c, generation)) return;
+            c.rcvRead += static_cast<std::uint32_t>(consumed);
+            if (consumed < s.len)
+            {
+                s.seq += static_cast<std::uint32_t>(consumed);
+                s.data += consumed;
+                s.len -= static_cast<std::uint32_t>(consumed);
+                break;
+            }
+        }
+        releaseSegment(s);
+        c.held.erase(c.held.begin());
+        --c.heldInOrder;
+    }
+
+    // Reopen the window once the application caught up by a useful amount.
+    const std::uint32_t edge = c.rcvRead + static_cast<std::uint32_t>(config.receiveWindow);
+    if (c.rcvRead != before && seqGt(edge, c.rcvAdvertised) && edge - c.rcvAdvertised >= 2 * c.mss) c.ackNow = true;
+
+    if (c.finReceived && !c.peerClosedNotified && c.heldInOrder == 0)
+    {
+        c.peerClosedNotified = true;
+        if (c.callbacks.peerClosed) c.callbacks.peerClosed(c);
+    }
+}
+
+void TcpLayer::releaseHeld(TcpConnection& c)
+{
+    for (auto& s : c.held) releaseSegment(s);
+    c.held.clear();
+    c.heldInOrder = 0;
+}
+
+bool TcpLayer::canHold() const
+{
+    return heldTotal < config.maxHeldTotal && pool.available() > config.txReserve;
+}
+
+void TcpLayer::releaseSegment(const TcpConnection::HeldSegment& s)
+{
+    if (!s.buffer) return;
+    pool.release(s.buffer);
+    --heldTotal;
+}
+
+// ---------------------------------------------------------------------------
+// Output
+// ---------------------------------------------------------------------------
+
+std::uint32_t TcpLayer::receiveWindow(const TcpConnection& c) const
+{
+    const std::uint32_t edge = c.rcvRead + static_cast<std::uint32_t>(config.receiveWindow);
+    return seqGt(edge, c.rcvNxt) ? edge - c.rcvNxt : 0;
+}
+
+std::uint16_t TcpLayer::windowField(TcpConnection& c, bool syn)
+{
+    const std::uint8_t scale = syn ? 0 : c.rcvScale;
+    std::uint32_t window = receiveWindow(c);
+
+    // Receiver SWS avoidance (RFC 1122 4.2.3.3): move the right edge only by a
+    // full segment or half the buffer, never backwards.
+    const std::uint32_t edge = c.rcvNxt + window;
+    const std::uint32_t step = static_cast<std::uint32_t>(std::min<std::size_t>(c.mss, config.receiveWindow / 2));
+    if (!syn && seqGeq(c.rcvAdvertised, c.rcvNxt) && seqGeq(edge, c.rcvAdvertised) && edge - c.rcvAdvertised < step)
+    {
+        window = c.rcvAdvertised - c.rcvNxt;
+    }
+
+    const std::uint32_t field = std::min<std::uint32_t>(window >> scale, 0xFFFF);
+    c.rcvAdvertised = c.rcvNxt + (field << scale);
+    return static_cast<std::uint16_t>(field);
+}
+
+bool TcpLayer::sendSegment(TcpConnection& c, std::uint32_t seq, std::size_t len, std::uint8_t flags)
+{
+    PacketBuffer* buffer = pool.acquire();
+    if (!buffer)
+    {
+        ++counters.txNoBuffer;
+        return false;
+    }
+    PacketRef owner(&pool, buffer);
+
+    if (len > 0)
+    {
+        std::uint8_t* out = buffer->append(len);
+        if (!out)
+        {
+            ++counters.txErrors;
+            return false;
+        }
+        const std::size_t mask = c.sendRing.size() - 1;
+        const std::size_t offset = (c.sndHead + (seq - c.sndUna)) & mask;
+        const std::size_t first = std::min(len, c.sendRing.size() - offset);
+        std::memcpy(out, c.sendRing.data() + offset, first);
+        std::memcpy(out + first, c.sendRing.data(), len - first);
+    }
+
+    std::uint8_t options[8];
+    std::size_t optionSize = 0;
+    const bool syn = (flags & TcpFlag::SYN) != 0;
+    if (syn)
+    {
+        options[0] = kOptionMss;
+        options[1] = 4;
+        options[2] = static_cast<std::uint8_t>(config.mss >> 8);
+        options[3] = static_cast<std::uint8_t>(config.mss & 0xFF);
+        optionSize = 4;
+        if (c.windowScaling)
+        {
+            options[4] = kOptionNop;
+            options[5] = kOptionWindowScale;
+            options[6] = 3;
+            options[7] = c.rcvScale;
+            optionSize = 8;
+        }
+    }
+
+    const std::size_t headerSize = kTcpHeaderSize + optionSize;
+    std::uint8_t* tcp = buffer->prepend(headerSize);
+    if (!tcp)
+    {
+        ++counters.txErrors;
+        return false;
+    }
+    std::memcpy(tcp + kTcpHeaderSize, options, optionSize);
+    const bool ack = (flags & TcpFlag::ACK) != 0;
+    finishSegment(tcp, headerSize + len, headerSize, c.route, c.localPortNumber, c.remotePortNumber, seq,
+                  ack ? c.rcvNxt : 0, flags, windowField(c, syn));
+
+    if (ipv4.output(*buffer, c.route, IpProto::TCP) < 0)
+    {
+        ++counters.txErrors;
+        return false;
+    }
+    ++counters.txSegments;
+    counters.txBytes += len;
+    c.txBytes += len;
+
+    if (ack)
+    {
+        // Every ACK-bearing segment answers whatever was pending.
+        c.ackNow = false;
+        c.ackPendingBytes = 0;
+        if (c.ackTimer)
+        {
+            timers.cancel(c.ackTimer);
+            c.ackTimer = 0;
+        }
+    }
+    return true;
+}
+
+void TcpLayer::retransmitFirst(TcpConnection& c)
+{
+    const std::uint32_t end = sendEnd(c);
+    const std::size_t unacked = std::min<std::size_t>(c.sndMax - c.sndUna, c.sndQueued);
+    const std::size_t len = std::min(c.mss, unacked);
+    std::uint8_t flags = TcpFlag::ACK;
+    if (c.finQueued && c.sndUna + len == end && seqGt(c.sndMax, end)) flags |= TcpFlag::FIN;
+    if (len == 0 && !(flags & TcpFlag::FIN)) return;
+    sendSegment(c, c.sndUna, len, flags);
+    ++counters.txRetransmits;
+    c.rttTiming = false;  // Karn
+}
+
+void TcpLayer::output(TcpConnection& c)
+{
+    switch (c.tcpState)
+    {
+    case TcpState::Established:
+    case TcpState::CloseWait:
+    case TcpState::FinWait1:
+    case TcpState::Closing:
+    case TcpState::LastAck:
+        break;
+    default:
+        if (c.ackNow && c.tcpState != TcpState::Closed) sendAck(c);
+        return;
+    }
+
+    const std::uint32_t end = sendEnd(c);
+    while (seqLt(c.sndNxt, end))
+    {
+        const std::size_t inFlight = c.sndNxt - c.sndUna;
+        const std::size_t window = std::min(c.sndWnd, c.cwnd);
+        if (inFlight >= window) break;
+        const std::size_t len = std::min({c.mss, static_cast<std::size_t>(end - c.sndNxt), window - inFlight});
+        // Sender SWS avoidance (RFC 1122 4.2.3.4): full segments, the tail of the
+        // data, or half the largest window seen; otherwise the persist timer retries.
+        if (len < c.mss && len < static_cast<std::size_t>(end - c.sndNxt) && len < c.maxSndWnd / 2) break;
+
+        std::uint8_t flags = TcpFlag::ACK;
+        if (c.sndNxt + len == end)
+        {
+            flags |= TcpFlag::PSH;
+            if (c.finQueued) flags |= TcpFlag::FIN;
+        }
+        if (!sendSegment(c, c.sndNxt, len, flags)) break;
+
+        if (seqLt(c.sndNxt, c.sndMax))
+        {
+            ++counters.txRetransmits;
+        }
+        else if (!c.rttTiming)
+        {
+            c.rttTiming = true;
+            c.rttSeq = c.sndNxt + static_cast<std::uint32_t>(len);
+            c.rttStart = now;
+        }
+        c.sndNxt += static_cast<std::uint32_t>(len) + ((flags & TcpFlag::FIN) ? 1 : 0);
+        if (seqGt(c.sndNxt, c.sndMax)) c.sndMax = c.sndNxt;
+    }
+
+    if (c.finQueued && c.sndNxt == end)
+    {
+        if (sendSegment(c, end, 0, TcpFlag::ACK | TcpFlag::FIN))
+        {
+            c.sndNxt = end + 1;
+            if (seqGt(c.sndNxt, c.sndMax)) c.sndMax = c.sndNxt;
+        }
+    }
+
+    // Retransmission timer, or persist timer when a zero window holds back queued data.
+    if (!c.rtoTimer && (c.sndMax != c.sndUna || seqLt(c.sndNxt, end))) armRetransmit(c);
+    if (c.ackNow) sendAck(c);
+}
+
+void TcpLayer::scheduleAck(TcpConnection& c)
+{
+    if (c.ackTimer) return;
+    TcpConnection* p = &c;
+    c.ackTimer = timers.schedule(config.delayedAck, [p] {
+        TcpLayer* layer = p->layer;
+        p->ackTimer = 0;
+        ++layer->counters.delayedAcks;
+        layer->sendAck(*p);
+    });
+}
+
+void TcpLayer::sendReset(const Ipv4Packet& packet, const Segment& seg, std::uint16_t srcPort, std::uint16_t dstPort)
+{
+    if (seg.flags & TcpFlag::RST) return;
+
+    PacketBuffer* buffer = pool.acquire();
+    if (!buffer)
+    {
+        ++counters.txNoBuffer;
+        return;
+    }
+    PacketRef owner(&pool, buffer);
+
+    Ipv4Route route;
+    route.srcMac = ipv4.link();
+    std::memcpy(route.dstMac.data(), packet.frame + 6, 6);
+    route.src = packet.dst;
+    route.dst = packet.src;
+
+    std::uint32_t seq = 0;
+    std::uint32_t ack = 0;
+    std::uint8_t flags = TcpFlag::RST;
+    if (seg.flags & TcpFlag::ACK)
+    {
+        seq = seg.ack;
+    }
+    else
+    {
+        ack = seg.seq + seg.len + ((seg.flags & TcpFlag::SYN) ? 1 : 0) + ((seg.flags & TcpFlag::FIN) ? 1 : 0);
+        flags |= TcpFlag::ACK;
+    }
+
+    std::uint8_t* tcp = buffer->prepend(kTcpHeaderSize);
+    finishSegment(tcp, kTcpHeaderSize, kTcpHeaderSize, route, srcPort, dstPort, seq, ack, flags, 0);
+    if (ipv4.output(*buffer, route, IpProto::TCP) < 0)
+    {
+        ++counters.txErrors;
+        return;
+    }
+    ++counters.txSegments;
+    ++counters.txResets;
+}
+
+// ---------------------------------------------------------------------------
+// Timers
+// ---------------------------------------------------------------------------
+
+void TcpLayer::armRetransmit(TcpConnection& c)
+{
+    TcpConnection* p = &c;
+    c.rtoTimer = timers.schedule(c.rto, [p] {
+        p->rtoTimer = 0;
+        p->layer->onRetransmitTimeout(*p);
+    });
+}
+
+void TcpLayer::updateRtt(TcpConnection& c, Clock::duration sample)
+{
+    using std::chrono::microseconds;
+    microseconds r = std::chrono::duration_cast<microseconds>(sample);
+    if (r.count() < 0) r = microseconds(0);
+
+    // RFC 6298 section 2.
+    if (!c.rttValid)
+    {
+        c.srtt = r;
+        c.rttvar = r / 2;
+        c.rttValid = true;
+    }
+    else
+    {
+        const microseconds delta = (c.srtt > r) ? c.srtt - r : r - c.srtt;
+        c.rttvar = (3 * c.rttvar + delta) / 4;
+        c.srtt = (7 * c.srtt + r) / 8;
+    }
+    const microseconds granularity = std::chrono::milliseconds(1);
+    const microseconds rto = c.srtt + std::max(granularity, 4 * c.rttvar);
+    c.rto = std::clamp(std::chrono::ceil<std::chrono::milliseconds>(rto), config.minRto, config.maxRto);
+}
+
+void TcpLayer::onRetransmitTimeout(TcpConnection& c)
+{
+    if (timers.now() > now) now = timers.now();
+    TcpConnection* previous = current;
+    current = &c;
+
+    const bool handshake = c.tcpState == TcpState::SynSent || c.tcpState == TcpState::SynReceived;
+    const std::uint32_t end = sendEnd(c);
+    const bool probe = !handshake && c.sndMax == c.sndUna && seqLt(c.sndNxt, end);
+
+    if (!probe && ++c.retries > config.maxRetransmits)
+    {
+        if (!handshake)
+        {
+            sendSegment(c, c.sndNxt, 0, TcpFlag::RST | TcpFlag::ACK);
+            ++counters.txResets;
+        }
+        current = previous;
+        reset(c);
+        return;
+    }
+
+    c.rto = std::min(c.rto * 2, config.maxRto);
+    c.rttTiming = false;
+
+    if (handshake)
+    {
+        ++counters.timeouts;
+        ++counters.txRetransmits;
+        sendSegment(c, c.iss, 0, TcpFlag::SYN | (c.tcpState == TcpState::SynReceived ? TcpFlag::ACK : 0));
+        armRetransmit(c);
+    }
+    else if (probe)
+    {
+        // Zero-window probe: an old sequence number makes the peer answer with its current window.
+        sendSegment(c, c.sndUna - 1, 0, TcpFlag::ACK);
+        armRetransmit(c);
+    }
+    else if (c.sndMax != c.sndUna)
+    {
+        // RFC 5681: collapse to one segment and go back to the first unacknowledged byte.
+        ++counters.timeouts;
+        const std::size_t flight = c.sndMax - c.sndUna;
+        c.ssthresh = std::max(flight / 2, 2 * c.mss);
+        c.cwnd = c.mss;
+        c.inRecovery = false;
+        c.dupAcks = 0;
+        c.sndNxt = c.sndUna;
+        output(c);
+    }
+    current = previous;
+}
+
+void TcpLayer::enterTimeWait(TcpConnection& c)
+{
+    c.tcpState = TcpState::TimeWait;
+    timers.cancel(c.rtoTimer);
+    timers.cancel(c.waitTimer);
+    c.rtoTimer = 0;
+    TcpConnection* p = &c;
+    c.waitTimer = timers.schedule(config.timeWait, [p] {
+        p->waitTimer = 0;
+        p->layer->release(*p);
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Test services
+// ---------------------------------------------------------------------------
+
+/** @brief One full RFC 864 cycle: 95 lines of 72 characters + CRLF, each shifted by one. */
+static const std::vector<std::uint8_t>& chargenPattern()
+{
+    static const std::vector<std::uint8_t> pattern = [] {
+        std::vector<std::uint8_t> out;
+        out.reserve(95 * 74);
+        for (std::size_t line = 0; line < 95; ++line)
+        {
+            for (std::size_t col = 0; col < 72; ++col) out.push_back(static_cast<std::uint8_t>(' ' + (line + col) % 95));
+            out.push_back('\r');
+            out.push_back('\n');
+        }
+        return out;
+    }();
+    return pattern;
+}
+
+void TcpLayer::enableServices()
+{
+    static constexpr std::uint64_t kHttpStarted = 1ull << 63;
+
+    listen(TcpPort::Discard, TcpCallbacks{});
+
+    TcpCallbacks echo;
+    echo.received = [](TcpConnection& c, const std::uint8_t* data, std::size_t size) { return c.send(data, size); };
+    echo.peerClosed = [](TcpConnection& c) { c.close(); };
+    listen(TcpPort::Echo, std::move(echo));
+
+    // user = position in the chargen cycle.
+    auto chargenPump = [](TcpConnection& c) {
+        const auto& pattern = chargenPattern();
+        while (c.sendSpace() > 0)
+        {
+            const std::size_t offset = static_cast<std::size_t>(c.user % pattern.size());
+            const std::size_t sent = c.send(pattern.data() + offset, pattern.size() - offset);
+            if (sent == 0) break;
+            c.user += sent;
+        }
+    };
+    TcpCallbacks chargen;
+    chargen.connected = chargenPump;
+    chargen.writable = chargenPump;
+    chargen.peerClosed = [](TcpConnection& c) { c.close(); };
+    listen(TcpPort::Chargen, std::move(chargen));
+
+    // GET /<bytes> answers with that many bytes (curl -o /dev/null http://ip/1000000000).
+    // user = kHttpStarted | body bytes still to queue.
+    auto httpPump = [](TcpConnection& c) {
+        const auto& pattern = chargenPattern();
+        std::uint64_t remaining = c.user & ~kHttpStarted;
+        while (remaining > 0 && c.sendSpace() > 0)
+        {
+            const std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(remaining, pattern.size()));
+            const std::size_t sent = c.send(pattern.data(), n);
+            if (sent == 0) break;
+            remaining -= sent;
+        }
+        c.user = kHttpStarted | remaining;
+        if (remaining == 0) c.close();
+    };
+    TcpCallbacks http;
+    http.received = [httpPump](TcpConnection& c, const std::uint8_t* data, std::size_t size) {
+        if (c.user & kHttpStarted) return size;
+
+        const std::string request(reinterpret_cast<const char*>(data), std::min<std::size_t>(size, 256));
+        std::uint64_t length = 0;
+        std::string status = "200 OK";
+        if (request.compare(0, 5, "GET /") == 0)
+        {
+            std::size_t i = 5;
+            while (i < request.size() && request[i] >= '0' && request[i] <= '9' && length < (1ull << 40))
+            {
+                length = length * 10 + static_cast<std::uint64_t>(request[i++] - '0');
+            }
+            if (i == 5) length = 1024u * 1024u;
+        }
+        else
+        {
+            status = "400 Bad Request";
+        }
+        const std::string header = "HTTP/1.1 " + status +
+                                   "\r\nContent-Type: application/octet-stream\r\nContent-Length: " +
+                                   std::to_string(length) + "\r\nConnection: close\r\n\r\n";
+        c.send(reinterpret_cast<const std::uint8_t*>(header.data()), header.size());
+        c.user = kHttpStarted | length;
+        httpPump(c);
+        return size;
+    };
+    http.writable = httpPump;
+    http.peerClosed = [](TcpConnection& c) { c.close(); };
+    listen(TcpPort::Http, std::move(http));
+}
@@ -0,0 +1,141 @@
+#include "timer_wheel.h"
+
+TimerWheel::TimerWheel(Clock::duration tick, std::size_t slots, Clock::time_point startTime)
+    : tickLength(tick.count() > 0 ? tick : Clock::duration(1)), start(startTime)
+{
+    std::size_t size = 1;
+    while (size < slots) size <<= 1;
+    mask = size - 1;
+    heads.assign(size, kNone);
+}
+
+std::uint32_t TimerWheel::indexOf(TimerId id) const
+{
+    const std::uint32_t index = static_cast<std::uint32_t>(id & 0xFFFFFFFFu);
+    if (index == 0 || index > nodes.size()) return kNone;
+    const Node& node = nodes[index - 1];
+    if (node.generation != static_cast<std::uint32_t>(id >> 32) || !node.callback) return kNone;
+    return index - 1;
+}
+
+bool TimerWheel::pending(TimerId id) const
+{
+    return indexOf(id) != kNone;
+}
+
+void TimerWheel::link(std::uint32_t index)
+{
+    Node& node = nodes[index];
+    std::uint32_t& head = heads[node.expires & mask];
+    node.prev = kNone;
+    node.next = head;
+    if (head != kNone) nodes[head].prev = index;
+    head = index;
+    node.linked = true;
+}
+
+void TimerWheel::unlink(std::uint32_t index)
+{
+    Node& node = nodes[index];
+    if (!node.linked) return;
+    if (node.prev != kNone) nodes[node.prev].next = node.next;
+    else heads[node.expires & mask] = node.next;
+    if (node.next != kNone) nodes[node.next].prev = node.prev;
+    node.prev = node.next = kNone;
+    node.linked = false;
+}
+
+void TimerWheel::freeNode(std::uint32_t index)
+{
+    Node& node = nodes[index];
+    node.callback = nullptr;
+    ++node.generation;
+    freeNodes.push_back(index);
+    --armed;
+}
+
+TimerId TimerWheel::schedule(Clock::duration delay, Callback callback)
+{
+    if (!callback) return 0;
+
+    std::uint32_t index;
+    if (!freeNodes.empty())
+    {
+        index = freeNodes.back();
+        freeNodes.pop_back();
+    }
+    else
+    {
+        index = static_cast<std::uint32_t>(nodes.size());
+        nodes.emplace_back();
+    }
+
+    std::uint64_t ticks = 1;
+    if (delay > Clock::duration::zero())
+    {
+        ticks = static_cast<std::uint64_t>((delay + tickLength - Clock::duration(1)) / tickLength);
+    }
+
+    Node& node = nodes[index];
+    node.callback = std::move(callback);
+    node.expires = currentTick + ticks;
+    link(index);
+    ++armed;
+    return (static_cast<TimerId>(node.generation) << 32) | (index + 1);
+}
+
+bool TimerWheel::cancel(TimerId id)
+{
+    const std::uint32_t index = indexOf(id);
+    if (index == kNone) return false;
+    unlink(index);
+    freeNode(index);
+    return true;
+}
+
+void TimerWheel::collect(std::size_t slot, std::uint64_t upTo)
+{
+    std::uint32_t index = heads[slot];
+    while (index != kNone)
+    {
+        const std::uint32_t next = nodes[index].next;
+        if (nodes[index].expires <= upTo)
+        {
+            unlink(index);
+            due.push_back((static_cast<TimerId>(nodes[index].generation) << 32) | (index + 1));
+        }
+        index = next;
+    }
+}
+
+std::size_t TimerWheel::advance(Clock::time_point now)
+{
+    if (now <= start) return 0;
+    const std::uint64_t target = static_cast<std::uint64_t>((now - start) / tickLength);
+    if (target <= currentTick) return 0;
+
+    due.clear();
+    if (target - currentTick > mask)
+    {
+        // Idle for more than a whole turn: one pass over every slot.
+        for (std::size_t slot = 0; slot <= mask; ++slot) collect(slot, target);
+    }
+    else
+    {
+        for (std::uint64_t t = currentTick + 1; t <= target; ++t) collect(t & mask, target);
+    }
+    currentTick = target;
+
+    // Fire after collecting so callbacks can reschedule (also into the slots just visited).
+    std::size_t fired = 0;
+    for (TimerId id : due)
+    {
+        const std::uint32_t index = indexOf(id);
+        if (index == kNone) continue;  // Cancelled by an earlier callback
+        Callback callback = std::move(nodes[index].callback);
+        freeNode(index);
+        callback();
+        ++fired;
+    }
+    return fired;
+}
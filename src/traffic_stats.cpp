@@ -0,0 +1,473 @@
+#include "traffic_stats.h"
+
+#include "ipv4.h"
+#include "ipv6.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// ---------------------------------------------------------------------------
+// SpaceSaving
+// ---------------------------------------------------------------------------
+
+static std::uint32_t heavyHash(const HeavyKey& key)
+{
+    std::uint64_t lo;
+    std::uint64_t hi;
+    std::memcpy(&lo, key.bytes, 8);
+    std::memcpy(&hi, key.bytes + 8, 8);
+    const std::uint64_t h = (lo ^ (hi * 0x9E3779B97F4A7C15ULL)) * 0xC2B2AE3D27D4EB4FULL;
+    return static_cast<std::uint32_t>(h >> 32);
+}
+
+static bool sameHeavyKey(const HeavyKey& a, const HeavyKey& b)
+{
+    std::uint64_t x[2];
+    std::uint64_t y[2];
+    std::memcpy(x, a.bytes, sizeof(x));
+    std::memcpy(y, b.bytes, sizeof(y));
+    return ((x[0] ^ y[0]) | (x[1] ^ y[1])) == 0;
+}
+
+SpaceSaving::SpaceSaving(std::size_t capacity)
+{
+    capacity = std::max<std::size_t>(capacity, 1);
+    std::size_t slots = 4;
+    while (slots < capacity * 2) slots <<= 1;
+    entries.resize(capacity);
+    heap.resize(capacity);
+    index.assign(slots, Slot{0, -1});
+}
+
+std::size_t SpaceSaving::memoryBytes() const
+{
+    return entries.size() * sizeof(Entry) + heap.size() * sizeof(std::uint32_t) + index.size() * sizeof(Slot);
+}
+
+std::size_t SpaceSaving::findSlot(const HeavyKey& key, std::uint32_t hash) const
+{
+    const std::size_t mask = index.size() - 1;
+    std::size_t slot = hash & mask;
+    while (index[slot].id >= 0 &&
+           (index[slot].hash != hash || !sameHeavyKey(entries[static_cast<std::size_t>(index[slot].id)].hitter.key, key)))
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void SpaceSaving::eraseSlot(std::size_t slot)
+{
+    // Backward-shift deletion keeps linear probing free of tombstones.
+    const std::size_t mask = index.size() - 1;
+    std::size_t hole = slot;
+    std::size_t next = (hole + 1) & mask;
+    while (index[next].id >= 0)
+    {
+        const std::size_t home = index[next].hash & mask;
+        // Move the entry back if the hole lies on its probe path (cyclically between home and next).
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            index[hole] = index[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    index[hole].id = -1;
+}
+
+void SpaceSaving::swapHeap(std::size_t a, std::size_t b)
+{
+    std::swap(heap[a], heap[b]);
+    entries[heap[a]].heapPos = static_cast<std::uint32_t>(a);
+    entries[heap[b]].heapPos = static_cast<std::uint32_t>(b);
+}
+
+void SpaceSaving::siftDown(std::size_t pos)
+{
+    for (;;)
+    {
+        const std::size_t left = pos * 2 + 1;
+        if (left >= used) return;
+        std::size_t smallest = left;
+        const std::size_t right = left + 1;
+        if (right < used && entries[heap[right]].hitter.count < entries[heap[left]].hitter.count) smallest = right;
+        if (entries[heap[smallest]].hitter.count >= entries[heap[pos]].hitter.count) return;
+        swapHeap(pos, smallest);
+        pos = smallest;
+    }
+}
+
+void SpaceSaving::siftUp(std::size_t pos)
+{
+    while (pos > 0)
+    {
+        const std::size_t parent = (pos - 1) / 2;
+        if (entries[heap[parent]].hitter.count <= entries[heap[pos]].hitter.count) return;
+        swapHeap(pos, parent);
+        pos = parent;
+    }
+}
+
+void SpaceSaving::add(const HeavyKey& key, std::uint32_t bytes)
+{
+    ++stream;
+    const std::uint32_t hash = heavyHash(key);
+    const std::size_t slot = findSlot(key, hash);
+    if (index[slot].id >= 0)
+    {
+        Entry& e = entries[static_cast<std::size_t>(index[slot].id)];
+        ++e.hitter.count;
+        e.hitter.bytes += bytes;
+        siftDown(e.heapPos);
+        return;
+    }
+    if (used < entries.size())
+    {
+        const std::size_t id = used++;
+        entries[id].hitter = HeavyHitter{key, 1, 0, bytes};
+        entries[id].heapPos = static_cast<std::uint32_t>(id);
+        heap[id] = static_cast<std::uint32_t>(id);
+        index[slot] = Slot{hash, static_cast<std::int32_t>(id)};
+        siftUp(id);
+        return;
+    }
+
+    // Take over the smallest counter: its count becomes our error bound.
+    const std::uint32_t victim = heap[0];
+    Entry& e = entries[victim];
+    eraseSlot(findSlot(e.hitter.key, heavyHash(e.hitter.key)));
+    e.hitter.key = key;
+    e.hitter.error = e.hitter.count;
+    ++e.hitter.count;
+    e.hitter.bytes = bytes;
+    index[findSlot(key, hash)] = Slot{hash, static_cast<std::int32_t>(victim)};
+    siftDown(0);
+}
+
+std::vector<HeavyHitter> SpaceSaving::top(std::size_t count) const
+{
+    std::vector<HeavyHitter> out;
+    out.reserve(used);
+    for (std::size_t i = 0; i < used; ++i) out.push_back(entries[i].hitter);
+    count = std::min(count, out.size());
+    std::partial_sort(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(count), out.end(),
+                      [](const HeavyHitter& a, const HeavyHitter& b) { return a.count > b.count; });
+    out.resize(count);
+    return out;
+}
+
+void SpaceSaving::clear()
+{
+    used = 0;
+    stream = 0;
+    std::fill(index.begin(), index.end(), Slot{0, -1});
+}
+
+// ---------------------------------------------------------------------------
+// TrafficStats
+// ---------------------------------------------------------------------------
+
+static void countFrame(TrafficCounter& counter, std::uint32_t bytes)
+{
+    ++counter.frames;
+    counter.bytes += bytes;
+}
+
+static void closeSecond(TrafficCounter& counter, bool consecutive)
+{
+    // A gap longer than one second means the previous second saw nothing.
+    counter.framesLastSecond = consecutive ? counter.frames - counter.framesMark : 0;
+    counter.bytesLastSecond = consecutive ? counter.bytes - counter.bytesMark : 0;
+    counter.framesMark = counter.frames;
+    counter.bytesMark = counter.bytes;
+}
+
+static HeavyKey macKey(const std::uint8_t* mac)
+{
+    HeavyKey key{};
+    std::memcpy(key.bytes, mac, 6);
+    return key;
+}
+
+static HeavyKey ipKey(const std::uint8_t* address, std::uint8_t version)
+{
+    HeavyKey key{};
+    if (version == 4)
+    {
+        key.bytes[10] = 0xff;
+        key.bytes[11] = 0xff;
+        std::memcpy(key.bytes + 12, address, 4);
+    }
+    else
+    {
+        std::memcpy(key.bytes, address, 16);
+    }
+    return key;
+}
+
+TrafficStats::TrafficStats(std::size_t topK)
+    : topSrcMac(topK), topDstMac(topK), topSrcIp(topK), topDstIp(topK)
+{
+}
+
+TrafficCounter& TrafficStats::etherTypeCounter(std::uint16_t type)
+{
+    // Few distinct EtherTypes show up on a link: a short probe from a multiplicative hash.
+    std::size_t slot = (static_cast<std::uint32_t>(type) * 0x9E3779B1u) >> 26;
+    for (std::size_t i = 0; i < EtherTypeSlots; ++i)
+    {
+        EtherTypeCounter& entry = etherTypeTable[slot];
+        if (entry.used && entry.type == type) return entry.counter;
+        if (!entry.used)
+        {
+            entry.used = true;
+            entry.type = type;
+            return entry.counter;
+        }
+        slot = (slot + 1) & (EtherTypeSlots - 1);
+    }
+    return etherTypeOther;
+}
+
+void TrafficStats::add(const FrameDescriptor& frame, TrafficDirection direction, Clock::time_point now)
+{
+    roll(now);
+    const std::uint32_t bytes = frame.frameSize;
+    TrafficSecond& second = seconds[head];
+    if (direction == TrafficDirection::Rx)
+    {
+        countFrame(rx, bytes);
+        ++second.rxFrames;
+        second.rxBytes += bytes;
+    }
+    else
+    {
+        countFrame(tx, bytes);
+        ++second.txFrames;
+        second.txBytes += bytes;
+    }
+    if (frame.layerCount == 0) return;
+
+    countFrame(etherTypeCounter(frame.etherType), bytes);
+    topSrcMac.add(macKey(frame.srcMac), bytes);
+    topDstMac.add(macKey(frame.dstMac), bytes);
+    if (frame.ipVersion == 4 || frame.ipVersion == 6)
+    {
+        countFrame(ipProtoTable[frame.ipProto], bytes);
+        topSrcIp.add(ipKey(frame.srcIp, frame.ipVersion), bytes);
+        topDstIp.add(ipKey(frame.dstIp, frame.ipVersion), bytes);
+    }
+}
+
+void TrafficStats::roll(Clock::time_point now)
+{
+    if (!started)
+    {
+        started = true;
+        secondStart = now;
+        return;
+    }
+    const auto elapsed = now - secondStart;
+    if (elapsed < std::chrono::seconds(1)) return;
+    const auto steps = static_cast<std::size_t>(std::chrono::duration_cast<std::chrono::seconds>(elapsed).count());
+    secondStart += std::chrono::seconds(steps);
+
+    const bool consecutive = steps == 1;
+    closeSecond(rx, consecutive);
+    closeSecond(tx, consecutive);
+    closeSecond(etherTypeOther, consecutive);
+    for (EtherTypeCounter& entry : etherTypeTable)
+    {
+        if (entry.used) closeSecond(entry.counter, consecutive);
+    }
+    for (TrafficCounter& counter : ipProtoTable) closeSecond(counter, consecutive);
+
+    for (std::size_t i = 0; i < std::min(steps, seconds.size()); ++i)
+    {
+        head = (head + 1) % seconds.size();
+        seconds[head] = TrafficSecond{};
+        completed = std::min(completed + 1, WindowSeconds);
+    }
+}
+
+TrafficSecond TrafficStats::window(std::size_t count) const
+{
+    TrafficSecond sum;
+    count = std::min(count, completed);
+    for (std::size_t i = 1; i <= count; ++i)
+    {
+        const TrafficSecond& s = seconds[(head + seconds.size() - i) % seconds.size()];
+        sum.rxFrames += s.rxFrames;
+        sum.rxBytes += s.rxBytes;
+        sum.txFrames += s.txFrames;
+        sum.txBytes += s.txBytes;
+    }
+    return sum;
+}
+
+TrafficSecond TrafficStats::peak() const
+{
+    TrafficSecond best;
+    for (std::size_t i = 1; i <= completed; ++i)
+    {
+        const TrafficSecond& s = seconds[(head + seconds.size() - i) % seconds.size()];
+        if (s.rxFrames + s.txFrames > best.rxFrames + best.txFrames) best = s;
+    }
+    return best;
+}
+
+void TrafficStats::clear()
+{
+    rx = TrafficCounter{};
+    tx = TrafficCounter{};
+    etherTypeTable.fill(EtherTypeCounter{});
+    etherTypeOther = TrafficCounter{};
+    ipProtoTable.fill(TrafficCounter{});
+    topSrcMac.clear();
+    topDstMac.clear();
+    topSrcIp.clear();
+    topDstIp.clear();
+    seconds.fill(TrafficSecond{});
+    head = 0;
+    completed = 0;
+    started = false;
+}
+
+std::size_t TrafficStats::memoryBytes() const
+{
+    return sizeof(*this) + topSrcMac.memoryBytes() + topDstMac.memoryBytes() + topSrcIp.memoryBytes() +
+           topDstIp.memoryBytes();
+}
+
+// ---------------------------------------------------------------------------
+// Formatting
+// ---------------------------------------------------------------------------
+
+static std::string statBytes(std::uint64_t bytes)
+{
+    char text[32];
+    if (bytes >= (1ull << 30)) std::snprintf(text, sizeof(text), "%.1fG", bytes / double(1ull << 30));
+    else if (bytes >= (1ull << 20)) std::snprintf(text, sizeof(text), "%.1fM", bytes / double(1ull << 20));
+    else if (bytes >= (1ull << 10)) std::snprintf(text, sizeof(text), "%.1fK", bytes / double(1ull << 10));
+    else std::snprintf(text, sizeof(text), "%lluB", static_cast<unsigned long long>(bytes));
+    return text;
+}
+
+static std::string etherTypeName(std::uint16_t type)
+{
+    switch (type)
+    {
+        case EtherType::IPv4: return "IPv4";
+        case EtherType::ARP: return "ARP";
+        case EtherType::IPv6: return "IPv6";
+        case EtherType::Demo: return "Demo";
+        default: break;
+    }
+    char text[8];
+    std::snprintf(text, sizeof(text), "0x%04X", type);
+    return text;
+}
+
+static std::string ipProtoName(std::size_t proto)
+{
+    switch (proto)
+    {
+        case IpProto::TCP: return "TCP";
+        case IpProto::UDP: return "UDP";
+        case IpProto::ICMP: return "ICMP";
+        case IpProto::ICMPv6: return "ICMPv6";
+        default: return "IP/" + std::to_string(proto);
+    }
+}
+
+static std::string counterLine(const std::string& name, const TrafficCounter& c)
+{
+    char text[96];
+    std::snprintf(text, sizeof(text), "  %-8s %10llu tramas %8s  %6llu/s", name.c_str(),
+                  static_cast<unsigned long long>(c.frames), statBytes(c.bytes).c_str(),
+                  static_cast<unsigned long long>(c.framesLastSecond));
+    return text;
+}
+
+static std::string heavyName(const HeavyKey& key, bool ip)
+{
+    if (!ip)
+    {
+        MacAddress mac;
+        std::memcpy(mac.data(), key.bytes, mac.size());
+        return macToString(mac);
+    }
+    static const std::uint8_t mapped[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+    if (std::memcmp(key.bytes, mapped, sizeof(mapped)) == 0)
+    {
+        Ipv4Address v4;
+        std::memcpy(v4.data(), key.bytes + 12, 4);
+        return ipv4ToString(v4);
+    }
+    Ipv6Address v6;
+    std::memcpy(v6.data(), key.bytes, 16);
+    return ipv6ToString(v6);
+}
+
+static void appendHeavy(std::vector<std::string>& lines, const char* title, const SpaceSaving& summary, bool ip,
+                        std::size_t perList)
+{
+    lines.push_back(std::string(title) + " (Space-Saving " + std::to_string(summary.size()) + "/" +
+                    std::to_string(summary.capacity()) + ", " + std::to_string(summary.total()) + " tramas)");
+    for (const HeavyHitter& h : summary.top(perList))
+    {
+        char text[128];
+        std::snprintf(text, sizeof(text), "  %-40s %10llu (+-%llu) %8s", heavyName(h.key, ip).c_str(),
+                      static_cast<unsigned long long>(h.count), static_cast<unsigned long long>(h.error),
+                      statBytes(h.bytes).c_str());
+        lines.push_back(text);
+    }
+}
+
+std::vector<std::string> formatTrafficStats(TrafficStats& stats, std::size_t perList, TrafficStats::Clock::time_point now)
+{
+    stats.roll(now);
+    std::vector<std::string> lines;
+    const TrafficCounter& rx = stats.total(TrafficDirection::Rx);
+    const TrafficCounter& tx = stats.total(TrafficDirection::Tx);
+    lines.push_back("RX " + std::to_string(rx.frames) + " tramas " + statBytes(rx.bytes) + " (" +
+                    std::to_string(rx.framesLastSecond) + "/s, " + statBytes(rx.bytesLastSecond) + "/s) | TX " +
+                    std::to_string(tx.frames) + " tramas " + statBytes(tx.bytes) + " (" +
+                    std::to_string(tx.framesLastSecond) + "/s, " + statBytes(tx.bytesLastSecond) + "/s)");
+    const TrafficSecond last10 = stats.window(10);
+    const TrafficSecond last60 = stats.window(TrafficStats::WindowSeconds);
+    const TrafficSecond best = stats.peak();
+    lines.push_back("Media 10s: " + std::to_string((last10.rxFrames + last10.txFrames) / 10) + " tramas/s | 60s: " +
+                    std::to_string((last60.rxFrames + last60.txFrames) / TrafficStats::WindowSeconds) +
+                    " tramas/s | pico: " + std::to_string(best.rxFrames + best.txFrames) + " tramas/s, " +
+                    statBytes(best.rxBytes + best.txBytes) + "/s | memoria " + statBytes(stats.memoryBytes()));
+
+    std::vector<const TrafficStats::EtherTypeCounter*> types;
+    for (const auto& entry : stats.etherTypes())
+    {
+        if (entry.used) types.push_back(&entry);
+    }
+    std::sort(types.begin(), types.end(), [](const auto* a, const auto* b) { return a->counter.frames > b->counter.frames; });
+    lines.push_back("EtherType");
+    for (const auto* entry : types) lines.push_back(counterLine(etherTypeName(entry->type), entry->counter));
+    if (stats.otherEtherTypes().frames > 0) lines.push_back(counterLine("otros", stats.otherEtherTypes()));
+
+    std::vector<std::size_t> protos;
+    for (std::size_t p = 0; p < stats.ipProtocols().size(); ++p)
+    {
+        if (stats.ipProtocols()[p].frames > 0) protos.push_back(p);
+    }
+    std::sort(protos.begin(), protos.end(), [&](std::size_t a, std::size_t b) {
+        return stats.ipProtocols()[a].frames > stats.ipProtocols()[b].frames;
+    });
+    lines.push_back("Protocolo IP");
+    for (std::size_t p : protos) lines.push_back(counterLine(ipProtoName(p), stats.ipProtocols()[p]));
+
+    appendHeavy(lines, "Top MAC origen", stats.srcMacs(), false, perList);
+    appendHeavy(lines, "Top MAC destino", stats.dstMacs(), false, perList);
+    appendHeavy(lines, "Top IP origen", stats.srcIps(), true, perList);
+    appendHeavy(lines, "Top IP destino", stats.dstIps(), true, perList);
+    return lines;
+}
@@ -1,12 +1,39 @@
 #include "tui_app.h"
 #include "arp.h"
+#include "bpf_filter.h"
+#include "dissector.h"
+#include "display_filter.h"
 #include "ethernet.h"
+#include "event_log.h"
+#include "file_watcher.h"
+#include "hex_view.h"
+#include "flow_table.h"
+#include "frame_history.h"
+#include "icmp.h"
+#include "ipv4.h"
+#include "ipv6.h"
+#include "latency_histogram.h"
+#include "log_ring.h"
+#include "mac_filter.h"
+#include "metrics.h"
+#include "ndp.h"
 #include "netgui_actions.h"
+#include "packet_buffer.h"
+#include "packet_library.h"
+#include "render_scheduler.h"
+#include "tcp.h"
+#include "timer_wheel.h"
+#include "traffic_stats.h"
+#include "udp.h"
 
 #include <ncurses.h>
 
 #include <algorithm>
 #include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <poll.h>
 #include <filesystem>
 #include <system_error>
@@ -17,18 +44,6 @@
 #include <chrono>
 
 namespace {
-struct LogBuffer {
-    std::vector<std::string> lines;
-    std::size_t maxLines = 200;
-
-    void push(const std::string& line) {
-        lines.push_back(line);
-        if (lines.size() > maxLines) {
-            lines.erase(lines.begin(), lines.begin() + (lines.size() - maxLines));
-        }
-    }
-};
-
 // ARP table types and formatters live in arp.h/arp.cpp
 
 void drawHeader(WINDOW* win, const std::string& iface, const std::string& status, const std::string& arpSummary) {
@@ -50,7 +65,7 @@ void drawHeader(WINDOW* win, const std::string& iface, const std::string& status
         mvwaddnstr(win, 2, x, line2.c_str(), maxWidth);
         mvwaddnstr(win, 3, x, line3.c_str(), maxWidth);
     }
-    wrefresh(win);
+    wnoutrefresh(win);
 }
 
 void drawFooter(WINDOW* win) {
@@ -88,39 +103,143 @@ void drawFooter(WINDOW* win) {
         mvwaddnstr(win, 2, x, "SYS:", 4);
         wattroff(win, COLOR_PAIR(6));
         
-        std::string line2 = " [i]Info [a]ARP [Arrows]Log Scroll";
+        std::string line2 = " [i]Info [a]ARP [f]Flujos [b]Filtro [v]Vista [g]mDNS [o]MAC [h]Historial [w]Panel [Arrows]Log Scroll";
         mvwaddnstr(win, 2, x + 4, line2.c_str(), maxWidth - 4);
     }
-    wrefresh(win);
+    wnoutrefresh(win);
 }
 
-void drawArpTable(WINDOW* win, const std::unordered_map<std::uint32_t, ArpEntry>& table) {
+void drawArpTable(WINDOW* win, const std::unordered_map<std::uint32_t, ArpEntry>& table,
+                  const NeighborCache& neighbors) {
     int h, w;
     getmaxyx(win, h, w);
     werase(win);
     box(win, 0, 0);
-    mvwaddnstr(win, 0, 2, " Tabla ARP ", w - 4);
+    mvwaddnstr(win, 0, 2, " Tabla ARP / NDP ", w - 4);
 
     int y = 1;
     mvwaddnstr(win, y++, 2, "REQ: who-has IP | REP: IP is-at MAC", w - 4);
-    if (table.empty()) {
+    if (table.empty() && neighbors.size() == 0) {
         mvwaddnstr(win, y++, 2, "Sin entradas", w - 4);
         mvwaddnstr(win, h - 2, 2, "[a] Cerrar", w - 4);
-        wrefresh(win);
+        wnoutrefresh(win);
         return;
     }
 
     const auto now = std::chrono::steady_clock::now();
     auto lines = formatArpTable(table, now);
+    if (neighbors.size() > 0) {
+        lines.push_back("");
+        auto ndpLines = formatNeighborCache(neighbors, now);
+        lines.insert(lines.end(), ndpLines.begin(), ndpLines.end());
+    }
     for (const auto& line : lines) {
         if (y >= h - 2) break;
         mvwaddnstr(win, y++, 2, line.c_str(), w - 4);
     }
     mvwaddnstr(win, h - 2, 2, "[a] Cerrar", w - 4);
+    wnoutrefresh(win);
+}
+
+void drawFlowTable(WINDOW* win, const FlowTable& flows, const std::vector<std::string>& lines) {
+    int h, w;
+    getmaxyx(win, h, w);
+    werase(win);
+    box(win, 0, 0);
+    mvwaddnstr(win, 0, 2, " Top flujos (bytes) ", w - 4);
+
+    const FlowStats& st = flows.stats();
+    const std::string summary = "Activos: " + std::to_string(flows.size()) + "/" + std::to_string(flows.maxFlows()) +
+                                " | creados " + std::to_string(st.created) + " | expirados " +
+                                std::to_string(st.expired) + " | desalojados " + std::to_string(st.evicted) +
+                                " | memoria " + std::to_string(flows.memoryBytes() >> 20) + " MB";
+    int y = 1;
+    mvwaddnstr(win, y++, 2, summary.c_str(), w - 4);
+    if (flows.size() == 0) {
+        mvwaddnstr(win, y++, 2, "Sin flujos", w - 4);
+    }
+    for (std::size_t i = 0; flows.size() > 0 && i < lines.size(); ++i) {
+        if (y >= h - 2) break;
+        if (i == 0) wattron(win, COLOR_PAIR(6));
+        mvwaddnstr(win, y++, 2, lines[i].c_str(), w - 4);
+        if (i == 0) wattroff(win, COLOR_PAIR(6));
+    }
+    mvwaddnstr(win, h - 2, 2, "[f] Cerrar", w - 4);
+    wnoutrefresh(win);
+}
+
+// Historial de tramas en la ventana del log: solo se decodifican las filas visibles.
+void drawHistory(WINDOW* win, const FrameHistory& history, std::uint64_t selected, std::int64_t epochNs) {
+    int h, w;
+    getmaxyx(win, h, w);
+    werase(win);
+    box(win, 0, 0);
+    const std::string title = " Historial: " + std::to_string(history.size()) + "/" +
+                              std::to_string(history.maxFrames()) + " tramas, " +
+                              std::to_string(history.bytesUsed() >> 10) + "/" +
+                              std::to_string(history.maxBytes() >> 10) + " KB ";
+    mvwaddnstr(win, 0, 2, title.c_str(), std::max(0, w - 4));
+
+    const int rows = std::max(0, h - 3);  // La última fila interior es la ayuda de teclas
+    const int maxText = std::max(0, w - 4);
+    if (history.empty()) {
+        wattron(win, COLOR_PAIR(4));
+        mvwaddnstr(win, 1, 2, "[ Sin tramas en el historial ]", maxText);
+        wattroff(win, COLOR_PAIR(4));
+    } else if (rows > 0) {
+        // Ventana centrada en la selección, pegada a los extremos del historial.
+        const std::uint64_t half = static_cast<std::uint64_t>(rows / 2);
+        const std::uint64_t lastFirst = history.endSeq() > history.firstSeq() + rows
+                                      ? history.endSeq() - rows : history.firstSeq();
+        const std::uint64_t first = std::min(std::max(selected > half ? selected - half : 0, history.firstSeq()),
+                                             lastFirst);
+        char prefix[64];
+        for (int row = 0; row < rows && first + row < history.endSeq(); ++row) {
+            HistoryFrame entry;
+            if (!history.get(first + row, entry)) break;
+            FrameDescriptor info;
+            const bool decoded = dissectFrame(entry.data, entry.size, info);
+            const bool rx = entry.direction == FrameDirection::Rx;
+            std::snprintf(prefix, sizeof(prefix), "%c%8llu %10.3fs %s %5zuB  ", entry.seq == selected ? '>' : ' ',
+                          static_cast<unsigned long long>(entry.seq),
+                          static_cast<double>(entry.timestampNs - epochNs) / 1e9, rx ? "RX" : "TX", entry.size);
+            const std::string line = prefix + (decoded ? describeFrame(info) : std::string("(no decodifica)"));
+            const attr_t attr = COLOR_PAIR(rx ? 1 : 2) | (entry.seq == selected ? A_REVERSE : A_NORMAL);
+            wattron(win, attr);
+            mvwaddnstr(win, 1 + row, 2, line.c_str(), maxText);
+            wattroff(win, attr);
+        }
+    }
+    mvwaddnstr(win, h - 2, 2, "[Flechas/RePag/AvPag/Inicio/Fin] Mover  [x] Guardar como custom  [h] Cerrar", maxText);
+    wnoutrefresh(win);
+}
+
+// Pide una línea de texto en la ventana del footer (bloqueante mientras se escribe).
+bool promptLine(WINDOW* win, const std::string& label, std::string& out) {
+    int h, w;
+    getmaxyx(win, h, w);
+    (void)h;
+    werase(win);
+    box(win, 0, 0);
+    wattron(win, COLOR_PAIR(4));
+    mvwaddnstr(win, 1, 2, label.c_str(), w - 4);
+    wattroff(win, COLOR_PAIR(4));
+    mvwaddnstr(win, 2, 2, "> ", w - 4);
     wrefresh(win);
+
+    echo();
+    curs_set(1);
+    char buffer[256] = {};
+    const int rc = mvwgetnstr(win, 2, 4, buffer, std::min<int>(sizeof(buffer) - 1, std::max(1, w - 6)));
+    noecho();
+    curs_set(0);
+    if (rc == ERR) return false;
+    out = buffer;
+    return true;
 }
 
-void drawSendMenu(WINDOW* win, bool customLoaded, std::size_t customSize) {
+void drawSendMenu(WINDOW* win, bool customLoaded, std::size_t customSize,
+                  const PacketLibrary& library, std::size_t libIndex) {
     int h, w;
     getmaxyx(win, h, w);
     (void)h;
@@ -140,8 +259,20 @@ void drawSendMenu(WINDOW* win, bool customLoaded, std::size_t customSize) {
     } else {
         mvwaddnstr(win, 4, 2, "Custom: NO cargado (usa [r] Recargar)", w - 4);
     }
-    mvwaddnstr(win, 6, 2, "[m] Cerrar", w - 4);
-    wrefresh(win);
+    mvwaddnstr(win, 5, 2, "[l] Biblioteca  [,/.] Elegir", w - 4);
+    if (library.size() > 0) {
+        const PacketView view = library.frame(libIndex);
+        std::string libLine = "#" + std::to_string(libIndex + 1) + "/" + std::to_string(library.size()) + " ";
+        if (!view.name.empty()) libLine.append(view.name.data(), view.name.size()).append(" ");
+        libLine += "(" + std::to_string(view.size) + "B)";
+        mvwaddnstr(win, 6, 2, libLine.c_str(), w - 4);
+    } else if (library.isOpen()) {
+        mvwaddnstr(win, 6, 2, "Biblioteca: vacia", w - 4);
+    } else {
+        mvwaddnstr(win, 6, 2, "Biblioteca: NO cargada", w - 4);
+    }
+    mvwaddnstr(win, 8, 2, "[m] Cerrar", w - 4);
+    wnoutrefresh(win);
 }
 
 void drawReceiveMenu(WINDOW* win) {
@@ -158,7 +289,7 @@ void drawReceiveMenu(WINDOW* win) {
     mvwaddnstr(win, 1, 2, "[t] Demo RX (Ethernet Demo)", w - 4);
     mvwaddnstr(win, 2, 2, "[p] Demo RX (ARP who-has)", w - 4);
     mvwaddnstr(win, 4, 2, "[n] Cerrar", w - 4);
-    wrefresh(win);
+    wnoutrefresh(win);
 }
 
 void drawScrollBar(WINDOW* win, int totalLines, int maxLines, int scrollOffset) {
@@ -188,125 +319,64 @@ void drawScrollBar(WINDOW* win, int totalLines, int maxLines, int scrollOffset)
     mvwaddch(win, knobPos, w - 2, ACS_DIAMOND);
 }
 
-struct WrappedLine {
-    std::string text;
-    int colorPair = 0;
-    bool isArp = false;
-};
-
-std::vector<std::string> wrapText(const std::string& text, int width) {
-    std::vector<std::string> lines;
-    if (width <= 0) return lines;
-
-    std::size_t pos = 0;
-    while (pos < text.size()) {
-        while (pos < text.size() && text[pos] == ' ') {
-            ++pos;
-        }
-        if (pos >= text.size()) break;
-
-        std::size_t lineStart = pos;
-        std::size_t lineEnd = pos;
-        std::size_t lastSpace = std::string::npos;
-        int remaining = width;
-
-        while (lineEnd < text.size() && remaining > 0) {
-            if (text[lineEnd] == ' ') {
-                lastSpace = lineEnd;
-            }
-            ++lineEnd;
-            --remaining;
-        }
-
-        if (lineEnd >= text.size()) {
-            lines.push_back(text.substr(lineStart));
-            break;
-        }
-
-        if (lastSpace != std::string::npos && lastSpace > lineStart) {
-            lines.push_back(text.substr(lineStart, lastSpace - lineStart));
-            pos = lastSpace + 1;
-        } else {
-            lines.push_back(text.substr(lineStart, width));
-            pos = lineStart + width;
-        }
+int logTagColor(LogTag tag) {
+    switch (tag) {
+    case LogTag::Rx: return 1;
+    case LogTag::Tx: return 2;
+    case LogTag::Info: return 3;
+    case LogTag::Warn: return 4;
+    case LogTag::None: break;
     }
-
-    return lines;
+    return 5;
 }
 
-std::vector<WrappedLine> buildWrappedLog(const LogBuffer& log, int maxWidth) {
-    std::vector<WrappedLine> out;
-    for (const auto& line : log.lines) {
-        const bool isArp = line.find("ARP") != std::string::npos;
-        std::string tag;
-        int tagColor = 0;
-        if (line.rfind("[RX]", 0) == 0) { tag = "[RX]"; tagColor = 1; }
-        else if (line.rfind("[TX]", 0) == 0) { tag = "[TX]"; tagColor = 2; }
-        else if (line.rfind("[INFO]", 0) == 0) { tag = "[INFO]"; tagColor = 3; }
-        else if (line.rfind("[WARN]", 0) == 0) { tag = "[WARN]"; tagColor = 4; }
-
-        int colorPair = (tagColor > 0) ? tagColor : 5;
-        std::string body = line;
-        std::string prefix;
-        if (!tag.empty()) {
-            body = line.substr(tag.size());
-            if (!body.empty() && body[0] == ' ') body.erase(0, 1);
-            prefix = tag + " ";
-        }
-
-        const int prefixLen = static_cast<int>(prefix.size());
-        const int bodyWidth = std::max(0, maxWidth - prefixLen);
-        auto wrapped = wrapText(body, bodyWidth);
-        if (wrapped.empty()) wrapped.push_back(" ");
-
-        for (std::size_t i = 0; i < wrapped.size(); ++i) {
-            std::string lineText;
-            if (!prefix.empty()) {
-                if (i == 0) {
-                    lineText = prefix + wrapped[i];
-                } else {
-                    lineText = std::string(prefixLen, ' ') + wrapped[i];
-                }
-            } else {
-                lineText = wrapped[i];
-            }
-            out.push_back({lineText, colorPair, isArp});
-        }
-    }
-    return out;
-}
-
-void drawLog(WINDOW* win, const LogBuffer& log, int scrollOffset) {
+// Solo pide al LogRing las filas visibles; el wrap ya está cacheado por línea.
+void drawLog(WINDOW* win, LogRing& log, int& scrollOffset, std::vector<LogRow>& rows) {
     werase(win);
     box(win, 0, 0);
     int h, w;
     getmaxyx(win, h, w);
     const int maxLines = h - 2;
     const int maxWidth = std::max(0, w - 4);
-    auto wrapped = buildWrappedLog(log, maxWidth);
-    int start = 0;
-    const int total = static_cast<int>(wrapped.size());
-    const int maxStart = (total > maxLines) ? (total - maxLines) : 0;
-    if (scrollOffset > maxStart) scrollOffset = maxStart;
+    const std::uint64_t total = log.totalRows(maxWidth);
+    const std::uint64_t maxStart = (total > static_cast<std::uint64_t>(std::max(0, maxLines)))
+                                       ? total - static_cast<std::uint64_t>(maxLines) : 0;
+    const int maxOffset = static_cast<int>(std::min<std::uint64_t>(maxStart, INT_MAX));
+    if (scrollOffset > maxOffset) scrollOffset = maxOffset;
     if (scrollOffset < 0) scrollOffset = 0;
-    start = maxStart - scrollOffset;
-    for (int i = 0; i < maxLines && (start + i) < total; ++i) {
-        const auto& line = wrapped[start + i];
-        if (line.isArp) {
+    log.rows(maxWidth, maxStart - static_cast<std::uint64_t>(scrollOffset), static_cast<std::size_t>(std::max(0, maxLines)), rows);
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        const LogRow& row = rows[i];
+        const int y = 1 + static_cast<int>(i);
+        if (row.isArp) {
             wattron(win, COLOR_PAIR(7));
-            mvwaddch(win, 1 + i, 1, ACS_CKBOARD);
+            mvwaddch(win, y, 1, ACS_CKBOARD);
             wattroff(win, COLOR_PAIR(7));
         } else {
-            mvwaddch(win, 1 + i, 1, ' ');
+            mvwaddch(win, y, 1, ' ');
         }
-        wmove(win, 1 + i, 2);
-        if (line.colorPair > 0) wattron(win, COLOR_PAIR(line.colorPair));
-        mvwaddnstr(win, 1 + i, 2, line.text.c_str(), maxWidth);
-        if (line.colorPair > 0) wattroff(win, COLOR_PAIR(line.colorPair));
+        const int colorPair = logTagColor(row.tag);
+        wattron(win, COLOR_PAIR(colorPair));
+        wmove(win, y, 2);
+        int room = maxWidth;
+        if (row.tag != LogTag::None) {
+            const char* tag = logTagText(row.tag);
+            const int tagLen = static_cast<int>(std::strlen(tag)) + 1;
+            if (row.firstRow) {
+                waddnstr(win, tag, room);
+                if (room > tagLen - 1) waddch(win, ' ');
+            } else {
+                wmove(win, y, 2 + std::min(tagLen, room));
+            }
+            room = std::max(0, room - tagLen);
+        }
+        if (room > 0 && !row.text.empty()) {
+            waddnstr(win, row.text.data(), std::min<int>(room, static_cast<int>(row.text.size())));
+        }
+        wattroff(win, COLOR_PAIR(colorPair));
     }
-    drawScrollBar(win, total, maxLines, scrollOffset);
-    wrefresh(win);
+    drawScrollBar(win, static_cast<int>(std::min<std::uint64_t>(total, INT_MAX)), maxLines, scrollOffset);
+    wnoutrefresh(win);
 }
 
 std::string txResult(int sent) {
@@ -316,190 +386,195 @@ std::string txResult(int sent) {
     return "TX ERROR";
 }
 
-std::string etherTypeLabel(std::uint16_t etherType) {
-    switch (etherType) {
-        case EtherType::IPv4: return "IPv4";
-        case EtherType::ARP: return "ARP";
-        case EtherType::IPv6: return "IPv6";
-        case EtherType::Demo: return "DEMO";
-        default: return "OTRO";
+// Capas con su offset en la trama: "Ethernet@0 > IPv4@14 > TCP@34 | datos@54 (12B)".
+std::string layerOffsets(const FrameDescriptor& info) {
+    std::string text;
+    for (std::size_t i = 0; i < info.layerCount; ++i) {
+        if (i) text += " > ";
+        text += std::string(layerName(info.layers[i].id)) + "@" + std::to_string(info.layers[i].offset);
     }
+    return text + " | datos@" + std::to_string(info.payloadOffset) + " (" + std::to_string(info.payloadSize) + "B)";
 }
 
-void drawLastTxPanel(WINDOW* win, const std::optional<EthernetFrame>& lastTxFrame) {
-    werase(win);
-    box(win, 0, 0);
-    mvwprintw(win, 0, 2, " Ultimo TX Enviado ");
-    
-    if (!lastTxFrame) {
-        wattron(win, COLOR_PAIR(4));
-        mvwprintw(win, 2, 2, "[ Sin paquetes TX ]");
-        wattroff(win, COLOR_PAIR(4));
-        wrefresh(win);
-        return;
+// Trama que muestra un panel: su entrada del historial y, si la hay, su decodificación. Los bytes se leen
+// del historial al pintar el panel; solo las tramas que no están en él (RX simulado, envíos fallidos)
+// llevan copia propia.
+struct PanelFrame {
+    bool present = false;
+    bool inHistory = false;
+    std::uint64_t seq = 0;
+    bool dissected = false;           // false: se decodifica al cargar el panel
+    FrameDescriptor info{};
+    std::vector<std::uint8_t> bytes;  // Solo si !inHistory
+};
+
+// Apunta @p panel a la entrada @p seq del historial (sin ella, a una copia de @p data) y cambia @p version.
+// Una trama sin cabecera Ethernet completa no cambia el panel.
+void setPanelFrame(PanelFrame& panel, std::uint64_t& version, std::optional<std::uint64_t> seq,
+                   const std::uint8_t* data, std::size_t size, const FrameDescriptor* info) {
+    if (size < EthernetII::HeaderSize) return;
+    panel.present = true;
+    panel.inHistory = seq.has_value();
+    panel.seq = seq.value_or(0);
+    if (seq) {
+        panel.bytes.clear();
+    } else {
+        panel.bytes.assign(data, data + size);
     }
-    
-    int y = 1;
-    int h, w;
-    getmaxyx(win, h, w);
-    
-    // Información de cabecera
-    wattron(win, COLOR_PAIR(2));
-    mvwprintw(win, y++, 2, "Dst: %s", macToString(lastTxFrame->dst).c_str());
-    mvwprintw(win, y++, 2, "Src: %s", macToString(lastTxFrame->src).c_str());
-    mvwprintw(win, y++, 2, "Tipo: 0x%04X (%s)", lastTxFrame->etherType, etherTypeLabel(lastTxFrame->etherType).c_str());
-    wattroff(win, COLOR_PAIR(2));
-    y++;
-    
-    // Payload en hex + ASCII
-    const int payloadLabelY = y++;
-    mvwprintw(win, payloadLabelY, 2, "Payload (%zu bytes):", lastTxFrame->payload.size());
-    const auto& payload = lastTxFrame->payload;
-    // Calculate dynamic bytes per line: Width = 11 + 4*N
-    int bytesPerLine = (w - 11) / 4;
-    if (bytesPerLine < 1) bytesPerLine = 1;
-    if (bytesPerLine > 16) bytesPerLine = 16;
-
-    const int maxLines = std::max(0, h - y - 1); // Espacio disponible (hasta la línea antes del borde)
-    if (maxLines == 0 && !payload.empty()) {
-        const std::string prefix = "Payload (" + std::to_string(payload.size()) + " bytes): ";
-        const int maxText = std::max(0, w - 4);
-        const int available = std::max(0, maxText - static_cast<int>(prefix.size()));
-        const int maxBytes = std::max(0, (available + 1) / 3);
-        const std::string hex = toHex(payload, static_cast<std::size_t>(maxBytes));
-        const std::string line = prefix + hex;
-        mvwaddnstr(win, payloadLabelY, 2, line.c_str(), maxText);
+    panel.dissected = info != nullptr;
+    if (info) panel.info = *info;
+    ++version;
+}
+
+// Bytes de la trama de @p panel; false si no tiene o si ya salió del historial.
+bool panelFrameBytes(const PanelFrame& panel, const FrameHistory& history, const std::uint8_t*& data,
+                     std::size_t& size) {
+    if (!panel.present) return false;
+    if (!panel.inHistory) {
+        data = panel.bytes.data();
+        size = panel.bytes.size();
+        return true;
     }
-    int linesDrawn = 0;
-    
-    for (std::size_t i = 0; i < payload.size() && linesDrawn < maxLines; i += bytesPerLine) {
-        // Offset
-        wattron(win, COLOR_PAIR(2));
-        mvwprintw(win, y, 2, "%04zX", i);
-        wattroff(win, COLOR_PAIR(2));
-        
-        // Hex bytes
-        int x = 7;
-        for (std::size_t j = 0; j < static_cast<std::size_t>(bytesPerLine) && (i + j) < payload.size(); ++j) {
-            wattron(win, COLOR_PAIR(2));
-            mvwprintw(win, y, x, "%02X", payload[i + j]);
-            wattroff(win, COLOR_PAIR(2));
-            x += 3;
-        }
-        
-        // Parte ASCII
-        x = 7 + bytesPerLine * 3 + 2;
-        if (x + bytesPerLine <= w - 2) {
-            wattron(win, COLOR_PAIR(3));
-            for (std::size_t j = 0; j < static_cast<std::size_t>(bytesPerLine) && (i + j) < payload.size(); ++j) {
-                std::uint8_t byte = payload[i + j];
-                char ch = (byte >= 32 && byte <= 126) ? static_cast<char>(byte) : '.';
-                mvwaddch(win, y, x + j, ch);
-            }
-            wattroff(win, COLOR_PAIR(3));
-        }
-        
-        y++;
-        linesDrawn++;
+    HistoryFrame entry;
+    if (!history.get(panel.seq, entry)) return false;
+    data = entry.data;
+    size = entry.size;
+    return true;
+}
+
+// Panel de trama (TX/RX): cabecera y visor hex de la trama completa, rehechos solo cuando cambia la trama.
+struct FramePanelCache {
+    std::uint64_t version = ~std::uint64_t{0};
+    bool hasFrame = false;
+    bool evicted = false;             // La trama del panel ya no estaba en el historial al cargarla
+    std::vector<std::string> header;  // Dst, Src, Tipo, capas
+    HexView view;                     // Formatea solo las filas visibles y las guarda para esta trama
+};
+
+// @p info: decodificación de la trama, o nullptr para hacerla aquí (TX no pasa por el dissector al enviarse).
+void loadFramePanel(FramePanelCache& cache, const std::uint8_t* data, std::size_t size, const FrameDescriptor* info) {
+    FrameDescriptor decoded;
+    if (!info) {
+        dissectFrame(data, size, decoded);
+        info = &decoded;
     }
-    
-    // Indicador si hay más datos
-    if (maxLines > 0 && payload.size() > static_cast<std::size_t>(maxLines * bytesPerLine)) {
-        wattron(win, COLOR_PAIR(4));
-        mvwprintw(win, y, 2, "... (%zu bytes mas)", 
-                 payload.size() - (maxLines * bytesPerLine));
-        wattroff(win, COLOR_PAIR(4));
+    MacAddress dst, src;
+    std::copy_n(data, 6, dst.begin());
+    std::copy_n(data + 6, 6, src.begin());
+    char type[16];
+    std::snprintf(type, sizeof(type), "0x%02X%02X", data[12], data[13]);
+    cache.header.clear();
+    cache.header.push_back("Dst: " + macToString(dst));
+    cache.header.push_back("Src: " + macToString(src));
+    cache.header.push_back(std::string("Tipo: ") + type + " (" + frameProtocolLabel(*info) + ")");
+    cache.header.push_back(layerOffsets(*info));
+    // La única copia de la trama es la del visor; sus offsets son los del dissector.
+    cache.view.setFrame(data, size, info);
+}
+
+int hexStyleAttr(HexStyle style) {
+    switch (style) {
+    case HexStyle::Link: return COLOR_PAIR(6);
+    case HexStyle::Tag: return COLOR_PAIR(7);
+    case HexStyle::Network: return COLOR_PAIR(1);
+    case HexStyle::Transport: return COLOR_PAIR(3);
+    case HexStyle::Payload: return COLOR_PAIR(5);
+    case HexStyle::Match: return COLOR_PAIR(4) | A_REVERSE;
+    case HexStyle::Plain: break;
     }
-    
-    wrefresh(win);
+    return A_NORMAL;
 }
 
-void drawLastRxPanel(WINDOW* win, const std::optional<EthernetFrame>& lastRxFrame) {
+// Panel con la última trama TX o RX. @p version cambia con cada trama nueva; con @p focused el panel
+// se queda con la trama que tenía (se puede recorrer, buscar y saltar a un offset sin que la cambie el tráfico).
+void drawFramePanel(WINDOW* win, const char* title, const char* emptyText, int colorPair,
+                    const PanelFrame& frame, const FrameHistory& history,
+                    std::uint64_t version, FramePanelCache& cache, bool focused) {
+    if (!focused && cache.version != version) {
+        // Aquí, y no al recibirla, se leen los bytes de la trama y se copian al visor.
+        cache.version = version;
+        const std::uint8_t* data = nullptr;
+        std::size_t size = 0;
+        const bool found = panelFrameBytes(frame, history, data, size);
+        cache.evicted = frame.present && !found;
+        cache.hasFrame = found && size >= EthernetII::HeaderSize;
+        if (cache.hasFrame) loadFramePanel(cache, data, size, frame.dissected ? &frame.info : nullptr);
+    }
+
+    int h, w;
+    getmaxyx(win, h, w);
     werase(win);
+    if (focused) wattron(win, COLOR_PAIR(4) | A_BOLD);
     box(win, 0, 0);
-    mvwprintw(win, 0, 2, " Ultimo RX Capturado ");
-    
-    if (!lastRxFrame) {
+    mvwaddstr(win, 0, 2, title);
+    if (focused) {
+        mvwaddnstr(win, h - 1, 2, " [Flechas] [/]Buscar [j]Offset [w]Soltar ", std::max(0, w - 4));
+        wattroff(win, COLOR_PAIR(4) | A_BOLD);
+    }
+
+    if (!cache.hasFrame) {
         wattron(win, COLOR_PAIR(4));
-        mvwprintw(win, 2, 2, "[ Sin paquetes RX ]");
+        mvwaddstr(win, 2, 2, cache.evicted ? "[ La trama ya salio del historial ]" : emptyText);
         wattroff(win, COLOR_PAIR(4));
-        wrefresh(win);
+        wnoutrefresh(win);
         return;
     }
-    
+    const int maxText = std::max(0, w - 4);
+
     int y = 1;
-    int h, w;
-    getmaxyx(win, h, w);
-    
-    // Información de cabecera
-    wattron(win, COLOR_PAIR(1));
-    mvwprintw(win, y++, 2, "Dst: %s", macToString(lastRxFrame->dst).c_str());
-    mvwprintw(win, y++, 2, "Src: %s", macToString(lastRxFrame->src).c_str());
-    mvwprintw(win, y++, 2, "Tipo: 0x%04X (%s)", lastRxFrame->etherType, etherTypeLabel(lastRxFrame->etherType).c_str());
-    wattroff(win, COLOR_PAIR(1));
+    wattron(win, COLOR_PAIR(colorPair));
+    for (const auto& line : cache.header) mvwaddnstr(win, y++, 2, line.c_str(), maxText);
+    wattroff(win, COLOR_PAIR(colorPair));
+
+    // Leyenda de colores por capa
+    int x = 2;
+    for (const auto& [name, style] : {std::pair<const char*, HexStyle>{"Eth", HexStyle::Link}, {"VLAN", HexStyle::Tag},
+                                      {"L3", HexStyle::Network}, {"L4", HexStyle::Transport},
+                                      {"Datos", HexStyle::Payload}}) {
+        if (x + static_cast<int>(std::strlen(name)) > w - 2) break;
+        wattron(win, hexStyleAttr(style));
+        mvwaddstr(win, y, x, name);
+        wattroff(win, hexStyleAttr(style));
+        x += static_cast<int>(std::strlen(name)) + 1;
+    }
     y++;
-    
-    // Payload en hex + ASCII
-    const int payloadLabelY = y++;
-    mvwprintw(win, payloadLabelY, 2, "Payload (%zu bytes):", lastRxFrame->payload.size());
-    const auto& payload = lastRxFrame->payload;
+
     // Calculate dynamic bytes per line: Width = 11 + 4*N
-    int bytesPerLine = (w - 11) / 4;
-    if (bytesPerLine < 1) bytesPerLine = 1;
-    if (bytesPerLine > 16) bytesPerLine = 16;
-    
-    const int maxLines = std::max(0, h - y - 1); // Espacio disponible (hasta la línea antes del borde)
-    if (maxLines == 0 && !payload.empty()) {
-        const std::string prefix = "Payload (" + std::to_string(payload.size()) + " bytes): ";
-        const int maxText = std::max(0, w - 4);
-        const int available = std::max(0, maxText - static_cast<int>(prefix.size()));
-        const int maxBytes = std::max(0, (available + 1) / 3);
-        const std::string hex = toHex(payload, static_cast<std::size_t>(maxBytes));
-        const std::string line = prefix + hex;
-        mvwaddnstr(win, payloadLabelY, 2, line.c_str(), maxText);
+    HexView& view = cache.view;
+    const int firstRowY = y + 1;
+    view.setGeometry(std::clamp((w - 11) / 4, 1, 16), std::max(1, h - firstRowY - 1));
+
+    std::string label = "Trama: " + std::to_string(view.originalSize()) + " bytes";
+    if (view.truncated()) label += " (se muestran " + std::to_string(view.size() >> 10) + " KB)";
+    if (view.rowCount() > static_cast<std::size_t>(view.visibleRows())) {
+        char range[48];
+        const std::size_t first = view.topRow() * static_cast<std::size_t>(view.bytesPerRow());
+        const std::size_t last = std::min(view.size(), first + static_cast<std::size_t>(view.visibleRows() * view.bytesPerRow()));
+        std::snprintf(range, sizeof(range), " | 0x%04zX-0x%04zX", first, last - 1);
+        label += range;
     }
-    int linesDrawn = 0;
-    
-    for (std::size_t i = 0; i < payload.size() && linesDrawn < maxLines; i += bytesPerLine) {
-        // Offset
-        wattron(win, COLOR_PAIR(1));
-        mvwprintw(win, y, 2, "%04zX", i);
-        wattroff(win, COLOR_PAIR(1));
-        
-        // Hex bytes
-        int x = 7;
-        for (std::size_t j = 0; j < static_cast<std::size_t>(bytesPerLine) && (i + j) < payload.size(); ++j) {
-            wattron(win, COLOR_PAIR(1));
-            mvwprintw(win, y, x, "%02X", payload[i + j]);
-            wattroff(win, COLOR_PAIR(1));
-            x += 3;
-        }
-        
-        // Parte ASCII
-        x = 7 + bytesPerLine * 3 + 2;
-        if (x + bytesPerLine <= w - 2) {
-            wattron(win, COLOR_PAIR(3));
-            for (std::size_t j = 0; j < static_cast<std::size_t>(bytesPerLine) && (i + j) < payload.size(); ++j) {
-                std::uint8_t byte = payload[i + j];
-                char ch = (byte >= 32 && byte <= 126) ? static_cast<char>(byte) : '.';
-                mvwaddch(win, y, x + j, ch);
-            }
-            wattroff(win, COLOR_PAIR(3));
-        }
-        
-        y++;
-        linesDrawn++;
+    if (view.hasMatch()) {
+        char match[32];
+        std::snprintf(match, sizeof(match), " | hallado en 0x%04zX", view.matchOffset());
+        label += match;
     }
-    
-    // Indicador si hay más datos
-    if (maxLines > 0 && payload.size() > static_cast<std::size_t>(maxLines * bytesPerLine)) {
-        wattron(win, COLOR_PAIR(4));
-        mvwprintw(win, y, 2, "... (%zu bytes mas)", 
-                 payload.size() - (maxLines * bytesPerLine));
-        wattroff(win, COLOR_PAIR(4));
+    mvwaddnstr(win, y++, 2, label.c_str(), maxText);
+
+    const int maxRowText = std::max(0, w - 3);
+    for (std::size_t r = view.topRow(); r < view.rowCount() && y < h - 1; ++r, ++y) {
+        const HexRow& row = view.row(r);
+        mvwaddnstr(win, y, 2, row.text.c_str(), maxRowText);
+        for (const HexSegment& segment : row.segments) {
+            if (segment.column >= maxRowText) continue;
+            const int attr = hexStyleAttr(segment.style);
+            wattron(win, attr);
+            mvwaddnstr(win, y, 2 + segment.column, row.text.c_str() + segment.column,
+                       std::min<int>(segment.length, maxRowText - segment.column));
+            wattroff(win, attr);
+        }
     }
-    
-    wrefresh(win);
+
+    wnoutrefresh(win);
 }
 
 // drawFrameBreakdown removed - unused function
@@ -620,7 +695,30 @@ void drawInfo(WINDOW* win, int infoPage, int tick, int lastTxTick, int lastRxTic
         mvwprintw(win, 12, 2, "  42 = 'B' en ASCII, util para patrones visibles");
         mvwprintw(win, h - 2, 2, "Controles: [i] Info  [-] Anterior  [+] Siguiente");
     }
-    wrefresh(win);
+    wnoutrefresh(win);
+}
+
+// Página de estadísticas de tráfico (después de las cuatro de drawInfo).
+constexpr int kTrafficStatsPage = 4;
+constexpr int kInfoPages = 5;
+
+void drawTrafficStats(WINDOW* win, const std::vector<std::string>& lines) {
+    int h, w;
+    getmaxyx(win, h, w);
+    werase(win);
+    box(win, 0, 0);
+    mvwaddnstr(win, 1, 2, "Info - Estadisticas de trafico (5/5)", w - 4);
+    int y = 3;
+    for (const std::string& line : lines) {
+        if (y >= h - 2) break;
+        // Títulos de sección (sin sangría) resaltados.
+        const bool title = !line.empty() && line[0] != ' ';
+        if (title) wattron(win, COLOR_PAIR(6));
+        mvwaddnstr(win, y++, 2, line.c_str(), w - 4);
+        if (title) wattroff(win, COLOR_PAIR(6));
+    }
+    mvwaddnstr(win, h - 2, 2, "Controles: [i] Info  [-] Anterior  [+] Siguiente", w - 4);
+    wnoutrefresh(win);
 }
 } // namespace
 
@@ -683,9 +781,60 @@ int runTuiApp(TapDevice& tap) {
     WINDOW* sendMenuWin = nullptr;
     WINDOW* recvMenuWin = nullptr;
 
-    LogBuffer log;
+    // Log: las últimas líneas en RAM con el wrap cacheado; las anteriores pasan a un
+    // fichero mapeado en el directorio temporal. NETGUI_LOG_LINES fija el total.
+    LogRing log;
+    std::vector<LogRow> logRows;
+    {
+        const char* env = std::getenv("NETGUI_LOG_LINES");
+        const unsigned long long wanted = env && env[0] != '\0' ? std::strtoull(env, nullptr, 10) : 1000000ULL;
+        std::error_code tmpEc;
+        std::filesystem::path spillDir = std::filesystem::temp_directory_path(tmpEc);
+        if (tmpEc) spillDir = "/tmp";
+        std::string spillError;
+        if (!log.enableSpill(static_cast<std::size_t>(wanted), spillDir, spillError)) {
+            log.push("[WARN] Log sin volcado a disco (solo RAM): " + spillError);
+        } else if (log.spilling()) {
+            log.push("[INFO] Log: " + std::to_string(log.capacity()) + " líneas (volcado mapeado en " +
+                     spillDir.string() + ")");
+        }
+    }
+    // Historial de tramas RX/TX en un arena fijo: NETGUI_HISTORY_FRAMES tramas y NETGUI_HISTORY_MB megas como máximo.
+    std::size_t historyFrames = 4096;
+    std::size_t historyMegabytes = 8;
+    {
+        const char* env = std::getenv("NETGUI_HISTORY_FRAMES");
+        if (env && env[0] != '\0' && std::strtoull(env, nullptr, 10) > 0) historyFrames = std::strtoull(env, nullptr, 10);
+        env = std::getenv("NETGUI_HISTORY_MB");
+        if (env && env[0] != '\0' && std::strtoull(env, nullptr, 10) > 0) historyMegabytes = std::strtoull(env, nullptr, 10);
+    }
+    FrameHistory history(historyFrames, historyMegabytes << 20);
+    const std::int64_t historyEpochNs =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
     std::string status = "Inicializando";
 
+    // Pintado: solo las regiones que cambiaron y como mucho NETGUI_FPS veces por segundo,
+    // aparte del bucle de paquetes (que sigue despertando cada 10ms o con cada trama).
+    RenderScheduler render;
+    {
+        const char* env = std::getenv("NETGUI_FPS");
+        if (env && env[0] != '\0') render.setFps(static_cast<unsigned>(std::strtoul(env, nullptr, 10)));
+    }
+    // Versiones de lo que pinta cada región: si no cambian, la región no se redibuja.
+    std::uint64_t txFrameVersion = 0;
+    std::uint64_t rxFrameVersion = 0;
+    FramePanelCache txPanelCache;
+    FramePanelCache rxPanelCache;
+    // Entrada del historial seleccionada: se muestra en el panel RX mientras la vista está abierta.
+    std::uint64_t historySelected = 0;
+    PanelFrame historyPanel;
+    std::uint64_t historyVersion = 0;
+    FramePanelCache historyPanelCache;
+    // [w] pasa las flechas del log a un panel de trama (que deja de seguir al tráfico) para recorrer su hex.
+    enum class PanelFocus { Log, Rx, Tx };
+    PanelFocus focus = PanelFocus::Log;
+    std::vector<std::uint8_t> lastSearch;
+
     std::error_code ec;
     std::filesystem::path basePath = std::filesystem::current_path(ec);
     if (ec) basePath = ".";
@@ -713,6 +862,58 @@ int runTuiApp(TapDevice& tap) {
     } else {
         status = "Custom NO cargado (revise " + packetFile.string() + ")";
     }
+    // Recarga al guardar (desde el editor de [e] o cualquier otro programa).
+    FileWatcher customWatch;
+    {
+        std::string watchError;
+        if (!customWatch.watch(packetFile, watchError)) {
+            log.push("[WARN] [CUSTOM] Sin recarga automática: " + watchError);
+        }
+    }
+    // Sustituye customPacket de una vez y solo si el fichero guardado es válido: el TX nunca ve uno a medias.
+    auto hotReloadCustom = [&]() {
+        auto fresh = loadCustomPacket(packetFile);
+        if (!fresh) {
+            status = "Custom inválido (se mantiene el anterior)";
+            log.push("[WARN] [CUSTOM] Guardado con errores, se mantiene el anterior (" + packetFile.string() + ")");
+            return;
+        }
+        if (customPacket && *fresh == *customPacket) return;
+        customPacket = std::move(fresh);
+        status = "Custom recargado: " + std::to_string(customPacket->size()) + " bytes";
+        log.push("[INFO] [CUSTOM] Recargado al guardar (" + std::to_string(customPacket->size()) + " bytes)");
+    };
+    // Editor de [e] en un proceso hijo: mientras está abierto la TUI no pinta ni lee teclas, pero el
+    // bucle sigue atendiendo el TAP.
+    pid_t editorPid = -1;
+
+    // Biblioteca de tramas junto a custom_packet.hex; se compila a .bin y se mapea.
+    const std::filesystem::path libraryFile = packetFile.parent_path() / "packets.hexlib";
+    PacketLibrary library;
+    std::size_t libIndex = 0;
+    std::string libraryError;
+    auto reportLibrary = [&](bool ok) {
+        if (ok) {
+            libraryError.clear();
+            if (library.compiledOnLastLoad()) {
+                log.push("[INFO] [LIB] " + std::to_string(library.size()) + " tramas compiladas (" +
+                         library.compiledPath().string() + ")");
+            }
+        } else if (msg != libraryError) {
+            // Solo una vez por error: refresh() reintenta mientras el fuente siga roto.
+            libraryError = msg;
+            log.push("[WARN] [LIB] " + msg);
+        }
+        if (libIndex >= library.size()) libIndex = 0;
+    };
+    if (std::filesystem::exists(libraryFile)) {
+        const bool ok = library.open(libraryFile, msg);
+        if (ok && !library.compiledOnLastLoad()) {
+            log.push("[INFO] [LIB] " + std::to_string(library.size()) + " tramas (cache " +
+                     library.compiledPath().string() + ")");
+        }
+        reportLibrary(ok);
+    }
 
     std::vector<uint8_t> rxBuffer(2048);
 
@@ -732,105 +933,491 @@ int runTuiApp(TapDevice& tap) {
 
     std::unordered_map<std::uint32_t, ArpEntry> arpTable;
 
+    // Estadísticas de tráfico (mezcla de protocolos, top MAC/IP, ventanas por segundo) en memoria fija.
+    TrafficStats trafficStats;
+    std::vector<std::string> statsLines;
+    int statsLinesTick = -100000;
+    // Latencia por etapa (read -> dissect -> handler -> write), histogramas por hilo sin locks.
+    PipelineLatency pipeline;
+    std::uint64_t rxStartTicks = 0;  // tap.read de la trama en curso (0 fuera del RX)
+    LatencyHistogram arpResolution;  // [d] who-has -> primera respuesta de esa IP
+
+    // Métricas Prometheus: contadores de un solo escritor (este hilo) que el servidor lee sin locks.
+    MetricsRegistry metrics;
+    MetricCounter& rxFramesMetric = metrics.counter("netgui_frames_total", "Tramas leídas/escritas en el TAP", "direction=\"rx\"");
+    MetricCounter& txFramesMetric = metrics.counter("netgui_frames_total", "Tramas leídas/escritas en el TAP", "direction=\"tx\"");
+    MetricCounter& rxBytesMetric = metrics.counter("netgui_bytes_total", "Bytes leídos/escritos en el TAP", "direction=\"rx\"");
+    MetricCounter& txBytesMetric = metrics.counter("netgui_bytes_total", "Bytes leídos/escritos en el TAP", "direction=\"tx\"");
+    MetricCounter& macDropMetric = metrics.counter("netgui_dropped_frames_total", "Tramas descartadas en espacio de usuario",
+                                                   "stage=\"mac_filter\"");
+    MetricCounter& bpfDropMetric = metrics.counter("netgui_dropped_frames_total", "Tramas descartadas en espacio de usuario",
+                                                   "stage=\"bpf\"");
+    metrics.callback("netgui_tap_tx_dropped_total", "tx_dropped del TAP en sysfs (filtros MAC/BPF del kernel)",
+                     MetricType::Counter, [&tap] { return static_cast<double>(tap.droppedByKernel()); });
+    MetricCounter& readAgainMetric = metrics.counter("netgui_eagain_total", "Llamadas al TAP que devolvieron EAGAIN", "op=\"read\"");
+    MetricCounter& writeAgainMetric = metrics.counter("netgui_eagain_total", "Llamadas al TAP que devolvieron EAGAIN", "op=\"write\"");
+    MetricCounter& readErrorMetric = metrics.counter("netgui_io_errors_total", "Errores de E/S en el TAP (sin EAGAIN)", "op=\"read\"");
+    MetricCounter& writeErrorMetric = metrics.counter("netgui_io_errors_total", "Errores de E/S en el TAP (sin EAGAIN)", "op=\"write\"");
+    MetricGauge& arpEntriesMetric = metrics.gauge("netgui_arp_entries", "Entradas en la tabla ARP");
+    MetricGauge& ndpNeighborsMetric = metrics.gauge("netgui_ndp_neighbors", "Vecinos en la caché NDP");
+    MetricGauge& tcpConnectionsMetric = metrics.gauge("netgui_tcp_connections", "Conexiones TCP activas");
+    MetricGauge& flowsMetric = metrics.gauge("netgui_flows", "Flujos activos en la tabla de flujos");
+    MetricCounter& uiFramesMetric = metrics.counter("netgui_ui_frames_total", "Redibujados de la TUI (limitados por NETGUI_FPS)");
+    metrics.histogram("netgui_arp_resolution_seconds", "Tiempo desde el ARP request hasta la respuesta", arpResolution);
+    for (std::size_t i = 0; i < kPipelineStages; ++i) {
+        const auto stage = static_cast<PipelineStage>(i);
+        metrics.histogram("netgui_stage_latency_seconds", "Latencia por etapa del pipeline RX -> handler -> TX",
+                          pipeline[stage], std::string("stage=\"") + pipelineStageName(stage) + "\"");
+    }
+
+    // Entrada del historial de la última escritura (nullopt si no salió): el panel TX apunta a ella.
+    std::optional<std::uint64_t> lastTxSeq;
+    // Todo lo que sale por el TAP pasa por aquí para contarlo en las estadísticas.
+    auto txWrite = [&](const std::uint8_t* frame, std::size_t size) {
+        lastTxSeq.reset();
+        const std::uint64_t writeStart = LatencyClock::now();
+        const int sent = tap.write(frame, size);
+        const std::uint64_t writeEnd = LatencyClock::now();
+        pipeline.record(PipelineStage::Write, writeStart, writeEnd);
+        if (rxStartTicks != 0) {
+            pipeline.record(PipelineStage::RxToTx, rxStartTicks, writeEnd);
+        }
+        if (sent < 0) {
+            (errno == EAGAIN ? writeAgainMetric : writeErrorMetric).add();
+        }
+        if (sent > 0) {
+            txFramesMetric.add();
+            txBytesMetric.add(static_cast<std::uint64_t>(sent));
+            const std::uint64_t seq = history.endSeq();
+            if (history.push(FrameDirection::Tx, frame, size,
+                             std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::steady_clock::now().time_since_epoch()).count())) {
+                lastTxSeq = seq;
+            }
+            FrameDescriptor txInfo;
+            dissectFrame(frame, size, txInfo);
+            trafficStats.add(txInfo, TrafficDirection::Tx, std::chrono::steady_clock::now());
+        }
+        return sent;
+    };
+
+    // NETGUI_METRICS: "host:puerto" o "puerto" en loopback, "unix:/ruta", "off" para desactivar.
+    MetricsServer metricsServer(metrics);
+    {
+        const char* env = std::getenv("NETGUI_METRICS");
+        const std::string endpoint = env && env[0] != '\0' ? env : "127.0.0.1:9464";
+        std::string metricsError;
+        if (endpoint == "off") {
+            log.push("[INFO] Métricas Prometheus desactivadas (NETGUI_METRICS=off)");
+        } else if (metricsServer.start(endpoint, metricsError)) {
+            log.push("[INFO] Métricas Prometheus en " + endpoint + " (GET /metrics)");
+        } else {
+            log.push("[WARN] Métricas Prometheus no disponibles: " + metricsError);
+        }
+    }
+
+    // Capa IPv4: validación, demux por dirección local y reensamblado con memoria acotada.
+    Ipv4Layer ipv4;
+    ipv4.addLocalAddress(myIp);
+    ipv4.setSender([&](const std::uint8_t* frame, std::size_t size) { return txWrite(frame, size); });
+    ipv4.setLinkAddress(myMac);
+    ipv4.setNeighborResolver([&](const Ipv4Address& ip) -> std::optional<MacAddress> {
+        auto it = arpTable.find(ipToKey(ip));
+        if (it == arpTable.end() || !it->second.resolved) return std::nullopt;
+        return it->second.mac;
+    });
+
+    // Responde ICMP echo in-place y escribe directo al TAP (ping / ping -f).
+    IcmpEchoResponder icmpEcho(ipv4);
+
+    // IPv6 link-local (EUI-64) con NDP: NS/NA in-place y filtro de multicast solicited-node.
+    Ipv6Layer ipv6;
+    ipv6.setLinkAddress(myMac);
+    ipv6.addLocalAddress(ipv6LinkLocal(myMac));
+    ipv6.setSender([&](const std::uint8_t* frame, std::size_t size) { return txWrite(frame, size); });
+    Ndp ndp(ipv6);
+    log.push("[INFO] IPv6: " + ipv6ToString(ipv6LinkLocal(myMac)) + " (NDP, grupo " +
+             ipv6ToString(ipv6SolicitedNode(ipv6LinkLocal(myMac))) + ")");
+
+    // Filtro de MAC destino: nuestra MAC, broadcast y los grupos unidos (all-nodes, solicited-node,
+    // mDNS con [g]). Se programa en el kernel (TUNSETTXFILTER, hash imperfecto para multicast) y se
+    // vuelve a comprobar aquí con un conjunto exacto; [o] lo desactiva (modo promiscuo).
+    const Ipv6Address mdnsGroup6{0xff, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xfb};
+    const MacAddress mdnsMac4{0x01, 0x00, 0x5e, 0x00, 0x00, 0xfb};  // 224.0.0.251
+    MacFilter macFilter;
+    macFilter.addUnicast(myMac);
+    ipv6.setGroupListener([&](const Ipv6Address& group, bool joined) {
+        if (joined) {
+            macFilter.join(ipv6MulticastMac(group));
+        } else {
+            macFilter.leave(ipv6MulticastMac(group));
+        }
+    });
+    bool macFilterOn = true;
+    bool macFilterInKernel = false;
+    bool mdnsJoined = false;
+    std::uint64_t macFilterProgrammed = ~0ULL;  // generation() cargada en el kernel
+    std::uint64_t macDropBase = 0;              // tx_dropped al programarlo (compartido con BPF)
+    std::uint64_t macDroppedKernel = 0;
+    // Los cambios de grupo actualizan la tabla userspace al momento; el kernel, en la siguiente vuelta.
+    auto syncMacFilter = [&]() {
+        if (macFilter.generation() == macFilterProgrammed) {
+            return;
+        }
+        macFilterProgrammed = macFilter.generation();
+        if (!macFilterOn) {
+            tap.clearMacFilter();
+            macFilterInKernel = false;
+            return;
+        }
+        const auto addresses = macFilter.kernelAddresses();
+        const bool wasInKernel = macFilterInKernel;
+        macFilterInKernel = !addresses.empty() && tap.setMacFilter(addresses, macFilter.allMulticast());
+        if (macFilterInKernel && !wasInKernel) {
+            macDropBase = tap.droppedByKernel();
+            macDroppedKernel = 0;
+        }
+        if (macFilterInKernel) {
+            log.push("[INFO] [MAC] Filtro en el kernel: " + std::to_string(macFilter.unicastCount()) + " unicast, " +
+                     std::to_string(macFilter.groupCount()) + " grupos" +
+                     (macFilter.acceptsBroadcast() ? " + broadcast" : ""));
+        } else {
+            log.push("[WARN] [MAC] TUNSETTXFILTER falló (" + std::string(std::strerror(errno)) +
+                     "); se filtra solo en userspace");
+        }
+    };
+    syncMacFilter();
+
+    // Buffers compartidos RX/TX: TCP retiene los RX fuera de orden por referencia (sin copias).
+    PacketPool packetPool(1024);
+    TimerWheel timers;
+
+    // UDP con servicios de prueba (iperf -u / nc -u): echo(7), discard(9), chargen(19).
+    UdpLayer udp(ipv4, packetPool);
+    udp.enableServices();
+    log.push("[INFO] UDP: echo(7) discard(9) chargen(19) en " + ipv4ToString(myIp));
+
+    // TCP (nc / curl): echo(7), discard(9), chargen(19), http(80) -> GET /<bytes>.
+    TcpLayer tcp(ipv4, packetPool, timers);
+    tcp.enableServices();
+    log.push("[INFO] TCP: echo(7) discard(9) chargen(19) http(80) en " + ipv4ToString(myIp));
+
+    // Flujos por 5-tupla (par de MACs si no es IP): memoria fija, envejecimiento incremental.
+    FlowTable flows;
+    std::vector<std::string> flowLines;
+    int flowLinesTick = -100000;
+
+    // Filtro BPF clásico en el TAP: el kernel descarta lo rechazado antes de copiarlo.
+    // Si no se puede adjuntar, el mismo programa se ejecuta aquí sobre cada trama.
+    std::optional<BpfProgram> tapFilter;
+    bool filterInKernel = false;
+    std::uint64_t filterDropBase = 0;   // tx_dropped del TAP al adjuntar
+    std::uint64_t filterDropped = 0;    // Tramas descartadas por el filtro (aprox. en kernel)
+    std::uint64_t filterDroppedUser = 0;
+    auto applyFilter = [&](const std::string& expression) {
+        std::string error;
+        auto program = compileBpfFilter(expression, error);
+        if (!program) {
+            status = "Filtro inválido: " + error;
+            log.push("[WARN] [BPF] '" + expression + "': " + error);
+            return;
+        }
+        if (tapFilter && filterInKernel) {
+            tap.detachFilter();
+        }
+        filterDropped = 0;
+        filterDroppedUser = 0;
+        if (expression.find_first_not_of(" \t") == std::string::npos) {
+            tapFilter.reset();
+            filterInKernel = false;
+            status = "Filtro eliminado";
+            log.push("[INFO] [BPF] Sin filtro: se reciben todas las tramas");
+            return;
+        }
+        filterInKernel = tap.attachFilter(program->code.data(), program->code.size());
+        filterDropBase = filterInKernel ? tap.droppedByKernel() : 0;
+        const std::string size = std::to_string(program->code.size()) + " instr";
+        if (filterInKernel) {
+            log.push("[INFO] [BPF] '" + expression + "' en el kernel (" + size + ")");
+        } else {
+            log.push("[WARN] [BPF] TUNATTACHFILTER falló (" + std::string(std::strerror(errno)) +
+                     "); se filtra en userspace (" + size + ")");
+        }
+        tapFilter = std::move(program);
+        status = "Filtro: " + expression;
+    };
+
     bool running = true;
     bool showInfo = false;
     bool showArpTable = false;
+    bool showFlows = false;
     bool showReceiveMenu = false;
+    bool showHistory = false;
     int infoPage = 0;
     int scrollOffset = 0;
-    std::optional<EthernetFrame> lastRxFrame;
-    std::optional<EthernetFrame> lastTxFrame;
+    // Últimas tramas RX/TX de los paneles: referencias al historial, se copian solo al pintarlas.
+    PanelFrame rxPanel;
+    PanelFrame txPanel;
     bool showSendMenu = false;
     int tick = 0;
     int lastTxTick = -100000;
     int lastRxTick = -100000;
     std::string arpSummary = "-";
-    auto handleRxFrame = [&](const EthernetFrame& rxFrame, bool fromTap) {
-        lastRxFrame = rxFrame;
-        const std::string typeLabel = etherTypeLabel(rxFrame.etherType);
-        log.push("[RX] " + describeEthernetII(rxFrame) + " proto=" + typeLabel);
+    // Último evento ARP pendiente de pasar a la cabecera (se formatea una vez por vuelta, no por trama).
+    std::optional<EventRecord> headerEvent;
+    // Filtro de vista (sobre el descriptor): decide qué tramas llegan al log y al panel RX.
+    // No afecta al procesamiento de protocolos.
+    std::optional<DisplayFilter> viewFilter;
+    std::uint64_t viewHidden = 0;
+    auto viewShows = [&](const FrameDescriptor& info) {
+        if (!viewFilter || viewFilter->matches(info)) return true;
+        ++viewHidden;
+        return false;
+    };
+    // Log, panel RX y tabla ARP leen la misma decodificación (FrameDescriptor) de la trama.
+    // @p seq: entrada de la trama en el historial; sin ella (RX simulado) el panel copia @p data.
+    auto handleRxFrame = [&](const FrameDescriptor& rxInfo, std::optional<std::uint64_t> seq,
+                             const std::uint8_t* data, std::size_t size) {
+        const auto rxNow = std::chrono::steady_clock::now();
+        const std::int64_t rxNowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(rxNow.time_since_epoch()).count();
+        if (viewShows(rxInfo)) {
+            setPanelFrame(rxPanel, rxFrameVersion, seq, data, size, &rxInfo);
+            // Registro binario: el texto solo se genera si la fila llega a dibujarse.
+            log.pushEvent(makeRxEvent(rxInfo, rxNowNs));
+        }
         lastRxTick = tick;
 
-        if (rxFrame.etherType == EtherType::ARP) {
-            auto infoOpt = parseArpFrame(rxFrame);
+        if (rxInfo.etherType == EtherType::ARP) {
+            std::optional<ArpInfo> infoOpt;
+            if (rxInfo.has(Layer::Arp)) {
+                ArpInfo decoded{};
+                decoded.opcode = rxInfo.arpOpcode;
+                std::copy_n(rxInfo.arpSenderMac, 6, decoded.senderMac.begin());
+                std::copy_n(rxInfo.arpTargetMac, 6, decoded.targetMac.begin());
+                std::copy_n(rxInfo.srcIp, 4, decoded.senderIp.begin());
+                std::copy_n(rxInfo.dstIp, 4, decoded.targetIp.begin());
+                infoOpt = decoded;
+            }
             if (infoOpt) {
-                const auto now = std::chrono::steady_clock::now();
+                const auto now = rxNow;
                 const std::uint32_t key = ipToKey(infoOpt->senderIp);
                 ArpEntry& entry = arpTable[key];
+                if (!entry.resolved && entry.requestedAt != std::chrono::steady_clock::time_point{}) {
+                    arpResolution.record(static_cast<std::uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(now - entry.requestedAt).count()));
+                }
                 entry.mac = infoOpt->senderMac;
                 entry.expiresAt = now + std::chrono::minutes(5);
                 entry.resolved = true;
+                entry.requestedAt = {};
 
-                if (infoOpt->opcode == 1) {
-                    arpSummary = "REQ who-has " +
-                                 std::to_string(infoOpt->targetIp[0]) + "." +
-                                 std::to_string(infoOpt->targetIp[1]) + "." +
-                                 std::to_string(infoOpt->targetIp[2]) + "." +
-                                 std::to_string(infoOpt->targetIp[3]) +
-                                 " tell " +
-                                 std::to_string(infoOpt->senderIp[0]) + "." +
-                                 std::to_string(infoOpt->senderIp[1]) + "." +
-                                 std::to_string(infoOpt->senderIp[2]) + "." +
-                                 std::to_string(infoOpt->senderIp[3]);
-                    log.push("[INFO] ARP REQ: " + arpSummary.substr(4));
-                } else if (infoOpt->opcode == 2) {
-                    arpSummary = "REP " +
-                                 std::to_string(infoOpt->senderIp[0]) + "." +
-                                 std::to_string(infoOpt->senderIp[1]) + "." +
-                                 std::to_string(infoOpt->senderIp[2]) + "." +
-                                 std::to_string(infoOpt->senderIp[3]) +
-                                 " is-at " + macToString(infoOpt->senderMac);
-                    log.push("[INFO] ARP REP: " + arpSummary.substr(4));
+                if (infoOpt->opcode == 1 || infoOpt->opcode == 2) {
+                    headerEvent = makeArpEvent(infoOpt->opcode == 1 ? EventKind::ArpRequest : EventKind::ArpReply,
+                                               infoOpt->senderIp, infoOpt->targetIp, infoOpt->senderMac, rxNowNs);
+                    log.pushEvent(*headerEvent);
                 }
             }
+            // Los who-has para nuestra IP a broadcast o a nuestra MAC (con o sin tags VLAN) ya los
+            // respondió arpReplyInPlace; los dirigidos a otra MAC solo se registran.
+        }
+    };
 
-            if (fromTap) {
-                std::string arpMsg;
-                auto arpReply = makeArpReply(rxFrame, myMac, myIp, arpMsg);
-                if (arpReply) {
-                    lastTxFrame = arpReply;
-                    auto bytes = serializeEthernetII(*arpReply);
-                    int sent = tap.write(bytes.data(), bytes.size());
-                    status = txResult(sent);
-                    log.push("[TX] " + arpMsg + " -> " + status);
-                    lastTxTick = tick;
-                    arpSummary = "REP " + arpMsg.substr(10);
-                }
-            }
+    // Bookkeeping de UI para requests ya respondidos por arpReplyInPlace (fuera del camino crítico).
+    // @p requestSeq: entrada del request en el historial, copiado antes de reescribir el buffer.
+    auto handleArpFastReply = [&](const ArpInfo& request, const FrameDescriptor& requestInfo,
+                                  std::optional<std::uint64_t> requestSeq, const std::uint8_t* reply,
+                                  std::size_t replyLen, int sent) {
+        lastRxTick = tick;
+        lastTxTick = tick;
+        // Como en handleRxFrame, el filtro de vista decide log y panel RX; la tabla ARP se actualiza siempre.
+        const bool shown = viewShows(requestInfo);
+        // El buffer ya es el reply: sin la copia del historial no queda request que mostrar.
+        if (shown && requestSeq) {
+            setPanelFrame(rxPanel, rxFrameVersion, requestSeq, nullptr, requestInfo.frameSize, &requestInfo);
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        ArpEntry& entry = arpTable[ipToKey(request.senderIp)];
+        if (!entry.resolved && entry.requestedAt != std::chrono::steady_clock::time_point{}) {
+            arpResolution.record(static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - entry.requestedAt).count()));
         }
+        entry.mac = request.senderMac;
+        entry.expiresAt = now + std::chrono::minutes(5);
+        entry.resolved = true;
+        entry.requestedAt = {};
+
+        // Solo registros binarios; estado y resumen ARP se formatean al pintar la cabecera.
+        const std::int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+        headerEvent = makeArpEvent(EventKind::ArpFastReply, request.senderIp, myIp, myMac, nowNs, sent);
+        if (shown) {
+            log.pushEvent(makeArpEvent(EventKind::ArpRequest, request.senderIp, myIp, request.senderMac, nowNs));
+            log.pushEvent(*headerEvent);
+        }
+        setPanelFrame(txPanel, txFrameVersion, lastTxSeq, reply, replyLen, nullptr);
     };
 
+    // Contadores de la cabecera: se componen al pintarla y, para saber si cambiaron, cada 500ms.
+    auto headerSummary = [&](std::chrono::steady_clock::time_point now) {
+        std::string icmpSummary = " | ICMP echo: " + std::to_string(icmpEcho.repliesPerSecond(now)) +
+                                  " rep/s (total " + std::to_string(icmpEcho.stats().echoReplies) + ")" +
+                                  " | TCP: " + std::to_string(tcp.activeConnections()) + " conex";
+        if (tapFilter) {
+            icmpSummary += " | BPF: " + std::to_string(filterDropped) + " filtradas" +
+                           (filterInKernel ? "" : " (userspace)");
+        }
+        if (macFilterOn) {
+            const MacFilterStats& mac = macFilter.stats();
+            icmpSummary += " | MAC: " + (macFilterInKernel ? std::to_string(macDroppedKernel) : std::string("-")) +
+                           " kernel, " + std::to_string(mac.rejectedHash) + " hash, " +
+                           std::to_string(mac.rejectedGroup) + " grupo, " +
+                           std::to_string(mac.rejectedUnicast + mac.rejectedBroadcast + mac.rejectedRunt) +
+                           " otras" + (mdnsJoined ? " (mDNS)" : "");
+        } else {
+            icmpSummary += " | MAC: promiscuo";
+        }
+        if (viewFilter) {
+            icmpSummary += " | Vista: " + std::to_string(viewHidden) + " ocultas";
+        }
+        return arpSummary + icmpSummary;
+    };
+    // Selecciona la trama @p seq del historial (acotada a las que quedan) y la decodifica para el panel RX.
+    auto selectHistory = [&](std::uint64_t seq) {
+        historyPanel.present = !history.empty();
+        if (historyPanel.present) {
+            historySelected = std::clamp(seq, history.firstSeq(), history.endSeq() - 1);
+            HistoryFrame entry;
+            history.get(historySelected, entry);
+            historyPanel.inHistory = true;
+            historyPanel.seq = historySelected;
+            historyPanel.dissected = true;
+            dissectFrame(entry.data, entry.size, historyPanel.info);
+        }
+        ++historyVersion;
+    };
+    // Visor hex del panel con el foco (el que se está mostrando), o nullptr si el foco está en el log.
+    auto focusedView = [&]() -> HexView* {
+        if (focus == PanelFocus::Rx && rxPanelWin) return showHistory ? &historyPanelCache.view : &rxPanelCache.view;
+        if (focus == PanelFocus::Tx && txPanelWin) return &txPanelCache.view;
+        return nullptr;
+    };
+    std::string drawnStatus;
+    std::string drawnSummary;
+    std::uint64_t drawnLogLines = 0;
+    std::uint64_t drawnTxVersion = 0;
+    std::uint64_t drawnRxVersion = 0;
+    int drawnView = -1;
+    auto lastHeaderCheck = std::chrono::steady_clock::now();
+
     while (running) {
         ++tick;
-        if (showInfo) {
+        if (headerEvent) {
+            arpSummary = eventArpSummary(*headerEvent);
+            if (headerEvent->kind == EventKind::ArpFastReply) status = txResult(headerEvent->value);
+            headerEvent.reset();
+            render.invalidate(RenderRegion::Header);
+        }
+
+        // Qué cambió desde el último frame: solo comparaciones; pintar es cosa de render.
+        const auto uiNow = std::chrono::steady_clock::now();
+        const int view = (showInfo ? 1 : 0) | (showArpTable ? 2 : 0) | (showFlows ? 4 : 0) |
+                         (showReceiveMenu ? 8 : 0) | (showSendMenu ? 16 : 0) | (showHistory ? 32 : 0);
+        if (view != drawnView) {
+            render.invalidate(RenderRegion::All);
+            drawnView = view;
+        }
+        if (showInfo || showArpTable || showFlows) {
+            // Páginas con contadores y animaciones: se repintan al ritmo de NETGUI_FPS.
+            render.invalidate(RenderRegion::Overlay);
+        }
+        if (status != drawnStatus) {
+            render.invalidate(RenderRegion::Header);
+        } else if (uiNow - lastHeaderCheck >= std::chrono::milliseconds(500)) {
+            lastHeaderCheck = uiNow;
+            if (headerSummary(uiNow) != drawnSummary) render.invalidate(RenderRegion::Header);
+        }
+        if (showHistory && !history.empty() && historySelected < history.firstSeq()) {
+            selectHistory(history.firstSeq());  // La seleccionada ya salió del historial
+        }
+        // Con el historial abierto, la ventana del log y el panel RX muestran el historial.
+        const std::uint64_t logVersion = showHistory ? history.endSeq() : log.pushed();
+        // Un panel con el foco conserva su trama: las nuevas no lo invalidan.
+        const std::uint64_t rxPanelVersion = focus == PanelFocus::Rx ? drawnRxVersion
+                                           : showHistory ? historyVersion : rxFrameVersion;
+        if (logVersion != drawnLogLines) render.invalidate(RenderRegion::Log);
+        if (focus != PanelFocus::Tx && txFrameVersion != drawnTxVersion) render.invalidate(RenderRegion::TxPanel);
+        if (rxPanelVersion != drawnRxVersion) render.invalidate(RenderRegion::RxPanel);
+
+        const std::uint32_t regions = editorPid > 0 ? 0 : render.beginFrame(uiNow);
+        if (regions == 0) {
+            // Nada que pintar (o aún no toca frame): la vuelta solo atiende paquetes y teclado.
+        } else if (showInfo) {
             // Fullscreen info to avoid flicker from other panels
             if (sendMenuWin) {
                 werase(sendMenuWin);
-                wrefresh(sendMenuWin);
+                wnoutrefresh(sendMenuWin);
                 delwin(sendMenuWin);
                 sendMenuWin = nullptr;
             }
             if (recvMenuWin) {
                 werase(recvMenuWin);
-                wrefresh(recvMenuWin);
+                wnoutrefresh(recvMenuWin);
                 delwin(recvMenuWin);
                 recvMenuWin = nullptr;
             }
-            drawInfo(stdscr, infoPage, tick, lastTxTick, lastRxTick);
+            if (infoPage == kTrafficStatsPage) {
+                if (tick - statsLinesTick >= 50) {
+                    int h, w;
+                    getmaxyx(stdscr, h, w);
+                    (void)w;
+                    // Secciones fijas (latencias, totales, EtherType, IP) + 4 listas top: reparte el alto que queda.
+                    const std::size_t perList = static_cast<std::size_t>(std::max(1, (h - 21) / 4));
+                    statsLines = formatPipelineLatency(pipeline);
+                    const auto traffic = formatTrafficStats(trafficStats, perList, std::chrono::steady_clock::now());
+                    statsLines.insert(statsLines.end(), traffic.begin(), traffic.end());
+                    statsLinesTick = tick;
+                }
+                drawTrafficStats(stdscr, statsLines);
+            } else {
+                drawInfo(stdscr, infoPage, tick, lastTxTick, lastRxTick);
+            }
         } else if (showArpTable) {
             if (sendMenuWin) {
                 werase(sendMenuWin);
-                wrefresh(sendMenuWin);
+                wnoutrefresh(sendMenuWin);
+                delwin(sendMenuWin);
+                sendMenuWin = nullptr;
+            }
+            if (recvMenuWin) {
+                werase(recvMenuWin);
+                wnoutrefresh(recvMenuWin);
+                delwin(recvMenuWin);
+                recvMenuWin = nullptr;
+            }
+            drawArpTable(stdscr, arpTable, ndp.neighbors());
+        } else if (showFlows) {
+            if (sendMenuWin) {
+                werase(sendMenuWin);
+                wnoutrefresh(sendMenuWin);
                 delwin(sendMenuWin);
                 sendMenuWin = nullptr;
             }
             if (recvMenuWin) {
                 werase(recvMenuWin);
-                wrefresh(recvMenuWin);
+                wnoutrefresh(recvMenuWin);
                 delwin(recvMenuWin);
                 recvMenuWin = nullptr;
             }
-            drawArpTable(stdscr, arpTable);
+            // El ranking recorre toda la tabla: se recalcula ~2 veces por segundo, no en cada vuelta.
+            if (tick - flowLinesTick >= 50) {
+                int h, w;
+                getmaxyx(stdscr, h, w);
+                (void)w;
+                flowLines = formatTopFlows(flows, static_cast<std::size_t>(std::max(1, h - 5)),
+                                           std::chrono::steady_clock::now());
+                flowLinesTick = tick;
+            }
+            drawFlowTable(stdscr, flows, flowLines);
         } else if (showReceiveMenu) {
             int const popupH = 6;
             int const popupW = 34;
@@ -843,9 +1430,11 @@ int runTuiApp(TapDevice& tap) {
             if (!recvMenuWin) {
                 recvMenuWin = newwin(popupH, popupW, popupY, popupX);
             }
-            drawReceiveMenu(recvMenuWin);
+            if (regions & RenderRegion::Overlay) {
+                drawReceiveMenu(recvMenuWin);
+            }
         } else if (showSendMenu) {
-            int const popupH = 7;
+            int const popupH = 9;
             int const popupW = 32;
             const int footerY = headerH + breakdownH + logH;
             const int footerX = 2;
@@ -856,71 +1445,194 @@ int runTuiApp(TapDevice& tap) {
             if (!sendMenuWin) {
                 sendMenuWin = newwin(popupH, popupW, popupY, popupX);
             }
-            drawSendMenu(sendMenuWin, customPacket.has_value(), customPacket ? customPacket->size() : 0);
+            if (regions & RenderRegion::Overlay) {
+                drawSendMenu(sendMenuWin, customPacket.has_value(), customPacket ? customPacket->size() : 0,
+                             library, libIndex);
+            }
         } else {
             if (sendMenuWin) {
                 werase(sendMenuWin);
-                wrefresh(sendMenuWin);
+                wnoutrefresh(sendMenuWin);
                 delwin(sendMenuWin);
                 sendMenuWin = nullptr;
             }
             if (recvMenuWin) {
                 werase(recvMenuWin);
-                wrefresh(recvMenuWin);
+                wnoutrefresh(recvMenuWin);
                 delwin(recvMenuWin);
                 recvMenuWin = nullptr;
             }
 
-            drawHeader(headerWin, tap.name(), status, arpSummary);
-            drawLog(logWin, log, scrollOffset);
-            if (txPanelWin) {
-                drawLastTxPanel(txPanelWin, lastTxFrame);
+            if (regions & RenderRegion::Header) {
+                drawnStatus = status;
+                drawnSummary = headerSummary(uiNow);
+                lastHeaderCheck = uiNow;
+                drawHeader(headerWin, tap.name(), drawnStatus, drawnSummary);
+            }
+            if (regions & RenderRegion::Log) {
+                drawnLogLines = logVersion;
+                if (showHistory) {
+                    drawHistory(logWin, history, historySelected, historyEpochNs);
+                } else {
+                    drawLog(logWin, log, scrollOffset, logRows);
+                }
+            }
+            if (txPanelWin && (regions & RenderRegion::TxPanel)) {
+                drawnTxVersion = txFrameVersion;
+                drawFramePanel(txPanelWin, " Ultimo TX Enviado ", "[ Sin paquetes TX ]", 2, txPanel, history,
+                               txFrameVersion, txPanelCache, focus == PanelFocus::Tx);
             }
-            if (rxPanelWin) {
-                drawLastRxPanel(rxPanelWin, lastRxFrame);
+            if (rxPanelWin && (regions & RenderRegion::RxPanel)) {
+                drawnRxVersion = rxPanelVersion;
+                if (showHistory) {
+                    const std::string title = " Historial #" + std::to_string(historySelected) + " ";
+                    drawFramePanel(rxPanelWin, title.c_str(),
+                                   history.empty() ? "[ Historial vacio ]" : "[ Trama no decodificable ]", 1,
+                                   historyPanel, history, historyVersion, historyPanelCache,
+                                   focus == PanelFocus::Rx);
+                } else {
+                    drawFramePanel(rxPanelWin, " Ultimo RX Capturado ", "[ Sin paquetes RX ]", 1, rxPanel,
+                                   history, rxFrameVersion, rxPanelCache, focus == PanelFocus::Rx);
+                }
+            }
+            if (regions & RenderRegion::Footer) {
+                drawFooter(footerWin);
             }
-            drawFooter(footerWin);
+        }
+        if (regions != 0) {
+            // Todas las ventanas tocadas en este frame salen al terminal en una sola escritura.
+            doupdate();
+            uiFramesMetric.add();
         }
 
-        struct pollfd pfd;
+        struct pollfd pfds[2];
+        struct pollfd& pfd = pfds[0];
         pfd.fd = tap.getFd();
         pfd.events = POLLIN;
-        int ret = poll(&pfd, 1, 10);  // 10ms para mejor responsividad de teclado
+        pfds[1].fd = customWatch.fd();
+        pfds[1].events = POLLIN;
+        pfds[1].revents = 0;
+        int ret = poll(pfds, customWatch.active() ? 2 : 1, 10);  // 10ms para mejor responsividad de teclado
+        if (ret > 0 && (pfds[1].revents & POLLIN) && customWatch.changed()) {
+            hotReloadCustom();
+        }
 
-        int ch = getch();
+        if (editorPid > 0 && editorFinished(editorPid, msg)) {
+            editorPid = -1;
+            log.push(msg);
+            if (!customWatch.active()) hotReloadCustom();
+            // El editor dejó la pantalla a su manera: el próximo frame la repinta entera.
+            clearok(curscr, TRUE);
+            render.invalidate(RenderRegion::All);
+        }
+
+        // Con el editor abierto el terminal es suyo: no se leen teclas.
+        int ch = editorPid > 0 ? ERR : getch();
         if (ch != ERR) {
+            render.invalidate(RenderRegion::All);
             if (ch == 'i' || ch == 'I') {
                 showInfo = !showInfo;
                 if (showInfo) {
+                    showHistory = false;
                     showSendMenu = false;
                     showArpTable = false;
+                    showFlows = false;
                     showReceiveMenu = false;
                 }
                 infoPage = 0;
             } else if (ch == 'a' || ch == 'A') {
                 showArpTable = !showArpTable;
                 if (showArpTable) {
+                    showHistory = false;
                     showSendMenu = false;
                     showInfo = false;
+                    showFlows = false;
                     showReceiveMenu = false;
                 }
+            } else if (ch == 'f' || ch == 'F') {
+                showFlows = !showFlows;
+                if (showFlows) {
+                    showHistory = false;
+                    showSendMenu = false;
+                    showInfo = false;
+                    showArpTable = false;
+                    showReceiveMenu = false;
+                    flowLinesTick = -100000;
+                }
+            } else if (ch == 'h' || ch == 'H') {
+                showHistory = !showHistory;
+                focus = PanelFocus::Log;
+                if (showHistory) {
+                    showInfo = false;
+                    showArpTable = false;
+                    showFlows = false;
+                    selectHistory(history.endSeq() > 0 ? history.endSeq() - 1 : 0);
+                }
+            } else if (ch == 'b' || ch == 'B') {
+                std::string expression;
+                const std::string current = tapFilter ? tapFilter->expression : "(ninguno)";
+                if (promptLine(footerWin, "Filtro BPF [actual: " + current + "] (vacío = quitar; ej: not ip6 and not udp port 5353)",
+                               expression)) {
+                    applyFilter(expression);
+                }
+            } else if (ch == 'v' || ch == 'V') {
+                std::string expression;
+                const std::string current = viewFilter ? viewFilter->expression() : "(ninguno)";
+                if (promptLine(footerWin, "Vista [actual: " + current + "] (vacío = todo; ej: arp.opcode==1 || ip.len>1000)",
+                               expression)) {
+                    std::string error;
+                    auto compiled = compileDisplayFilter(expression, error);
+                    if (!compiled) {
+                        status = "Vista inválida: " + error;
+                        log.push("[WARN] [VISTA] '" + expression + "': " + error);
+                    } else if (compiled->empty()) {
+                        viewFilter.reset();
+                        status = "Vista: todo";
+                        log.push("[INFO] [VISTA] Sin filtro de vista");
+                    } else {
+                        log.push("[INFO] [VISTA] '" + expression + "' (" +
+                                 std::to_string(compiled->instructionCount()) + " instr)");
+                        viewFilter = std::move(compiled);
+                        viewHidden = 0;
+                        status = "Vista: " + expression;
+                    }
+                }
+            } else if (ch == 'g' || ch == 'G') {
+                mdnsJoined = !mdnsJoined;
+                if (mdnsJoined) {
+                    ipv6.joinGroup(mdnsGroup6);
+                    macFilter.join(mdnsMac4);
+                } else {
+                    ipv6.leaveGroup(mdnsGroup6);
+                    macFilter.leave(mdnsMac4);
+                }
+                status = mdnsJoined ? "mDNS: unido a ff02::fb y 224.0.0.251" : "mDNS: grupos abandonados";
+                log.push("[INFO] [MAC] " + status);
+            } else if (ch == 'o' || ch == 'O') {
+                macFilterOn = !macFilterOn;
+                macFilterProgrammed = ~0ULL;
+                macFilter.resetStats();
+                status = macFilterOn ? "Filtro MAC activo" : "Filtro MAC desactivado (promiscuo)";
+                log.push("[INFO] [MAC] " + status);
             } else if (ch == '-' && showInfo) {
-                infoPage = (infoPage - 1 + 4) % 4;
+                infoPage = (infoPage - 1 + kInfoPages) % kInfoPages;
+                statsLinesTick = -100000;
             } else if (ch == '+' && showInfo) {
-                infoPage = (infoPage + 1) % 4;
+                infoPage = (infoPage + 1) % kInfoPages;
+                statsLinesTick = -100000;
             } else if (ch == 'm' || ch == 'M') {
-                if (!showInfo && !showArpTable && !showReceiveMenu) {
+                if (!showInfo && !showArpTable && !showFlows && !showReceiveMenu) {
                     showSendMenu = !showSendMenu;
                 }
             } else if (ch == 'n' || ch == 'N') {
-                if (!showInfo && !showArpTable && !showSendMenu) {
+                if (!showInfo && !showArpTable && !showFlows && !showSendMenu) {
                     showReceiveMenu = !showReceiveMenu;
                 }
             } else if ((ch == 's' || ch == 'S') && showSendMenu) {
                 auto frame = makeDefaultDemoFrame(0);
-                lastTxFrame = frame;
                 auto bytes = serializeEthernetII(frame);
-                int sent = tap.write(bytes.data(), bytes.size());
+                int sent = txWrite(bytes.data(), bytes.size());
+                setPanelFrame(txPanel, txFrameVersion, lastTxSeq, bytes.data(), bytes.size(), nullptr);
                 status = txResult(sent);
                 log.push("[TX] Demo 0x00 (" + std::to_string(bytes.size()) + "B) -> " + status);
                 lastTxTick = tick;
@@ -930,9 +1642,9 @@ int runTuiApp(TapDevice& tap) {
                 std::string arpMsg;
                 auto req = makeArpRequest(myMac, myIp, arpTargetIp, arpMsg);
                 if (req) {
-                    lastTxFrame = req;
                     auto bytes = serializeEthernetII(*req);
-                    int sent = tap.write(bytes.data(), bytes.size());
+                    int sent = txWrite(bytes.data(), bytes.size());
+                    setPanelFrame(txPanel, txFrameVersion, lastTxSeq, bytes.data(), bytes.size(), nullptr);
                     status = txResult(sent);
                     log.push("[TX] " + arpMsg + " -> " + status);
                     lastTxTick = tick;
@@ -944,21 +1656,27 @@ int runTuiApp(TapDevice& tap) {
                     entry.mac = MacAddress{};
                     entry.expiresAt = now + std::chrono::minutes(1);
                     entry.resolved = false;
+                    entry.requestedAt = now;
                 } else {
                     status = "Error creando ARP Request";
                     log.push("[WARN] " + status);
                 }
                 showSendMenu = false;
             } else if ((ch == 't' || ch == 'T') && showReceiveMenu) {
-                auto demoFrame = makeDefaultDemoFrame(0);
-                handleRxFrame(demoFrame, false);
+                const auto demoBytes = serializeEthernetII(makeDefaultDemoFrame(0));
+                FrameDescriptor demoInfo;
+                dissectFrame(demoBytes.data(), demoBytes.size(), demoInfo);
+                handleRxFrame(demoInfo, std::nullopt, demoBytes.data(), demoBytes.size());
                 status = "RX Demo simulado (Ethernet)";
                 showReceiveMenu = false;
             } else if ((ch == 'p' || ch == 'P') && showReceiveMenu) {
                 std::string arpMsg;
                 auto req = makeArpRequest(demoPeerMac, demoPeerIp, myIp, arpMsg);
                 if (req) {
-                    handleRxFrame(*req, false);
+                    const auto reqBytes = serializeEthernetII(*req);
+                    FrameDescriptor reqInfo;
+                    dissectFrame(reqBytes.data(), reqBytes.size(), reqInfo);
+                    handleRxFrame(reqInfo, std::nullopt, reqBytes.data(), reqBytes.size());
                     status = "RX Demo simulado (ARP)";
                 } else {
                     status = "Error creando ARP Demo";
@@ -966,31 +1684,12 @@ int runTuiApp(TapDevice& tap) {
                 }
                 showReceiveMenu = false;
             } else if (ch == 'e' || ch == 'E') {
+                // Sale del modo curses sin perder su estado; se vuelve con el primer doupdate().
+                def_prog_mode();
                 endwin();
-                openFileInEditor(packetFile, msg);
-                initscr();
-                cbreak();
-                noecho();
-                keypad(stdscr, TRUE);
-                nodelay(stdscr, TRUE);
-                curs_set(0);
-                if (has_colors()) {
-                    start_color();
-                    init_pair(1, COLOR_GREEN, COLOR_BLACK);
-                    init_pair(2, COLOR_RED, COLOR_BLACK);
-                    init_pair(3, COLOR_CYAN, COLOR_BLACK);
-                    init_pair(4, COLOR_YELLOW, COLOR_BLACK);
-                    init_pair(5, COLOR_WHITE, COLOR_BLACK);
-                    init_pair(6, COLOR_BLUE, COLOR_BLACK);
-                    init_pair(7, COLOR_MAGENTA, COLOR_BLACK);
-                }
+                editorPid = startEditor(packetFile, msg);
                 log.push(msg);
-                customPacket = loadCustomPacket(packetFile);
-                if (customPacket) {
-                    status = "Custom editado y recargado: " + std::to_string(customPacket->size()) + " bytes";
-                } else {
-                    status = "Error al parsear custom editado";
-                }
+                status = editorPid > 0 ? "Editando custom (se recarga al guardar)" : "Error al abrir el editor";
             } else if (ch == 'r' || ch == 'R') {
                 customPacket = loadCustomPacket(packetFile);
                 if (customPacket) {
@@ -1000,29 +1699,60 @@ int runTuiApp(TapDevice& tap) {
                     status = "Custom inválido";
                     log.push("[WARN] [CUSTOM] Error de parseo (" + packetFile.string() + ")");
                 }
+                if (library.isOpen() || std::filesystem::exists(libraryFile)) {
+                    reportLibrary(library.isOpen() ? library.refresh(msg) : library.open(libraryFile, msg));
+                }
+            } else if ((ch == ',' || ch == '.') && showSendMenu) {
+                if (library.size() > 0) {
+                    const std::size_t n = library.size();
+                    libIndex = ch == '.' ? (libIndex + 1) % n : (libIndex + n - 1) % n;
+                }
+            } else if ((ch == 'l' || ch == 'L') && showSendMenu) {
+                // Solo un stat() si el fuente no cambió; recompila si cambió.
+                if (library.isOpen()) reportLibrary(library.refresh(msg));
+                if (library.size() == 0) {
+                    status = "Biblioteca vacia o no cargada";
+                    log.push("[WARN] [TX] Biblioteca: no hay tramas (" + libraryFile.string() + ")");
+                } else {
+                    const PacketView view = library.frame(libIndex);
+                    int sent = txWrite(view.data, view.size);
+                    setPanelFrame(txPanel, txFrameVersion, lastTxSeq, view.data, view.size, nullptr);
+                    status = txResult(sent);
+                    std::string label = "#" + std::to_string(libIndex + 1);
+                    if (!view.name.empty()) label.append(" ").append(view.name.data(), view.name.size());
+                    log.push("[TX] Biblioteca " + label + " (" + std::to_string(view.size) + "B) -> " + status);
+                }
+                lastTxTick = tick;
+                showSendMenu = false;
             } else if ((ch == 'c' || ch == 'C') && showSendMenu) {
                 if (!customPacket) {
                     status = "Custom no cargado";
                     log.push("[WARN] [TX] Custom falló: no hay bytes");
                 } else {
-                    // Parsear el custom para guardarlo en lastTxFrame
-                    auto customFrameOpt = parseEthernetII(customPacket->data(), customPacket->size());
-                    if (customFrameOpt) {
-                        lastTxFrame = customFrameOpt;
-                    }
-                    int sent = tap.write(customPacket->data(), customPacket->size());
+                    int sent = txWrite(customPacket->data(), customPacket->size());
+                    setPanelFrame(txPanel, txFrameVersion, lastTxSeq, customPacket->data(), customPacket->size(),
+                                  nullptr);
                     status = txResult(sent);
                     log.push("[TX] Custom -> " + status);
                 }
                 lastTxTick = tick;
                 showSendMenu = false;
-            } else if ((ch == 's' || ch == 'S' || ch == 'd' || ch == 'D' || ch == 'c' || ch == 'C') && !showSendMenu) {
+            } else if ((ch == 's' || ch == 'S' || ch == 'd' || ch == 'D' || ch == 'c' || ch == 'C' || ch == 'l' || ch == 'L') && !showSendMenu) {
                 status = "Abre el menu con [m] para enviar";
             } else if (ch == 'x' || ch == 'X') {
-                if (!lastRxFrame) {
-                    log.push("[WARN] [RX] No hay paquete RX capturado para guardar");
+                // Con el historial abierto se guarda la trama seleccionada (RX o TX).
+                // La trama se reconstruye aquí, desde el historial, solo para guardarla.
+                std::optional<EthernetFrame> toSave;
+                const std::uint8_t* saveData = nullptr;
+                std::size_t saveSize = 0;
+                if (panelFrameBytes(showHistory ? historyPanel : rxPanel, history, saveData, saveSize)) {
+                    toSave = parseEthernetII(saveData, saveSize);
+                }
+                if (!toSave) {
+                    log.push(showHistory ? "[WARN] [RX] La trama seleccionada del historial no se puede guardar"
+                                         : "[WARN] [RX] No hay paquete RX capturado para guardar");
                 } else {
-                    if (saveRxFrameAsCustom(*lastRxFrame, packetFile, msg)) {
+                    if (saveRxFrameAsCustom(*toSave, packetFile, msg)) {
                         log.push(msg);
                         // BUGFIX: Recargar el custom después de guardarlo
                         customPacket = loadCustomPacket(packetFile);
@@ -1041,6 +1771,65 @@ int runTuiApp(TapDevice& tap) {
                 status = "Abre el menu con [m] para enviar";
             } else if ((ch == 't' || ch == 'T' || ch == 'p' || ch == 'P') && !showReceiveMenu) {
                 status = "Abre el menu con [n] para recibir";
+            } else if (ch == 'w' || ch == 'W') {
+                // Log -> panel RX -> panel TX -> log (solo los paneles que caben en la pantalla).
+                if (focus == PanelFocus::Log && rxPanelWin) {
+                    focus = PanelFocus::Rx;
+                } else if (focus != PanelFocus::Tx && txPanelWin) {
+                    focus = PanelFocus::Tx;
+                } else {
+                    focus = PanelFocus::Log;
+                }
+                status = focus == PanelFocus::Rx ? "Foco: panel RX (congelado)"
+                       : focus == PanelFocus::Tx ? "Foco: panel TX (congelado)" : "Foco: log";
+            } else if (focusedView() && (ch == KEY_UP || ch == KEY_DOWN || ch == KEY_PPAGE || ch == KEY_NPAGE ||
+                                         ch == KEY_HOME || ch == KEY_END)) {
+                HexView& view = *focusedView();
+                const long page = std::max(1, view.visibleRows());
+                if (ch == KEY_UP) view.scrollBy(-1);
+                else if (ch == KEY_DOWN) view.scrollBy(1);
+                else if (ch == KEY_PPAGE) view.scrollBy(-page);
+                else if (ch == KEY_NPAGE) view.scrollBy(page);
+                else if (ch == KEY_HOME) view.scrollTo(0);
+                else view.scrollTo(view.rowCount());
+            } else if (ch == '/' || ch == 'j' || ch == 'J') {
+                HexView* view = focusedView();
+                std::string input;
+                if (!view) {
+                    status = "Pasa el foco a un panel con [w] para buscar o saltar";
+                } else if (ch == '/' && promptLine(footerWin, "Buscar (hex: de ad be ef | texto: \"GET\") [vacío = siguiente]", input)) {
+                    if (!input.empty()) lastSearch = HexView::parseQuery(input);
+                    if (lastSearch.empty()) {
+                        status = "Nada que buscar";
+                    } else if (!view->find(lastSearch)) {
+                        status = "Sin coincidencias";
+                    } else {
+                        char found[48];
+                        std::snprintf(found, sizeof(found), "Encontrado en 0x%04zX", view->matchOffset());
+                        status = found;
+                    }
+                } else if (ch != '/' && promptLine(footerWin, "Ir a offset (hex, ej: 0x36)", input)) {
+                    char* end = nullptr;
+                    const unsigned long offset = std::strtoul(input.c_str(), &end, 16);
+                    status = (end != input.c_str() && view->jumpTo(offset)) ? "Offset " + input
+                                                                            : "Offset fuera de la trama: " + input;
+                }
+            } else if (showHistory && (ch == KEY_UP || ch == KEY_DOWN || ch == KEY_PPAGE || ch == KEY_NPAGE ||
+                                       ch == KEY_HOME || ch == KEY_END)) {
+                int h, w;
+                getmaxyx(logWin, h, w);
+                (void)w;
+                const std::uint64_t page = static_cast<std::uint64_t>(std::max(1, h - 3));
+                const std::uint64_t step = (ch == KEY_PPAGE || ch == KEY_NPAGE) ? page : 1;
+                if (ch == KEY_UP || ch == KEY_PPAGE) {
+                    selectHistory(historySelected > step ? historySelected - step : 0);
+                } else if (ch == KEY_DOWN || ch == KEY_NPAGE) {
+                    selectHistory(historySelected + step);
+                } else if (ch == KEY_HOME) {
+                    selectHistory(0);
+                } else {
+                    selectHistory(history.endSeq() > 0 ? history.endSeq() - 1 : 0);
+                }
             } else if (ch == KEY_UP) {
                 scrollOffset += 1; // Scroll up (back in history)
             } else if (ch == KEY_DOWN) {
@@ -1049,21 +1838,136 @@ int runTuiApp(TapDevice& tap) {
                 scrollOffset += 5;
             } else if (ch == KEY_NPAGE) {
                 scrollOffset -= 5;
+            } else if (ch == KEY_HOME) {
+                scrollOffset = INT_MAX; // Línea más antigua (drawLog lo recorta)
+            } else if (ch == KEY_END) {
+                scrollOffset = 0;
             }
         }
 
-        if (ret > 0 && (pfd.revents & POLLIN)) {
-            int n = tap.read(rxBuffer.data(), rxBuffer.size());
+        // Drena varias tramas por vuelta: con TCP a plena velocidad llegan muchas entre refrescos.
+        for (int batch = 0; ret > 0 && (pfd.revents & POLLIN) && batch < 64; ++batch) {
+            // RX en buffers del pool (TCP puede quedarse con una referencia); si se agota, buffer local.
+            PacketRef rxRef(&packetPool, packetPool.acquire());
+            if (rxRef) rxRef->reset(0);
+            std::uint8_t* rxData = rxRef ? rxRef->data() : rxBuffer.data();
+            const std::size_t rxCapacity = rxRef ? rxRef->tailroom() : rxBuffer.size();
+
+            int n = tap.read(rxData, rxCapacity);
+            const std::uint64_t readTicks = LatencyClock::now();
             if (n > 0) {
-                auto frameOpt = parseEthernetII(rxBuffer.data(), n);
-                if (frameOpt) {
-                    handleRxFrame(*frameOpt, true);
+                rxFramesMetric.add();
+                rxBytesMetric.add(static_cast<std::uint64_t>(n));
+            }
+            // Mismo orden que el TAP: filtro MAC y después BPF (el hash del kernel deja pasar grupos ajenos).
+            if (n > 0 && macFilterOn && !macFilter.accept(rxData, static_cast<std::size_t>(n))) {
+                macDropMetric.add();
+                continue;
+            }
+            if (n > 0 && tapFilter && !filterInKernel &&
+                runBpfFilter(tapFilter->code, rxData, static_cast<std::size_t>(n)) == 0) {
+                ++filterDroppedUser;
+                bpfDropMetric.add();
+                continue;
+            }
+            if (n > 0) {
+                // Una sola pasada de decodificación por trama; todo lo demás lee el descriptor.
+                rxStartTicks = readTicks;
+                FrameDescriptor rxInfo;
+                const bool decoded = dissectFrame(rxData, static_cast<std::size_t>(n), rxInfo);
+                const std::uint64_t dissectTicks = LatencyClock::now();
+                pipeline.record(PipelineStage::Dissect, readTicks, dissectTicks);
+                const auto rxNow = std::chrono::steady_clock::now();
+                flows.update(rxInfo, rxNow);
+                trafficStats.add(rxInfo, TrafficDirection::Rx, rxNow);
+                // Copia al historial antes de que el fast path ARP o un responder reescriban el buffer: es la
+                // única copia de la trama (el panel RX apunta a ella). Siempre cabe: el arena es de al menos 1 MB.
+                const std::uint64_t rxSeq = history.endSeq();
+                const bool rxKept = history.push(FrameDirection::Rx, rxData, static_cast<std::size_t>(n),
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(rxNow.time_since_epoch()).count());
+
+                // Fast path: who-has para nuestra IP (a broadcast o a nuestra MAC, también tras tags VLAN)
+                // se responde en el propio buffer RX, sin copias.
+                ArpInfo arpRequest{};
+                const std::size_t replyLen = rxInfo.has(Layer::Arp)
+                    ? arpReplyInPlace(rxData, static_cast<std::size_t>(n), rxCapacity, myMac, myIp, arpRequest,
+                                      rxInfo.l3Offset)
+                    : 0;
+                if (replyLen > 0) {
+                    const int sent = txWrite(rxData, replyLen);
+                    handleArpFastReply(arpRequest, rxInfo, rxKept ? std::optional<std::uint64_t>(rxSeq) : std::nullopt,
+                                       rxData, replyLen, sent);
                 } else {
-                    log.push("[RX] " + std::to_string(n) + " bytes (raw)");
-                    lastRxTick = tick;
+                    // IP trabaja sobre el buffer crudo desde el offset L3 del dissector (también tras tags VLAN).
+                    if (rxInfo.ipVersion == 4) {
+                        if (rxRef) {
+                            rxRef->resize(static_cast<std::size_t>(n));
+                            ipv4.input(*rxRef.get(), rxNow, rxInfo.l3Offset);
+                        } else {
+                            ipv4.input(rxData, static_cast<std::size_t>(n), rxCapacity, rxNow, rxInfo.l3Offset);
+                        }
+                    } else if (rxInfo.ipVersion == 6) {
+                        // NS para nuestra dirección -> NA escrito en el mismo buffer.
+                        ipv6.input(rxData, static_cast<std::size_t>(n), rxCapacity, rxNow, rxInfo.l3Offset);
+                    }
+                    if (decoded) {
+                        handleRxFrame(rxInfo, rxKept ? std::optional<std::uint64_t>(rxSeq) : std::nullopt, rxData,
+                                      static_cast<std::size_t>(n));
+                    } else {
+                        if (viewShows(rxInfo)) {
+                            log.pushEvent(makeRxRawEvent(static_cast<std::size_t>(n),
+                                std::chrono::duration_cast<std::chrono::nanoseconds>(rxNow.time_since_epoch()).count()));
+                        }
+                        lastRxTick = tick;
+                    }
                 }
-            } else if (n < 0 && errno != EAGAIN) {
-                log.push("[RX] Error leyendo TAP");
+                pipeline.record(PipelineStage::Handle, dissectTicks, LatencyClock::now());
+                rxStartTicks = 0;
+            } else {
+                if (n < 0 && errno == EAGAIN) {
+                    readAgainMetric.add();
+                } else if (n < 0) {
+                    readErrorMetric.add();
+                    log.push("[RX] Error leyendo TAP");
+                }
+                break;
+            }
+        }
+
+        // Retransmisiones, delayed ACK y TIME-WAIT de TCP.
+        timers.advance(std::chrono::steady_clock::now());
+
+        // Descartes del filtro: tx_dropped del TAP (sysfs) desde que se adjuntó.
+        if ((tick % 50) == 0 && tapFilter) {
+            const std::uint64_t kernelDropped = filterInKernel ? tap.droppedByKernel() : 0;
+            filterDropped = !filterInKernel ? filterDroppedUser
+                          : kernelDropped >= filterDropBase ? kernelDropped - filterDropBase : 0;
+        }
+
+        syncMacFilter();
+        if ((tick % 50) == 0 && macFilterInKernel) {
+            const std::uint64_t kernelDropped = tap.droppedByKernel();
+            macDroppedKernel = kernelDropped >= macDropBase ? kernelDropped - macDropBase : 0;
+        }
+
+        if ((tick % 50) == 0) {
+            arpEntriesMetric.set(static_cast<double>(arpTable.size()));
+            ndpNeighborsMetric.set(static_cast<double>(ndp.neighbors().size()));
+            tcpConnectionsMetric.set(static_cast<double>(tcp.activeConnections()));
+            flowsMetric.set(static_cast<double>(flows.size()));
+        }
+
+        // Temporizadores NUD (REACHABLE -> STALE, sondas DELAY/PROBE, retransmisión de NS).
+        if ((tick % 20) == 0) {
+            ndp.expire(std::chrono::steady_clock::now());
+            // Barrido incremental (sweepSlots por llamada): nunca recorre toda la tabla de golpe.
+            flows.expire(std::chrono::steady_clock::now());
+        }
+
+        if ((tick % 200) == 0) {
+            const std::size_t expired = ipv4.expire(std::chrono::steady_clock::now());
+            if (expired > 0) {
+                log.push("[WARN] IPv4: " + std::to_string(expired) + " datagrama(s) incompletos expirados");
             }
         }
 
@@ -0,0 +1,245 @@
+#include "udp.h"
+#include "checksum.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstddef>
+#include <cstring>
+
+/** @brief RFC 864 character set: the 95 printable ASCII characters. */
+static constexpr char kChargenFirst = ' ';
+static constexpr std::size_t kChargenSet = 95;
+static constexpr std::size_t kChargenLine = 72;
+
+UdpLayer::UdpLayer(Ipv4Layer& layer, PacketPool& buffers) : ipv4(layer), pool(buffers)
+{
+    rehash(64);
+    ipv4.setHandler(IpProto::UDP, [this](Ipv4Packet& packet) { input(packet); });
+}
+
+std::size_t UdpLayer::slotFor(std::uint16_t port) const
+{
+    // Fibonacci hashing: multiply and keep the top bits.
+    return static_cast<std::size_t>((static_cast<std::uint32_t>(port) * 0x9E3779B1u) >> hashShift);
+}
+
+std::size_t UdpLayer::indexOf(std::uint16_t port) const
+{
+    const std::size_t mask = ports.size() - 1;
+    for (std::size_t i = slotFor(port);; i = (i + 1) & mask)
+    {
+        const PortSlot& slot = ports[i];
+        if (slot.state == 0) return ports.size();
+        if (slot.state == 1 && slot.port == port) return i;
+    }
+}
+
+UdpLayer::PortSlot* UdpLayer::find(std::uint16_t port)
+{
+    const std::size_t i = indexOf(port);
+    return (i < ports.size()) ? &ports[i] : nullptr;
+}
+
+void UdpLayer::rehash(std::size_t newCapacity)
+{
+    std::vector<PortSlot> old;
+    old.swap(ports);
+    ports.resize(newCapacity);
+    hashShift = 32;
+    for (std::size_t c = newCapacity; c > 1; c >>= 1) --hashShift;
+    used = 0;
+    deleted = 0;
+    for (auto& slot : old)
+    {
+        if (slot.state == 1) bind(slot.port, std::move(slot.handler));
+    }
+}
+
+bool UdpLayer::bind(std::uint16_t port, UdpReceiveHandler handler)
+{
+    if (!handler || find(port)) return false;
+    if ((used + deleted + 1) * 2 > ports.size())
+    {
+        // Grow when live entries need it; otherwise rehashing just clears tombstones.
+        rehash((used + 1) * 4 > ports.size() ? ports.size() * 2 : ports.size());
+    }
+
+    const std::size_t mask = ports.size() - 1;
+    for (std::size_t i = slotFor(port);; i = (i + 1) & mask)
+    {
+        PortSlot& slot = ports[i];
+        if (slot.state == 1) continue;
+        if (slot.state == 2) --deleted;
+        slot.port = port;
+        slot.state = 1;
+        slot.handler = std::move(handler);
+        ++used;
+        return true;
+    }
+}
+
+void UdpLayer::unbind(std::uint16_t port)
+{
+    PortSlot* slot = find(port);
+    if (!slot) return;
+    slot->state = 2;
+    slot->handler = nullptr;
+    --used;
+    ++deleted;
+}
+
+bool UdpLayer::isBound(std::uint16_t port) const
+{
+    return indexOf(port) < ports.size();
+}
+
+void UdpLayer::input(Ipv4Packet& packet)
+{
+    if (packet.payloadSize < sizeof(UdpHeader))
+    {
+        ++counters.rxMalformed;
+        return;
+    }
+
+    const std::uint8_t* udp = packet.payload();
+    UdpHeader header;
+    std::memcpy(&header, udp, sizeof(header));
+    const std::size_t length = ntohs(header.length);
+    if (length < sizeof(UdpHeader) || length > packet.payloadSize)
+    {
+        ++counters.rxMalformed;
+        return;
+    }
+
+    if (header.checksum != 0)
+    {
+        std::uint32_t sum = checksumPseudoIpv4(packet.src.data(), packet.dst.data(), IpProto::UDP,
+                                               static_cast<std::uint16_t>(length));
+        sum = checksumAccumulate(udp, length, sum);
+        if (checksumFinish(sum) != 0)
+        {
+            ++counters.rxChecksumErrors;
+            return;
+        }
+    }
+
+    ++counters.rxDatagrams;
+    counters.rxBytes += length - sizeof(UdpHeader);
+
+    PortSlot* slot = find(ntohs(header.dstPort));
+    if (!slot)
+    {
+        ++counters.rxNoPort;
+        return;
+    }
+
+    UdpDatagram datagram;
+    datagram.packet = &packet;
+    std::memcpy(datagram.srcMac.data(), packet.frame + 6, 6);
+    datagram.srcIp = packet.src;
+    datagram.dstIp = packet.dst;
+    datagram.srcPort = ntohs(header.srcPort);
+    datagram.dstPort = ntohs(header.dstPort);
+    datagram.data = udp + sizeof(UdpHeader);
+    datagram.size = length - sizeof(UdpHeader);
+    slot->handler(datagram);
+}
+
+PacketBuffer* UdpLayer::allocate()
+{
+    PacketBuffer* buffer = pool.acquire();
+    if (!buffer) ++counters.txNoBuffer;
+    return buffer;
+}
+
+int UdpLayer::sendTo(PacketBuffer* payload, std::uint16_t srcPort, const Ipv4Address& dst, std::uint16_t dstPort)
+{
+    auto route = ipv4.route(dst);
+    if (!route)
+    {
+        pool.release(payload);
+        ++counters.txErrors;
+        return -1;
+    }
+    return sendTo(payload, srcPort, *route, dstPort);
+}
+
+int UdpLayer::sendTo(PacketBuffer* payload, std::uint16_t srcPort, const Ipv4Route& route, std::uint16_t dstPort)
+{
+    if (!payload) return -1;
+    PacketRef owner(&pool, payload);
+
+    const std::size_t dataSize = payload->size();
+    const std::size_t length = sizeof(UdpHeader) + dataSize;
+    std::uint8_t* udp = payload->prepend(sizeof(UdpHeader));
+    if (!udp || length > kIpv4MaxDatagram - kIpv4HeaderSize)
+    {
+        ++counters.txErrors;
+        return -1;
+    }
+
+    UdpHeader header{htons(srcPort), htons(dstPort), htons(static_cast<std::uint16_t>(length)), 0};
+    std::memcpy(udp, &header, sizeof(header));
+    std::uint32_t sum = checksumPseudoIpv4(route.src.data(), route.dst.data(), IpProto::UDP,
+                                           static_cast<std::uint16_t>(length));
+    std::uint16_t checksum = checksumFinish(checksumAccumulate(udp, length, sum));
+    if (checksum == 0) checksum = 0xFFFF;  // 0 means "no checksum" on the wire
+    std::memcpy(udp + offsetof(UdpHeader, checksum), &checksum, sizeof(checksum));
+
+    const int sent = ipv4.output(*payload, route, IpProto::UDP);
+    if (sent < 0)
+    {
+        ++counters.txErrors;
+        return -1;
+    }
+    ++counters.txDatagrams;
+    counters.txBytes += dataSize;
+    return sent;
+}
+
+int UdpLayer::reply(const UdpDatagram& to, PacketBuffer* payload)
+{
+    static const Ipv4Address kBroadcast{255, 255, 255, 255};
+    Ipv4Route route;
+    route.srcMac = ipv4.link();
+    route.dstMac = to.srcMac;
+    route.src = (to.dstIp == kBroadcast && !ipv4.localAddresses().empty()) ? ipv4.localAddresses().front() : to.dstIp;
+    route.dst = to.srcIp;
+    return sendTo(payload, to.dstPort, route, to.srcPort);
+}
+
+void UdpLayer::enableServices(std::size_t chargenSize)
+{
+    bind(UdpPort::Echo, [this](const UdpDatagram& d) {
+        PacketBuffer* out = allocate();
+        if (!out) return;
+        std::uint8_t* data = out->append(d.size);
+        if (!data)
+        {
+            pool.release(out);
+            return;
+        }
+        std::memcpy(data, d.data, d.size);
+        if (reply(d, out) >= 0) ++counters.echoDatagrams;
+    });
+
+    bind(UdpPort::Discard, [this](const UdpDatagram& d) { counters.discardBytes += d.size; });
+
+    bind(UdpPort::Chargen, [this, chargenSize](const UdpDatagram& d) {
+        PacketBuffer* out = allocate();
+        if (!out) return;
+        const std::size_t size = std::min(chargenSize, out->tailroom() - EthernetII::MinFrameSize);
+        std::uint8_t* data = out->append(size);
+        // 72-character lines, each starting one character later than the previous one.
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            const std::size_t line = i / (kChargenLine + 2);
+            const std::size_t col = i % (kChargenLine + 2);
+            if (col == kChargenLine) data[i] = '\r';
+            else if (col == kChargenLine + 1) data[i] = '\n';
+            else data[i] = static_cast<std::uint8_t>(kChargenFirst + (chargenOffset + line + col) % kChargenSet);
+        }
+        chargenOffset = (chargenOffset + 1) % kChargenSet;
+        if (reply(d, out) >= 0) ++counters.chargenDatagrams;
+    });
+}